@@ -0,0 +1,612 @@
+#!/usr/bin/env python3
+
+"""Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+"""
+
+"""
+Generate a C++ header from a reaction network description (a .rn file).
+
+Usage: generate_reaction_network.py <network.rn> <output directory>
+
+The description lists, one per line ('#' starts a comment):
+
+    model <Name>
+    species <symbol> [<default initial condition>]
+    input <symbol> "<parameter name>" <default value>
+    parameter <symbol> <default value>
+    let <symbol> = <expression>
+    reaction <name>: <reactants> -> <products> ; <forward rate> [; <reverse rate>]
+
+Species are the state variables, in order. Inputs are the ODE system parameters, set
+from outside (e.g. from neighbouring edges). Parameters are kinetic constants, passed
+to the generated functions in an array of their own, so that one block of them can be
+shared by many systems. Expressions may use +, -, *, /, parentheses, numbers,
+any declared symbol, and the functions pow, exp, log and sqrt. Reactants and products
+are species joined by '+', with an optional integer stoichiometry ('2 A').
+
+The header <Name>ReactionNetwork.hpp defines a struct holding the metadata of the network
+and inline functions for the right-hand side, its analytic Jacobian and a right-hand side
+for a batch of systems stored species by species, which share one block of parameters.
+Expressions are emitted in the order written, so the right-hand side is evaluated exactly
+as written.
+"""
+
+import ast
+import os
+import re
+import sys
+
+FUNCTIONS = ('pow', 'exp', 'log', 'sqrt')
+
+
+class NetworkError(Exception):
+    pass
+
+
+class Reaction(object):
+    def __init__(self, name, reactants, products, forward, reverse):
+        self.name = name
+        self.reactants = reactants
+        self.products = products
+        self.forward = forward
+        self.reverse = reverse
+
+
+class Network(object):
+    def __init__(self):
+        self.name = None
+        self.species = []
+        self.initial_conditions = {}
+        self.inputs = []
+        self.parameters = []
+        self.parameter_names = {}
+        self.defaults = {}
+        self.lets = []
+        self.let_expressions = {}
+        self.reactions = []
+
+    def symbols(self):
+        return set(self.species) | set(self.inputs) | set(self.parameters) | set(self.lets)
+
+    def all_parameters(self):
+        return self.inputs + self.parameters
+
+    def parameter_sources(self, input_source, parameter_source):
+        """The C++ expression reading each input or parameter, given those reading each array."""
+        sources = {}
+        for index, symbol in enumerate(self.inputs):
+            sources[symbol] = input_source(index)
+        for index, symbol in enumerate(self.parameters):
+            sources[symbol] = parameter_source(index)
+        return sources
+
+
+def parse_expression(text, network, where):
+    try:
+        tree = ast.parse(text.strip(), mode='eval').body
+    except SyntaxError:
+        raise NetworkError('%s: cannot parse expression "%s"' % (where, text.strip()))
+    check_expression(tree, network, where)
+    return tree
+
+
+def check_expression(node, network, where):
+    if isinstance(node, ast.BinOp):
+        if not isinstance(node.op, (ast.Add, ast.Sub, ast.Mult, ast.Div)):
+            raise NetworkError('%s: unsupported operator' % where)
+        check_expression(node.left, network, where)
+        check_expression(node.right, network, where)
+    elif isinstance(node, ast.UnaryOp):
+        if not isinstance(node.op, (ast.USub, ast.UAdd)):
+            raise NetworkError('%s: unsupported operator' % where)
+        check_expression(node.operand, network, where)
+    elif isinstance(node, ast.Call):
+        if not isinstance(node.func, ast.Name) or node.func.id not in FUNCTIONS:
+            raise NetworkError('%s: unknown function' % where)
+        expected = 2 if node.func.id == 'pow' else 1
+        if len(node.args) != expected or node.keywords:
+            raise NetworkError('%s: %s takes %d argument(s)' % (where, node.func.id, expected))
+        for arg in node.args:
+            check_expression(arg, network, where)
+    elif isinstance(node, ast.Name):
+        if node.id not in network.symbols():
+            raise NetworkError('%s: unknown symbol "%s"' % (where, node.id))
+    elif isinstance(node, ast.Constant) and isinstance(node.value, (int, float)):
+        pass
+    else:
+        raise NetworkError('%s: unsupported expression' % where)
+
+
+def parse_side(text, network, where):
+    side = {}
+    for term in text.split('+'):
+        term = term.strip()
+        if not term:
+            continue
+        match = re.match(r'^(\d+)?\s*([A-Za-z_]\w*)$', term)
+        if not match or match.group(2) not in network.species:
+            raise NetworkError('%s: "%s" is not a species' % (where, term))
+        side[match.group(2)] = side.get(match.group(2), 0) + int(match.group(1) or 1)
+    return side
+
+
+def parse_network(path):
+    network = Network()
+    with open(path) as description:
+        lines = description.readlines()
+    for number, raw_line in enumerate(lines, 1):
+        line = raw_line.split('#', 1)[0].strip()
+        where = '%s:%d' % (os.path.basename(path), number)
+        if not line:
+            continue
+        keyword, _, rest = line.partition(' ')
+        rest = rest.strip()
+        if keyword == 'model':
+            network.name = rest
+        elif keyword == 'species':
+            fields = rest.split()
+            network.species.append(fields[0])
+            network.initial_conditions[fields[0]] = float(fields[1]) if len(fields) > 1 else 0.0
+        elif keyword == 'input':
+            match = re.match(r'^([A-Za-z_]\w*)\s+"([^"]+)"\s+(\S+)$', rest)
+            if not match:
+                raise NetworkError('%s: expected input <symbol> "<name>" <default>' % where)
+            network.inputs.append(match.group(1))
+            network.parameter_names[match.group(1)] = match.group(2)
+            network.defaults[match.group(1)] = float(match.group(3))
+        elif keyword == 'parameter':
+            fields = rest.split()
+            if len(fields) != 2:
+                raise NetworkError('%s: expected parameter <symbol> <default>' % where)
+            network.parameters.append(fields[0])
+            network.parameter_names[fields[0]] = fields[0]
+            network.defaults[fields[0]] = float(fields[1])
+        elif keyword == 'let':
+            symbol, _, expression = rest.partition('=')
+            symbol = symbol.strip()
+            network.let_expressions[symbol] = parse_expression(expression, network, where)
+            network.lets.append(symbol)
+        elif keyword == 'reaction':
+            name, _, body = rest.partition(':')
+            parts = [part.strip() for part in body.split(';')]
+            if len(parts) not in (2, 3) or '->' not in parts[0]:
+                raise NetworkError('%s: expected reaction <name>: <reactants> -> <products> ; <forward> [; <reverse>]' % where)
+            reactants, products = parts[0].split('->')
+            reverse = parse_expression(parts[2], network, where) if len(parts) == 3 else None
+            network.reactions.append(Reaction(name.strip(),
+                                              parse_side(reactants, network, where),
+                                              parse_side(products, network, where),
+                                              parse_expression(parts[1], network, where),
+                                              reverse))
+        else:
+            raise NetworkError('%s: unknown keyword "%s"' % (where, keyword))
+
+    if not network.name or not network.species:
+        raise NetworkError('%s: a model needs a name and at least one species' % path)
+    names = [network.name] + network.species + network.all_parameters() + network.lets + [r.name for r in network.reactions]
+    duplicates = set(name for name in names if names.count(name) > 1)
+    if duplicates:
+        raise NetworkError('%s: symbols declared twice: %s' % (path, ', '.join(sorted(duplicates))))
+    return network
+
+
+# Symbolic differentiation
+
+def number(value):
+    return ast.Constant(value=value)
+
+
+def is_number(node, value=None):
+    return isinstance(node, ast.Constant) and (value is None or node.value == value)
+
+
+def add(left, right):
+    if is_number(left, 0):
+        return right
+    if is_number(right, 0):
+        return left
+    return ast.BinOp(left=left, op=ast.Add(), right=right)
+
+
+def subtract(left, right):
+    if is_number(right, 0):
+        return left
+    if is_number(left, 0):
+        return ast.UnaryOp(op=ast.USub(), operand=right)
+    return ast.BinOp(left=left, op=ast.Sub(), right=right)
+
+
+def multiply(left, right):
+    if is_number(left, 0) or is_number(right, 0):
+        return number(0)
+    if is_number(left, 1):
+        return right
+    if is_number(right, 1):
+        return left
+    return ast.BinOp(left=left, op=ast.Mult(), right=right)
+
+
+def divide(left, right):
+    if is_number(left, 0):
+        return number(0)
+    if is_number(right, 1):
+        return left
+    return ast.BinOp(left=left, op=ast.Div(), right=right)
+
+
+def call(function, *args):
+    return ast.Call(func=ast.Name(id=function, ctx=ast.Load()), args=list(args), keywords=[])
+
+
+def derivative_name(symbol, species):
+    return 'd_%s_d_%s' % (symbol, species)
+
+
+def dependencies(node, network, cache):
+    """The species on which an expression depends, directly or through lets."""
+    found = set()
+    for child in ast.walk(node):
+        if isinstance(child, ast.Name) and child.id not in FUNCTIONS:
+            if child.id in network.species:
+                found.add(child.id)
+            elif child.id in network.let_expressions:
+                if child.id not in cache:
+                    cache[child.id] = dependencies(network.let_expressions[child.id], network, cache)
+                found |= cache[child.id]
+    return found
+
+
+def differentiate(node, species, network, cache):
+    if isinstance(node, ast.Constant):
+        return number(0)
+    if isinstance(node, ast.Name):
+        if node.id == species:
+            return number(1)
+        if node.id in network.let_expressions and species in dependencies(node, network, cache):
+            return ast.Name(id=derivative_name(node.id, species), ctx=ast.Load())
+        return number(0)
+    if isinstance(node, ast.UnaryOp):
+        inner = differentiate(node.operand, species, network, cache)
+        return subtract(number(0), inner) if isinstance(node.op, ast.USub) else inner
+    if isinstance(node, ast.BinOp):
+        d_left = differentiate(node.left, species, network, cache)
+        d_right = differentiate(node.right, species, network, cache)
+        if isinstance(node.op, ast.Add):
+            return add(d_left, d_right)
+        if isinstance(node.op, ast.Sub):
+            return subtract(d_left, d_right)
+        if isinstance(node.op, ast.Mult):
+            return add(multiply(d_left, node.right), multiply(node.left, d_right))
+        # Quotient rule
+        return divide(subtract(multiply(d_left, node.right), multiply(node.left, d_right)),
+                      call('pow', node.right, number(2)))
+    if isinstance(node, ast.Call):
+        function = node.func.id
+        argument = node.args[0]
+        d_argument = differentiate(argument, species, network, cache)
+        if function == 'pow':
+            exponent = node.args[1]
+            if species in dependencies(exponent, network, cache):
+                raise NetworkError('exponents depending on a species are not supported')
+            return multiply(multiply(exponent, call('pow', argument, subtract(exponent, number(1)))), d_argument)
+        if function == 'exp':
+            return multiply(node, d_argument)
+        if function == 'log':
+            return divide(d_argument, argument)
+        if function == 'sqrt':
+            return divide(d_argument, multiply(number(2), node))
+    raise NetworkError('cannot differentiate expression')
+
+
+# C++ output
+
+PRECEDENCE = {ast.Add: 1, ast.Sub: 1, ast.Mult: 2, ast.Div: 2}
+OPERATORS = {ast.Add: '+', ast.Sub: '-', ast.Mult: '*', ast.Div: '/'}
+
+
+def to_cpp(node, rename=None):
+    """Print an expression with just the parentheses needed to keep its evaluation order."""
+    def format_number(value):
+        text = repr(float(value))
+        return text if ('.' in text or 'e' in text) else text + '.0'
+
+    def visit(node, parent_precedence=0, is_right=False):
+        if isinstance(node, ast.Constant):
+            return format_number(node.value)
+        if isinstance(node, ast.Name):
+            return rename(node.id) if rename else node.id
+        if isinstance(node, ast.UnaryOp):
+            text = ('-' if isinstance(node.op, ast.USub) else '+') + visit(node.operand, 3)
+            return '(' + text + ')' if parent_precedence > 0 else text
+        if isinstance(node, ast.Call):
+            return '%s(%s)' % (node.func.id, ', '.join(visit(arg) for arg in node.args))
+        precedence = PRECEDENCE[type(node.op)]
+        text = '%s %s %s' % (visit(node.left, precedence), OPERATORS[type(node.op)], visit(node.right, precedence, True))
+        if precedence < parent_precedence or (is_right and precedence == parent_precedence):
+            text = '(' + text + ')'
+        return text
+
+    return visit(node)
+
+
+def used_symbols(nodes, network):
+    """The symbols used by some expressions, including those used by the lets they use."""
+    used = set()
+    pending = list(nodes)
+    while pending:
+        for child in ast.walk(pending.pop()):
+            if isinstance(child, ast.Name) and child.id not in FUNCTIONS and child.id not in used:
+                used.add(child.id)
+                if child.id in network.let_expressions:
+                    pending.append(network.let_expressions[child.id])
+    return used
+
+
+def declarations(network, used, species_source, parameter_sources, indent):
+    lines = []
+    for index, species in enumerate(network.species):
+        if species in used:
+            lines.append('%sconst double %s = %s;' % (indent, species, species_source(index)))
+    for parameter in network.all_parameters():
+        if parameter in used:
+            lines.append('%sconst double %s = %s;' % (indent, parameter, parameter_sources[parameter]))
+    for let in network.lets:
+        if let in used:
+            lines.append('%sconst double %s = %s;' % (indent, let, to_cpp(network.let_expressions[let])))
+    return lines
+
+
+def net_rate(reaction):
+    if reaction.reverse is None:
+        return reaction.forward
+    return ast.BinOp(left=reaction.forward, op=ast.Sub(), right=reaction.reverse)
+
+
+def rate_of_change(network, species, term):
+    """The sum of +/- term(reaction) over the reactions changing a species, in reaction order."""
+    text = ''
+    for reaction in network.reactions:
+        change = reaction.products.get(species, 0) - reaction.reactants.get(species, 0)
+        if change == 0:
+            continue
+        magnitude = term(reaction) if abs(change) == 1 else '%d.0*%s' % (abs(change), term(reaction))
+        if not text:
+            text = magnitude if change > 0 else '-' + magnitude
+        else:
+            text += (' + ' if change > 0 else ' - ') + magnitude
+    return text or '0.0'
+
+
+def rhs_body(network, species_source, parameter_sources, target, indent):
+    rates = [net_rate(reaction) for reaction in network.reactions]
+    lines = declarations(network, used_symbols(rates, network), species_source, parameter_sources, indent)
+    lines.append('')
+    for reaction, rate in zip(network.reactions, rates):
+        lines.append('%sconst double %s = %s;' % (indent, reaction.name, to_cpp(rate)))
+    lines.append('')
+    for index, species in enumerate(network.species):
+        lines.append('%s%s = %s;' % (indent, target(index), rate_of_change(network, species, lambda r: r.name)))
+    return lines
+
+
+def jacobian_body(network, indent):
+    cache = {}
+    n = len(network.species)
+    rates = [net_rate(reaction) for reaction in network.reactions]
+    partials = []
+    for reaction, rate in zip(network.reactions, rates):
+        for j, species in enumerate(network.species):
+            partial = differentiate(rate, species, network, cache)
+            if not is_number(partial, 0):
+                partials.append((reaction, j, partial))
+
+    # Derivatives of the lets, each written in terms of those of the lets it uses
+    let_derivatives = []
+    for let in network.lets:
+        for species in network.species:
+            if species in dependencies(network.let_expressions[let], network, cache):
+                let_derivatives.append((derivative_name(let, species),
+                                        differentiate(network.let_expressions[let], species, network, cache)))
+    needed = used_symbols([partial for _, _, partial in partials], network)
+    for name, expression in reversed(let_derivatives):
+        if name in needed:
+            needed |= used_symbols([expression], network)
+
+    lines = declarations(network, needed, lambda i: 'pY[%d]' % i,
+                         network.parameter_sources(lambda i: 'pInputs[%d]' % i, lambda i: 'pParameters[%d]' % i), indent)
+    for name, expression in let_derivatives:
+        if name in needed:
+            lines.append('%sconst double %s = %s;' % (indent, name, to_cpp(expression)))
+    lines.append('')
+
+    lines.append('%sfor (unsigned i = 0; i < %d; i++)' % (indent, n*n))
+    lines.append('%s{' % indent)
+    lines.append('%s    pJacobian[i] = 0.0;' % indent)
+    lines.append('%s}' % indent)
+    for reaction, j, partial in partials:
+        name = 'd_%s_d_%s' % (reaction.name, network.species[j])
+        lines.append('%sconst double %s = %s;' % (indent, name, to_cpp(partial)))
+        for i, changed in enumerate(network.species):
+            change = reaction.products.get(changed, 0) - reaction.reactants.get(changed, 0)
+            if change != 0:
+                term = name if abs(change) == 1 else '%d.0*%s' % (abs(change), name)
+                lines.append('%spJacobian[%d] %s= %s;' % (indent, i*n + j, '+' if change > 0 else '-', term))
+    return lines
+
+
+def generate(network):
+    struct = '%sReactionNetwork' % network.name
+    guard = struct.upper() + '_HPP_'
+    n = len(network.species)
+
+    out = []
+    out.append('// Generated by reaction_networks/generate_reaction_network.py from %s.rn; do not edit.' % network.name)
+    out.append('')
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('#include <cmath>')
+    out.append('')
+    out.append('/**')
+    out.append(' * The %s reaction network: its species and parameters, and specialised' % network.name)
+    out.append(' * evaluations of its right-hand side and Jacobian.')
+    out.append(' */')
+    out.append('struct %s' % struct)
+    out.append('{')
+    out.append('    /** The number of species, which are the state variables. */')
+    out.append('    static constexpr unsigned NUM_SPECIES = %d;' % n)
+    out.append('')
+    out.append('    /** The number of inputs, which are the ODE system parameters. */')
+    out.append('    static constexpr unsigned NUM_INPUTS = %d;' % len(network.inputs))
+    out.append('')
+    out.append('    /** The number of kinetic parameters, which are passed separately from the inputs. */')
+    out.append('    static constexpr unsigned NUM_KINETIC_PARAMETERS = %d;' % len(network.parameters))
+    out.append('')
+    for index, species in enumerate(network.species):
+        out.append('    /** The index of species %s. */' % species)
+        out.append('    static constexpr unsigned SPECIES_%s = %d;' % (species, index))
+    out.append('')
+    for index, symbol in enumerate(network.inputs):
+        out.append('    /** The index of input %s ("%s"). */' % (symbol, network.parameter_names[symbol]))
+        out.append('    static constexpr unsigned INPUT_%s = %d;' % (symbol, index))
+    out.append('')
+    for index, parameter in enumerate(network.parameters):
+        out.append('    /** The index of kinetic parameter %s. */' % parameter)
+        out.append('    static constexpr unsigned PARAMETER_%s = %d;' % (parameter, index))
+    out.append('')
+
+    def table(function, doc, kind, values):
+        out.append('    /**')
+        out.append('     * @param index the index of a %s' % kind)
+        out.append('     * @return %s' % doc)
+        out.append('     */')
+        ctype = 'const char*' if isinstance(values[0], str) else 'double'
+        out.append('    static %s %s(unsigned index)' % (ctype, function))
+        out.append('    {')
+        items = ', '.join('"%s"' % v if isinstance(v, str) else repr(float(v)) for v in values)
+        out.append('        static const %s values[%d] = {%s};' % ('char* const' if ctype == 'const char*' else 'double', len(values), items))
+        out.append('        return values[index];')
+        out.append('    }')
+        out.append('')
+
+    table('GetSpeciesName', 'the name of the species', 'species', network.species)
+    table('GetDefaultInitialCondition', 'the default initial condition of the species', 'species',
+          [network.initial_conditions[s] for s in network.species])
+    table('GetInputName', 'the name of the input', 'input', [network.parameter_names[p] for p in network.inputs])
+    table('GetDefaultInput', 'the default value of the input', 'input', [network.defaults[p] for p in network.inputs])
+    table('GetParameterName', 'the name of the kinetic parameter', 'kinetic parameter',
+          [network.parameter_names[p] for p in network.parameters])
+    table('GetDefaultParameter', 'the default value of the kinetic parameter', 'kinetic parameter',
+          [network.defaults[p] for p in network.parameters])
+
+    out.append('    /**')
+    out.append('     * Evaluate the right-hand side.')
+    out.append('     *')
+    out.append('     * @param pY the %d species' % n)
+    out.append('     * @param pInputs the %d inputs' % len(network.inputs))
+    out.append('     * @param pParameters the %d kinetic parameters' % len(network.parameters))
+    out.append('     * @param pDY filled in with the rate of change of each species')
+    out.append('     */')
+    out.append('    static inline void EvaluateRhs(const double* pY, const double* pInputs, const double* pParameters, double* pDY)')
+    out.append('    {')
+    out.extend(rhs_body(network, lambda i: 'pY[%d]' % i,
+                        network.parameter_sources(lambda i: 'pInputs[%d]' % i, lambda i: 'pParameters[%d]' % i),
+                        lambda i: 'pDY[%d]' % i, '        '))
+    out.append('    }')
+    out.append('')
+    out.append('    /**')
+    out.append('     * Evaluate the right-hand side of a batch of systems, stored species by species so')
+    out.append('     * that the loop over systems can be vectorised.')
+    out.append('     *')
+    out.append('     * @param numSystems the number of systems')
+    out.append('     * @param pY species i of system s at pY[i*numSystems + s]')
+    out.append('     * @param pInputs input j of system s at pInputs[j*numSystems + s]')
+    out.append('     * @param pParameters the %d kinetic parameters, shared by every system' % len(network.parameters))
+    out.append('     * @param pDY filled in like pY with the rates of change')
+    out.append('     */')
+    out.append('    static inline void EvaluateRhsBatch(unsigned numSystems, const double* pY, const double* pInputs, const double* pParameters, double* pDY)')
+    out.append('    {')
+    out.append('        for (unsigned s = 0; s < numSystems; s++)')
+    out.append('        {')
+    out.extend(rhs_body(network, lambda i: 'pY[%d*numSystems + s]' % i,
+                        network.parameter_sources(lambda i: 'pInputs[%d*numSystems + s]' % i, lambda i: 'pParameters[%d]' % i),
+                        lambda i: 'pDY[%d*numSystems + s]' % i, '            '))
+    out.append('        }')
+    out.append('    }')
+    out.append('')
+    out.append('    /**')
+    out.append('     * Evaluate the analytic Jacobian of the right-hand side.')
+    out.append('     *')
+    out.append('     * @param pY the %d species' % n)
+    out.append('     * @param pInputs the %d inputs' % len(network.inputs))
+    out.append('     * @param pParameters the %d kinetic parameters' % len(network.parameters))
+    out.append('     * @param pJacobian filled in with the %dx%d Jacobian, stored by rows' % (n, n))
+    out.append('     */')
+    out.append('    static inline void EvaluateJacobian(const double* pY, const double* pInputs, const double* pParameters, double* pJacobian)')
+    out.append('    {')
+    out.extend(jacobian_body(network, '        '))
+    out.append('    }')
+    out.append('')
+    out.append('};')
+    out.append('')
+    out.append('#endif /*%s*/' % guard)
+    # Strip trailing spaces left by empty lines
+    return '\n'.join(line.rstrip() for line in out) + '\n'
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('Usage: %s <network.rn> <output directory>\n' % argv[0])
+        return 2
+    try:
+        network = parse_network(argv[1])
+        text = generate(network)
+    except NetworkError as error:
+        sys.stderr.write('error: %s\n' % error)
+        return 1
+
+    if not os.path.isdir(argv[2]):
+        os.makedirs(argv[2])
+    output = os.path.join(argv[2], '%sReactionNetwork.hpp' % network.name)
+
+    # Only touch the header when it changes, to avoid needless rebuilds
+    if os.path.exists(output):
+        with open(output) as existing:
+            if existing.read() == text:
+                return 0
+    with open(output, 'w') as header:
+        header.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,109 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AbstractReactionNetworkOdeSystem.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "Exception.hpp"
+
+AbstractReactionNetworkOdeSystem::AbstractReactionNetworkOdeSystem(unsigned numberOfStateVariables)
+    : AbstractOdeSystem(numberOfStateVariables),
+      mSuggestedTimeStep(0.0)
+{
+}
+
+AbstractReactionNetworkOdeSystem::~AbstractReactionNetworkOdeSystem()
+{
+}
+
+void AbstractReactionNetworkOdeSystem::EvaluateJacobian(double time, const std::vector<double>& rY, std::vector<double>& rJacobian)
+{
+    ApproximateJacobian(*this, time, rY, rJacobian);
+}
+
+void AbstractReactionNetworkOdeSystem::ApproximateJacobian(AbstractOdeSystem& rSystem, double time, const std::vector<double>& rY, std::vector<double>& rJacobian)
+{
+    const unsigned n = rY.size();
+    rJacobian.resize(n*n);
+
+    std::vector<double> y_perturbed(rY);
+    std::vector<double> dy(n);
+    std::vector<double> dy_perturbed(n);
+    rSystem.EvaluateYDerivatives(time, rY, dy);
+
+    const double sqrt_eps = sqrt(DBL_EPSILON);
+    for (unsigned j = 0; j < n; j++)
+    {
+        const double increment = sqrt_eps*std::max(fabs(rY[j]), 1.0);
+        y_perturbed[j] = rY[j] + increment;
+        rSystem.EvaluateYDerivatives(time, y_perturbed, dy_perturbed);
+        y_perturbed[j] = rY[j];
+
+        for (unsigned i = 0; i < n; i++)
+        {
+            rJacobian[i*n + j] = (dy_perturbed[i] - dy[i])/increment;
+        }
+    }
+}
+
+double AbstractReactionNetworkOdeSystem::GetSuggestedTimeStep() const
+{
+    return mSuggestedTimeStep;
+}
+
+void AbstractReactionNetworkOdeSystem::SetSuggestedTimeStep(double timeStep)
+{
+    mSuggestedTimeStep = timeStep;
+}
+
+void AbstractReactionNetworkOdeSystem::SetFastSpeciesHint(const std::vector<unsigned>& rFastSpecies)
+{
+    for (unsigned i = 0; i < rFastSpecies.size(); i++)
+    {
+        if (rFastSpecies[i] >= GetNumberOfStateVariables())
+        {
+            EXCEPTION("Fast species index " << rFastSpecies[i] << " is out of range.");
+        }
+    }
+    mFastSpeciesHint = rFastSpecies;
+}
+
+const std::vector<unsigned>& AbstractReactionNetworkOdeSystem::rGetFastSpeciesHint() const
+{
+    return mFastSpeciesHint;
+}
@@ -0,0 +1,146 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ABSTRACTREACTIONNETWORKODESYSTEM_HPP_
+#define ABSTRACTREACTIONNETWORKODESYSTEM_HPP_
+
+#include "ChasteSerialization.hpp"
+#include "ClassIsAbstract.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <vector>
+
+#include "AbstractOdeSystem.hpp"
+
+/**
+ * An ODE system describing a small reaction network, with the extra information
+ * used by the specialised solvers in this project (such as RosenbrockWIvpOdeSolver).
+ *
+ * Subclasses should override EvaluateJacobian() if an analytic Jacobian is available;
+ * by default it is approximated by finite differences. The system also stores the
+ * step size last proposed by an adaptive solver, so that a solver shared between many
+ * systems (as CellCycleModelOdeSolver singletons are) can restart each system with the
+ * step size appropriate to it.
+ */
+class AbstractReactionNetworkOdeSystem : public AbstractOdeSystem
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractOdeSystem>(*this);
+        archive & mSuggestedTimeStep;
+        archive & mFastSpeciesHint;
+    }
+
+    /** The step size last proposed by an adaptive solver for this system, or 0 if none. */
+    double mSuggestedTimeStep;
+
+    /** Indices of the state variables that multirate solvers should treat as fast; empty for automatic partitioning. */
+    std::vector<unsigned> mFastSpeciesHint;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param numberOfStateVariables the number of state variables in the ODE system
+     */
+    AbstractReactionNetworkOdeSystem(unsigned numberOfStateVariables);
+
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractReactionNetworkOdeSystem();
+
+    /**
+     * Compute the Jacobian of the right-hand side, J[i*n + j] = d(dy_i/dt)/dy_j.
+     *
+     * The default implementation uses ApproximateJacobian().
+     *
+     * @param time the time at which to evaluate the Jacobian
+     * @param rY the state at which to evaluate the Jacobian
+     * @param rJacobian filled in with the n*n Jacobian, stored by rows
+     */
+    virtual void EvaluateJacobian(double time, const std::vector<double>& rY, std::vector<double>& rJacobian);
+
+    /**
+     * Approximate the Jacobian of any ODE system by forward differences.
+     *
+     * @param rSystem the ODE system
+     * @param time the time at which to evaluate the Jacobian
+     * @param rY the state at which to evaluate the Jacobian
+     * @param rJacobian filled in with the n*n Jacobian, stored by rows
+     */
+    static void ApproximateJacobian(AbstractOdeSystem& rSystem, double time, const std::vector<double>& rY, std::vector<double>& rJacobian);
+
+    /**
+     * @return the step size last proposed by an adaptive solver for this system, or 0 if none
+     */
+    double GetSuggestedTimeStep() const;
+
+    /**
+     * Store the step size proposed by an adaptive solver for this system.
+     *
+     * @param timeStep the proposed step size
+     */
+    void SetSuggestedTimeStep(double timeStep);
+
+    /**
+     * Tell multirate solvers which state variables are fast, overriding their automatic
+     * partitioning by timescale. Pass an empty vector to return to automatic partitioning.
+     *
+     * @param rFastSpecies the indices of the fast state variables
+     */
+    void SetFastSpeciesHint(const std::vector<unsigned>& rFastSpecies);
+
+    /**
+     * @return the indices of the state variables given as fast by SetFastSpeciesHint(), or an empty vector
+     */
+    const std::vector<unsigned>& rGetFastSpeciesHint() const;
+};
+
+CLASS_IS_ABSTRACT(AbstractReactionNetworkOdeSystem)
+
+#endif /*ABSTRACTREACTIONNETWORKODESYSTEM_HPP_*/
@@ -0,0 +1,284 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AsyncEdgeDataOutputModifier.hpp"
+#include "CellData.hpp"
+#include "CellEdgeData.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+#include "SimulationTime.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "Exception.hpp"
+
+template<unsigned DIM>
+AsyncEdgeDataOutputModifier<DIM>::AsyncEdgeDataOutputModifier()
+    : AbstractCellBasedSimulationModifier<DIM,DIM>(),
+      mSamplingTimestepMultiple(1),
+      mNumberOfBuffers(2),
+      mNumberOfPieces(1),
+      mUseCompression(false)
+{
+}
+
+template<unsigned DIM>
+AsyncEdgeDataOutputModifier<DIM>::~AsyncEdgeDataOutputModifier()
+{
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::SetSamplingTimestepMultiple(unsigned samplingTimestepMultiple)
+{
+    if (samplingTimestepMultiple == 0)
+    {
+        EXCEPTION("The sampling timestep multiple must be positive.");
+    }
+    mSamplingTimestepMultiple = samplingTimestepMultiple;
+}
+
+template<unsigned DIM>
+unsigned AsyncEdgeDataOutputModifier<DIM>::GetSamplingTimestepMultiple() const
+{
+    return mSamplingTimestepMultiple;
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::SetNumberOfBuffers(unsigned numBuffers)
+{
+    if (numBuffers == 0)
+    {
+        EXCEPTION("An edge data writer needs at least one snapshot buffer.");
+    }
+    mNumberOfBuffers = numBuffers;
+}
+
+template<unsigned DIM>
+unsigned AsyncEdgeDataOutputModifier<DIM>::GetNumberOfBuffers() const
+{
+    return mNumberOfBuffers;
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::SetNumberOfPieces(unsigned numPieces)
+{
+    if (numPieces == 0)
+    {
+        EXCEPTION("An edge data writer needs at least one piece.");
+    }
+    mNumberOfPieces = numPieces;
+}
+
+template<unsigned DIM>
+unsigned AsyncEdgeDataOutputModifier<DIM>::GetNumberOfPieces() const
+{
+    return mNumberOfPieces;
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::SetUseCompression(bool useCompression)
+{
+    mUseCompression = useCompression;
+}
+
+template<unsigned DIM>
+bool AsyncEdgeDataOutputModifier<DIM>::GetUseCompression() const
+{
+    return mUseCompression;
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::SetEdgeDataSchema(boost::shared_ptr<EdgeDataSchema> pEdgeDataSchema)
+{
+    mpEdgeDataSchema = pEdgeDataSchema;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<EdgeDataSchema> AsyncEdgeDataOutputModifier<DIM>::GetEdgeDataSchema() const
+{
+    return mpEdgeDataSchema;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<EdgeDataVtuWriter> AsyncEdgeDataOutputModifier<DIM>::GetWriter() const
+{
+    return mpWriter;
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (SimulationTime::Instance()->GetTimeStepsElapsed() % mSamplingTimestepMultiple == 0)
+    {
+        WriteSnapshot(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    assert(dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation));
+
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    mpWriter.reset();
+    if (PetscTools::AmMaster())
+    {
+        mpWriter.reset(new EdgeDataVtuWriter(output_file_handler.GetOutputDirectoryFullPath(), "edge_results",
+                                             mNumberOfBuffers, mNumberOfPieces, mUseCompression));
+    }
+    WriteSnapshot(rCellPopulation);
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpWriter)
+    {
+        mpWriter->Finish();
+    }
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::WriteSnapshot(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (!mpWriter)
+    {
+        return;
+    }
+
+    // Waits here if the writer has fallen behind
+    EdgeDataSnapshot& r_snapshot = mpWriter->AcquireBuffer();
+    r_snapshot.mTime = SimulationTime::Instance()->GetTime();
+    r_snapshot.mTimeStep = SimulationTime::Instance()->GetTimeStepsElapsed();
+
+    VertexBasedCellPopulation<DIM>* p_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    MutableVertexMesh<DIM,DIM>& r_mesh = p_population->rGetMesh();
+
+    std::vector<std::string> edge_keys;
+    std::vector<std::string> cell_keys;
+    std::vector<double> cell_values;
+    bool is_first_cell = true;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        // Each of these builds a property collection, so fetch them once per cell
+        boost::shared_ptr<CellEdgeData> p_cell_edge_data = cell_iter->GetCellEdgeData();
+        boost::shared_ptr<CellData> p_cell_data = cell_iter->GetCellData();
+
+        // The fields are the written items of the first cell
+        if (is_first_cell)
+        {
+            is_first_cell = false;
+            for (const std::string& r_key : p_cell_edge_data->GetKeys())
+            {
+                if (!mpEdgeDataSchema || mpEdgeDataSchema->IsItemWritten(r_key))
+                {
+                    edge_keys.push_back(r_key);
+                }
+            }
+            cell_keys = p_cell_data->GetKeys();
+            cell_values.resize(cell_keys.size());
+            r_snapshot.mFieldNames = edge_keys;
+            r_snapshot.mFieldNames.insert(r_snapshot.mFieldNames.end(), cell_keys.begin(), cell_keys.end());
+            r_snapshot.mFields.resize(r_snapshot.mFieldNames.size());
+        }
+
+        const unsigned location_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        VertexElement<DIM,DIM>* p_element = r_mesh.GetElement(location_index);
+        const unsigned cell_id = cell_iter->GetCellId();
+        for (unsigned key = 0; key < cell_keys.size(); key++)
+        {
+            cell_values[key] = p_cell_data->GetItem(cell_keys[key]);
+        }
+
+        // The centroid, then the nodes of the element
+        const unsigned first_point = r_snapshot.mPoints.size()/3;
+        c_vector<double, DIM> centroid = r_mesh.GetCentroidOfElement(location_index);
+        for (unsigned i = 0; i < 3; i++)
+        {
+            r_snapshot.mPoints.push_back(i < DIM ? centroid[i] : 0.0);
+        }
+        for (unsigned node = 0; node < p_element->GetNumNodes(); node++)
+        {
+            const c_vector<double, DIM>& r_location = p_element->GetNode(node)->rGetLocation();
+            for (unsigned i = 0; i < 3; i++)
+            {
+                r_snapshot.mPoints.push_back(i < DIM ? r_location[i] : 0.0);
+            }
+        }
+
+        // A triangle per edge
+        for (unsigned edge = 0; edge < p_element->GetNumEdges(); edge++)
+        {
+            Edge<DIM>* p_edge = p_element->GetEdge(edge);
+            r_snapshot.mConnectivity.push_back(first_point);
+            r_snapshot.mConnectivity.push_back(first_point + 1 + p_element->GetNodeLocalIndex(p_edge->GetNode(0)->GetIndex()));
+            r_snapshot.mConnectivity.push_back(first_point + 1 + p_element->GetNodeLocalIndex(p_edge->GetNode(1)->GetIndex()));
+            r_snapshot.mCellIds.push_back(cell_id);
+
+            for (unsigned key = 0; key < edge_keys.size(); key++)
+            {
+                r_snapshot.mFields[key].push_back(p_cell_edge_data->GetItemAtIndex(edge_keys[key], edge));
+            }
+            for (unsigned key = 0; key < cell_keys.size(); key++)
+            {
+                r_snapshot.mFields[edge_keys.size() + key].push_back(cell_values[key]);
+            }
+        }
+    }
+
+    mpWriter->Submit(r_snapshot);
+}
+
+template<unsigned DIM>
+void AsyncEdgeDataOutputModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<SamplingTimestepMultiple>" << mSamplingTimestepMultiple << "</SamplingTimestepMultiple>\n";
+    *rParamsFile << "\t\t\t<NumberOfBuffers>" << mNumberOfBuffers << "</NumberOfBuffers>\n";
+    *rParamsFile << "\t\t\t<NumberOfPieces>" << mNumberOfPieces << "</NumberOfPieces>\n";
+    *rParamsFile << "\t\t\t<UseCompression>" << mUseCompression << "</UseCompression>\n";
+    *rParamsFile << "\t\t\t<UseEdgeDataSchema>" << bool(mpEdgeDataSchema) << "</UseEdgeDataSchema>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class AsyncEdgeDataOutputModifier<1>;
+template class AsyncEdgeDataOutputModifier<2>;
+template class AsyncEdgeDataOutputModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(AsyncEdgeDataOutputModifier)
@@ -0,0 +1,228 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ASYNCEDGEDATAOUTPUTMODIFIER_HPP_
+#define ASYNCEDGEDATAOUTPUTMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "EdgeDataSchema.hpp"
+#include "EdgeDataVtuWriter.hpp"
+
+/**
+ * A modifier that writes the CellData and CellEdgeData of a vertex-based cell population
+ * to VTU files without holding up the simulation.
+ *
+ * At each sampled time step the positions and data are copied into a pre-allocated
+ * snapshot buffer, which an EdgeDataVtuWriter writes on a background thread while the
+ * simulation carries on. A bounded number of buffers provides backpressure: if the disk
+ * falls behind, the simulation waits for a buffer rather than queueing ever more snapshots.
+ * The files, edge_results_<time step>.vtu collected in edge_results.pvd, hold a triangle
+ * per cell edge (as the population's own edge output does), with the edge data items and
+ * the cell data items of the edge's cell. For large tissues each snapshot can be split
+ * into spatial pieces written concurrently, edge_results_<time step>.pvtu, and the data
+ * compressed; see EdgeDataVtuWriter. Given the EdgeDataSchema of an edge tracking modifier,
+ * only the edge data items the schema writes are output.
+ *
+ * Add this modifier after any modifier that updates the edge data, so that the snapshots
+ * hold the data at the end of each step. To take the population's own output off the
+ * critical path, pair this modifier with a large sampling timestep multiple on the simulation.
+ */
+template<unsigned DIM>
+class AsyncEdgeDataOutputModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The number of time steps between snapshots. Initialised to 1 in the constructor. */
+    unsigned mSamplingTimestepMultiple;
+
+    /** The number of snapshot buffers. Initialised to 2 in the constructor. */
+    unsigned mNumberOfBuffers;
+
+    /** The number of pieces each snapshot is split into. Initialised to 1 in the constructor. */
+    unsigned mNumberOfPieces;
+
+    /** Whether to compress the data arrays. Initialised to false in the constructor. */
+    bool mUseCompression;
+
+    /** The schema saying which edge data items to write, or null to write them all. */
+    boost::shared_ptr<EdgeDataSchema> mpEdgeDataSchema;
+
+    /** The writer of the current (or last) solve, on the master process only. */
+    boost::shared_ptr<EdgeDataVtuWriter> mpWriter;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mSamplingTimestepMultiple;
+        archive & mNumberOfBuffers;
+        archive & mNumberOfPieces;
+        archive & mUseCompression;
+        archive & mpEdgeDataSchema;
+    }
+
+    /**
+     * Helper method to copy the positions and data of the population into a snapshot
+     * buffer and hand it to the writer.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void WriteSnapshot(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    AsyncEdgeDataOutputModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~AsyncEdgeDataOutputModifier();
+
+    /**
+     * @param samplingTimestepMultiple the number of time steps between snapshots
+     */
+    void SetSamplingTimestepMultiple(unsigned samplingTimestepMultiple);
+
+    /**
+     * @return the number of time steps between snapshots
+     */
+    unsigned GetSamplingTimestepMultiple() const;
+
+    /**
+     * @param numBuffers the number of snapshot buffers, and so the largest number of snapshots in flight
+     */
+    void SetNumberOfBuffers(unsigned numBuffers);
+
+    /**
+     * @return the number of snapshot buffers
+     */
+    unsigned GetNumberOfBuffers() const;
+
+    /**
+     * @param numPieces the number of pieces, written concurrently, each snapshot is split into
+     */
+    void SetNumberOfPieces(unsigned numPieces);
+
+    /**
+     * @return the number of pieces each snapshot is split into
+     */
+    unsigned GetNumberOfPieces() const;
+
+    /**
+     * @param useCompression whether to compress the data arrays with zlib
+     */
+    void SetUseCompression(bool useCompression);
+
+    /**
+     * @return whether the data arrays are compressed
+     */
+    bool GetUseCompression() const;
+
+    /**
+     * Set the schema saying which edge data items to write, typically that of the modifier
+     * publishing them. Items unknown to the schema, and the cell data items, are always written.
+     *
+     * @param pEdgeDataSchema the schema, or null to write every edge data item
+     */
+    void SetEdgeDataSchema(boost::shared_ptr<EdgeDataSchema> pEdgeDataSchema);
+
+    /**
+     * @return the schema saying which edge data items to write, or null if they are all written
+     */
+    boost::shared_ptr<EdgeDataSchema> GetEdgeDataSchema() const;
+
+    /**
+     * @return the writer of the current (or last) solve, which is null before the first solve and on processes other than the master
+     */
+    boost::shared_ptr<EdgeDataVtuWriter> GetWriter() const;
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specify what to do in the simulation at the end of each time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Start the writer and write the initial snapshot.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Wait for every snapshot to be written.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(AsyncEdgeDataOutputModifier)
+
+#endif /*ASYNCEDGEDATAOUTPUTMODIFIER_HPP_*/
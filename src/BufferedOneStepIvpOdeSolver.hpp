@@ -0,0 +1,127 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef BUFFEREDONESTEPIVPODESOLVER_HPP_
+#define BUFFEREDONESTEPIVPODESOLVER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "AbstractOdeSystem.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+/**
+ * A one-step solver (a subclass of AbstractOneStepIvpOdeSolver, such as
+ * RungeKutta4IvpOdeSolver) whose Solve() without sampling keeps the next state in a
+ * member, rather than in working memory allocated by every call, so that integrating
+ * an edge SRN over a time step does not allocate once the first step has been taken.
+ *
+ * The steps themselves are those of ONE_STEP_SOLVER, so the results are unchanged.
+ * Solve() with sampling is inherited, since it allocates the OdeSolution anyway.
+ */
+template<class ONE_STEP_SOLVER>
+class BufferedOneStepIvpOdeSolver : public ONE_STEP_SOLVER
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Archive the solver, never used directly - boost uses this.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<ONE_STEP_SOLVER>(*this);
+    }
+
+    /** Working memory: the state at the end of each step. */
+    std::vector<double> mNextYValues;
+
+public:
+
+    using ONE_STEP_SOLVER::Solve;
+
+    /**
+     * Solve without sampling, as AbstractOneStepIvpOdeSolver does, but with working memory
+     * that is kept between calls.
+     *
+     * @param pOdeSystem the ODE system to solve
+     * @param rYValues the initial state, overwritten with the state at the end time
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param timeStep the time step
+     */
+    virtual void Solve(AbstractOdeSystem* pOdeSystem,
+                       std::vector<double>& rYValues,
+                       double startTime,
+                       double endTime,
+                       double timeStep) override
+    {
+        assert(rYValues.size() == pOdeSystem->GetNumberOfStateVariables());
+        assert(endTime > startTime);
+        assert(timeStep > 0.0);
+
+        this->mStoppingEventOccurred = false;
+        if (pOdeSystem->CalculateStoppingEvent(startTime, rYValues))
+        {
+            EXCEPTION("(Solve without sampling) Stopping event is true for initial condition");
+        }
+
+        mNextYValues.resize(rYValues.size());
+        TimeStepper stepper(startTime, endTime, timeStep);
+        while (!stepper.IsTimeAtEnd() && !this->mStoppingEventOccurred)
+        {
+            this->CalculateNextYValue(pOdeSystem, stepper.GetNextTimeStep(), stepper.GetTime(), rYValues, mNextYValues);
+            stepper.AdvanceOneTimeStep();
+
+            if (pOdeSystem->CalculateStoppingEvent(stepper.GetTime(), mNextYValues))
+            {
+                this->mStoppingTime = stepper.GetTime();
+                this->mStoppingEventOccurred = true;
+            }
+            std::copy(mNextYValues.begin(), mNextYValues.end(), rYValues.begin());
+        }
+    }
+};
+
+#endif /*BUFFEREDONESTEPIVPODESOLVER_HPP_*/
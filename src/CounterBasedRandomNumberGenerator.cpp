@@ -0,0 +1,99 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CounterBasedRandomNumberGenerator.hpp"
+
+CounterBasedRandomNumberGenerator::CounterBasedRandomNumberGenerator(unsigned seed, unsigned stream)
+    : mSeed(seed),
+      mStream(stream)
+{
+}
+
+void CounterBasedRandomNumberGenerator::Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4])
+{
+    // Multipliers and Weyl sequence increments from Salmon et al
+    const uint64_t M0 = 0xD2511F53;
+    const uint64_t M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9;
+    const uint32_t W1 = 0xBB67AE85;
+
+    uint32_t c0 = counter[0];
+    uint32_t c1 = counter[1];
+    uint32_t c2 = counter[2];
+    uint32_t c3 = counter[3];
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+
+    for (unsigned round = 0; round < 10; round++)
+    {
+        const uint64_t product0 = M0*c0;
+        const uint64_t product1 = M1*c2;
+        const uint32_t hi0 = uint32_t(product0 >> 32);
+        const uint32_t lo0 = uint32_t(product0);
+        const uint32_t hi1 = uint32_t(product1 >> 32);
+        const uint32_t lo1 = uint32_t(product1);
+
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+
+        k0 += W0;
+        k1 += W1;
+    }
+
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+}
+
+double CounterBasedRandomNumberGenerator::ranf(unsigned cellIndex, unsigned edgeIndex, unsigned drawIndex) const
+{
+    const uint32_t counter[4] = {cellIndex, edgeIndex, drawIndex, 0};
+    const uint32_t key[2] = {mSeed, mStream};
+    uint32_t words[4];
+    Philox4x32(counter, key, words);
+
+    // Combine 27 and 26 random bits into a double in [0, 1)
+    const double high = words[0] >> 5;
+    const double low = words[1] >> 6;
+    return (high*67108864.0 + low)/9007199254740992.0;
+}
+
+double CounterBasedRandomNumberGenerator::ranfForCell(unsigned cellIndex, unsigned drawIndex) const
+{
+    return ranf(cellIndex, CELL_LEVEL, drawIndex);
+}
@@ -0,0 +1,108 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef COUNTERBASEDRANDOMNUMBERGENERATOR_HPP_
+#define COUNTERBASEDRANDOMNUMBERGENERATOR_HPP_
+
+#include <climits>
+#include <cstdint>
+
+/**
+ * A counter-based random number generator, using the Philox-4x32-10 bijection of Salmon
+ * et al, "Parallel random numbers: as easy as 1, 2, 3" (SC11, 2011).
+ *
+ * Unlike RandomNumberGenerator, which produces a single sequence that must be consumed
+ * in order, each number here is a pure function of the seed and of the indices of the
+ * cell and edge it is drawn for. The generator has no state, so draws can be made in any
+ * order, from any thread or process, and give bit-identical results however the work is
+ * divided up.
+ *
+ * The 64-bit key is formed from the seed and a stream number (for example a replica
+ * index), and the 128-bit counter from the cell index, the edge index and a draw index,
+ * which distinguishes several quantities drawn for the same cell or edge.
+ */
+class CounterBasedRandomNumberGenerator
+{
+private:
+
+    /** The first word of the key. */
+    uint32_t mSeed;
+
+    /** The second word of the key. */
+    uint32_t mStream;
+
+public:
+
+    /** The edge index to use for quantities drawn once per cell rather than per edge. */
+    static const unsigned CELL_LEVEL = UINT_MAX;
+
+    /**
+     * Constructor.
+     *
+     * @param seed the seed
+     * @param stream the stream number (defaults to 0)
+     */
+    CounterBasedRandomNumberGenerator(unsigned seed, unsigned stream=0);
+
+    /**
+     * Apply the Philox-4x32-10 bijection.
+     *
+     * @param counter the counter
+     * @param key the key
+     * @param result filled in with the four random 32-bit words
+     */
+    static void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+    /**
+     * Draw a uniform random number in [0, 1), with 53 random bits.
+     *
+     * @param cellIndex the index of the cell the number is drawn for
+     * @param edgeIndex the local index of the edge the number is drawn for, or CELL_LEVEL
+     * @param drawIndex the index of the quantity drawn for this cell or edge (defaults to 0)
+     * @return the random number
+     */
+    double ranf(unsigned cellIndex, unsigned edgeIndex, unsigned drawIndex=0) const;
+
+    /**
+     * Draw a uniform random number in [0, 1) for a quantity defined once per cell.
+     *
+     * @param cellIndex the index of the cell the number is drawn for
+     * @param drawIndex the index of the quantity drawn for this cell
+     * @return the random number
+     */
+    double ranfForCell(unsigned cellIndex, unsigned drawIndex) const;
+};
+
+#endif /*COUNTERBASEDRANDOMNUMBERGENERATOR_HPP_*/
@@ -0,0 +1,106 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DELTANOTCHEDGESPECIES_HPP_
+#define DELTANOTCHEDGESPECIES_HPP_
+
+#include <array>
+
+#include "DeltaNotchEdgeSrnModel.hpp"
+
+/**
+ * The species list of Chaste's Delta-Notch edge SRN, for EdgeSpeciesTrackingModifier.
+ *
+ * Delta and Notch are both exchanged with neighbouring edges, giving the "edge" and
+ * "neighbour" items read by DeltaNotchEdgeSrnModel. Neither diffuses within the membrane.
+ */
+struct DeltaNotchEdgeSpecies
+{
+    /** The edge SRN model holding the species. */
+    typedef DeltaNotchEdgeSrnModel SrnModel;
+
+    /** The number of species. */
+    static constexpr unsigned NUM_SPECIES = 2;
+
+    /**
+     * @param species the index of a species
+     * @return the name used in the CellEdgeData items of the species
+     */
+    static const char* GetName(unsigned species)
+    {
+        static const char* const names[NUM_SPECIES] = {"delta", "notch"};
+        return names[species];
+    }
+
+    /**
+     * @param species the index of a species
+     * @return whether the species diffuses around the edges of a cell
+     */
+    static constexpr bool IsDiffusing(unsigned species)
+    {
+        return false;
+    }
+
+    /**
+     * @param species the index of a species
+     * @return whether the mean level of the species in neighbouring edges is published
+     */
+    static constexpr bool IsExchanged(unsigned species)
+    {
+        return true;
+    }
+
+    /**
+     * @param rSrnModel an edge SRN model
+     * @param rLevels filled in with the level of each species
+     */
+    static void GetLevels(SrnModel& rSrnModel, std::array<double, NUM_SPECIES>& rLevels)
+    {
+        rLevels[0] = rSrnModel.GetDelta();
+        rLevels[1] = rSrnModel.GetNotch();
+    }
+
+    /**
+     * @param rSrnModel an edge SRN model
+     * @param rLevels the level of each species
+     */
+    static void SetLevels(SrnModel& rSrnModel, const std::array<double, NUM_SPECIES>& rLevels)
+    {
+        rSrnModel.SetDelta(rLevels[0]);
+        rSrnModel.SetNotch(rLevels[1]);
+    }
+};
+
+#endif /*DELTANOTCHEDGESPECIES_HPP_*/
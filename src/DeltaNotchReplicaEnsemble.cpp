@@ -0,0 +1,393 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "DeltaNotchReplicaEnsemble.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "CellSrnModel.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "DeltaNotchEdgeSrnModel.hpp"
+#include "DeltaNotchEdgeTrackingModifier.hpp"
+#include "Exception.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+DeltaNotchReplicaEnsemble::DeltaNotchReplicaEnsemble(unsigned numCellsAcross,
+                                                     unsigned numCellsUp,
+                                                     const std::string& rOutputDirectory)
+    : mNumCellsAcross(numCellsAcross),
+      mNumCellsUp(numCellsUp),
+      mOutputDirectory(rOutputDirectory),
+      mNumReplicas(100),
+      mBaseSeed(0),
+      mDt(0.1),
+      mEndTime(500.0),
+      mNumLocalReplicas(0)
+{
+}
+
+void DeltaNotchReplicaEnsemble::SetNumReplicas(unsigned numReplicas)
+{
+    if (numReplicas == 0)
+    {
+        EXCEPTION("The ensemble must have at least one replica.");
+    }
+    mNumReplicas = numReplicas;
+}
+
+void DeltaNotchReplicaEnsemble::SetBaseSeed(unsigned baseSeed)
+{
+    mBaseSeed = baseSeed;
+}
+
+void DeltaNotchReplicaEnsemble::SetDt(double dt)
+{
+    mDt = dt;
+}
+
+void DeltaNotchReplicaEnsemble::SetEndTime(double endTime)
+{
+    mEndTime = endTime;
+}
+
+void DeltaNotchReplicaEnsemble::Solve()
+{
+    if (mEndTime <= 0.0 || mDt <= 0.0)
+    {
+        EXCEPTION("The time step and end time of the replicas must be positive.");
+    }
+
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+    if (p_simulation_time->IsEndTimeAndNumberOfTimeStepsSetUp())
+    {
+        EXCEPTION("The replica ensemble sets up SimulationTime itself, so it cannot be solved while the end time is set up.");
+    }
+    const bool was_start_time_set_up = p_simulation_time->IsStartTimeSetUp();
+    const double start_time = was_start_time_set_up ? p_simulation_time->GetStartTime() : 0.0;
+
+    // Constructed on every process, since creating the directory is collective
+    OutputFileHandler output_file_handler(mOutputDirectory);
+
+    // The static mesh is shared by all the replicas run on this process
+    HoneycombVertexMeshGenerator generator(mNumCellsAcross, mNumCellsUp);
+    boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+    mNumEdgesPerCell.clear();
+    for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+    {
+        mNumEdgesPerCell.push_back(p_mesh->GetElement(elem_index)->GetNumEdges());
+    }
+    const unsigned num_edges = std::accumulate(mNumEdgesPerCell.begin(), mNumEdgesPerCell.end(), 0u);
+    mCellDeltaStatistics = RunningStatistics(p_mesh->GetNumElements());
+    mCellNotchStatistics = RunningStatistics(p_mesh->GetNumElements());
+    mEdgeDeltaStatistics = RunningStatistics(num_edges);
+    mEdgeNotchStatistics = RunningStatistics(num_edges);
+    mWavelengthStatistics = RunningStatistics(1);
+    mNumLocalReplicas = 0;
+
+    MAKE_PTR(WildTypeCellMutationState, p_state);
+    MAKE_PTR(StemCellProliferativeType, p_diff_type);
+
+    for (unsigned replica = PetscTools::GetMyRank(); replica < mNumReplicas; replica += PetscTools::GetNumProcs())
+    {
+        SimulationTime::Destroy();
+        p_simulation_time = SimulationTime::Instance();
+        p_simulation_time->SetStartTime(0.0);
+        p_simulation_time->SetEndTimeAndNumberOfTimeSteps(mEndTime, (unsigned)(mEndTime/mDt + 0.5));
+
+        CounterBasedRandomNumberGenerator rng(mBaseSeed, replica);
+
+        // Set up the cells exactly as in TestDeltaNotchSRN
+        std::vector<CellPtr> cells;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+
+            auto p_element = p_mesh->GetElement(elem_index);
+            auto p_cell_edge_srn_model = new CellSrnModel();
+
+            const double delta_concentration = rng.ranfForCell(elem_index, 0);
+            const double notch_concentration = rng.ranfForCell(elem_index, 1);
+
+            double total_edge_length = 0.0;
+            for (unsigned i = 0; i < p_element->GetNumEdges(); i++)
+            {
+                total_edge_length += p_element->GetEdge(i)->rGetLength();
+            }
+            for (unsigned i = 0; i < p_element->GetNumEdges(); i++)
+            {
+                const double edge_length = p_element->GetEdge(i)->rGetLength();
+                std::vector<double> initial_conditions;
+                initial_conditions.push_back(edge_length / total_edge_length * delta_concentration);
+                initial_conditions.push_back(edge_length / total_edge_length * notch_concentration);
+
+                MAKE_PTR(DeltaNotchEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(initial_conditions);
+                p_cell_edge_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_edge_srn_model));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            p_cell->SetBirthTime(-rng.ranfForCell(elem_index, 2) * 12.0);
+            cells.push_back(p_cell);
+        }
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        MAKE_PTR(DeltaNotchEdgeTrackingModifier<2>, p_modifier);
+        p_modifier->SetupSolve(cell_population, mOutputDirectory);
+
+        // The time loop of OffLatticeSimulation, for a static tissue and without output
+        while (!p_simulation_time->IsFinished())
+        {
+            for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+                 cell_iter != cell_population.End();
+                 ++cell_iter)
+            {
+                cell_iter->GetSrnModel()->SimulateToCurrentTime();
+            }
+            p_simulation_time->IncrementTimeOneStep();
+            p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        }
+
+        AddReplicaToStatistics(cell_population);
+        mNumLocalReplicas++;
+    }
+
+    // Give SimulationTime back as it was found
+    SimulationTime::Destroy();
+    if (was_start_time_set_up)
+    {
+        SimulationTime::Instance()->SetStartTime(start_time);
+    }
+
+    mCellDeltaStatistics.MergeAcrossProcesses();
+    mCellNotchStatistics.MergeAcrossProcesses();
+    mEdgeDeltaStatistics.MergeAcrossProcesses();
+    mEdgeNotchStatistics.MergeAcrossProcesses();
+    mWavelengthStatistics.MergeAcrossProcesses();
+
+    if (PetscTools::AmMaster())
+    {
+        WriteStatistics(output_file_handler);
+    }
+    PetscTools::Barrier("DeltaNotchReplicaEnsemble::Solve");
+}
+
+void DeltaNotchReplicaEnsemble::AddReplicaToStatistics(AbstractCellPopulation<2>& rCellPopulation)
+{
+    const unsigned num_cells = mNumEdgesPerCell.size();
+    std::vector<unsigned> first_edge(num_cells, 0);
+    for (unsigned cell_index = 1; cell_index < num_cells; cell_index++)
+    {
+        first_edge[cell_index] = first_edge[cell_index - 1] + mNumEdgesPerCell[cell_index - 1];
+    }
+
+    std::vector<double> cell_delta(num_cells, 0.0);
+    std::vector<double> cell_notch(num_cells, 0.0);
+    std::vector<c_vector<double, 2> > cell_centres(num_cells);
+    std::vector<double> edge_delta(mEdgeDeltaStatistics.GetNumQuantities(), 0.0);
+    std::vector<double> edge_notch(mEdgeNotchStatistics.GetNumQuantities(), 0.0);
+
+    for (AbstractCellPopulation<2>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        const unsigned cell_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        cell_centres[cell_index] = rCellPopulation.GetLocationOfCellCentre(*cell_iter);
+
+        auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+        for (unsigned edge_index = 0; edge_index < p_cell_srn->GetNumEdgeSrn(); edge_index++)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<DeltaNotchEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+            edge_delta[first_edge[cell_index] + edge_index] = p_edge_srn->GetDelta();
+            edge_notch[first_edge[cell_index] + edge_index] = p_edge_srn->GetNotch();
+            cell_delta[cell_index] += p_edge_srn->GetDelta();
+            cell_notch[cell_index] += p_edge_srn->GetNotch();
+        }
+    }
+
+    mCellDeltaStatistics.AddSample(cell_delta);
+    mCellNotchStatistics.AddSample(cell_notch);
+    mEdgeDeltaStatistics.AddSample(edge_delta);
+    mEdgeNotchStatistics.AddSample(edge_notch);
+
+    mWavelengthStatistics.AddSample(std::vector<double>(1, CalculateRowWavelength(cell_centres, cell_delta)));
+}
+
+double DeltaNotchReplicaEnsemble::CalculateWavelength(const std::vector<double>& rLevels)
+{
+    if (rLevels.empty())
+    {
+        return 0.0;
+    }
+    const double mean = std::accumulate(rLevels.begin(), rLevels.end(), 0.0)/rLevels.size();
+
+    // Count the crossings of the mean, ignoring cells at the mean
+    unsigned num_crossings = 0;
+    int last_sign = 0;
+    for (double level : rLevels)
+    {
+        const int sign = (level > mean) - (level < mean);
+        if (sign != 0)
+        {
+            if (last_sign != 0 && sign != last_sign)
+            {
+                num_crossings++;
+            }
+            last_sign = sign;
+        }
+    }
+    return 2.0*rLevels.size()/std::max(num_crossings, 1u);
+}
+
+double DeltaNotchReplicaEnsemble::CalculateRowWavelength(const std::vector<c_vector<double, 2> >& rCentres,
+                                                         const std::vector<double>& rLevels)
+{
+    assert(rCentres.size() == rLevels.size());
+    if (rLevels.empty())
+    {
+        return 0.0;
+    }
+
+    // Order the cells row by row, then along x within each row
+    const double row_tolerance = 0.1;
+    std::vector<unsigned> order(rLevels.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+                     [&rCentres](unsigned a, unsigned b) { return rCentres[a][1] < rCentres[b][1]; });
+
+    double wavelength_sum = 0.0;
+    unsigned num_rows = 0;
+    std::vector<unsigned> row;
+    for (unsigned i = 0; i <= order.size(); i++)
+    {
+        if (i == order.size() || (!row.empty() && rCentres[order[i]][1] - rCentres[row[0]][1] > row_tolerance))
+        {
+            std::stable_sort(row.begin(), row.end(),
+                             [&rCentres](unsigned a, unsigned b) { return rCentres[a][0] < rCentres[b][0]; });
+            std::vector<double> row_levels(row.size());
+            for (unsigned j = 0; j < row.size(); j++)
+            {
+                row_levels[j] = rLevels[row[j]];
+            }
+            wavelength_sum += CalculateWavelength(row_levels);
+            num_rows++;
+            row.clear();
+        }
+        if (i < order.size())
+        {
+            row.push_back(order[i]);
+        }
+    }
+    return wavelength_sum/num_rows;
+}
+
+void DeltaNotchReplicaEnsemble::WriteStatistics(OutputFileHandler& rOutputFileHandler)
+{
+    const std::vector<double> cell_delta_variances = mCellDeltaStatistics.GetVariances();
+    const std::vector<double> cell_notch_variances = mCellNotchStatistics.GetVariances();
+    out_stream p_cell_file = rOutputFileHandler.OpenOutputFile("cell_statistics.dat");
+    *p_cell_file << "# cell mean_delta variance_delta mean_notch variance_notch\n";
+    for (unsigned cell_index = 0; cell_index < mNumEdgesPerCell.size(); cell_index++)
+    {
+        *p_cell_file << cell_index << " " << mCellDeltaStatistics.rGetMeans()[cell_index] << " " << cell_delta_variances[cell_index]
+                     << " " << mCellNotchStatistics.rGetMeans()[cell_index] << " " << cell_notch_variances[cell_index] << "\n";
+    }
+    p_cell_file->close();
+
+    const std::vector<double> edge_delta_variances = mEdgeDeltaStatistics.GetVariances();
+    const std::vector<double> edge_notch_variances = mEdgeNotchStatistics.GetVariances();
+    out_stream p_edge_file = rOutputFileHandler.OpenOutputFile("edge_statistics.dat");
+    *p_edge_file << "# cell edge mean_delta variance_delta mean_notch variance_notch\n";
+    unsigned edge = 0;
+    for (unsigned cell_index = 0; cell_index < mNumEdgesPerCell.size(); cell_index++)
+    {
+        for (unsigned edge_index = 0; edge_index < mNumEdgesPerCell[cell_index]; edge_index++, edge++)
+        {
+            *p_edge_file << cell_index << " " << edge_index
+                         << " " << mEdgeDeltaStatistics.rGetMeans()[edge] << " " << edge_delta_variances[edge]
+                         << " " << mEdgeNotchStatistics.rGetMeans()[edge] << " " << edge_notch_variances[edge] << "\n";
+        }
+    }
+    p_edge_file->close();
+
+    out_stream p_wavelength_file = rOutputFileHandler.OpenOutputFile("wavelength_statistics.dat");
+    *p_wavelength_file << "# replicas mean_wavelength variance_wavelength\n";
+    *p_wavelength_file << mWavelengthStatistics.GetCount() << " " << mWavelengthStatistics.rGetMeans()[0]
+                       << " " << mWavelengthStatistics.GetVariances()[0] << "\n";
+    p_wavelength_file->close();
+}
+
+unsigned DeltaNotchReplicaEnsemble::GetNumLocalReplicas() const
+{
+    return mNumLocalReplicas;
+}
+
+const RunningStatistics& DeltaNotchReplicaEnsemble::rGetCellDeltaStatistics() const
+{
+    return mCellDeltaStatistics;
+}
+
+const RunningStatistics& DeltaNotchReplicaEnsemble::rGetCellNotchStatistics() const
+{
+    return mCellNotchStatistics;
+}
+
+const RunningStatistics& DeltaNotchReplicaEnsemble::rGetEdgeDeltaStatistics() const
+{
+    return mEdgeDeltaStatistics;
+}
+
+const RunningStatistics& DeltaNotchReplicaEnsemble::rGetEdgeNotchStatistics() const
+{
+    return mEdgeNotchStatistics;
+}
+
+const RunningStatistics& DeltaNotchReplicaEnsemble::rGetWavelengthStatistics() const
+{
+    return mWavelengthStatistics;
+}
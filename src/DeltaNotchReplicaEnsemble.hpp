@@ -0,0 +1,208 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DELTANOTCHREPLICAENSEMBLE_HPP_
+#define DELTANOTCHREPLICAENSEMBLE_HPP_
+
+#include <string>
+#include <vector>
+
+#include "AbstractCellPopulation.hpp"
+#include "OutputFileHandler.hpp"
+#include "RunningStatistics.hpp"
+
+/**
+ * Runs many stochastic replicas of the edge-based Delta-Notch simulation of TestDeltaNotchSRN
+ * and gathers statistics of their final states, without writing any per-replica output.
+ *
+ * Each replica draws its random initial Delta and Notch levels and birth times from a
+ * CounterBasedRandomNumberGenerator keyed by the base seed and the replica index, so every
+ * replica is reproducible and independent of how replicas are shared out. When run in parallel, the replicas are
+ * distributed round-robin over the processes, each of which runs its share in turn.
+ *
+ * At the end of each replica the per-cell and per-edge Delta and Notch levels, and the
+ * wavelength of the Delta pattern along the rows of the honeycomb, are added to running statistics
+ * (see RunningStatistics). These are merged across processes once all replicas are done,
+ * and written by the master process.
+ *
+ * As in TestDeltaNotchSRN, the tissue is a static honeycomb mesh with no forces and no cell
+ * division, so one mesh is shared by all the replicas on a process.
+ *
+ * The ensemble owns SimulationTime while it runs: each replica restarts it from zero, so
+ * Solve() may not be called while another simulation has set its end time. Afterwards
+ * SimulationTime is left with the start time it had, if any, and no end time.
+ */
+class DeltaNotchReplicaEnsemble
+{
+private:
+
+    /** The number of cells across the honeycomb mesh. */
+    unsigned mNumCellsAcross;
+
+    /** The number of cells up the honeycomb mesh. */
+    unsigned mNumCellsUp;
+
+    /** The output directory, relative to where Chaste output is stored. */
+    std::string mOutputDirectory;
+
+    /** The number of replicas to run. */
+    unsigned mNumReplicas;
+
+    /** The seed shared by all replicas. */
+    unsigned mBaseSeed;
+
+    /** The time step. */
+    double mDt;
+
+    /** The end time of each replica. */
+    double mEndTime;
+
+    /** The number of edges of each cell. */
+    std::vector<unsigned> mNumEdgesPerCell;
+
+    /** The number of replicas run by this process. */
+    unsigned mNumLocalReplicas;
+
+    /** Statistics of the total Delta level of each cell. */
+    RunningStatistics mCellDeltaStatistics;
+
+    /** Statistics of the total Notch level of each cell. */
+    RunningStatistics mCellNotchStatistics;
+
+    /** Statistics of the Delta level of each edge, in cell order. */
+    RunningStatistics mEdgeDeltaStatistics;
+
+    /** Statistics of the Notch level of each edge, in cell order. */
+    RunningStatistics mEdgeNotchStatistics;
+
+    /** Statistics of the pattern wavelength. */
+    RunningStatistics mWavelengthStatistics;
+
+    /**
+     * Add the final state of a replica to the statistics.
+     *
+     * @param rCellPopulation the replica's cell population
+     */
+    void AddReplicaToStatistics(AbstractCellPopulation<2>& rCellPopulation);
+
+    /**
+     * Write the statistics to file. Only called on the master process.
+     *
+     * @param rOutputFileHandler handler for the output directory
+     */
+    void WriteStatistics(OutputFileHandler& rOutputFileHandler);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param numCellsAcross the number of cells across the honeycomb mesh
+     * @param numCellsUp the number of cells up the honeycomb mesh
+     * @param rOutputDirectory the output directory, relative to where Chaste output is stored
+     */
+    DeltaNotchReplicaEnsemble(unsigned numCellsAcross, unsigned numCellsUp, const std::string& rOutputDirectory);
+
+    /**
+     * @param numReplicas the number of replicas to run (defaults to 100)
+     */
+    void SetNumReplicas(unsigned numReplicas);
+
+    /**
+     * @param baseSeed the seed shared by all replicas, each of which has its own stream (defaults to 0)
+     */
+    void SetBaseSeed(unsigned baseSeed);
+
+    /**
+     * @param dt the time step (defaults to 0.1)
+     */
+    void SetDt(double dt);
+
+    /**
+     * @param endTime the end time of each replica (defaults to 500)
+     */
+    void SetEndTime(double endTime);
+
+    /**
+     * Run this process's share of the replicas, then merge the statistics across processes
+     * and write them to cell_statistics.dat, edge_statistics.dat and wavelength_statistics.dat.
+     * SimulationTime must not have its end time set up.
+     */
+    void Solve();
+
+    /**
+     * Compute the wavelength of a pattern, in cells, from the number of times it crosses its mean.
+     * A pattern that never crosses its mean is given a wavelength of twice its length.
+     *
+     * @param rLevels the level in each cell, in order along the pattern
+     * @return the wavelength
+     */
+    static double CalculateWavelength(const std::vector<double>& rLevels);
+
+    /**
+     * Compute the wavelength of a pattern on a tissue, in cells along x. Cells whose centres
+     * lie within a tenth of a cell width of each other in y form a row; the wavelength of each
+     * row, ordered by x, is computed by CalculateWavelength() and the result is the mean over
+     * the rows.
+     *
+     * @param rCentres the centre of each cell, with cells one unit apart along a row
+     * @param rLevels the level in each cell
+     * @return the mean wavelength of the rows
+     */
+    static double CalculateRowWavelength(const std::vector<c_vector<double, 2> >& rCentres,
+                                         const std::vector<double>& rLevels);
+
+    /**
+     * @return the number of replicas run by this process
+     */
+    unsigned GetNumLocalReplicas() const;
+
+    /** @return statistics of the total Delta level of each cell */
+    const RunningStatistics& rGetCellDeltaStatistics() const;
+
+    /** @return statistics of the total Notch level of each cell */
+    const RunningStatistics& rGetCellNotchStatistics() const;
+
+    /** @return statistics of the Delta level of each edge, in cell order */
+    const RunningStatistics& rGetEdgeDeltaStatistics() const;
+
+    /** @return statistics of the Notch level of each edge, in cell order */
+    const RunningStatistics& rGetEdgeNotchStatistics() const;
+
+    /** @return statistics of the pattern wavelength */
+    const RunningStatistics& rGetWavelengthStatistics() const;
+};
+
+#endif /*DELTANOTCHREPLICAENSEMBLE_HPP_*/
@@ -0,0 +1,136 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "EdgeDataSchema.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Exception.hpp"
+
+unsigned EdgeDataSchema::AddField(const std::string& rName, bool isRequired, bool isWritten)
+{
+    if (HasField(rName))
+    {
+        EXCEPTION("The edge data schema already has a field called \"" << rName << "\".");
+    }
+    mNames.push_back(rName);
+    mIsRequired.push_back(isRequired);
+    mIsKept.push_back(true);
+    mIsWritten.push_back(isWritten);
+    return mNames.size() - 1;
+}
+
+unsigned EdgeDataSchema::GetNumFields() const
+{
+    return mNames.size();
+}
+
+bool EdgeDataSchema::HasField(const std::string& rName) const
+{
+    return std::find(mNames.begin(), mNames.end(), rName) != mNames.end();
+}
+
+unsigned EdgeDataSchema::GetFieldIndex(const std::string& rName) const
+{
+    std::vector<std::string>::const_iterator it = std::find(mNames.begin(), mNames.end(), rName);
+    if (it == mNames.end())
+    {
+        EXCEPTION("The edge data schema has no field called \"" << rName << "\".");
+    }
+    return it - mNames.begin();
+}
+
+const std::string& EdgeDataSchema::rGetFieldName(unsigned index) const
+{
+    assert(index < mNames.size());
+    return mNames[index];
+}
+
+void EdgeDataSchema::SetKept(const std::string& rName, bool isKept)
+{
+    const unsigned index = GetFieldIndex(rName);
+    if (!isKept && mIsRequired[index])
+    {
+        EXCEPTION("The edge data field \"" << rName << "\" is read by the edge SRNs and must be kept.");
+    }
+    mIsKept[index] = isKept;
+    if (!isKept)
+    {
+        mIsWritten[index] = false;
+    }
+}
+
+void EdgeDataSchema::SetWritten(const std::string& rName, bool isWritten)
+{
+    const unsigned index = GetFieldIndex(rName);
+    mIsWritten[index] = isWritten;
+    if (isWritten)
+    {
+        mIsKept[index] = true;
+    }
+}
+
+bool EdgeDataSchema::IsItemWritten(const std::string& rName) const
+{
+    std::vector<std::string>::const_iterator it = std::find(mNames.begin(), mNames.end(), rName);
+    return it == mNames.end() || mIsWritten[it - mNames.begin()];
+}
+
+std::vector<std::string> EdgeDataSchema::GetKeptFields() const
+{
+    std::vector<std::string> kept_fields;
+    for (unsigned index = 0; index < mNames.size(); index++)
+    {
+        if (mIsKept[index])
+        {
+            kept_fields.push_back(mNames[index]);
+        }
+    }
+    return kept_fields;
+}
+
+std::vector<std::string> EdgeDataSchema::GetWrittenFields() const
+{
+    std::vector<std::string> written_fields;
+    for (unsigned index = 0; index < mNames.size(); index++)
+    {
+        if (mIsWritten[index])
+        {
+            written_fields.push_back(mNames[index]);
+        }
+    }
+    return written_fields;
+}
@@ -0,0 +1,180 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef EDGEDATASCHEMA_HPP_
+#define EDGEDATASCHEMA_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <string>
+#include <vector>
+
+/**
+ * The fields an edge tracking modifier may publish as CellEdgeData items, saying for each
+ * whether it is kept in the CellEdgeData and whether it is written to output.
+ *
+ * A field that is not kept is never stored, saving its memory and the cost of storing it
+ * at every step. A field that the edge SRNs read (such as the neighbour means) is required
+ * and always kept. Writing a field implies keeping it, since the output reads the items
+ * from the CellEdgeData. The schema is shared with output modifiers such as
+ * AsyncEdgeDataOutputModifier, which write only the written fields.
+ *
+ * Settings should be made before the simulation is solved; an item already stored in the
+ * CellEdgeData is not removed when its field stops being kept.
+ */
+class EdgeDataSchema
+{
+private:
+
+    /** The item name of each field. */
+    std::vector<std::string> mNames;
+
+    /** Whether each field is read by the edge SRNs, and so must be kept. */
+    std::vector<bool> mIsRequired;
+
+    /** Whether each field is kept in the CellEdgeData. */
+    std::vector<bool> mIsKept;
+
+    /** Whether each field is written to output. */
+    std::vector<bool> mIsWritten;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mNames;
+        archive & mIsRequired;
+        archive & mIsKept;
+        archive & mIsWritten;
+    }
+
+public:
+
+    /**
+     * Add a field.
+     *
+     * @param rName the item name of the field, which must be new to the schema
+     * @param isRequired whether the field is read by the edge SRNs, and so must always be kept
+     * @param isWritten whether the field is written to output by default
+     * @return the index of the field
+     */
+    unsigned AddField(const std::string& rName, bool isRequired, bool isWritten);
+
+    /**
+     * @return the number of fields
+     */
+    unsigned GetNumFields() const;
+
+    /**
+     * @param rName an item name
+     * @return whether the schema has a field of this name
+     */
+    bool HasField(const std::string& rName) const;
+
+    /**
+     * @param rName the item name of a field of the schema
+     * @return the index of the field
+     */
+    unsigned GetFieldIndex(const std::string& rName) const;
+
+    /**
+     * @param index the index of a field
+     * @return the item name of the field
+     */
+    const std::string& rGetFieldName(unsigned index) const;
+
+    /**
+     * Set whether a field is kept in the CellEdgeData. A field that is not kept is not written.
+     *
+     * @param rName the item name of the field
+     * @param isKept whether to keep the field
+     */
+    void SetKept(const std::string& rName, bool isKept);
+
+    /**
+     * Set whether a field is written to output. A written field is kept.
+     *
+     * @param rName the item name of the field
+     * @param isWritten whether to write the field
+     */
+    void SetWritten(const std::string& rName, bool isWritten);
+
+    /**
+     * @param index the index of a field
+     * @return whether the field is kept in the CellEdgeData
+     */
+    bool IsKept(unsigned index) const
+    {
+        return mIsKept[index];
+    }
+
+    /**
+     * @param index the index of a field
+     * @return whether the field is written to output
+     */
+    bool IsWritten(unsigned index) const
+    {
+        return mIsWritten[index];
+    }
+
+    /**
+     * @param rName an item name
+     * @return whether the item is written to output; items unknown to the schema, published
+     * by other modifiers, are written
+     */
+    bool IsItemWritten(const std::string& rName) const;
+
+    /**
+     * @return the item names of the kept fields, in the order they were added
+     */
+    std::vector<std::string> GetKeptFields() const;
+
+    /**
+     * @return the item names of the written fields, in the order they were added
+     */
+    std::vector<std::string> GetWrittenFields() const;
+};
+
+#endif /*EDGEDATASCHEMA_HPP_*/
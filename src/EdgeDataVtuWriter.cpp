@@ -0,0 +1,697 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "EdgeDataVtuWriter.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <system_error>
+
+#include <zlib.h>
+
+#include "Exception.hpp"
+
+/**
+ * @return the byte order of this machine, as named in VTK files
+ */
+static const char* GetByteOrder()
+{
+    const uint16_t probe = 1;
+    return (*reinterpret_cast<const unsigned char*>(&probe) == 1) ? "LittleEndian" : "BigEndian";
+}
+
+/** The size of the blocks in which data arrays are compressed, as used by VTK. */
+static const std::size_t COMPRESSION_BLOCK_SIZE = 32768;
+
+/**
+ * Share the cells in [begin, end) of rCells between pieces [firstPiece, firstPiece + numPieces),
+ * splitting them in proportion to their numbers of triangles across the longest side of
+ * their bounding box, recursively.
+ *
+ * @param rCentroids the coordinates of the centroid of each cell, three per cell
+ * @param rCellTriangles the first triangle of each cell, followed by the number of triangles
+ * @param rCells the cells, reordered in place
+ * @param begin the first cell of the range
+ * @param end one past the last cell of the range
+ * @param firstPiece the first piece to fill
+ * @param numPieces the number of pieces to fill
+ * @param rPieces the triangles of each piece, filled in
+ */
+static void BisectCells(const std::vector<double>& rCentroids,
+                        const std::vector<unsigned>& rCellTriangles,
+                        std::vector<unsigned>& rCells,
+                        unsigned begin,
+                        unsigned end,
+                        unsigned firstPiece,
+                        unsigned numPieces,
+                        std::vector<std::vector<unsigned> >& rPieces)
+{
+    if (numPieces == 1)
+    {
+        for (unsigned i = begin; i < end; i++)
+        {
+            for (unsigned triangle = rCellTriangles[rCells[i]]; triangle < rCellTriangles[rCells[i] + 1]; triangle++)
+            {
+                rPieces[firstPiece].push_back(triangle);
+            }
+        }
+        return;
+    }
+
+    // Find the longest side of the bounding box
+    unsigned axis = 0;
+    double longest_side = -1.0;
+    for (unsigned dim = 0; dim < 3; dim++)
+    {
+        double min_coordinate = std::numeric_limits<double>::max();
+        double max_coordinate = -std::numeric_limits<double>::max();
+        for (unsigned i = begin; i < end; i++)
+        {
+            min_coordinate = std::min(min_coordinate, rCentroids[3*rCells[i] + dim]);
+            max_coordinate = std::max(max_coordinate, rCentroids[3*rCells[i] + dim]);
+        }
+        if (max_coordinate - min_coordinate > longest_side)
+        {
+            longest_side = max_coordinate - min_coordinate;
+            axis = dim;
+        }
+    }
+    std::sort(rCells.begin() + begin, rCells.begin() + end, [&](unsigned a, unsigned b)
+    {
+        return rCentroids[3*a + axis] < rCentroids[3*b + axis] || (rCentroids[3*a + axis] == rCentroids[3*b + axis] && a < b);
+    });
+
+    // Give the lower pieces their share of the triangles
+    const unsigned num_lower_pieces = numPieces/2;
+    std::size_t num_triangles = 0;
+    for (unsigned i = begin; i < end; i++)
+    {
+        num_triangles += rCellTriangles[rCells[i] + 1] - rCellTriangles[rCells[i]];
+    }
+    const std::size_t lower_share = num_triangles*num_lower_pieces/numPieces;
+    unsigned split = begin;
+    std::size_t num_lower_triangles = 0;
+    while (split < end && num_lower_triangles < lower_share)
+    {
+        num_lower_triangles += rCellTriangles[rCells[split] + 1] - rCellTriangles[rCells[split]];
+        split++;
+    }
+
+    BisectCells(rCentroids, rCellTriangles, rCells, begin, split, firstPiece, num_lower_pieces, rPieces);
+    BisectCells(rCentroids, rCellTriangles, rCells, split, end, firstPiece + num_lower_pieces, numPieces - num_lower_pieces, rPieces);
+}
+
+void EdgeDataSnapshot::Clear()
+{
+    mTime = 0.0;
+    mTimeStep = 0;
+    mPoints.clear();
+    mConnectivity.clear();
+    mCellIds.clear();
+    mFieldNames.clear();
+    for (std::vector<double>& r_field : mFields)
+    {
+        r_field.clear();
+    }
+}
+
+EdgeDataVtuWriter::EdgeDataVtuWriter(const std::string& rDirectory,
+                                     const std::string& rBaseName,
+                                     unsigned numBuffers,
+                                     unsigned numPieces,
+                                     bool useCompression)
+    : mDirectory(rDirectory),
+      mBaseName(rBaseName),
+      mNumberOfPieces(numPieces),
+      mUseCompression(useCompression),
+      mIsFinishing(false),
+      mNumberOfSnapshotsWritten(0),
+      mNumberOfWaits(0),
+      mpPieceSnapshot(nullptr),
+      mpPieceTriangles(nullptr),
+      mpPieceNames(nullptr),
+      mNextPiece(0),
+      mNumPiecesInProgress(0),
+      mArePieceWorkersStopping(false)
+{
+    if (numBuffers == 0)
+    {
+        EXCEPTION("An edge data writer needs at least one snapshot buffer.");
+    }
+    if (numPieces == 0)
+    {
+        EXCEPTION("An edge data writer needs at least one piece.");
+    }
+    if (mDirectory.empty() || mDirectory.back() != '/')
+    {
+        mDirectory += "/";
+    }
+
+    mBuffers.resize(numBuffers);
+    for (unsigned i = 0; i < numBuffers; i++)
+    {
+        mBuffers[i].Clear();
+        mFreeBuffers.push_back(i);
+    }
+    for (unsigned piece = 1; piece < mNumberOfPieces; piece++)
+    {
+        try
+        {
+            mPieceWorkers.emplace_back(&EdgeDataVtuWriter::RunPieceWorker, this);
+        }
+        catch (std::system_error&)
+        {
+            // Out of threads: the background thread writes the remaining share itself
+            break;
+        }
+    }
+    try
+    {
+        mThread = std::thread(&EdgeDataVtuWriter::Run, this);
+    }
+    catch (std::system_error&)
+    {
+        StopPieceWorkers();
+        throw;
+    }
+}
+
+EdgeDataVtuWriter::~EdgeDataVtuWriter()
+{
+    if (mThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mIsFinishing = true;
+        }
+        mBufferSubmitted.notify_all();
+        mThread.join();
+    }
+    StopPieceWorkers();
+}
+
+void EdgeDataVtuWriter::StopPieceWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mPieceMutex);
+        mArePieceWorkersStopping = true;
+    }
+    mPiecesReady.notify_all();
+    for (std::thread& r_worker : mPieceWorkers)
+    {
+        if (r_worker.joinable())
+        {
+            r_worker.join();
+        }
+    }
+}
+
+void EdgeDataVtuWriter::RunPieceWorker()
+{
+    std::unique_lock<std::mutex> lock(mPieceMutex);
+    while (true)
+    {
+        mPiecesReady.wait(lock, [this]{ return mArePieceWorkersStopping || (mpPieceSnapshot && mNextPiece < mIsPieceWritten.size()); });
+        if (!WriteNextPiece(lock))
+        {
+            // Stopping, with no pieces left to write
+            break;
+        }
+    }
+}
+
+bool EdgeDataVtuWriter::WriteNextPiece(std::unique_lock<std::mutex>& rLock)
+{
+    if (!mpPieceSnapshot || mNextPiece >= mIsPieceWritten.size())
+    {
+        return false;
+    }
+    const unsigned piece = mNextPiece++;
+    mNumPiecesInProgress++;
+    const EdgeDataSnapshot& r_snapshot = *mpPieceSnapshot;
+    const std::vector<unsigned>& r_triangles = (*mpPieceTriangles)[piece];
+    const std::string& r_name = (*mpPieceNames)[piece];
+
+    rLock.unlock();
+    const bool is_written = WritePiece(r_snapshot, r_triangles, r_name);
+    rLock.lock();
+
+    mIsPieceWritten[piece] = is_written;
+    mNumPiecesInProgress--;
+    if (mNextPiece == mIsPieceWritten.size() && mNumPiecesInProgress == 0)
+    {
+        mPiecesDone.notify_all();
+    }
+    return true;
+}
+
+EdgeDataSnapshot& EdgeDataVtuWriter::AcquireBuffer()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mIsFinishing)
+    {
+        EXCEPTION("No snapshots may be written once the edge data writer has finished.");
+    }
+    if (mFreeBuffers.empty())
+    {
+        // Every buffer is waiting to be written: wait for the disk to catch up
+        mNumberOfWaits++;
+        mBufferFreed.wait(lock, [this]{ return !mFreeBuffers.empty(); });
+    }
+    if (!mError.empty())
+    {
+        EXCEPTION(mError);
+    }
+
+    const unsigned index = mFreeBuffers.front();
+    mFreeBuffers.pop_front();
+    lock.unlock();
+
+    mBuffers[index].Clear();
+    return mBuffers[index];
+}
+
+void EdgeDataVtuWriter::Submit(EdgeDataSnapshot& rSnapshot)
+{
+    const unsigned index = &rSnapshot - &mBuffers[0];
+    assert(index < mBuffers.size());
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mSubmittedBuffers.push_back(index);
+    }
+    mBufferSubmitted.notify_one();
+}
+
+void EdgeDataVtuWriter::Finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsFinishing = true;
+    }
+    mBufferSubmitted.notify_all();
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    StopPieceWorkers();
+    if (!mError.empty())
+    {
+        EXCEPTION(mError);
+    }
+}
+
+unsigned EdgeDataVtuWriter::GetNumberOfSnapshotsWritten()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumberOfSnapshotsWritten;
+}
+
+unsigned EdgeDataVtuWriter::GetNumberOfWaits()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumberOfWaits;
+}
+
+void EdgeDataVtuWriter::Run()
+{
+    while (true)
+    {
+        unsigned index;
+        bool has_failed;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mBufferSubmitted.wait(lock, [this]{ return mIsFinishing || !mSubmittedBuffers.empty(); });
+            if (mSubmittedBuffers.empty())
+            {
+                // Finishing, and everything submitted has been written
+                break;
+            }
+            index = mSubmittedBuffers.front();
+            mSubmittedBuffers.pop_front();
+            has_failed = !mError.empty();
+        }
+
+        // Once a write has failed, buffers are just recycled so that the simulation is not blocked
+        std::string error;
+        if (!has_failed)
+        {
+            const EdgeDataSnapshot& r_snapshot = mBuffers[index];
+            std::stringstream file_name;
+            file_name << mBaseName << "_" << r_snapshot.mTimeStep << (mNumberOfPieces > 1 ? ".pvtu" : ".vtu");
+            if (!WriteSnapshot(r_snapshot, file_name.str()))
+            {
+                error = "Could not write " + mDirectory + file_name.str();
+            }
+            else
+            {
+                mWrittenFiles.push_back(std::make_pair(r_snapshot.mTime, file_name.str()));
+                if (!WriteCollection())
+                {
+                    error = "Could not write " + mDirectory + mBaseName + ".pvd";
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!has_failed)
+            {
+                if (error.empty())
+                {
+                    mNumberOfSnapshotsWritten++;
+                }
+                else
+                {
+                    mError = error;
+                }
+            }
+            mFreeBuffers.push_back(index);
+        }
+        mBufferFreed.notify_one();
+    }
+}
+
+bool EdgeDataVtuWriter::WriteSnapshot(const EdgeDataSnapshot& rSnapshot, const std::string& rFileName)
+{
+    const unsigned num_triangles = rSnapshot.mConnectivity.size()/3;
+    if (mNumberOfPieces == 1)
+    {
+        std::vector<unsigned> triangles(num_triangles);
+        for (unsigned i = 0; i < num_triangles; i++)
+        {
+            triangles[i] = i;
+        }
+        return WritePiece(rSnapshot, triangles, rFileName);
+    }
+
+    std::vector<std::vector<unsigned> > pieces;
+    PartitionTriangles(rSnapshot, pieces);
+
+    const std::string stem = rFileName.substr(0, rFileName.size() - std::string(".pvtu").size());
+    std::vector<std::string> piece_names(mNumberOfPieces);
+    for (unsigned piece = 0; piece < mNumberOfPieces; piece++)
+    {
+        std::stringstream piece_name;
+        piece_name << stem << "_" << piece << ".vtu";
+        piece_names[piece] = piece_name.str();
+    }
+
+    // Hand the pieces to the piece workers, and write pieces on this thread too until none are left
+    bool are_all_written;
+    {
+        std::unique_lock<std::mutex> lock(mPieceMutex);
+        mpPieceSnapshot = &rSnapshot;
+        mpPieceTriangles = &pieces;
+        mpPieceNames = &piece_names;
+        mIsPieceWritten.assign(mNumberOfPieces, false);
+        mNextPiece = 0;
+        mNumPiecesInProgress = 0;
+        mPiecesReady.notify_all();
+
+        while (WriteNextPiece(lock))
+        {
+        }
+        mPiecesDone.wait(lock, [this]{ return mNumPiecesInProgress == 0; });
+
+        are_all_written = std::find(mIsPieceWritten.begin(), mIsPieceWritten.end(), false) == mIsPieceWritten.end();
+        mpPieceSnapshot = nullptr;
+        mpPieceTriangles = nullptr;
+        mpPieceNames = nullptr;
+    }
+    if (!are_all_written)
+    {
+        return false;
+    }
+
+    std::ofstream file(mDirectory + rFileName);
+    if (!file)
+    {
+        return false;
+    }
+    file << "<?xml version=\"1.0\"?>\n";
+    file << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"" << GetByteOrder() << "\" header_type=\"UInt64\">\n";
+    file << "  <PUnstructuredGrid GhostLevel=\"0\">\n";
+    file << "    <PPoints>\n";
+    file << "      <PDataArray type=\"Float64\" NumberOfComponents=\"3\"/>\n";
+    file << "    </PPoints>\n";
+    file << "    <PCellData>\n";
+    file << "      <PDataArray type=\"UInt32\" Name=\"Cell IDs\"/>\n";
+    for (const std::string& r_field_name : rSnapshot.mFieldNames)
+    {
+        file << "      <PDataArray type=\"Float64\" Name=\"" << r_field_name << "\"/>\n";
+    }
+    file << "    </PCellData>\n";
+    for (const std::string& r_piece_name : piece_names)
+    {
+        file << "    <Piece Source=\"" << r_piece_name << "\"/>\n";
+    }
+    file << "  </PUnstructuredGrid>\n";
+    file << "</VTKFile>\n";
+
+    file.close();
+    return !file.fail();
+}
+
+bool EdgeDataVtuWriter::WritePiece(const EdgeDataSnapshot& rSnapshot, const std::vector<unsigned>& rTriangles, const std::string& rFileName)
+{
+    const unsigned num_triangles = rTriangles.size();
+    const unsigned num_fields = rSnapshot.mFieldNames.size();
+    assert(rSnapshot.mCellIds.size() == rSnapshot.mConnectivity.size()/3);
+
+    // Number the points of these triangles afresh, and gather their data
+    std::vector<unsigned> local_indices(rSnapshot.mPoints.size()/3, UINT_MAX);
+    std::vector<double> points;
+    std::vector<int32_t> connectivity;
+    connectivity.reserve(3*num_triangles);
+    std::vector<int32_t> offsets;
+    offsets.reserve(num_triangles);
+    std::vector<uint8_t> types(num_triangles, 5); // VTK_TRIANGLE
+    std::vector<uint32_t> cell_ids;
+    cell_ids.reserve(num_triangles);
+    std::vector<std::vector<double> > fields(num_fields);
+    for (unsigned i = 0; i < num_triangles; i++)
+    {
+        const unsigned triangle = rTriangles[i];
+        for (unsigned vertex = 0; vertex < 3; vertex++)
+        {
+            const unsigned point = rSnapshot.mConnectivity[3*triangle + vertex];
+            if (local_indices[point] == UINT_MAX)
+            {
+                local_indices[point] = points.size()/3;
+                points.insert(points.end(), rSnapshot.mPoints.begin() + 3*point, rSnapshot.mPoints.begin() + 3*point + 3);
+            }
+            connectivity.push_back(local_indices[point]);
+        }
+        offsets.push_back(3*(i + 1));
+        cell_ids.push_back(rSnapshot.mCellIds[triangle]);
+        for (unsigned field = 0; field < num_fields; field++)
+        {
+            assert(rSnapshot.mFields[field].size() == rSnapshot.mCellIds.size());
+            fields[field].push_back(rSnapshot.mFields[field][triangle]);
+        }
+    }
+
+    // Encode the arrays, in the order they are declared below
+    std::vector<std::vector<char> > encoded(5 + num_fields);
+    bool is_encoded = EncodeArray(points.data(), points.size()*sizeof(double), encoded[0])
+                      && EncodeArray(connectivity.data(), connectivity.size()*sizeof(int32_t), encoded[1])
+                      && EncodeArray(offsets.data(), offsets.size()*sizeof(int32_t), encoded[2])
+                      && EncodeArray(types.data(), types.size()*sizeof(uint8_t), encoded[3])
+                      && EncodeArray(cell_ids.data(), cell_ids.size()*sizeof(uint32_t), encoded[4]);
+    for (unsigned field = 0; field < num_fields && is_encoded; field++)
+    {
+        is_encoded = EncodeArray(fields[field].data(), fields[field].size()*sizeof(double), encoded[5 + field]);
+    }
+    if (!is_encoded)
+    {
+        return false;
+    }
+    std::vector<std::size_t> array_offsets(encoded.size(), 0);
+    for (unsigned array = 1; array < encoded.size(); array++)
+    {
+        array_offsets[array] = array_offsets[array - 1] + encoded[array - 1].size();
+    }
+
+    std::ofstream file(mDirectory + rFileName, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "<?xml version=\"1.0\"?>\n";
+    file << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"" << GetByteOrder() << "\" header_type=\"UInt64\"";
+    if (mUseCompression)
+    {
+        file << " compressor=\"vtkZLibDataCompressor\"";
+    }
+    file << ">\n";
+    file << "  <UnstructuredGrid>\n";
+    file << "    <Piece NumberOfPoints=\"" << points.size()/3 << "\" NumberOfCells=\"" << num_triangles << "\">\n";
+    file << "      <Points>\n";
+    file << "        <DataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" << array_offsets[0] << "\"/>\n";
+    file << "      </Points>\n";
+    file << "      <Cells>\n";
+    file << "        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"appended\" offset=\"" << array_offsets[1] << "\"/>\n";
+    file << "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\"" << array_offsets[2] << "\"/>\n";
+    file << "        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"" << array_offsets[3] << "\"/>\n";
+    file << "      </Cells>\n";
+    file << "      <CellData>\n";
+    file << "        <DataArray type=\"UInt32\" Name=\"Cell IDs\" format=\"appended\" offset=\"" << array_offsets[4] << "\"/>\n";
+    for (unsigned field = 0; field < num_fields; field++)
+    {
+        file << "        <DataArray type=\"Float64\" Name=\"" << rSnapshot.mFieldNames[field]
+             << "\" format=\"appended\" offset=\"" << array_offsets[5 + field] << "\"/>\n";
+    }
+    file << "      </CellData>\n";
+    file << "    </Piece>\n";
+    file << "  </UnstructuredGrid>\n";
+    file << "  <AppendedData encoding=\"raw\">\n";
+    file << "   _";
+    for (const std::vector<char>& r_encoded : encoded)
+    {
+        file.write(r_encoded.data(), r_encoded.size());
+    }
+    file << "\n  </AppendedData>\n";
+    file << "</VTKFile>\n";
+
+    file.close();
+    return !file.fail();
+}
+
+bool EdgeDataVtuWriter::EncodeArray(const void* pData, std::size_t numBytes, std::vector<char>& rEncoded) const
+{
+    const char* p_bytes = static_cast<const char*>(pData);
+    if (!mUseCompression)
+    {
+        const uint64_t size = numBytes;
+        rEncoded.resize(sizeof(uint64_t) + numBytes);
+        std::memcpy(rEncoded.data(), &size, sizeof(uint64_t));
+        if (numBytes > 0)
+        {
+            std::memcpy(rEncoded.data() + sizeof(uint64_t), p_bytes, numBytes);
+        }
+        return true;
+    }
+
+    // The header gives the number of blocks, the block size, the size of the last block
+    // and the compressed size of each block
+    const std::size_t num_blocks = (numBytes + COMPRESSION_BLOCK_SIZE - 1)/COMPRESSION_BLOCK_SIZE;
+    std::vector<uint64_t> header(3 + num_blocks);
+    header[0] = num_blocks;
+    header[1] = COMPRESSION_BLOCK_SIZE;
+    header[2] = (num_blocks == 0) ? 0 : numBytes - (num_blocks - 1)*COMPRESSION_BLOCK_SIZE;
+
+    std::vector<char> blocks;
+    for (std::size_t block = 0; block < num_blocks; block++)
+    {
+        const std::size_t block_size = std::min(COMPRESSION_BLOCK_SIZE, numBytes - block*COMPRESSION_BLOCK_SIZE);
+        uLongf compressed_size = compressBound(block_size);
+        const std::size_t start = blocks.size();
+        blocks.resize(start + compressed_size);
+        if (compress2(reinterpret_cast<Bytef*>(blocks.data() + start), &compressed_size,
+                      reinterpret_cast<const Bytef*>(p_bytes + block*COMPRESSION_BLOCK_SIZE), block_size,
+                      Z_BEST_SPEED) != Z_OK)
+        {
+            return false;
+        }
+        blocks.resize(start + compressed_size);
+        header[3 + block] = compressed_size;
+    }
+
+    const std::size_t header_size = header.size()*sizeof(uint64_t);
+    rEncoded.resize(header_size + blocks.size());
+    std::memcpy(rEncoded.data(), header.data(), header_size);
+    if (!blocks.empty())
+    {
+        std::memcpy(rEncoded.data() + header_size, blocks.data(), blocks.size());
+    }
+    return true;
+}
+
+void EdgeDataVtuWriter::PartitionTriangles(const EdgeDataSnapshot& rSnapshot, std::vector<std::vector<unsigned> >& rPieces) const
+{
+    // The triangles of each cell are consecutive and share their first point, the cell centroid
+    const unsigned num_triangles = rSnapshot.mConnectivity.size()/3;
+    std::vector<unsigned> cell_triangles;
+    std::vector<double> centroids;
+    for (unsigned triangle = 0; triangle < num_triangles; triangle++)
+    {
+        const unsigned centroid = rSnapshot.mConnectivity[3*triangle];
+        if (triangle == 0 || centroid != rSnapshot.mConnectivity[3*(triangle - 1)])
+        {
+            cell_triangles.push_back(triangle);
+            centroids.insert(centroids.end(), rSnapshot.mPoints.begin() + 3*centroid, rSnapshot.mPoints.begin() + 3*centroid + 3);
+        }
+    }
+    const unsigned num_cells = cell_triangles.size();
+    cell_triangles.push_back(num_triangles);
+
+    std::vector<unsigned> cells(num_cells);
+    for (unsigned cell = 0; cell < num_cells; cell++)
+    {
+        cells[cell] = cell;
+    }
+    rPieces.assign(mNumberOfPieces, std::vector<unsigned>());
+    BisectCells(centroids, cell_triangles, cells, 0, num_cells, 0, mNumberOfPieces, rPieces);
+}
+
+bool EdgeDataVtuWriter::WriteCollection()
+{
+    std::ofstream file(mDirectory + mBaseName + ".pvd");
+    if (!file)
+    {
+        return false;
+    }
+    file.precision(std::numeric_limits<double>::max_digits10);
+
+    file << "<?xml version=\"1.0\"?>\n";
+    file << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"" << GetByteOrder() << "\">\n";
+    file << "  <Collection>\n";
+    for (const std::pair<double, std::string>& r_file : mWrittenFiles)
+    {
+        file << "    <DataSet timestep=\"" << r_file.first << "\" group=\"\" part=\"0\" file=\"" << r_file.second << "\"/>\n";
+    }
+    file << "  </Collection>\n";
+    file << "</VTKFile>\n";
+
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,320 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef EDGEDATAVTUWRITER_HPP_
+#define EDGEDATAVTUWRITER_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * A copy of the geometry and edge data of a vertex-based cell population at one time,
+ * in the form written by EdgeDataVtuWriter: each edge of each cell is a triangle joining
+ * the cell centroid to the two ends of the edge, carrying that edge's data.
+ */
+struct EdgeDataSnapshot
+{
+    /** The simulation time of the snapshot. */
+    double mTime;
+
+    /** The number of time steps elapsed, which numbers the output file. */
+    unsigned mTimeStep;
+
+    /** The coordinates of the points, three per point. */
+    std::vector<double> mPoints;
+
+    /** The indices of the points of the triangles, three per triangle. */
+    std::vector<unsigned> mConnectivity;
+
+    /** The id of the cell of each triangle. */
+    std::vector<unsigned> mCellIds;
+
+    /** The names of the edge data fields. */
+    std::vector<std::string> mFieldNames;
+
+    /** The values of each field, one per triangle. */
+    std::vector<std::vector<double> > mFields;
+
+    /**
+     * Empty the snapshot, keeping its memory so that it can be refilled without allocating.
+     */
+    void Clear();
+};
+
+/**
+ * Writes snapshots of edge data to VTU files on a background thread, so that the
+ * simulation does not wait for the disk.
+ *
+ * The writer owns a fixed pool of snapshot buffers. The simulation acquires a free buffer,
+ * fills it and submits it; the background thread writes submitted snapshots in order, each
+ * to <base name>_<time step>.vtu, keeps a <base name>.pvd collection of them up to date and
+ * then returns the buffer to the pool.
+ *
+ * Large tissues may be split into several pieces, each holding the cells of one region
+ * of space (found by recursive coordinate bisection of the cell centroids). The pieces,
+ * <base name>_<time step>_<piece>.vtu, are written concurrently by worker threads and
+ * gathered by <base name>_<time step>.pvtu, so that ParaView can also read them in parallel.
+ * The piece workers are started with the writer and kept for its lifetime; the background
+ * thread writes pieces alongside them.
+ * Data arrays are stored as raw binary in the appended section of each file, optionally
+ * compressed with zlib. When every buffer is waiting to be written,
+ * AcquireBuffer() blocks until one is free, which bounds the memory used and slows the
+ * simulation to the speed of the disk rather than letting snapshots pile up. Two buffers
+ * give double buffering: one is filled while the other is written.
+ *
+ * Errors on the background thread are reported by the next call to AcquireBuffer() or
+ * Finish().
+ */
+class EdgeDataVtuWriter
+{
+private:
+
+    /** The directory written to, ending in a slash. */
+    std::string mDirectory;
+
+    /** The base name of the files. */
+    std::string mBaseName;
+
+    /** The number of pieces each snapshot is split into. */
+    unsigned mNumberOfPieces;
+
+    /** Whether the data arrays are compressed. */
+    bool mUseCompression;
+
+    /** The snapshot buffers. */
+    std::vector<EdgeDataSnapshot> mBuffers;
+
+    /** The indices of the buffers that may be filled. */
+    std::deque<unsigned> mFreeBuffers;
+
+    /** The indices of the buffers waiting to be written, in order of submission. */
+    std::deque<unsigned> mSubmittedBuffers;
+
+    /** The time and file name of each snapshot written, for the collection file. Only used by the background thread. */
+    std::vector<std::pair<double, std::string> > mWrittenFiles;
+
+    /** Guards the queues, mIsFinishing, mError and the counters. */
+    std::mutex mMutex;
+
+    /** Signalled when a buffer is returned to the pool. */
+    std::condition_variable mBufferFreed;
+
+    /** Signalled when a buffer is submitted, or the writer is finishing. */
+    std::condition_variable mBufferSubmitted;
+
+    /** Whether Finish() has been called. */
+    bool mIsFinishing;
+
+    /** The first error on the background thread, or empty. */
+    std::string mError;
+
+    /** The number of snapshots written. */
+    unsigned mNumberOfSnapshotsWritten;
+
+    /** The number of calls to AcquireBuffer() that had to wait for a free buffer. */
+    unsigned mNumberOfWaits;
+
+    /** The background thread. */
+    std::thread mThread;
+
+    /** The threads that help the background thread write the pieces of a snapshot. */
+    std::vector<std::thread> mPieceWorkers;
+
+    /** Guards the members describing the pieces being written. */
+    std::mutex mPieceMutex;
+
+    /** Signalled when there are pieces to write, or the piece workers are stopping. */
+    std::condition_variable mPiecesReady;
+
+    /** Signalled when the last piece of a snapshot has been written. */
+    std::condition_variable mPiecesDone;
+
+    /** The snapshot whose pieces are being written, or null. */
+    const EdgeDataSnapshot* mpPieceSnapshot;
+
+    /** The triangles of each piece being written. */
+    const std::vector<std::vector<unsigned> >* mpPieceTriangles;
+
+    /** The file name of each piece being written. */
+    const std::vector<std::string>* mpPieceNames;
+
+    /** Whether each piece has been written. */
+    std::vector<char> mIsPieceWritten;
+
+    /** The next piece to be claimed by a thread. */
+    unsigned mNextPiece;
+
+    /** The number of pieces claimed but not yet written. */
+    unsigned mNumPiecesInProgress;
+
+    /** Whether the piece workers should stop. */
+    bool mArePieceWorkersStopping;
+
+    /**
+     * The body of the background thread: write submitted snapshots until finishing.
+     */
+    void Run();
+
+    /**
+     * The body of a piece worker: help write the pieces of each snapshot until stopping.
+     */
+    void RunPieceWorker();
+
+    /**
+     * Claim the next unclaimed piece, if any, and write it.
+     *
+     * @param rLock a lock on mPieceMutex, released while the piece is written
+     * @return whether a piece was claimed
+     */
+    bool WriteNextPiece(std::unique_lock<std::mutex>& rLock);
+
+    /**
+     * Stop and join the piece workers.
+     */
+    void StopPieceWorkers();
+
+    /**
+     * Write a snapshot to a VTU file, or to a PVTU file and its pieces.
+     *
+     * @param rSnapshot the snapshot
+     * @param rFileName the name of the VTU or PVTU file, relative to the directory
+     * @return whether every file was written
+     */
+    bool WriteSnapshot(const EdgeDataSnapshot& rSnapshot, const std::string& rFileName);
+
+    /**
+     * Write some of the triangles of a snapshot to a VTU file.
+     *
+     * @param rSnapshot the snapshot
+     * @param rTriangles the triangles to write, in order
+     * @param rFileName the name of the file, relative to the directory
+     * @return whether the file was written
+     */
+    bool WritePiece(const EdgeDataSnapshot& rSnapshot, const std::vector<unsigned>& rTriangles, const std::string& rFileName);
+
+    /**
+     * Encode a data array for the appended section of a VTU file: a header giving its size
+     * in bytes followed by the bytes themselves, or, when compressing, a header giving the
+     * number and sizes of the blocks followed by the compressed blocks.
+     *
+     * @param pData the start of the array
+     * @param numBytes the size of the array in bytes
+     * @param rEncoded filled in with the encoded array
+     * @return whether the array could be encoded
+     */
+    bool EncodeArray(const void* pData, std::size_t numBytes, std::vector<char>& rEncoded) const;
+
+    /**
+     * Share the triangles of a snapshot between the pieces, keeping the triangles of each
+     * cell together and the cells of each piece close together in space.
+     *
+     * @param rSnapshot the snapshot
+     * @param rPieces filled in with the triangles of each piece
+     */
+    void PartitionTriangles(const EdgeDataSnapshot& rSnapshot, std::vector<std::vector<unsigned> >& rPieces) const;
+
+    /**
+     * Rewrite the collection file listing the snapshots written so far.
+     *
+     * @return whether the file was written
+     */
+    bool WriteCollection();
+
+public:
+
+    /**
+     * Constructor. Starts the background thread, and a worker for each piece after the first.
+     *
+     * @param rDirectory the full path of the directory to write to
+     * @param rBaseName the base name of the files
+     * @param numBuffers the number of snapshot buffers (at least 1; defaults to 2)
+     * @param numPieces the number of pieces each snapshot is split into (at least 1; defaults to 1)
+     * @param useCompression whether to compress the data arrays (defaults to false)
+     */
+    EdgeDataVtuWriter(const std::string& rDirectory,
+                      const std::string& rBaseName,
+                      unsigned numBuffers=2,
+                      unsigned numPieces=1,
+                      bool useCompression=false);
+
+    /**
+     * Destructor. Writes any submitted snapshots and stops the background thread and piece workers.
+     */
+    ~EdgeDataVtuWriter();
+
+    /** Writers own a thread, so may not be copied. */
+    EdgeDataVtuWriter(const EdgeDataVtuWriter&) = delete;
+
+    /** Writers own a thread, so may not be assigned. */
+    EdgeDataVtuWriter& operator=(const EdgeDataVtuWriter&) = delete;
+
+    /**
+     * Take a free buffer to fill, waiting for one if all are waiting to be written.
+     *
+     * @return the buffer, emptied
+     */
+    EdgeDataSnapshot& AcquireBuffer();
+
+    /**
+     * Hand a filled buffer to the background thread to write.
+     *
+     * @param rSnapshot a buffer returned by AcquireBuffer()
+     */
+    void Submit(EdgeDataSnapshot& rSnapshot);
+
+    /**
+     * Wait for every submitted snapshot to be written and stop the background thread and
+     * piece workers. Further snapshots may not be submitted.
+     */
+    void Finish();
+
+    /**
+     * @return the number of snapshots written so far
+     */
+    unsigned GetNumberOfSnapshotsWritten();
+
+    /**
+     * @return the number of times the simulation has had to wait for a free buffer
+     */
+    unsigned GetNumberOfWaits();
+};
+
+#endif /*EDGEDATAVTUWRITER_HPP_*/
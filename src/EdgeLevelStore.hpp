@@ -0,0 +1,193 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef EDGELEVELSTORE_HPP_
+#define EDGELEVELSTORE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/**
+ * The levels of a fixed number of species on each of many edges, packed edge by edge
+ * in a single contiguous array.
+ *
+ * EdgeSpeciesTrackingModifier uses three of these stores for its own caches of published
+ * levels, exchanged levels and neighbour means.
+ */
+template<unsigned NUM_SPECIES>
+class EdgeLevelStore
+{
+public:
+
+    /** The levels of every species on one edge. */
+    typedef std::array<double, NUM_SPECIES> Levels;
+
+private:
+
+    /** The number of edges. */
+    std::size_t mNumEdges;
+
+    /** The levels, packed edge by edge. */
+    std::vector<double> mLevels;
+
+public:
+
+    /**
+     * Constructor. The store is empty.
+     */
+    EdgeLevelStore()
+        : mNumEdges(0)
+    {
+    }
+
+    /**
+     * Empty the store, and give back its memory.
+     */
+    void Clear()
+    {
+        mNumEdges = 0;
+        std::vector<double>().swap(mLevels);
+    }
+
+    /**
+     * @return the number of edges
+     */
+    std::size_t GetNumEdges() const
+    {
+        return mNumEdges;
+    }
+
+    /**
+     * @return whether there are no edges
+     */
+    bool IsEmpty() const
+    {
+        return mNumEdges == 0;
+    }
+
+    /**
+     * Change the number of edges, keeping the levels of the edges that remain. Any new
+     * edges have zero levels. Memory is kept when the store shrinks, so that it is
+     * reused when it grows back.
+     *
+     * @param numEdges the number of edges
+     */
+    void Resize(std::size_t numEdges)
+    {
+        mNumEdges = numEdges;
+        mLevels.resize(numEdges*NUM_SPECIES, 0.0);
+    }
+
+    /**
+     * Set the number of edges and zero every level.
+     *
+     * @param numEdges the number of edges
+     */
+    void AssignZero(std::size_t numEdges)
+    {
+        mNumEdges = numEdges;
+        mLevels.assign(numEdges*NUM_SPECIES, 0.0);
+    }
+
+    /**
+     * @param edge the edge
+     * @param species the species
+     * @return the level of the species on the edge
+     */
+    double Get(std::size_t edge, unsigned species) const
+    {
+        assert(edge < mNumEdges && species < NUM_SPECIES);
+        return mLevels[edge*NUM_SPECIES + species];
+    }
+
+    /**
+     * @param edge the edge
+     * @param species the species
+     * @param level the new level of the species on the edge
+     */
+    void Set(std::size_t edge, unsigned species, double level)
+    {
+        assert(edge < mNumEdges && species < NUM_SPECIES);
+        mLevels[edge*NUM_SPECIES + species] = level;
+    }
+
+    /**
+     * @param edge the edge
+     * @param species the species
+     * @param increment the amount to add to the level of the species on the edge
+     */
+    void Add(std::size_t edge, unsigned species, double increment)
+    {
+        assert(edge < mNumEdges && species < NUM_SPECIES);
+        mLevels[edge*NUM_SPECIES + species] += increment;
+    }
+
+    /**
+     * @param edge the edge
+     * @param rLevels the new levels of every species on the edge
+     */
+    void SetEdge(std::size_t edge, const Levels& rLevels)
+    {
+        assert(edge < mNumEdges);
+        std::copy(rLevels.begin(), rLevels.end(), mLevels.begin() + edge*NUM_SPECIES);
+    }
+
+    /**
+     * Copy the levels of one edge from another store.
+     *
+     * @param edge the edge
+     * @param rStore the store to copy from
+     */
+    void CopyEdge(std::size_t edge, const EdgeLevelStore& rStore)
+    {
+        assert(edge < mNumEdges && edge < rStore.mNumEdges);
+        std::copy(rStore.mLevels.begin() + edge*NUM_SPECIES,
+                  rStore.mLevels.begin() + (edge + 1)*NUM_SPECIES,
+                  mLevels.begin() + edge*NUM_SPECIES);
+    }
+
+    /**
+     * @return every level, packed edge by edge, valid until this store is changed
+     */
+    const double* GetLevels() const
+    {
+        return mLevels.data();
+    }
+};
+
+#endif /*EDGELEVELSTORE_HPP_*/
@@ -0,0 +1,629 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef EDGESPECIESTRACKINGMODIFIER_HPP_
+#define EDGESPECIESTRACKINGMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "EdgeDataSchema.hpp"
+#include "EdgeLevelStore.hpp"
+#include "EdgeStateFlightRecorder.hpp"
+
+/**
+ * A modifier that tracks the levels of the species of an edge SRN, parameterised by a
+ * compile-time species list SPECIES (see PolarityEdgeSpecies for an example).
+ *
+ * The species list gives the edge SRN model, the number of species, their names, which
+ * of them diffuse around the edges of a cell and which are exchanged with neighbouring
+ * edges, and how to read and write the levels of all species of an edge at once. From
+ * this the modifier builds fused loops over fixed-size arrays of levels:
+ *  - the diffusing species are diffused around each cell at the end of each time step;
+ *  - each edge's levels are published as the CellEdgeData items "edge <name>";
+ *  - the mean levels of the exchanged species in each edge's neighbouring edges are
+ *    published as "neighbour <name>".
+ * The item names are built once, in the constructor, together with an EdgeDataSchema
+ * declaring which items are kept in the CellEdgeData and which are written to output.
+ * CellEdgeData gives no lasting access to the storage of its items, so each write looks
+ * the item up by name. To keep these writes few, an item is only rewritten when one of the
+ * levels it holds has changed since the cell last published it, which the modifier can
+ * tell from its own packed copies of the published levels and neighbour means.
+ * By default the edge levels are kept and written, and the neighbour means, which the
+ * edge SRNs read, are kept but not written.
+ *
+ * Optionally, the packed levels and neighbour means of the last few time steps are kept
+ * in an EdgeStateFlightRecorder, which is only written out when a level goes bad, on
+ * SIGUSR1, when the modifier's own SRN solve throws, or on request.
+ *
+ * Model-specific modifiers derive from this class, which keeps each one to its species
+ * list and anything genuinely particular to the model. The members are defined in
+ * EdgeSpeciesTrackingModifierImpl.hpp; each model-specific modifier's translation unit
+ * includes it and explicitly instantiates this class for its species list, so this class
+ * depends on no particular model.
+ */
+template<unsigned DIM, class SPECIES>
+class EdgeSpeciesTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+public:
+
+    /** The number of species. */
+    static constexpr unsigned NUM_SPECIES = SPECIES::NUM_SPECIES;
+
+    /** The levels of every species on one edge. */
+    typedef std::array<double, NUM_SPECIES> Levels;
+
+private:
+
+    /**
+     * Diffusion coefficient of the diffusing species within the plasma membrane.
+     * Initialised to 0.03 in the constructor.
+     */
+    double mDiffusionCoefficient;
+
+    /**
+     * Whether to use Strang splitting between membrane diffusion and the edge
+     * reactions, rather than the default Lie splitting. Initialised to false in the
+     * constructor.
+     */
+    bool mUseStrangSplitting;
+
+    /**
+     * The largest number of time steps allowed between exchanges of edge levels with
+     * neighbouring cells. Initialised to 1 in the constructor, so that levels are
+     * exchanged at every time step.
+     */
+    unsigned mMaxNeighbourExchangeInterval;
+
+    /**
+     * The largest change in any published edge level allowed before it is exchanged
+     * with neighbouring cells. Initialised to 1e-3 in the constructor.
+     */
+    double mNeighbourExchangeTolerance;
+
+    /** The current number of time steps between exchanges with neighbouring cells. */
+    unsigned mNeighbourExchangeInterval;
+
+    /** The number of calls to UpdateCellData() since the last exchange. */
+    unsigned mStepsSinceNeighbourExchange;
+
+    /** The number of exchanges with neighbouring cells so far. */
+    unsigned mNumberOfNeighbourExchanges;
+
+    /** Fingerprint of the cells and edges at the last exchange. */
+    std::size_t mTopologyFingerprint;
+
+    /**
+     * The edge levels of every cell last used to compute the neighbour means, with edges
+     * numbered in cell iteration order.
+     */
+    EdgeLevelStore<NUM_SPECIES> mExchangedLevels;
+
+    /** The edge levels of every cell published by the last call to UpdateCellData(), laid out as mExchangedLevels. */
+    EdgeLevelStore<NUM_SPECIES> mPublishedLevels;
+
+    /**
+     * Whether to update the neighbour means only around edges whose levels have changed,
+     * rather than recomputing them all at each exchange. Initialised to false in the
+     * constructor.
+     */
+    bool mUseIncrementalNeighbourMeans;
+
+    /**
+     * The largest change in any level of an edge, since it was last used to compute the
+     * neighbour means, for which the edge is treated as unchanged when updating the means
+     * incrementally. Initialised to 1e-6 in the constructor.
+     */
+    double mDirtyEdgeTolerance;
+
+    /**
+     * The number of exchanges after which all neighbour means are recomputed when updating
+     * them incrementally, so that neither rounding errors nor changes below
+     * mDirtyEdgeTolerance can accumulate. Initialised to 100 in the constructor.
+     */
+    unsigned mFullNeighbourRecomputeInterval;
+
+    /** The number of exchanges since all neighbour means were last recomputed. */
+    unsigned mExchangesSinceFullRecompute;
+
+    /** The number of edges whose neighbour means have been recomputed or updated so far. */
+    unsigned mNumberOfUpdatedNeighbourMeans;
+
+    /** The cells, in iteration order, at the last change of topology. */
+    std::vector<CellPtr> mCellsInOrder;
+
+    /**
+     * The CellEdgeData of each cell in mCellsInOrder, kept since Cell::GetCellEdgeData()
+     * searches (and copies) the cell's properties.
+     */
+    std::vector<boost::shared_ptr<CellEdgeData> > mCellEdgeData;
+
+    /** The number of the first edge of each cell, followed by the total number of edges. */
+    std::vector<unsigned> mCellFirstEdge;
+
+    /** The position in mCellsInOrder of the cell owning each edge. */
+    std::vector<unsigned> mEdgeCell;
+
+    /** The numbers of the neighbouring edges of each edge. */
+    std::vector<std::vector<unsigned> > mNeighbourEdges;
+
+    /** The numbers of the edges having each edge among their neighbouring edges. */
+    std::vector<std::vector<unsigned> > mDependentEdges;
+
+    /** The mean levels in the neighbouring edges of each edge. */
+    EdgeLevelStore<NUM_SPECIES> mNeighbourMeans;
+
+    /** The CellEdgeData item names "edge <name>" of the species. */
+    std::array<std::string, NUM_SPECIES> mEdgeItemNames;
+
+    /** The CellEdgeData item names "neighbour <name>" of the species. */
+    std::array<std::string, NUM_SPECIES> mNeighbourItemNames;
+
+    /** The fields of the CellEdgeData items published by this modifier. */
+    boost::shared_ptr<EdgeDataSchema> mpEdgeDataSchema;
+
+    /** The index in mpEdgeDataSchema of the field "edge <name>" of each species. */
+    std::array<unsigned, NUM_SPECIES> mEdgeFields;
+
+    /** Whether the item "edge <name>" of each species was kept at the last UpdateCellData(). */
+    std::array<bool, NUM_SPECIES> mEdgeItemIsKept;
+
+    /** The number of time steps held by the flight recorder, or 0 for none. Initialised to 0 in the constructor. */
+    unsigned mFlightRecorderLength;
+
+    /** Whether SIGUSR1 triggers a flight recorder dump. Initialised to false in the constructor. */
+    bool mDumpFlightRecorderOnSignal;
+
+    /**
+     * The largest amount by which a level may fall below zero without triggering a flight
+     * recorder dump. Initialised to 1e-8 in the constructor.
+     */
+    double mFlightRecorderNegativeTolerance;
+
+    /** The flight recorder of the current (or last) solve, if enabled. */
+    boost::shared_ptr<EdgeStateFlightRecorder> mpFlightRecorder;
+
+    /** The id of each cell in mCellsInOrder, reused by RecordFlightFrame(). */
+    std::vector<unsigned> mFlightRecorderCellIds;
+
+    /*
+     * Scratch space, kept between time steps so that a step of a tissue whose topology
+     * has not changed allocates nothing. None of it is archived.
+     */
+
+    /** The level of one species on each edge of a cell, as stored in its CellEdgeData. */
+    std::vector<double> mScratchEdgeItem;
+
+    /** The levels on each edge of the cell being diffused. */
+    std::vector<Levels> mScratchCellLevels;
+
+    /** The level of one species around the ring of edges of the cell being diffused. */
+    std::vector<double> mScratchRingLevels;
+
+    /** Workspace for DiffuseAroundRing(). */
+    std::vector<double> mScratchRingWorkspace;
+
+    /**
+     * Whether the mean of each species around the edges of each cell in mCellsInOrder has
+     * changed at this exchange, so that its "neighbour" item must be rewritten.
+     */
+    std::vector<bool> mScratchNeighbourItemIsStale;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mDiffusionCoefficient;
+        archive & mUseStrangSplitting;
+        archive & mMaxNeighbourExchangeInterval;
+        archive & mNeighbourExchangeTolerance;
+        archive & mUseIncrementalNeighbourMeans;
+        archive & mDirtyEdgeTolerance;
+        archive & mFullNeighbourRecomputeInterval;
+        archive & mpEdgeDataSchema;
+        archive & mFlightRecorderLength;
+        archive & mDumpFlightRecorderOnSignal;
+        archive & mFlightRecorderNegativeTolerance;
+    }
+
+    /**
+     * Mix a value into a topology fingerprint.
+     *
+     * @param rFingerprint the fingerprint, updated in place
+     * @param value the value to mix in
+     */
+    static void CombineFingerprint(std::size_t& rFingerprint, std::size_t value);
+
+    /**
+     * Helper method to number the edges of every cell and to cache which edges neighbour
+     * each other, so that the neighbour means can be computed without querying the mesh.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void CacheEdgeNeighbours(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Helper method to store the neighbour means of one cell's edges in its CellEdgeData,
+     * rewriting only the items marked in mScratchNeighbourItemIsStale.
+     *
+     * @param cellPosition the position of the cell in mCellsInOrder
+     */
+    void StoreNeighbourMeans(unsigned cellPosition);
+
+    /**
+     * Helper method to compute the mean levels in each edge's neighbouring edges, store
+     * these in the CellEdgeData and remember the levels that were exchanged.
+     *
+     * When incremental updates are enabled, only the means of edges neighbouring an edge
+     * whose levels have changed by more than mDirtyEdgeTolerance are updated, by the change
+     * in that edge's contribution. All means are recomputed after a change of topology and
+     * every mFullNeighbourRecomputeInterval exchanges. Either way, only the items holding a
+     * changed mean are rewritten.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param topologyChanged whether the cells or edges have changed since the last exchange
+     */
+    void ExchangeNeighbourLevels(AbstractCellPopulation<DIM,DIM>& rCellPopulation, bool topologyChanged);
+
+    /**
+     * Helper method to record the levels published by the last call to UpdateCellData(),
+     * and the neighbour means, in the flight recorder, if there is one.
+     */
+    void RecordFlightFrame();
+
+protected:
+
+    /**
+     * @param locationIndex the location index of a cell
+     * @return whether the cell's edges are updated by this process; true unless overridden
+     */
+    virtual bool IsLocallyOwned(unsigned locationIndex) const;
+
+    /**
+     * Called once the drift of the published levels since the last exchange has been
+     * measured over this process's cells, before deciding whether to exchange. Does
+     * nothing unless overridden.
+     *
+     * @param rMaxDrift the largest drift, which may be updated
+     * @param topologyChanged whether the cells or edges have changed since the last exchange
+     */
+    virtual void ReduceDrift(double& rMaxDrift, bool topologyChanged);
+
+    /**
+     * Called at the start of UpdateCellData(), before any levels are published, so that
+     * the levels of cells whose edges are updated by another process can be brought up to
+     * date. Does nothing unless overridden.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void SynchroniseLevels(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Helper method to diffuse the diffusing species around the edges of one cell.
+     *
+     * @param pCell the cell
+     * @param dt the time step
+     */
+    void DiffuseCellEdgeSpecies(CellPtr pCell, double dt);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    EdgeSpeciesTrackingModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~EdgeSpeciesTrackingModifier();
+
+    /**
+     * @param diffusionCoefficient the diffusion coefficient of the diffusing species within the membrane
+     */
+    void SetDiffusionCoefficient(double diffusionCoefficient);
+
+    /**
+     * @return the diffusion coefficient of the diffusing species within the membrane
+     */
+    double GetDiffusionCoefficient() const;
+
+    /**
+     * Set whether to use Strang splitting.
+     *
+     * By default the edge SRNs are solved over each time step before the cells are
+     * updated, and membrane diffusion is applied afterwards in UpdateAtEndOfTimeStep().
+     * This Lie splitting is first order accurate in the time step. With Strang splitting,
+     * UpdateAtEndOfTimeStep() applies half a diffusion step, solves the edge SRNs up to
+     * the current time and then applies the other half of the diffusion step.
+     *
+     * Only the splitting between diffusion and reactions within a cell becomes second
+     * order. The edge SRNs are still solved with the neighbour levels of the last
+     * exchange held fixed over the step, so in a tissue, where edges react with the
+     * edges of neighbouring cells, the scheme as a whole stays first order in the time
+     * step. The gain is therefore limited to isolated cells, or to tissues in which the
+     * coupling between cells is slow compared with diffusion and the reactions within them.
+     *
+     * @param useStrangSplitting whether to use Strang splitting
+     */
+    void SetUseStrangSplitting(bool useStrangSplitting);
+
+    /**
+     * @return whether Strang splitting is used
+     */
+    bool GetUseStrangSplitting() const;
+
+    /**
+     * Allow the exchange of edge levels with neighbouring cells to be skipped while
+     * the levels barely change.
+     *
+     * The neighbour means are then refreshed at most every maxInterval time steps, with
+     * the interval adapted to how far the published levels drift between exchanges. An
+     * exchange is forced whenever any level has drifted by more than the tolerance, and
+     * after any change of topology (cells added or removed, or edges rearranged).
+     *
+     * @param maxInterval the largest number of time steps between exchanges (1 to exchange at every step)
+     */
+    void SetMaxNeighbourExchangeInterval(unsigned maxInterval);
+
+    /**
+     * @return the largest number of time steps between exchanges with neighbouring cells
+     */
+    unsigned GetMaxNeighbourExchangeInterval() const;
+
+    /**
+     * @param tolerance the largest change in any published edge level allowed between exchanges
+     */
+    void SetNeighbourExchangeTolerance(double tolerance);
+
+    /**
+     * @return the largest change in any published edge level allowed between exchanges
+     */
+    double GetNeighbourExchangeTolerance() const;
+
+    /**
+     * @return the current number of time steps between exchanges with neighbouring cells
+     */
+    unsigned GetNeighbourExchangeInterval() const;
+
+    /**
+     * @return the number of exchanges with neighbouring cells so far
+     */
+    unsigned GetNumberOfNeighbourExchanges() const;
+
+    /**
+     * Set whether to maintain the neighbour means incrementally.
+     *
+     * Each exchange then only revisits the edges next to an edge whose levels have changed,
+     * so that on a large, mostly settled tissue its cost scales with the activity rather
+     * than the size of the tissue.
+     *
+     * @param useIncrementalNeighbourMeans whether to update the neighbour means incrementally
+     */
+    void SetUseIncrementalNeighbourMeans(bool useIncrementalNeighbourMeans);
+
+    /**
+     * @return whether the neighbour means are updated incrementally
+     */
+    bool GetUseIncrementalNeighbourMeans() const;
+
+    /**
+     * @param tolerance the largest change in an edge's levels ignored by incremental updates
+     */
+    void SetDirtyEdgeTolerance(double tolerance);
+
+    /**
+     * @return the largest change in an edge's levels ignored by incremental updates
+     */
+    double GetDirtyEdgeTolerance() const;
+
+    /**
+     * @param interval the number of exchanges between full recomputations of the neighbour means
+     */
+    void SetFullNeighbourRecomputeInterval(unsigned interval);
+
+    /**
+     * @return the number of exchanges between full recomputations of the neighbour means
+     */
+    unsigned GetFullNeighbourRecomputeInterval() const;
+
+    /**
+     * @return the number of edges whose neighbour means have been recomputed or updated so far
+     */
+    unsigned GetNumberOfUpdatedNeighbourMeans() const;
+
+    /**
+     * @return the schema declaring which of the published items are kept in the CellEdgeData
+     * and which are written to output; pass it to an output modifier to apply the latter
+     */
+    boost::shared_ptr<EdgeDataSchema> GetEdgeDataSchema() const;
+
+    /**
+     * Set the number of time steps held by the flight recorder, which is created by
+     * SetupSolve(). Dumps are written to flight_recorder_<dump number>.dat in the output
+     * directory (flight_recorder_<rank>_<dump number>.dat in parallel).
+     *
+     * @param length the number of time steps held, or 0 for no flight recorder
+     */
+    void SetFlightRecorderLength(unsigned length);
+
+    /**
+     * @return the number of time steps held by the flight recorder, or 0 if there is none
+     */
+    unsigned GetFlightRecorderLength() const;
+
+    /**
+     * @param dumpOnSignal whether receiving SIGUSR1 during a solve triggers a flight recorder dump
+     */
+    void SetDumpFlightRecorderOnSignal(bool dumpOnSignal);
+
+    /**
+     * @return whether receiving SIGUSR1 during a solve triggers a flight recorder dump
+     */
+    bool GetDumpFlightRecorderOnSignal() const;
+
+    /**
+     * @param tolerance the largest amount by which a level may fall below zero without triggering a flight recorder dump
+     */
+    void SetFlightRecorderNegativeTolerance(double tolerance);
+
+    /**
+     * @return the largest amount by which a level may fall below zero without triggering a flight recorder dump
+     */
+    double GetFlightRecorderNegativeTolerance() const;
+
+    /**
+     * @return the flight recorder of the current (or last) solve, or null if it is not enabled
+     */
+    boost::shared_ptr<EdgeStateFlightRecorder> GetFlightRecorder() const;
+
+    /**
+     * Dump the flight recorder, for example after a simulation has thrown. The recorder
+     * is kept after a solve ends, so it can still be dumped then.
+     *
+     * @param rReason why the dump was made
+     * @return the path of the dump file, or an empty string if there is no flight recorder
+     */
+    std::string DumpFlightRecorder(const std::string& rReason);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specifies what to do in the simulation at the end of each time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Specifies what to do in the simulation before the start of the time loop.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Stop the flight recorder listening for SIGUSR1.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Apply diffusion to levels stored around the ring of edges of a cell, with
+     * periodic boundary conditions.
+     *
+     * @param rLevels the level on each edge, updated in place
+     * @param diffusionCoefficient the diffusion coefficient
+     * @param dt the time step
+     * @param useSecondOrderScheme whether to use Heun's method rather than explicit Euler
+     */
+    static void DiffuseAroundRing(std::vector<double>& rLevels,
+                                  double diffusionCoefficient,
+                                  double dt,
+                                  bool useSecondOrderScheme);
+
+    /**
+     * As DiffuseAroundRing() above, but using workspace provided by the caller rather
+     * than allocating it.
+     *
+     * @param rLevels the level on each edge, updated in place
+     * @param diffusionCoefficient the diffusion coefficient
+     * @param dt the time step
+     * @param useSecondOrderScheme whether to use Heun's method rather than explicit Euler
+     * @param rWorkspace workspace, resized as needed
+     */
+    static void DiffuseAroundRing(std::vector<double>& rLevels,
+                                  double diffusionCoefficient,
+                                  double dt,
+                                  bool useSecondOrderScheme,
+                                  std::vector<double>& rWorkspace);
+
+    /**
+     * Helper method to diffuse the diffusing species around the edges of each cell.
+     * Does nothing if no species diffuses.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param dt the time step
+     */
+    virtual void DiffuseEdgeSpecies(AbstractCellPopulation<DIM,DIM>& rCellPopulation, double dt);
+
+    /**
+     * Helper method to solve each cell's SRN up to the current time.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SimulateEdgeReactions(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Helper method to store each cell's edge levels in the CellEdgeData and, when due, to
+     * compute the mean levels in each edge's neighbouring edges and store these too.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#endif /*EDGESPECIESTRACKINGMODIFIER_HPP_*/
@@ -0,0 +1,905 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef EDGESPECIESTRACKINGMODIFIERIMPL_HPP_
+#define EDGESPECIESTRACKINGMODIFIERIMPL_HPP_
+
+/*
+ * The definitions of the members of EdgeSpeciesTrackingModifier. Include this only in the
+ * translation unit of a model-specific modifier, which explicitly instantiates
+ * EdgeSpeciesTrackingModifier for its own species list.
+ */
+
+#include "EdgeSpeciesTrackingModifier.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "CellSrnModel.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+template<unsigned DIM, class SPECIES>
+EdgeSpeciesTrackingModifier<DIM,SPECIES>::EdgeSpeciesTrackingModifier()
+        : AbstractCellBasedSimulationModifier<DIM>(),
+        mDiffusionCoefficient(0.03),
+        mUseStrangSplitting(false),
+        mMaxNeighbourExchangeInterval(1),
+        mNeighbourExchangeTolerance(1e-3),
+        mNeighbourExchangeInterval(1),
+        mStepsSinceNeighbourExchange(0),
+        mNumberOfNeighbourExchanges(0),
+        mTopologyFingerprint(0),
+        mUseIncrementalNeighbourMeans(false),
+        mDirtyEdgeTolerance(1e-6),
+        mFullNeighbourRecomputeInterval(100),
+        mExchangesSinceFullRecompute(0),
+        mNumberOfUpdatedNeighbourMeans(0),
+        mpEdgeDataSchema(new EdgeDataSchema()),
+        mFlightRecorderLength(0),
+        mDumpFlightRecorderOnSignal(false),
+        mFlightRecorderNegativeTolerance(1e-8)
+{
+    mEdgeItemIsKept.fill(false);
+    for (unsigned species = 0; species < NUM_SPECIES; species++)
+    {
+        const std::string name(SPECIES::GetName(species));
+        mEdgeItemNames[species] = "edge " + name;
+        mNeighbourItemNames[species] = "neighbour " + name;
+        mEdgeFields[species] = mpEdgeDataSchema->AddField(mEdgeItemNames[species], false, true);
+    }
+
+    // The edge SRNs read the neighbour means from the CellEdgeData
+    for (unsigned species = 0; species < NUM_SPECIES; species++)
+    {
+        if (SPECIES::IsExchanged(species))
+        {
+            mpEdgeDataSchema->AddField(mNeighbourItemNames[species], true, false);
+        }
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+EdgeSpeciesTrackingModifier<DIM,SPECIES>::~EdgeSpeciesTrackingModifier()
+{
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetDiffusionCoefficient(double diffusionCoefficient)
+{
+    if (diffusionCoefficient < 0.0)
+    {
+        EXCEPTION("The diffusion coefficient must be non-negative.");
+    }
+    mDiffusionCoefficient = diffusionCoefficient;
+}
+
+template<unsigned DIM, class SPECIES>
+double EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetDiffusionCoefficient() const
+{
+    return mDiffusionCoefficient;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetUseStrangSplitting(bool useStrangSplitting)
+{
+    mUseStrangSplitting = useStrangSplitting;
+}
+
+template<unsigned DIM, class SPECIES>
+bool EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetUseStrangSplitting() const
+{
+    return mUseStrangSplitting;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetMaxNeighbourExchangeInterval(unsigned maxInterval)
+{
+    if (maxInterval == 0)
+    {
+        EXCEPTION("The maximum neighbour exchange interval must be at least one time step.");
+    }
+    mMaxNeighbourExchangeInterval = maxInterval;
+    mNeighbourExchangeInterval = std::min(mNeighbourExchangeInterval, maxInterval);
+}
+
+template<unsigned DIM, class SPECIES>
+unsigned EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetMaxNeighbourExchangeInterval() const
+{
+    return mMaxNeighbourExchangeInterval;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetNeighbourExchangeTolerance(double tolerance)
+{
+    if (tolerance <= 0.0)
+    {
+        EXCEPTION("The neighbour exchange tolerance must be positive.");
+    }
+    mNeighbourExchangeTolerance = tolerance;
+}
+
+template<unsigned DIM, class SPECIES>
+double EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetNeighbourExchangeTolerance() const
+{
+    return mNeighbourExchangeTolerance;
+}
+
+template<unsigned DIM, class SPECIES>
+unsigned EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetNeighbourExchangeInterval() const
+{
+    return mNeighbourExchangeInterval;
+}
+
+template<unsigned DIM, class SPECIES>
+unsigned EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetNumberOfNeighbourExchanges() const
+{
+    return mNumberOfNeighbourExchanges;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetUseIncrementalNeighbourMeans(bool useIncrementalNeighbourMeans)
+{
+    mUseIncrementalNeighbourMeans = useIncrementalNeighbourMeans;
+}
+
+template<unsigned DIM, class SPECIES>
+bool EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetUseIncrementalNeighbourMeans() const
+{
+    return mUseIncrementalNeighbourMeans;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetDirtyEdgeTolerance(double tolerance)
+{
+    if (tolerance < 0.0)
+    {
+        EXCEPTION("The dirty edge tolerance must be non-negative.");
+    }
+    mDirtyEdgeTolerance = tolerance;
+}
+
+template<unsigned DIM, class SPECIES>
+double EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetDirtyEdgeTolerance() const
+{
+    return mDirtyEdgeTolerance;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetFullNeighbourRecomputeInterval(unsigned interval)
+{
+    if (interval == 0)
+    {
+        EXCEPTION("The full neighbour recompute interval must be at least one exchange.");
+    }
+    mFullNeighbourRecomputeInterval = interval;
+}
+
+template<unsigned DIM, class SPECIES>
+unsigned EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetFullNeighbourRecomputeInterval() const
+{
+    return mFullNeighbourRecomputeInterval;
+}
+
+template<unsigned DIM, class SPECIES>
+unsigned EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetNumberOfUpdatedNeighbourMeans() const
+{
+    return mNumberOfUpdatedNeighbourMeans;
+}
+
+
+template<unsigned DIM, class SPECIES>
+bool EdgeSpeciesTrackingModifier<DIM,SPECIES>::IsLocallyOwned(unsigned locationIndex) const
+{
+    return true;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::ReduceDrift(double& rMaxDrift, bool topologyChanged)
+{
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SynchroniseLevels(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    double dt = SimulationTime::Instance()->GetTimeStep();
+
+    if (mUseStrangSplitting)
+    {
+        /*
+         * The edge SRNs were last solved up to the start of this time step, in
+         * UpdateCellPopulation(). Take half a diffusion step, bring the reactions up
+         * to the current time, then take the second half of the diffusion step. The
+         * SRN solve in the next UpdateCellPopulation() then has nothing left to do.
+         */
+        DiffuseEdgeSpecies(rCellPopulation, 0.5*dt);
+        try
+        {
+            SimulateEdgeReactions(rCellPopulation);
+        }
+        catch (Exception&)
+        {
+            DumpFlightRecorder("edge SRN solver failure");
+            throw;
+        }
+        DiffuseEdgeSpecies(rCellPopulation, 0.5*dt);
+    }
+    else
+    {
+        DiffuseEdgeSpecies(rCellPopulation, dt);
+    }
+
+    // Update the cell
+    this->UpdateCellData(rCellPopulation);
+    RecordFlightFrame();
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    // Emptying the stores forces a full exchange at the first UpdateCellData()
+    mExchangedLevels.Clear();
+    mPublishedLevels.Clear();
+    mNeighbourMeans.Clear();
+
+    mpFlightRecorder.reset();
+    if (mFlightRecorderLength > 0)
+    {
+        OutputFileHandler output_file_handler(outputDirectory, false);
+        std::stringstream base_name;
+        base_name << "flight_recorder";
+        if (PetscTools::IsParallel())
+        {
+            base_name << "_" << PetscTools::GetMyRank();
+        }
+        std::vector<std::string> species_names;
+        for (unsigned species = 0; species < NUM_SPECIES; species++)
+        {
+            species_names.push_back(SPECIES::GetName(species));
+        }
+        mpFlightRecorder.reset(new EdgeStateFlightRecorder(species_names, mFlightRecorderLength,
+                                                           output_file_handler.GetOutputDirectoryFullPath(),
+                                                           base_name.str(), mFlightRecorderNegativeTolerance));
+        mpFlightRecorder->SetDumpOnSignal(mDumpFlightRecorderOnSignal);
+    }
+
+    /*
+     * We must update CellData in SetupSolve(), otherwise it will not have been
+     * fully initialised by the time we enter the main time loop.
+     */
+    UpdateCellData(rCellPopulation);
+    RecordFlightFrame();
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpFlightRecorder)
+    {
+        mpFlightRecorder->SetDumpOnSignal(false);
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::DiffuseAroundRing(std::vector<double>& rLevels,
+                                                                 double diffusionCoefficient,
+                                                                 double dt,
+                                                                 bool useSecondOrderScheme)
+{
+    std::vector<double> workspace;
+    DiffuseAroundRing(rLevels, diffusionCoefficient, dt, useSecondOrderScheme, workspace);
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::DiffuseAroundRing(std::vector<double>& rLevels,
+                                                                 double diffusionCoefficient,
+                                                                 double dt,
+                                                                 bool useSecondOrderScheme,
+                                                                 std::vector<double>& rWorkspace)
+{
+    ///\todo consider validity of diffusive flux expression
+    const unsigned num_edges = rLevels.size();
+
+    // The flux into each edge, followed by the levels predicted by Heun's method
+    rWorkspace.resize(2*num_edges);
+    double* flux = rWorkspace.data();
+    double* predicted = flux + num_edges;
+    for (unsigned edge_index = 0; edge_index < num_edges; ++edge_index)
+    {
+        unsigned prev_index = (edge_index == 0) ? num_edges - 1 : edge_index - 1;
+        unsigned next_index = (edge_index == num_edges - 1) ? 0 : edge_index + 1;
+        flux[edge_index] = diffusionCoefficient*(rLevels[prev_index] - 2.0*rLevels[edge_index] + rLevels[next_index]);
+    }
+
+    if (!useSecondOrderScheme)
+    {
+        // Explicit Euler
+        for (unsigned edge_index = 0; edge_index < num_edges; ++edge_index)
+        {
+            rLevels[edge_index] += flux[edge_index]*dt;
+        }
+    }
+    else
+    {
+        // Heun's method (explicit trapezoidal rule)
+        for (unsigned edge_index = 0; edge_index < num_edges; ++edge_index)
+        {
+            predicted[edge_index] = rLevels[edge_index] + flux[edge_index]*dt;
+        }
+        for (unsigned edge_index = 0; edge_index < num_edges; ++edge_index)
+        {
+            unsigned prev_index = (edge_index == 0) ? num_edges - 1 : edge_index - 1;
+            unsigned next_index = (edge_index == num_edges - 1) ? 0 : edge_index + 1;
+            double predicted_flux = diffusionCoefficient*(predicted[prev_index] - 2.0*predicted[edge_index] + predicted[next_index]);
+            rLevels[edge_index] += 0.5*(flux[edge_index] + predicted_flux)*dt;
+        }
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::DiffuseCellEdgeSpecies(CellPtr pCell, double dt)
+{
+    assert(dynamic_cast<CellSrnModel*>(pCell->GetSrnModel()));
+    auto p_cell_srn = static_cast<CellSrnModel*>(pCell->GetSrnModel());
+    unsigned num_edges = p_cell_srn->GetNumEdgeSrn();
+
+    std::vector<Levels>& edge_levels = mScratchCellLevels;
+    edge_levels.resize(num_edges);
+    for (unsigned edge_index = 0 ; edge_index  < num_edges; ++edge_index)
+    {
+        auto p_edge_srn = boost::static_pointer_cast<typename SPECIES::SrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+        SPECIES::GetLevels(*p_edge_srn, edge_levels[edge_index]);
+    }
+
+    std::vector<double>& ring_levels = mScratchRingLevels;
+    ring_levels.resize(num_edges);
+    for (unsigned species = 0; species < NUM_SPECIES; species++)
+    {
+        if (SPECIES::IsDiffusing(species))
+        {
+            for (unsigned edge_index = 0 ; edge_index  < num_edges; ++edge_index)
+            {
+                ring_levels[edge_index] = edge_levels[edge_index][species];
+            }
+            DiffuseAroundRing(ring_levels, mDiffusionCoefficient, dt, mUseStrangSplitting, mScratchRingWorkspace);
+            for (unsigned edge_index = 0 ; edge_index  < num_edges; ++edge_index)
+            {
+                edge_levels[edge_index][species] = ring_levels[edge_index];
+            }
+        }
+    }
+
+    for (unsigned edge_index = 0 ; edge_index  < num_edges; ++edge_index)
+    {
+        auto p_edge_srn = boost::static_pointer_cast<typename SPECIES::SrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+        SPECIES::SetLevels(*p_edge_srn, edge_levels[edge_index]);
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::DiffuseEdgeSpecies(AbstractCellPopulation<DIM,DIM>& rCellPopulation, double dt)
+{
+    /*
+     * Update the diffusing species based on a linear diffusive flux between
+     * neighbouring edges. A second order scheme is used within Strang splitting,
+     * so as not to spoil its order of accuracy.
+     */
+    bool any_diffusing = false;
+    for (unsigned species = 0; species < NUM_SPECIES; species++)
+    {
+        any_diffusing = any_diffusing || SPECIES::IsDiffusing(species);
+    }
+    if (!any_diffusing)
+    {
+        return;
+    }
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        DiffuseCellEdgeSpecies(*cell_iter, dt);
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SimulateEdgeReactions(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        cell_iter->GetSrnModel()->SimulateToCurrentTime();
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // Recovers each cell's edge levels, and those of its neighbours,
+    // then saves them
+
+    // For ease, store a static cast of the vertex-based cell population
+    assert(dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation));
+    auto p_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+
+    SynchroniseLevels(rCellPopulation);
+
+    /*
+     * While publishing each cell's edge levels, measure how far they have drifted
+     * from the levels last exchanged with neighbours, and fingerprint the topology.
+     */
+    double max_drift = 0.0;
+    std::size_t topology_fingerprint = 0;
+    const bool have_snapshot = !mExchangedLevels.IsEmpty();
+    const unsigned num_previous_edges = mPublishedLevels.GetNumEdges();
+
+    // An item that has just started to be kept must be written for every cell
+    bool kept_items_changed = false;
+    for (unsigned species = 0; species < NUM_SPECIES; species++)
+    {
+        const bool is_kept = mpEdgeDataSchema->IsKept(mEdgeFields[species]);
+        kept_items_changed = kept_items_changed || (is_kept != mEdgeItemIsKept[species]);
+        mEdgeItemIsKept[species] = is_kept;
+    }
+
+    std::vector<double>& species_levels = mScratchEdgeItem;
+    unsigned cell_position = 0;
+    unsigned first_edge = 0;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        assert(dynamic_cast<CellSrnModel*>(cell_iter->GetSrnModel()));
+        auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+        unsigned num_edges = p_cell_srn->GetNumEdgeSrn();
+
+        auto p_element = p_population->GetElementCorrespondingToCell(*cell_iter);
+        const unsigned location_index = p_population->GetLocationIndexUsingCell(*cell_iter);
+        const bool is_owned = IsLocallyOwned(location_index);
+        CombineFingerprint(topology_fingerprint, location_index);
+        CombineFingerprint(topology_fingerprint, num_edges);
+        for (unsigned edge_index = 0; edge_index < num_edges; ++edge_index)
+        {
+            CombineFingerprint(topology_fingerprint, p_element->GetEdge(edge_index)->GetIndex());
+        }
+
+        /*
+         * If this cell published the same edges at the same place last time, the levels it
+         * published are still in mPublishedLevels, so only the items of the species whose
+         * levels have changed need to be written again.
+         */
+        const bool is_cached = cell_position < mCellsInOrder.size() && mCellsInOrder[cell_position] == *cell_iter;
+        const bool was_published = is_cached
+                                   && !kept_items_changed
+                                   && mCellFirstEdge[cell_position] == first_edge
+                                   && mCellFirstEdge[cell_position + 1] == first_edge + num_edges
+                                   && first_edge + num_edges <= num_previous_edges;
+        std::array<bool, NUM_SPECIES> item_is_stale;
+        item_is_stale.fill(!was_published);
+
+        if (mPublishedLevels.GetNumEdges() < first_edge + num_edges)
+        {
+            mPublishedLevels.Resize(first_edge + num_edges);
+        }
+        for (unsigned edge_index = 0 ; edge_index  < num_edges; ++edge_index)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<typename SPECIES::SrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+            Levels levels;
+            SPECIES::GetLevels(*p_edge_srn, levels);
+
+            const unsigned edge = first_edge + edge_index;
+            for (unsigned species = 0; species < NUM_SPECIES; species++)
+            {
+                const double previous_level = mPublishedLevels.Get(edge, species);
+                mPublishedLevels.Set(edge, species, levels[species]);
+                item_is_stale[species] = item_is_stale[species] || (mPublishedLevels.Get(edge, species) != previous_level);
+            }
+            if (is_owned && have_snapshot && edge < mExchangedLevels.GetNumEdges())
+            {
+                for (unsigned species = 0; species < NUM_SPECIES; species++)
+                {
+                    max_drift = std::max(max_drift, fabs(mPublishedLevels.Get(edge, species) - mExchangedLevels.Get(edge, species)));
+                }
+            }
+        }
+
+        // Note: state variables must be in the same order as in the species list. Setting an
+        // item of unchanged length copies into its existing storage.
+        boost::shared_ptr<CellEdgeData> p_data = is_cached ? mCellEdgeData[cell_position] : cell_iter->GetCellEdgeData();
+        cell_position++;
+        species_levels.resize(num_edges);
+        for (unsigned species = 0; species < NUM_SPECIES; species++)
+        {
+            if (!mEdgeItemIsKept[species] || !item_is_stale[species])
+            {
+                continue;
+            }
+            for (unsigned edge_index = 0 ; edge_index  < num_edges; ++edge_index)
+            {
+                species_levels[edge_index] = mPublishedLevels.Get(first_edge + edge_index, species);
+            }
+            p_data->SetItem(mEdgeItemNames[species], species_levels);
+        }
+        first_edge += num_edges;
+    }
+    mPublishedLevels.Resize(first_edge);
+
+    /*
+     * Decide whether to exchange levels with neighbours at this step. An exchange is
+     * forced at the first call, after any change of topology, and whenever the
+     * published levels have drifted by more than the tolerance; otherwise it happens
+     * every mNeighbourExchangeInterval steps. The interval grows while the drift
+     * between exchanges stays below half the tolerance, and shrinks when the
+     * tolerance is exceeded.
+     */
+    mStepsSinceNeighbourExchange++;
+    bool exchange = false;
+    const bool topology_changed = !have_snapshot
+                                  || topology_fingerprint != mTopologyFingerprint
+                                  || mPublishedLevels.GetNumEdges() != mExchangedLevels.GetNumEdges();
+    ReduceDrift(max_drift, topology_changed);
+    if (topology_changed)
+    {
+        exchange = true;
+        mNeighbourExchangeInterval = 1;
+    }
+    else if (max_drift > mNeighbourExchangeTolerance)
+    {
+        exchange = true;
+        mNeighbourExchangeInterval = std::max(1u, mNeighbourExchangeInterval/2);
+    }
+    else if (mStepsSinceNeighbourExchange >= mNeighbourExchangeInterval)
+    {
+        exchange = true;
+        if (max_drift < 0.5*mNeighbourExchangeTolerance)
+        {
+            mNeighbourExchangeInterval = std::min(mMaxNeighbourExchangeInterval, 2*mNeighbourExchangeInterval);
+        }
+    }
+
+    if (exchange)
+    {
+        ExchangeNeighbourLevels(rCellPopulation, topology_changed);
+
+        mTopologyFingerprint = topology_fingerprint;
+        mStepsSinceNeighbourExchange = 0;
+        mNumberOfNeighbourExchanges++;
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::CombineFingerprint(std::size_t& rFingerprint, std::size_t value)
+{
+    rFingerprint ^= value + 0x9e3779b9 + (rFingerprint << 6) + (rFingerprint >> 2);
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::CacheEdgeNeighbours(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    auto p_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+
+    // Number the edges of every cell consecutively, in cell iteration order
+    mCellsInOrder.clear();
+    mCellEdgeData.clear();
+    mCellFirstEdge.assign(1, 0);
+    mEdgeCell.clear();
+    std::map<unsigned, unsigned> location_to_position;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+        unsigned num_edges = p_cell_srn->GetNumEdgeSrn();
+
+        location_to_position[p_population->GetLocationIndexUsingCell(*cell_iter)] = mCellsInOrder.size();
+        mEdgeCell.insert(mEdgeCell.end(), num_edges, mCellsInOrder.size());
+        mCellsInOrder.push_back(*cell_iter);
+        mCellEdgeData.push_back(cell_iter->GetCellEdgeData());
+        mCellFirstEdge.push_back(mCellFirstEdge.back() + num_edges);
+    }
+
+    const unsigned num_edges_total = mCellFirstEdge.back();
+    mNeighbourEdges.assign(num_edges_total, std::vector<unsigned>());
+    mDependentEdges.assign(num_edges_total, std::vector<unsigned>());
+    for (unsigned cell_position = 0; cell_position < mCellsInOrder.size(); cell_position++)
+    {
+        const unsigned first_edge = mCellFirstEdge[cell_position];
+        const unsigned num_edges = mCellFirstEdge[cell_position + 1] - first_edge;
+        for (unsigned edge_index = 0; edge_index < num_edges; ++edge_index)
+        {
+            auto elem_neighbours = p_population->GetNeighbouringEdgeIndices(mCellsInOrder[cell_position], edge_index);
+            for (auto neighbour : elem_neighbours)
+            {
+                unsigned neighbour_edge = mCellFirstEdge[location_to_position[neighbour.first]] + neighbour.second;
+                mNeighbourEdges[first_edge + edge_index].push_back(neighbour_edge);
+                mDependentEdges[neighbour_edge].push_back(first_edge + edge_index);
+            }
+        }
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::StoreNeighbourMeans(unsigned cellPosition)
+{
+    const unsigned first_edge = mCellFirstEdge[cellPosition];
+    const unsigned num_edges = mCellFirstEdge[cellPosition + 1] - first_edge;
+
+    const boost::shared_ptr<CellEdgeData>& p_data = mCellEdgeData[cellPosition];
+    std::vector<double>& neigh_means = mScratchEdgeItem;
+    neigh_means.resize(num_edges);
+    for (unsigned species = 0; species < NUM_SPECIES; species++)
+    {
+        if (SPECIES::IsExchanged(species) && mScratchNeighbourItemIsStale[cellPosition*NUM_SPECIES + species])
+        {
+            for (unsigned edge_index = 0; edge_index < num_edges; ++edge_index)
+            {
+                neigh_means[edge_index] = mNeighbourMeans.Get(first_edge + edge_index, species);
+            }
+            p_data->SetItem(mNeighbourItemNames[species], neigh_means);
+        }
+    }
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::ExchangeNeighbourLevels(AbstractCellPopulation<DIM,DIM>& rCellPopulation,
+                                                                        bool topologyChanged)
+{
+    if (topologyChanged || mCellFirstEdge.empty())
+    {
+        CacheEdgeNeighbours(rCellPopulation);
+    }
+    const unsigned num_edges_total = mCellFirstEdge.back();
+    assert(mPublishedLevels.GetNumEdges() == num_edges_total);
+
+    const bool recompute_all = topologyChanged
+                               || !mUseIncrementalNeighbourMeans
+                               || mNeighbourMeans.GetNumEdges() != mPublishedLevels.GetNumEdges()
+                               || mExchangesSinceFullRecompute + 1 >= mFullNeighbourRecomputeInterval;
+    /*
+     * Only the "neighbour" items holding a changed mean are rewritten. After a change of
+     * topology the old means no longer belong to the same edges, so every item is.
+     */
+    std::vector<bool>& item_is_stale = mScratchNeighbourItemIsStale;
+    const bool have_means = !topologyChanged && mNeighbourMeans.GetNumEdges() == num_edges_total;
+    item_is_stale.assign(mCellsInOrder.size()*NUM_SPECIES, !have_means);
+
+    if (recompute_all)
+    {
+        //After the edge data is filled, fill the edge neighbour data, summing in double precision
+        mNeighbourMeans.Resize(num_edges_total);
+        for (unsigned edge = 0; edge < num_edges_total; edge++)
+        {
+            const std::vector<unsigned>& r_neighbours = mNeighbourEdges[edge];
+            Levels means;
+            means.fill(0.0);
+            for (unsigned neighbour_edge : r_neighbours)
+            {
+                for (unsigned species = 0; species < NUM_SPECIES; species++)
+                {
+                    means[species] += mPublishedLevels.Get(neighbour_edge, species) / r_neighbours.size();
+                }
+            }
+            for (unsigned species = 0; species < NUM_SPECIES; species++)
+            {
+                const double previous_mean = mNeighbourMeans.Get(edge, species);
+                mNeighbourMeans.Set(edge, species, means[species]);
+                if (mNeighbourMeans.Get(edge, species) != previous_mean)
+                {
+                    item_is_stale[mEdgeCell[edge]*NUM_SPECIES + species] = true;
+                }
+            }
+        }
+        for (unsigned cell_position = 0; cell_position < mCellsInOrder.size(); cell_position++)
+        {
+            StoreNeighbourMeans(cell_position);
+        }
+
+        mExchangedLevels = mPublishedLevels;
+        mNumberOfUpdatedNeighbourMeans += num_edges_total;
+        mExchangesSinceFullRecompute = 0;
+        return;
+    }
+
+    /*
+     * Otherwise only pass on the change in each edge whose levels have moved by more than
+     * mDirtyEdgeTolerance since they were last used. Edges below the tolerance keep their
+     * old contribution, so their change is passed on once it accumulates beyond it.
+     */
+    for (unsigned edge = 0; edge < num_edges_total; edge++)
+    {
+        double change = 0.0;
+        for (unsigned species = 0; species < NUM_SPECIES; species++)
+        {
+            change = std::max(change, fabs(mPublishedLevels.Get(edge, species) - mExchangedLevels.Get(edge, species)));
+        }
+        if (change <= mDirtyEdgeTolerance)
+        {
+            continue;
+        }
+
+        for (unsigned dependent_edge : mDependentEdges[edge])
+        {
+            const double num_neighbours = mNeighbourEdges[dependent_edge].size();
+            for (unsigned species = 0; species < NUM_SPECIES; species++)
+            {
+                const double increment = (mPublishedLevels.Get(edge, species) - mExchangedLevels.Get(edge, species)) / num_neighbours;
+                if (increment != 0.0)
+                {
+                    mNeighbourMeans.Add(dependent_edge, species, increment);
+                    item_is_stale[mEdgeCell[dependent_edge]*NUM_SPECIES + species] = true;
+                }
+            }
+            mNumberOfUpdatedNeighbourMeans++;
+        }
+        mExchangedLevels.CopyEdge(edge, mPublishedLevels);
+    }
+
+    for (unsigned cell_position = 0; cell_position < mCellsInOrder.size(); cell_position++)
+    {
+        StoreNeighbourMeans(cell_position);
+    }
+    mExchangesSinceFullRecompute++;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::RecordFlightFrame()
+{
+    if (!mpFlightRecorder || mPublishedLevels.IsEmpty())
+    {
+        return;
+    }
+
+    // After UpdateCellData() the edges are numbered as at the last exchange
+    assert(mCellFirstEdge.back() == mPublishedLevels.GetNumEdges());
+    mFlightRecorderCellIds.resize(mCellsInOrder.size());
+    for (unsigned cell_position = 0; cell_position < mCellsInOrder.size(); cell_position++)
+    {
+        mFlightRecorderCellIds[cell_position] = mCellsInOrder[cell_position]->GetCellId();
+    }
+
+    const double* p_neighbour_means = (mNeighbourMeans.GetNumEdges() == mPublishedLevels.GetNumEdges())
+                                      ? mNeighbourMeans.GetLevels() : nullptr;
+    mpFlightRecorder->Record(SimulationTime::Instance()->GetTime(),
+                             SimulationTime::Instance()->GetTimeStepsElapsed(),
+                             mFlightRecorderCellIds,
+                             mCellFirstEdge,
+                             mPublishedLevels.GetLevels(),
+                             p_neighbour_means);
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetFlightRecorderLength(unsigned length)
+{
+    mFlightRecorderLength = length;
+}
+
+template<unsigned DIM, class SPECIES>
+unsigned EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetFlightRecorderLength() const
+{
+    return mFlightRecorderLength;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetDumpFlightRecorderOnSignal(bool dumpOnSignal)
+{
+    mDumpFlightRecorderOnSignal = dumpOnSignal;
+}
+
+template<unsigned DIM, class SPECIES>
+bool EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetDumpFlightRecorderOnSignal() const
+{
+    return mDumpFlightRecorderOnSignal;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::SetFlightRecorderNegativeTolerance(double tolerance)
+{
+    if (tolerance < 0.0)
+    {
+        EXCEPTION("The flight recorder's negative level tolerance must be non-negative.");
+    }
+    mFlightRecorderNegativeTolerance = tolerance;
+}
+
+template<unsigned DIM, class SPECIES>
+double EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetFlightRecorderNegativeTolerance() const
+{
+    return mFlightRecorderNegativeTolerance;
+}
+
+template<unsigned DIM, class SPECIES>
+boost::shared_ptr<EdgeStateFlightRecorder> EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetFlightRecorder() const
+{
+    return mpFlightRecorder;
+}
+
+template<unsigned DIM, class SPECIES>
+std::string EdgeSpeciesTrackingModifier<DIM,SPECIES>::DumpFlightRecorder(const std::string& rReason)
+{
+    if (!mpFlightRecorder)
+    {
+        return "";
+    }
+    return mpFlightRecorder->Dump(rReason);
+}
+
+template<unsigned DIM, class SPECIES>
+boost::shared_ptr<EdgeDataSchema> EdgeSpeciesTrackingModifier<DIM,SPECIES>::GetEdgeDataSchema() const
+{
+    return mpEdgeDataSchema;
+}
+
+template<unsigned DIM, class SPECIES>
+void EdgeSpeciesTrackingModifier<DIM,SPECIES>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<DiffusionCoefficient>" << mDiffusionCoefficient << "</DiffusionCoefficient>\n";
+    *rParamsFile << "\t\t\t<UseStrangSplitting>" << mUseStrangSplitting << "</UseStrangSplitting>\n";
+    *rParamsFile << "\t\t\t<MaxNeighbourExchangeInterval>" << mMaxNeighbourExchangeInterval << "</MaxNeighbourExchangeInterval>\n";
+    *rParamsFile << "\t\t\t<NeighbourExchangeTolerance>" << mNeighbourExchangeTolerance << "</NeighbourExchangeTolerance>\n";
+    *rParamsFile << "\t\t\t<UseIncrementalNeighbourMeans>" << mUseIncrementalNeighbourMeans << "</UseIncrementalNeighbourMeans>\n";
+    *rParamsFile << "\t\t\t<DirtyEdgeTolerance>" << mDirtyEdgeTolerance << "</DirtyEdgeTolerance>\n";
+    *rParamsFile << "\t\t\t<FullNeighbourRecomputeInterval>" << mFullNeighbourRecomputeInterval << "</FullNeighbourRecomputeInterval>\n";
+    *rParamsFile << "\t\t\t<FlightRecorderLength>" << mFlightRecorderLength << "</FlightRecorderLength>\n";
+    *rParamsFile << "\t\t\t<DumpFlightRecorderOnSignal>" << mDumpFlightRecorderOnSignal << "</DumpFlightRecorderOnSignal>\n";
+    *rParamsFile << "\t\t\t<FlightRecorderNegativeTolerance>" << mFlightRecorderNegativeTolerance << "</FlightRecorderNegativeTolerance>\n";
+    *rParamsFile << "\t\t\t<KeptEdgeDataFields>";
+    const std::vector<std::string> kept_fields = mpEdgeDataSchema->GetKeptFields();
+    for (unsigned i = 0; i < kept_fields.size(); i++)
+    {
+        *rParamsFile << (i == 0 ? "" : ",") << kept_fields[i];
+    }
+    *rParamsFile << "</KeptEdgeDataFields>\n";
+    *rParamsFile << "\t\t\t<WrittenEdgeDataFields>";
+    const std::vector<std::string> written_fields = mpEdgeDataSchema->GetWrittenFields();
+    for (unsigned i = 0; i < written_fields.size(); i++)
+    {
+        *rParamsFile << (i == 0 ? "" : ",") << written_fields[i];
+    }
+    *rParamsFile << "</WrittenEdgeDataFields>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+#endif /*EDGESPECIESTRACKINGMODIFIERIMPL_HPP_*/
@@ -0,0 +1,236 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "EdgeStateFlightRecorder.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "Exception.hpp"
+
+volatile std::sig_atomic_t EdgeStateFlightRecorder::msDumpRequested = 0;
+
+void EdgeStateFlightRecorder::HandleSignal(int signalNumber)
+{
+    msDumpRequested = 1;
+}
+
+EdgeStateFlightRecorder::EdgeStateFlightRecorder(const std::vector<std::string>& rSpeciesNames,
+                                                 unsigned length,
+                                                 const std::string& rDirectory,
+                                                 const std::string& rBaseName,
+                                                 double negativeLevelTolerance)
+    : mSpeciesNames(rSpeciesNames),
+      mFrames(length),
+      mNextFrame(0),
+      mNumFramesHeld(0),
+      mNegativeLevelTolerance(negativeLevelTolerance),
+      mHasDumpedBadLevel(false),
+      mNumberOfDumps(0),
+      mDirectory(rDirectory),
+      mBaseName(rBaseName),
+      mDumpOnSignal(false),
+      mpPreviousSignalHandler(SIG_DFL)
+{
+    if (length == 0)
+    {
+        EXCEPTION("A flight recorder must hold at least one time step.");
+    }
+    if (!mDirectory.empty() && mDirectory[mDirectory.size() - 1] != '/')
+    {
+        mDirectory += "/";
+    }
+}
+
+EdgeStateFlightRecorder::~EdgeStateFlightRecorder()
+{
+    SetDumpOnSignal(false);
+}
+
+void EdgeStateFlightRecorder::SetDumpOnSignal(bool dumpOnSignal)
+{
+    if (dumpOnSignal == mDumpOnSignal)
+    {
+        return;
+    }
+    if (dumpOnSignal)
+    {
+        msDumpRequested = 0;
+        mpPreviousSignalHandler = std::signal(SIGUSR1, &EdgeStateFlightRecorder::HandleSignal);
+        if (mpPreviousSignalHandler == SIG_ERR)
+        {
+            mpPreviousSignalHandler = SIG_DFL;
+            EXCEPTION("Could not install the flight recorder's SIGUSR1 handler.");
+        }
+    }
+    else
+    {
+        std::signal(SIGUSR1, mpPreviousSignalHandler);
+    }
+    mDumpOnSignal = dumpOnSignal;
+}
+
+void EdgeStateFlightRecorder::Record(double time,
+                                     unsigned timeStep,
+                                     const std::vector<unsigned>& rCellIds,
+                                     const std::vector<unsigned>& rCellFirstEdge,
+                                     const double* pLevels,
+                                     const double* pNeighbourMeans)
+{
+    assert(rCellFirstEdge.size() == rCellIds.size() + 1);
+    const unsigned num_values = rCellFirstEdge.back()*mSpeciesNames.size();
+
+    // Copy into the oldest frame, reusing its memory
+    EdgeStateFrame& r_frame = mFrames[mNextFrame];
+    r_frame.mTime = time;
+    r_frame.mTimeStep = timeStep;
+    r_frame.mCellIds.assign(rCellIds.begin(), rCellIds.end());
+    r_frame.mCellFirstEdge.assign(rCellFirstEdge.begin(), rCellFirstEdge.end());
+    r_frame.mLevels.assign(pLevels, pLevels + num_values);
+    if (pNeighbourMeans)
+    {
+        r_frame.mNeighbourMeans.assign(pNeighbourMeans, pNeighbourMeans + num_values);
+    }
+    else
+    {
+        r_frame.mNeighbourMeans.assign(num_values, 0.0);
+    }
+
+    mNextFrame = (mNextFrame + 1) % mFrames.size();
+    if (mNumFramesHeld < mFrames.size())
+    {
+        mNumFramesHeld++;
+    }
+
+    // Check the levels just recorded
+    if (!mHasDumpedBadLevel)
+    {
+        for (unsigned i = 0; i < num_values; i++)
+        {
+            const double level = r_frame.mLevels[i];
+            if (!std::isfinite(level) || level < -mNegativeLevelTolerance)
+            {
+                const unsigned species = i % mSpeciesNames.size();
+                const unsigned edge = i / mSpeciesNames.size();
+                std::stringstream reason;
+                reason << (std::isfinite(level) ? "negative" : "non-finite") << " level " << level
+                       << " of " << mSpeciesNames[species] << " on edge " << edge << " at time " << time;
+                mHasDumpedBadLevel = true;
+                Dump(reason.str());
+                break;
+            }
+        }
+    }
+
+    if (msDumpRequested)
+    {
+        msDumpRequested = 0;
+        Dump("SIGUSR1 received");
+    }
+}
+
+std::string EdgeStateFlightRecorder::Dump(const std::string& rReason)
+{
+    std::stringstream path;
+    path << mDirectory << mBaseName << "_" << mNumberOfDumps << ".dat";
+    std::ofstream file(path.str().c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not write the flight recorder dump " << path.str() << ".");
+    }
+    file.precision(17);
+
+    file << "# Flight recorder dump: " << rReason << "\n";
+    file << "# time time_step cell_id edge";
+    for (const std::string& r_name : mSpeciesNames)
+    {
+        file << " " << r_name;
+    }
+    for (const std::string& r_name : mSpeciesNames)
+    {
+        file << " neighbour_" << r_name;
+    }
+    file << "\n";
+
+    const unsigned num_species = mSpeciesNames.size();
+    for (unsigned age = mNumFramesHeld; age-- > 0; )
+    {
+        const EdgeStateFrame& r_frame = rGetFrame(age);
+        for (unsigned cell = 0; cell < r_frame.mCellIds.size(); cell++)
+        {
+            for (unsigned edge = r_frame.mCellFirstEdge[cell]; edge < r_frame.mCellFirstEdge[cell + 1]; edge++)
+            {
+                file << r_frame.mTime << " " << r_frame.mTimeStep << " " << r_frame.mCellIds[cell]
+                     << " " << edge - r_frame.mCellFirstEdge[cell];
+                for (unsigned species = 0; species < num_species; species++)
+                {
+                    file << " " << r_frame.mLevels[edge*num_species + species];
+                }
+                for (unsigned species = 0; species < num_species; species++)
+                {
+                    file << " " << r_frame.mNeighbourMeans[edge*num_species + species];
+                }
+                file << "\n";
+            }
+        }
+    }
+    file.close();
+
+    mNumberOfDumps++;
+    return path.str();
+}
+
+unsigned EdgeStateFlightRecorder::GetLength() const
+{
+    return mFrames.size();
+}
+
+unsigned EdgeStateFlightRecorder::GetNumFramesHeld() const
+{
+    return mNumFramesHeld;
+}
+
+const EdgeStateFrame& EdgeStateFlightRecorder::rGetFrame(unsigned age) const
+{
+    assert(age < mNumFramesHeld);
+    return mFrames[(mNextFrame + mFrames.size() - 1 - age) % mFrames.size()];
+}
+
+unsigned EdgeStateFlightRecorder::GetNumberOfDumps() const
+{
+    return mNumberOfDumps;
+}
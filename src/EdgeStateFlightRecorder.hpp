@@ -0,0 +1,206 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef EDGESTATEFLIGHTRECORDER_HPP_
+#define EDGESTATEFLIGHTRECORDER_HPP_
+
+#include <csignal>
+#include <string>
+#include <vector>
+
+/**
+ * The edge levels and neighbour means of every edge at one time step, as recorded by
+ * EdgeStateFlightRecorder. Edges are numbered cell by cell.
+ */
+struct EdgeStateFrame
+{
+    /** The simulation time of the frame. */
+    double mTime;
+
+    /** The number of time steps elapsed. */
+    unsigned mTimeStep;
+
+    /** The id of each cell. */
+    std::vector<unsigned> mCellIds;
+
+    /** The number of the first edge of each cell, followed by the total number of edges. */
+    std::vector<unsigned> mCellFirstEdge;
+
+    /** The level of each species on each edge, packed edge by edge. */
+    std::vector<double> mLevels;
+
+    /** The mean level of each species in the neighbouring edges of each edge, packed as mLevels. */
+    std::vector<double> mNeighbourMeans;
+};
+
+/**
+ * A flight recorder for debugging rare blow-ups of edge SRN simulations: a ring buffer
+ * holding the packed edge levels and neighbour means of the last few time steps, which is
+ * only written to disk when something goes wrong.
+ *
+ * Recording a frame copies into the memory of the oldest frame, so once the buffer has
+ * filled no memory is allocated unless the tissue grows. A dump, to
+ * <base name>_<dump number>.dat in the output directory, holds the frames from oldest
+ * to newest. Dumps are made:
+ *  - when a recorded level is not finite, or is below minus the negative level tolerance
+ *    (once per recorder, since a blow-up usually persists);
+ *  - at the next recorded frame after the process receives SIGUSR1, if enabled;
+ *  - on request, by calling Dump(), for example when an SRN solver has thrown.
+ */
+class EdgeStateFlightRecorder
+{
+private:
+
+    /** The names of the species. */
+    std::vector<std::string> mSpeciesNames;
+
+    /** The frames, used as a ring buffer. */
+    std::vector<EdgeStateFrame> mFrames;
+
+    /** The index of the frame to record next. */
+    unsigned mNextFrame;
+
+    /** The number of frames held, at most the length of the recorder. */
+    unsigned mNumFramesHeld;
+
+    /** The largest amount by which a level may fall below zero without triggering a dump. */
+    double mNegativeLevelTolerance;
+
+    /** Whether a dump has been triggered by a bad level. */
+    bool mHasDumpedBadLevel;
+
+    /** The number of dumps so far. */
+    unsigned mNumberOfDumps;
+
+    /** The directory dumps are written to, ending in a slash. */
+    std::string mDirectory;
+
+    /** The base name of the dump files. */
+    std::string mBaseName;
+
+    /** Whether this recorder has installed the SIGUSR1 handler. */
+    bool mDumpOnSignal;
+
+    /** The SIGUSR1 handler replaced by this recorder's. */
+    void (*mpPreviousSignalHandler)(int);
+
+    /** Set by the SIGUSR1 handler, and cleared when the dump is made. */
+    static volatile std::sig_atomic_t msDumpRequested;
+
+    /**
+     * The SIGUSR1 handler, which only requests a dump.
+     *
+     * @param signalNumber the signal number
+     */
+    static void HandleSignal(int signalNumber);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rSpeciesNames the names of the species
+     * @param length the number of time steps held
+     * @param rDirectory the directory dumps are written to
+     * @param rBaseName the base name of the dump files
+     * @param negativeLevelTolerance the largest amount by which a level may fall below zero without triggering a dump
+     */
+    EdgeStateFlightRecorder(const std::vector<std::string>& rSpeciesNames,
+                            unsigned length,
+                            const std::string& rDirectory,
+                            const std::string& rBaseName,
+                            double negativeLevelTolerance=1e-8);
+
+    /**
+     * Destructor. Restores the SIGUSR1 handler, if this recorder replaced it.
+     */
+    ~EdgeStateFlightRecorder();
+
+    /**
+     * Set whether receiving SIGUSR1 triggers a dump, installing or removing the handler.
+     *
+     * @param dumpOnSignal whether to dump on SIGUSR1
+     */
+    void SetDumpOnSignal(bool dumpOnSignal);
+
+    /**
+     * Record the state of one time step, replacing the oldest frame once the recorder is
+     * full, then dump if a level is bad or a dump has been requested by a signal.
+     *
+     * @param time the simulation time
+     * @param timeStep the number of time steps elapsed
+     * @param rCellIds the id of each cell
+     * @param rCellFirstEdge the number of the first edge of each cell, followed by the total number of edges
+     * @param pLevels the level of each species on each edge, packed edge by edge
+     * @param pNeighbourMeans the neighbour means, packed as pLevels, or NULL if there are none yet
+     */
+    void Record(double time,
+                unsigned timeStep,
+                const std::vector<unsigned>& rCellIds,
+                const std::vector<unsigned>& rCellFirstEdge,
+                const double* pLevels,
+                const double* pNeighbourMeans);
+
+    /**
+     * Write the frames held to a new dump file.
+     *
+     * @param rReason why the dump was made, written at the top of the file
+     * @return the path of the dump file
+     */
+    std::string Dump(const std::string& rReason);
+
+    /**
+     * @return the number of time steps held once the recorder is full
+     */
+    unsigned GetLength() const;
+
+    /**
+     * @return the number of frames held
+     */
+    unsigned GetNumFramesHeld() const;
+
+    /**
+     * @param age the age of a frame held, with 0 the most recent
+     * @return the frame
+     */
+    const EdgeStateFrame& rGetFrame(unsigned age) const;
+
+    /**
+     * @return the number of dumps so far
+     */
+    unsigned GetNumberOfDumps() const;
+};
+
+#endif /*EDGESTATEFLIGHTRECORDER_HPP_*/
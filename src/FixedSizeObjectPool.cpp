@@ -0,0 +1,119 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "FixedSizeObjectPool.hpp"
+
+#include <cassert>
+#include <new>
+
+FixedSizeObjectPool::FixedSizeObjectPool(std::size_t objectSize, unsigned objectsPerChunk)
+    : mObjectSize(objectSize),
+      mObjectsPerChunk(objectsPerChunk),
+      mpFreeList(nullptr),
+      mNumUntouchedObjects(0),
+      mNumObjectsInUse(0)
+{
+    assert(mObjectsPerChunk > 0);
+
+    // Each object must be able to hold the free list link, and keep the next one aligned
+    const std::size_t alignment = alignof(std::max_align_t);
+    if (mObjectSize < sizeof(FreeObject))
+    {
+        mObjectSize = sizeof(FreeObject);
+    }
+    mObjectSize = ((mObjectSize + alignment - 1)/alignment)*alignment;
+}
+
+FixedSizeObjectPool::~FixedSizeObjectPool()
+{
+    for (void* p_chunk : mChunks)
+    {
+        ::operator delete(p_chunk);
+    }
+}
+
+void* FixedSizeObjectPool::Allocate()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mNumObjectsInUse++;
+
+    // Reuse the most recently freed object, whose memory is likely to be in cache
+    if (mpFreeList != nullptr)
+    {
+        FreeObject* p_object = mpFreeList;
+        mpFreeList = p_object->mpNext;
+        return p_object;
+    }
+
+    if (mNumUntouchedObjects == 0)
+    {
+        mChunks.push_back(::operator new(mObjectSize*mObjectsPerChunk));
+        mNumUntouchedObjects = mObjectsPerChunk;
+    }
+    char* p_chunk = static_cast<char*>(mChunks.back());
+    return p_chunk + (mObjectsPerChunk - mNumUntouchedObjects--)*mObjectSize;
+}
+
+void FixedSizeObjectPool::Deallocate(void* pObject)
+{
+    if (pObject == nullptr)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    assert(mNumObjectsInUse > 0);
+    mNumObjectsInUse--;
+
+    FreeObject* p_object = static_cast<FreeObject*>(pObject);
+    p_object->mpNext = mpFreeList;
+    mpFreeList = p_object;
+}
+
+std::size_t FixedSizeObjectPool::GetObjectSize() const
+{
+    return mObjectSize;
+}
+
+unsigned FixedSizeObjectPool::GetNumObjectsInUse()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumObjectsInUse;
+}
+
+unsigned FixedSizeObjectPool::GetCapacity()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mChunks.size()*mObjectsPerChunk;
+}
@@ -0,0 +1,137 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef FIXEDSIZEOBJECTPOOL_HPP_
+#define FIXEDSIZEOBJECTPOOL_HPP_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * A pool of memory for objects of one size, from which a class can allocate its
+ * instances by overriding operator new and operator delete.
+ *
+ * Memory is taken from the system in chunks of many objects and never given back
+ * while the pool exists. Freed objects are kept on a free list and handed out again
+ * before a new chunk is taken, so that a tissue that keeps creating and destroying
+ * edges (by division, T1 swaps and edge merges) soon stops allocating at all.
+ *
+ * Allocation and deallocation are guarded by a mutex, since SRN models may be built
+ * on several threads (see PolarityCellsGenerator).
+ */
+class FixedSizeObjectPool
+{
+private:
+
+    /** A freed object, which holds the next free object. */
+    struct FreeObject
+    {
+        /** The next free object, or nullptr. */
+        FreeObject* mpNext;
+    };
+
+    /** The size of the objects, rounded up to keep them aligned. */
+    std::size_t mObjectSize;
+
+    /** The number of objects in each chunk. */
+    unsigned mObjectsPerChunk;
+
+    /** The chunks taken from the system. */
+    std::vector<void*> mChunks;
+
+    /** The most recently freed object, or nullptr. */
+    FreeObject* mpFreeList;
+
+    /** The number of objects not yet handed out from the last chunk. */
+    unsigned mNumUntouchedObjects;
+
+    /** The number of objects handed out and not yet freed. */
+    unsigned mNumObjectsInUse;
+
+    /** Guards the members above. */
+    std::mutex mMutex;
+
+    /** Pools are not copied. */
+    FixedSizeObjectPool(const FixedSizeObjectPool&) = delete;
+
+    /** Pools are not copied. */
+    FixedSizeObjectPool& operator=(const FixedSizeObjectPool&) = delete;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param objectSize the size of the objects
+     * @param objectsPerChunk the number of objects in each chunk taken from the system (defaults to 1024)
+     */
+    FixedSizeObjectPool(std::size_t objectSize, unsigned objectsPerChunk=1024);
+
+    /**
+     * Destructor. Gives the chunks back to the system, so must only be called once
+     * every object has been freed.
+     */
+    ~FixedSizeObjectPool();
+
+    /**
+     * @return memory for one object
+     */
+    void* Allocate();
+
+    /**
+     * Return an object's memory to the pool.
+     *
+     * @param pObject memory from Allocate()
+     */
+    void Deallocate(void* pObject);
+
+    /**
+     * @return the size of the objects, rounded up to keep them aligned
+     */
+    std::size_t GetObjectSize() const;
+
+    /**
+     * @return the number of objects handed out and not yet freed
+     */
+    unsigned GetNumObjectsInUse();
+
+    /**
+     * @return the number of objects the pool can hold without taking another chunk
+     */
+    unsigned GetCapacity();
+};
+
+#endif /*FIXEDSIZEOBJECTPOOL_HPP_*/
@@ -0,0 +1,154 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef FIXEDSIZEOBJECTPOOLALLOCATOR_HPP_
+#define FIXEDSIZEOBJECTPOOLALLOCATOR_HPP_
+
+#include <cstddef>
+#include <new>
+
+#include "FixedSizeObjectPool.hpp"
+
+/**
+ * A standard allocator that takes single objects from a FixedSizeObjectPool, for
+ * containers and shared pointers whose own bookkeeping would otherwise be allocated
+ * one small block at a time (such as the control block of each edge SRN's shared
+ * pointer, see PolarityEdgeSrnModel::Create()).
+ *
+ * Arrays, and objects larger than the pool's objects, are taken from the global
+ * operator new instead. Allocators rebound to another type share the pool.
+ */
+template<class T>
+class FixedSizeObjectPoolAllocator
+{
+private:
+
+    template<class U> friend class FixedSizeObjectPoolAllocator;
+
+    /** The pool; not owned. */
+    FixedSizeObjectPool* mpPool;
+
+    /**
+     * @param numObjects the number of objects
+     * @return whether memory for this many objects is taken from the pool
+     */
+    bool UsesPool(std::size_t numObjects) const
+    {
+        return numObjects == 1 && sizeof(T) <= mpPool->GetObjectSize();
+    }
+
+public:
+
+    /** The type of object allocated. */
+    typedef T value_type;
+
+    /** The same allocator for another type of object. */
+    template<class U>
+    struct rebind
+    {
+        /** The rebound allocator. */
+        typedef FixedSizeObjectPoolAllocator<U> other;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param pPool the pool, which must outlive every object allocated from it
+     */
+    explicit FixedSizeObjectPoolAllocator(FixedSizeObjectPool* pPool)
+        : mpPool(pPool)
+    {
+    }
+
+    /**
+     * Rebinding constructor.
+     *
+     * @param rAllocator an allocator for another type, whose pool is shared
+     */
+    template<class U>
+    FixedSizeObjectPoolAllocator(const FixedSizeObjectPoolAllocator<U>& rAllocator)
+        : mpPool(rAllocator.mpPool)
+    {
+    }
+
+    /**
+     * @param numObjects the number of objects
+     * @return memory for the objects
+     */
+    T* allocate(std::size_t numObjects)
+    {
+        if (UsesPool(numObjects))
+        {
+            return static_cast<T*>(mpPool->Allocate());
+        }
+        return static_cast<T*>(::operator new(numObjects*sizeof(T)));
+    }
+
+    /**
+     * @param pObjects memory from allocate()
+     * @param numObjects the number of objects it was allocated for
+     */
+    void deallocate(T* pObjects, std::size_t numObjects)
+    {
+        if (UsesPool(numObjects))
+        {
+            mpPool->Deallocate(pObjects);
+            return;
+        }
+        ::operator delete(pObjects);
+    }
+
+    /**
+     * @param rAllocator another allocator
+     * @return whether memory from one can be freed by the other
+     */
+    template<class U>
+    bool operator==(const FixedSizeObjectPoolAllocator<U>& rAllocator) const
+    {
+        return mpPool == rAllocator.mpPool;
+    }
+
+    /**
+     * @param rAllocator another allocator
+     * @return whether memory from one cannot be freed by the other
+     */
+    template<class U>
+    bool operator!=(const FixedSizeObjectPoolAllocator<U>& rAllocator) const
+    {
+        return mpPool != rAllocator.mpPool;
+    }
+};
+
+#endif /*FIXEDSIZEOBJECTPOOLALLOCATOR_HPP_*/
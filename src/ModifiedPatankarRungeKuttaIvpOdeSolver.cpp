@@ -0,0 +1,146 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ModifiedPatankarRungeKuttaIvpOdeSolver.hpp"
+
+#include <cfloat>
+
+#include "Exception.hpp"
+
+ModifiedPatankarRungeKuttaIvpOdeSolver::ModifiedPatankarRungeKuttaIvpOdeSolver()
+    : AbstractOneStepIvpOdeSolver()
+{
+}
+
+ModifiedPatankarRungeKuttaIvpOdeSolver::~ModifiedPatankarRungeKuttaIvpOdeSolver()
+{
+}
+
+double ModifiedPatankarRungeKuttaIvpOdeSolver::CalculatePatankarFactor(double timeStep,
+                                                                       const std::vector<double>& rY,
+                                                                       const std::vector<double>& rRates,
+                                                                       const std::vector<double>& rWeights) const
+{
+    bool is_any_species_used_up = false;
+    for (unsigned j = 0; j < rY.size(); j++)
+    {
+        if (rRates[j] < 0.0)
+        {
+            if (rY[j] <= 0.0)
+            {
+                return 0.0;
+            }
+            is_any_species_used_up = true;
+        }
+    }
+    if (!is_any_species_used_up)
+    {
+        return 1.0;
+    }
+
+    double factor = 0.0;
+    for (unsigned iteration = 0; iteration < 100; iteration++)
+    {
+        double product = 1.0;
+        double log_derivative = 0.0;
+        for (unsigned j = 0; j < rY.size(); j++)
+        {
+            if (rRates[j] < 0.0)
+            {
+                const double new_y = rY[j] + timeStep*factor*rRates[j];
+                product *= new_y/rWeights[j];
+                log_derivative += timeStep*rRates[j]/new_y;
+            }
+        }
+
+        // Iterates increase towards the root, so stop once round-off stops them doing so
+        const double next_factor = factor - (product - factor)/(product*log_derivative - 1.0);
+        if (!(next_factor > factor*(1.0 + DBL_EPSILON)))
+        {
+            break;
+        }
+        factor = next_factor;
+    }
+    return factor;
+}
+
+void ModifiedPatankarRungeKuttaIvpOdeSolver::CalculateNextYValue(AbstractOdeSystem* pAbstractOdeSystem,
+                                                                 double timeStep,
+                                                                 double time,
+                                                                 std::vector<double>& rCurrentYValues,
+                                                                 std::vector<double>& rNextYValues)
+{
+    const unsigned num_variables = rCurrentYValues.size();
+    for (unsigned i = 0; i < num_variables; i++)
+    {
+        if (rCurrentYValues[i] < 0.0)
+        {
+            EXCEPTION("ModifiedPatankarRungeKuttaIvpOdeSolver needs non-negative state variables, but variable "
+                      << i << " is " << rCurrentYValues[i] << " at time " << time << ".");
+        }
+    }
+    mRates.resize(num_variables);
+    mStageRates.resize(num_variables);
+    mStageY.resize(num_variables);
+
+    // Modified Patankar-Euler stage
+    pAbstractOdeSystem->EvaluateYDerivatives(time, rCurrentYValues, mRates);
+    const double stage_factor = CalculatePatankarFactor(timeStep, rCurrentYValues, mRates, rCurrentYValues);
+    for (unsigned i = 0; i < num_variables; i++)
+    {
+        mStageY[i] = rCurrentYValues[i] + timeStep*stage_factor*mRates[i];
+    }
+
+    // Second order correction, weighted by the stage values
+    pAbstractOdeSystem->EvaluateYDerivatives(time + timeStep, mStageY, mStageRates);
+    for (unsigned i = 0; i < num_variables; i++)
+    {
+        mRates[i] = 0.5*(mRates[i] + mStageRates[i]);
+    }
+    const double factor = CalculatePatankarFactor(timeStep, rCurrentYValues, mRates, mStageY);
+    if (factor < stage_factor)
+    {
+        rNextYValues = mStageY;
+        return;
+    }
+    for (unsigned i = 0; i < num_variables; i++)
+    {
+        rNextYValues[i] = rCurrentYValues[i] + timeStep*factor*mRates[i];
+    }
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(ModifiedPatankarRungeKuttaIvpOdeSolver)
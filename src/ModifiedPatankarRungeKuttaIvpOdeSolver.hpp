@@ -0,0 +1,155 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MODIFIEDPATANKARRUNGEKUTTAIVPODESOLVER_HPP_
+#define MODIFIEDPATANKARRUNGEKUTTAIVPODESOLVER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <vector>
+
+#include "AbstractOneStepIvpOdeSolver.hpp"
+
+/**
+ * A second order modified Patankar Runge-Kutta solver for reaction networks, which keeps
+ * the state positive and every linear invariant of the network (such as the total amount
+ * of A, of B and of C on a polarity edge) constant to round-off, whatever the time step.
+ *
+ * A Patankar scheme that weights each production and destruction term separately only
+ * conserves quantities that reactions move from one species to another. Complex formation
+ * such as B + BoundA -> BA takes one molecule from each of two species, which no such
+ * split can express without losing total B or total A. This solver therefore follows
+ * Bruggeman et al. (Appl. Numer. Math. 57:36-58, 2007) and scales the whole right-hand
+ * side f of each stage by a single Patankar factor,
+ *
+ *   y*  = y + h p1 f(y),                      p1 = prod_{j: f_j(y) < 0} y*_j/y_j,
+ *   y'  = y + h/2 p2 (f(y) + f(y*)),          p2 = prod_{j: f_j(y) + f_j(y*) < 0} y'_j/y*_j.
+ *
+ * Every species changes by a multiple of the same rate vector, so any linear combination
+ * of the species that the reactions leave unchanged stays unchanged. Each factor is the
+ * root of a scalar equation that is found by Newton's method from below, so it always
+ * leaves the species that are being used up positive. The second factor is close to one
+ * to second order in h, so the scheme is second order accurate.
+ *
+ * At large steps the factors become small whenever some species is nearly used up, which
+ * slows every reaction down to the rate at which that species can be drawn on: the
+ * solution stays positive and conservative but approaches steady state more slowly than
+ * the true one. When the second factor is smaller than the first (for example when a
+ * species absent at the start of the step would be used up by the averaged rate), the
+ * step keeps the first stage, which is first order accurate.
+ *
+ * The state must be non-negative.
+ */
+class ModifiedPatankarRungeKuttaIvpOdeSolver : public AbstractOneStepIvpOdeSolver
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Archive the abstract IVP Solver, never used directly - boost uses this.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractOneStepIvpOdeSolver>(*this);
+    }
+
+    /** Working memory: the right-hand side at the start of the step, then its stage average. */
+    std::vector<double> mRates;
+
+    /** Working memory: the right-hand side at the intermediate stage. */
+    std::vector<double> mStageRates;
+
+    /** Working memory: the intermediate stage. */
+    std::vector<double> mStageY;
+
+    /**
+     * Find the Patankar factor of a stage: the root p > 0 of
+     *
+     *   prod_{j: rRates_j < 0} (rY_j + timeStep p rRates_j)/rWeights_j = p.
+     *
+     * The left-hand side is convex and decreasing until the first of its factors
+     * vanishes, so Newton's method from p = 0 increases towards the root without passing
+     * it, and every factor stays positive.
+     *
+     * @param timeStep the time step
+     * @param rY the state at the start of the step
+     * @param rRates the rate of change of the stage
+     * @param rWeights the Patankar weights
+     * @return the factor, or 0 if a species that is absent at the start of the step would be used up
+     */
+    double CalculatePatankarFactor(double timeStep,
+                                   const std::vector<double>& rY,
+                                   const std::vector<double>& rRates,
+                                   const std::vector<double>& rWeights) const;
+
+protected:
+
+    /**
+     * Calculate the solution to the ODE system at the next timestep.
+     *
+     * @param pAbstractOdeSystem  the ODE system to solve
+     * @param timeStep  dt
+     * @param time  the current time
+     * @param rCurrentYValues  the current (initial condition) solution
+     * @param rNextYValues  the state vector to be filled in
+     */
+    virtual void CalculateNextYValue(AbstractOdeSystem* pAbstractOdeSystem,
+                                     double timeStep,
+                                     double time,
+                                     std::vector<double>& rCurrentYValues,
+                                     std::vector<double>& rNextYValues) override;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    ModifiedPatankarRungeKuttaIvpOdeSolver();
+
+    /**
+     * Destructor.
+     */
+    virtual ~ModifiedPatankarRungeKuttaIvpOdeSolver();
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(ModifiedPatankarRungeKuttaIvpOdeSolver)
+
+#endif /*MODIFIEDPATANKARRUNGEKUTTAIVPODESOLVER_HPP_*/
@@ -0,0 +1,412 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MultirateIvpOdeSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "AbstractReactionNetworkOdeSystem.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+double MultirateIvpOdeSolver::msDefaultRelativeTolerance = 1e-4;
+double MultirateIvpOdeSolver::msDefaultAbsoluteTolerance = 1e-6;
+
+MultirateIvpOdeSolver::MultirateIvpOdeSolver()
+    : AbstractIvpOdeSolver(),
+      mRelativeTolerance(msDefaultRelativeTolerance),
+      mAbsoluteTolerance(msDefaultAbsoluteTolerance),
+      mNumberOfRhsEvaluations(0),
+      mNumberOfAcceptedSteps(0),
+      mNumberOfRejectedSteps(0)
+{
+}
+
+MultirateIvpOdeSolver::~MultirateIvpOdeSolver()
+{
+}
+
+void MultirateIvpOdeSolver::SetDefaultTolerances(double relTol, double absTol)
+{
+    if (relTol <= 0.0 || absTol <= 0.0)
+    {
+        EXCEPTION("ODE solver tolerances must be positive.");
+    }
+    msDefaultRelativeTolerance = relTol;
+    msDefaultAbsoluteTolerance = absTol;
+}
+
+void MultirateIvpOdeSolver::SetTolerances(double relTol, double absTol)
+{
+    if (relTol <= 0.0 || absTol <= 0.0)
+    {
+        EXCEPTION("ODE solver tolerances must be positive.");
+    }
+    mRelativeTolerance = relTol;
+    mAbsoluteTolerance = absTol;
+}
+
+unsigned MultirateIvpOdeSolver::GetNumberOfRhsEvaluations() const
+{
+    return mNumberOfRhsEvaluations;
+}
+
+unsigned MultirateIvpOdeSolver::GetNumberOfAcceptedSteps() const
+{
+    return mNumberOfAcceptedSteps;
+}
+
+unsigned MultirateIvpOdeSolver::GetNumberOfRejectedSteps() const
+{
+    return mNumberOfRejectedSteps;
+}
+
+const std::vector<unsigned>& MultirateIvpOdeSolver::rGetLastFastSpecies() const
+{
+    return mLastFastSpecies;
+}
+
+void MultirateIvpOdeSolver::EvaluateWithInterpolatedSlowSpecies(AbstractOdeSystem* pOdeSystem,
+                                                                const std::vector<double>& rYStart,
+                                                                double startTime,
+                                                                double macroStep,
+                                                                double time,
+                                                                std::vector<double>& rY,
+                                                                std::vector<double>& rDY)
+{
+    const double fraction = (time - startTime)/macroStep;
+    for (unsigned i = 0; i < rY.size(); i++)
+    {
+        if (!mIsFast[i])
+        {
+            rY[i] = rYStart[i] + fraction*(mYPredicted[i] - rYStart[i]);
+        }
+    }
+    pOdeSystem->EvaluateYDerivatives(time, rY, rDY);
+    mNumberOfRhsEvaluations++;
+}
+
+void MultirateIvpOdeSolver::InternalSolve(AbstractOdeSystem* pOdeSystem,
+                                          std::vector<double>& rYValues,
+                                          double startTime,
+                                          double endTime,
+                                          double maxTimeStep)
+{
+    const unsigned n = rYValues.size();
+    mIsFast.resize(n);
+    mF0.resize(n);
+    mF1.resize(n);
+    mYPredicted.resize(n);
+    mYFast.resize(n);
+    mYStage.resize(n);
+    mK1.resize(n);
+    mK2.resize(n);
+    mK3.resize(n);
+    mK4.resize(n);
+    mError.resize(n);
+    mFastError.resize(n);
+
+    // RK4 substeps of the fast partition keep h*|J_ii| below this bound
+    const double fast_step_bound = 0.5;
+    const double min_time_step = 1e-12*std::max(1.0, fabs(endTime));
+
+    // Restart from this system's own step size if it has one
+    AbstractReactionNetworkOdeSystem* p_network = dynamic_cast<AbstractReactionNetworkOdeSystem*>(pOdeSystem);
+    double h = maxTimeStep;
+    if (p_network && p_network->GetSuggestedTimeStep() > 0.0)
+    {
+        h = std::min(h, p_network->GetSuggestedTimeStep());
+    }
+
+    double time = startTime;
+    bool at_new_state = true;
+    while (endTime - time > min_time_step)
+    {
+        if (at_new_state)
+        {
+            pOdeSystem->EvaluateYDerivatives(time, rYValues, mF0);
+            mNumberOfRhsEvaluations++;
+            if (p_network)
+            {
+                p_network->EvaluateJacobian(time, rYValues, mJacobian);
+            }
+            else
+            {
+                AbstractReactionNetworkOdeSystem::ApproximateJacobian(*pOdeSystem, time, rYValues, mJacobian);
+            }
+            at_new_state = false;
+        }
+
+        const bool last_step = (h >= endTime - time);
+        const double step = last_step ? endTime - time : h;
+
+        // Partition the species, using the hint if there is one
+        double max_fast_rate = 0.0;
+        mLastFastSpecies.clear();
+        const bool use_hint = p_network && !p_network->rGetFastSpeciesHint().empty();
+        for (unsigned i = 0; i < n; i++)
+        {
+            mIsFast[i] = !use_hint && fabs(mJacobian[i*n + i])*step > 1.0;
+        }
+        if (use_hint)
+        {
+            const std::vector<unsigned>& r_hint = p_network->rGetFastSpeciesHint();
+            for (unsigned k = 0; k < r_hint.size(); k++)
+            {
+                mIsFast[r_hint[k]] = true;
+            }
+        }
+        for (unsigned i = 0; i < n; i++)
+        {
+            if (mIsFast[i])
+            {
+                mLastFastSpecies.push_back(i);
+                max_fast_rate = std::max(max_fast_rate, fabs(mJacobian[i*n + i]));
+            }
+        }
+
+        // Explicit Euler predictor for the slow partition
+        for (unsigned i = 0; i < n; i++)
+        {
+            mYPredicted[i] = mIsFast[i] ? rYValues[i] : rYValues[i] + step*mF0[i];
+        }
+
+        // RK4 substeps for the fast partition, against the interpolated slow partition
+        mYFast = rYValues;
+        std::fill(mFastError.begin(), mFastError.end(), 0.0);
+        double substep = 0.0;
+        if (!mLastFastSpecies.empty())
+        {
+            const unsigned num_substeps = std::max(1u, static_cast<unsigned>(ceil(step*max_fast_rate/fast_step_bound)));
+            substep = step/num_substeps;
+            for (unsigned s = 0; s < num_substeps; s++)
+            {
+                const double t = time + s*substep;
+                mYStage = mYFast;
+                if (s == 0)
+                {
+                    mK1 = mF0;
+                }
+                else
+                {
+                    EvaluateWithInterpolatedSlowSpecies(pOdeSystem, rYValues, time, step, t, mYStage, mK1);
+
+                    // The first stage of this substep completes the embedded estimate of the last one
+                    for (unsigned i = 0; i < n; i++)
+                    {
+                        mFastError[i] += substep*(mK4[i] - mK1[i])/6.0;
+                    }
+                }
+                for (unsigned i = 0; i < n; i++)
+                {
+                    mYStage[i] = mYFast[i] + 0.5*substep*mK1[i];
+                }
+                EvaluateWithInterpolatedSlowSpecies(pOdeSystem, rYValues, time, step, t + 0.5*substep, mYStage, mK2);
+                for (unsigned i = 0; i < n; i++)
+                {
+                    mYStage[i] = mYFast[i] + 0.5*substep*mK2[i];
+                }
+                EvaluateWithInterpolatedSlowSpecies(pOdeSystem, rYValues, time, step, t + 0.5*substep, mYStage, mK3);
+                for (unsigned i = 0; i < n; i++)
+                {
+                    mYStage[i] = mYFast[i] + substep*mK3[i];
+                }
+                EvaluateWithInterpolatedSlowSpecies(pOdeSystem, rYValues, time, step, t + substep, mYStage, mK4);
+                for (unsigned i = 0; i < n; i++)
+                {
+                    if (mIsFast[i])
+                    {
+                        mYFast[i] += substep*(mK1[i] + 2.0*mK2[i] + 2.0*mK3[i] + mK4[i])/6.0;
+                    }
+                }
+            }
+        }
+
+        // Trapezoidal corrector for the slow partition
+        for (unsigned i = 0; i < n; i++)
+        {
+            if (mIsFast[i])
+            {
+                mYPredicted[i] = mYFast[i];
+            }
+        }
+        pOdeSystem->EvaluateYDerivatives(time + step, mYPredicted, mF1);
+        mNumberOfRhsEvaluations++;
+
+        // ...and the corrector evaluation completes that of the last fast substep
+        if (!mLastFastSpecies.empty())
+        {
+            for (unsigned i = 0; i < n; i++)
+            {
+                mFastError[i] += substep*(mK4[i] - mF1[i])/6.0;
+            }
+        }
+
+        for (unsigned i = 0; i < n; i++)
+        {
+            mError[i] = mIsFast[i] ? 0.0 : 0.5*step*(mF1[i] - mF0[i]);
+        }
+
+        // The fast partition also saw the predicted slow values; estimate the effect of their error
+        for (unsigned i = 0; i < n; i++)
+        {
+            if (mIsFast[i])
+            {
+                double coupling = 0.0;
+                for (unsigned j = 0; j < n; j++)
+                {
+                    if (!mIsFast[j])
+                    {
+                        coupling += mJacobian[i*n + j]*mError[j];
+                    }
+                }
+                const double response_time = std::min(0.5*step, 1.0/std::max(fabs(mJacobian[i*n + i]), 1e-300));
+                mError[i] = response_time*coupling + mFastError[i];
+            }
+        }
+
+        double error_norm = 0.0;
+        for (unsigned i = 0; i < n; i++)
+        {
+            const double new_value = mYPredicted[i] + (mIsFast[i] ? 0.0 : mError[i]);
+            const double scale = mAbsoluteTolerance + mRelativeTolerance*std::max(fabs(rYValues[i]), fabs(new_value));
+            error_norm += (mError[i]/scale)*(mError[i]/scale);
+        }
+        error_norm = sqrt(error_norm/n);
+
+        if (error_norm <= 1.0)
+        {
+            for (unsigned i = 0; i < n; i++)
+            {
+                rYValues[i] = mIsFast[i] ? mYFast[i] : mYPredicted[i] + mError[i];
+            }
+            time = last_step ? endTime : time + step;
+            mNumberOfAcceptedSteps++;
+            at_new_state = true;
+
+            double factor = (error_norm > 0.0) ? 0.9/sqrt(error_norm) : 5.0;
+            factor = std::min(5.0, std::max(0.2, factor));
+
+            // A step shortened to land on endTime says little about the step size the system can take
+            if (!last_step || factor < 1.0)
+            {
+                h = std::min(maxTimeStep, (last_step ? h : step)*factor);
+            }
+
+            if (pOdeSystem->CalculateStoppingEvent(time, rYValues))
+            {
+                mStoppingTime = time;
+                mStoppingEventOccurred = true;
+                break;
+            }
+        }
+        else
+        {
+            // Also catches a NaN error norm
+            mNumberOfRejectedSteps++;
+            h = step*((error_norm > 0.0 && error_norm < 25.0) ? 0.9/sqrt(error_norm) : 0.2);
+            if (h < min_time_step)
+            {
+                EXCEPTION("MultirateIvpOdeSolver step size fell below " << min_time_step << " at time " << time << ".");
+            }
+        }
+    }
+
+    if (p_network)
+    {
+        p_network->SetSuggestedTimeStep(h);
+    }
+}
+
+OdeSolution MultirateIvpOdeSolver::Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                                         std::vector<double>& rYValues,
+                                         double startTime,
+                                         double endTime,
+                                         double timeStep,
+                                         double timeSampling)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+    assert(timeSampling >= timeStep);
+
+    mStoppingEventOccurred = false;
+    if (pAbstractOdeSystem->CalculateStoppingEvent(startTime, rYValues))
+    {
+        EXCEPTION("(Solve with sampling) Stopping event is true for initial condition");
+    }
+
+    TimeStepper stepper(startTime, endTime, timeSampling);
+
+    OdeSolution solutions;
+    solutions.SetNumberOfTimeSteps(stepper.EstimateTimeSteps());
+    solutions.rGetSolutions().push_back(rYValues);
+    solutions.rGetTimes().push_back(startTime);
+    solutions.SetOdeSystemInformation(pAbstractOdeSystem->GetSystemInformation());
+
+    while (!stepper.IsTimeAtEnd() && !mStoppingEventOccurred)
+    {
+        InternalSolve(pAbstractOdeSystem, rYValues, stepper.GetTime(), stepper.GetNextTime(), timeStep);
+        stepper.AdvanceOneTimeStep();
+
+        solutions.rGetSolutions().push_back(rYValues);
+        solutions.rGetTimes().push_back(mStoppingEventOccurred ? mStoppingTime : stepper.GetTime());
+    }
+    solutions.SetNumberOfTimeSteps(stepper.GetTotalTimeStepsTaken());
+
+    return solutions;
+}
+
+void MultirateIvpOdeSolver::Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                                  std::vector<double>& rYValues,
+                                  double startTime,
+                                  double endTime,
+                                  double timeStep)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+
+    mStoppingEventOccurred = false;
+    if (pAbstractOdeSystem->CalculateStoppingEvent(startTime, rYValues))
+    {
+        EXCEPTION("(Solve without sampling) Stopping event is true for initial condition");
+    }
+
+    InternalSolve(pAbstractOdeSystem, rYValues, startTime, endTime, timeStep);
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(MultirateIvpOdeSolver)
@@ -0,0 +1,265 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MULTIRATEIVPODESOLVER_HPP_
+#define MULTIRATEIVPODESOLVER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <vector>
+
+#include "AbstractIvpOdeSolver.hpp"
+
+/**
+ * An adaptive multirate solver for reaction networks whose species change on
+ * different timescales.
+ *
+ * At the start of each macro step of size H the state variables are split into a
+ * fast and a slow partition. Unless the system gives a partition through
+ * AbstractReactionNetworkOdeSystem::SetFastSpeciesHint(), species i is fast when
+ * its relaxation time 1/|J_ii| is shorter than H, where J is the Jacobian.
+ *
+ * The slow partition is advanced by Heun's method over the whole macro step: an
+ * explicit Euler predictor, then a trapezoidal corrector. The fast partition is
+ * advanced by RK4 substeps, short enough to resolve the fastest species, with the
+ * slow species linearly interpolated between the start and the predictor. The
+ * difference between predictor and corrector estimates the local error of the slow
+ * partition; its effect on the fast partition is estimated through the coupling
+ * terms of the Jacobian. The truncation error of each RK4 substep is estimated by
+ * the embedded third-order formula with weights (1/6, 1/3, 1/3, 0, 1/6), whose last
+ * stage is the first stage of the next substep (or the corrector evaluation), so it
+ * costs no extra right-hand side evaluations. Together these control the macro step
+ * across the partition, even when every species is fast.
+ *
+ * During long quiescent phases, when no species is fast, this reduces to adaptive
+ * Heun steps of up to the maximum step size, needing two right-hand side
+ * evaluations per step. The time step passed to Solve() is used as the maximum macro
+ * step, and the last proposed step is stored on the system as in RosenbrockWIvpOdeSolver.
+ */
+class MultirateIvpOdeSolver : public AbstractIvpOdeSolver
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Archive the ODE solver and member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractIvpOdeSolver>(*this);
+        archive & mRelativeTolerance;
+        archive & mAbsoluteTolerance;
+    }
+
+    /** Relative tolerance given to newly constructed solvers. */
+    static double msDefaultRelativeTolerance;
+
+    /** Absolute tolerance given to newly constructed solvers. */
+    static double msDefaultAbsoluteTolerance;
+
+    /** Relative tolerance for the local error. */
+    double mRelativeTolerance;
+
+    /** Absolute tolerance for the local error. */
+    double mAbsoluteTolerance;
+
+    /** Number of right-hand side evaluations since construction. */
+    unsigned mNumberOfRhsEvaluations;
+
+    /** Number of accepted macro steps since construction. */
+    unsigned mNumberOfAcceptedSteps;
+
+    /** Number of rejected macro steps since construction. */
+    unsigned mNumberOfRejectedSteps;
+
+    /** The fast species used in the most recent macro step. */
+    std::vector<unsigned> mLastFastSpecies;
+
+    /** Working memory: whether each species is fast in the current macro step. */
+    std::vector<bool> mIsFast;
+
+    /** Working memory: the Jacobian at the start of the macro step. */
+    std::vector<double> mJacobian;
+
+    /** Working memory: right-hand side at the start of the macro step. */
+    std::vector<double> mF0;
+
+    /** Working memory: right-hand side at the end of the macro step. */
+    std::vector<double> mF1;
+
+    /** Working memory: slow predictor, then the full state at the end of the macro step. */
+    std::vector<double> mYPredicted;
+
+    /** Working memory: state during the fast substeps. */
+    std::vector<double> mYFast;
+
+    /** Working memory: RK4 stage state. */
+    std::vector<double> mYStage;
+
+    /** Working memory: RK4 stages. */
+    std::vector<double> mK1, mK2, mK3, mK4;
+
+    /** Working memory: local error estimate. */
+    std::vector<double> mError;
+
+    /** Working memory: truncation error of the fast substeps, summed over the macro step. */
+    std::vector<double> mFastError;
+
+    /**
+     * Evaluate the right-hand side with the slow species replaced by their linear
+     * interpolant over the macro step.
+     *
+     * @param pOdeSystem the ODE system
+     * @param rYStart the state at the start of the macro step
+     * @param startTime the start of the macro step
+     * @param macroStep the length of the macro step
+     * @param time the time at which to evaluate
+     * @param rY the state at which to evaluate; its slow species are overwritten
+     * @param rDY filled in with the derivatives
+     */
+    void EvaluateWithInterpolatedSlowSpecies(AbstractOdeSystem* pOdeSystem,
+                                             const std::vector<double>& rYStart,
+                                             double startTime,
+                                             double macroStep,
+                                             double time,
+                                             std::vector<double>& rY,
+                                             std::vector<double>& rDY);
+
+    /**
+     * Integrate from startTime to endTime, updating rYValues.
+     *
+     * @param pOdeSystem the ODE system
+     * @param rYValues the initial state, overwritten by the final state
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param maxTimeStep the maximum macro step
+     */
+    void InternalSolve(AbstractOdeSystem* pOdeSystem,
+                       std::vector<double>& rYValues,
+                       double startTime,
+                       double endTime,
+                       double maxTimeStep);
+
+public:
+
+    /**
+     * Constructor. The tolerances are those set by SetDefaultTolerances().
+     */
+    MultirateIvpOdeSolver();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MultirateIvpOdeSolver();
+
+    /**
+     * Set the tolerances given to solvers constructed from now on.
+     *
+     * @param relTol the relative tolerance (defaults to 1e-4)
+     * @param absTol the absolute tolerance (defaults to 1e-6)
+     */
+    static void SetDefaultTolerances(double relTol, double absTol);
+
+    /**
+     * Set the tolerances of this solver.
+     *
+     * @param relTol the relative tolerance
+     * @param absTol the absolute tolerance
+     */
+    void SetTolerances(double relTol, double absTol);
+
+    /**
+     * @return the number of right-hand side evaluations made by this solver
+     */
+    unsigned GetNumberOfRhsEvaluations() const;
+
+    /**
+     * @return the number of accepted macro steps taken by this solver
+     */
+    unsigned GetNumberOfAcceptedSteps() const;
+
+    /**
+     * @return the number of rejected macro steps taken by this solver
+     */
+    unsigned GetNumberOfRejectedSteps() const;
+
+    /**
+     * @return the indices of the species treated as fast in the most recent macro step
+     */
+    const std::vector<unsigned>& rGetLastFastSpecies() const;
+
+    /**
+     * Solve the ODE system, returning the solution at the sampling times.
+     *
+     * @param pAbstractOdeSystem the ODE system
+     * @param rYValues the initial state, overwritten by the final state
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param timeStep the maximum macro step
+     * @param timeSampling the interval at which to store the solution
+     * @return the solution
+     */
+    virtual OdeSolution Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                              std::vector<double>& rYValues,
+                              double startTime,
+                              double endTime,
+                              double timeStep,
+                              double timeSampling) override;
+
+    /**
+     * Solve the ODE system, updating rYValues to the final state.
+     *
+     * @param pAbstractOdeSystem the ODE system
+     * @param rYValues the initial state, overwritten by the final state
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param timeStep the maximum macro step
+     */
+    virtual void Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                       std::vector<double>& rYValues,
+                       double startTime,
+                       double endTime,
+                       double timeStep) override;
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(MultirateIvpOdeSolver)
+
+#endif /*MULTIRATEIVPODESOLVER_HPP_*/
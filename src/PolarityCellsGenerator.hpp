@@ -0,0 +1,262 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYCELLSGENERATOR_HPP_
+#define POLARITYCELLSGENERATOR_HPP_
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "Cell.hpp"
+#include "CellSrnModel.hpp"
+#include "Exception.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeReactionNetwork.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityInitialConditionTable.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+/**
+ * Builds the cells of a tissue of polarity edge SRNs in bulk, one cell per element of a
+ * vertex mesh, from a PolarityInitialConditionTable, in the manner of CellsGenerator.
+ *
+ * Rather than consulting PolarityEdgeOdeSolverRegistry for every edge, one solver is
+ * created up front and shared by all the edge SRNs. The SRNs, which touch no shared state
+ * once the solver exists, are built by several threads, each taking a contiguous range of
+ * cells; the cells themselves are then created in order on the calling thread, so that
+ * cell ids are the same however many threads are used.
+ *
+ * Only the construction of the SRN models is threaded. Their ODE systems are created when
+ * the SRNs are initialised, which the cell population does serially for each cell as it
+ * is constructed (see AbstractCellPopulation::InitialiseCells()), so that part of building
+ * a large tissue is not sped up by more threads.
+ */
+template<class CELL_CYCLE_MODEL, unsigned DIM>
+class PolarityCellsGenerator
+{
+private:
+
+    /** The number of threads used to build the SRNs. */
+    unsigned mNumThreads;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param numThreads the number of threads used to build the SRNs (0 for one per hardware thread)
+     */
+    PolarityCellsGenerator(unsigned numThreads=0)
+        : mNumThreads(numThreads)
+    {
+        if (mNumThreads == 0)
+        {
+            mNumThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    /**
+     * @return the number of threads used to build the SRNs
+     */
+    unsigned GetNumThreads() const
+    {
+        return mNumThreads;
+    }
+
+    /**
+     * Fill a vector of cells, one per element of a mesh, with the edge SRNs, initial
+     * conditions and birth times of a table.
+     *
+     * @param rCells an empty vector of cells to fill
+     * @param rMesh the mesh, whose elements must have the numbers of edges of the cells of the table
+     * @param rTable the initial conditions
+     * @param pCellProliferativeType the proliferative type of the cells (defaults to stem)
+     */
+    void GenerateCells(std::vector<CellPtr>& rCells,
+                       MutableVertexMesh<DIM,DIM>& rMesh,
+                       const PolarityInitialConditionTable& rTable,
+                       boost::shared_ptr<AbstractCellProperty> pCellProliferativeType=boost::shared_ptr<AbstractCellProperty>())
+    {
+        const unsigned num_cells = rTable.GetNumCells();
+        const unsigned num_species = PolarityEdgeReactionNetwork::NUM_SPECIES;
+        if (rTable.GetNumSpecies() != num_species)
+        {
+            EXCEPTION("The initial condition table has " << rTable.GetNumSpecies() << " species per edge, not " << num_species << ".");
+        }
+        if (num_cells != rMesh.GetNumElements())
+        {
+            EXCEPTION("The initial condition table has " << num_cells << " cells, but the mesh has " << rMesh.GetNumElements() << " elements.");
+        }
+        for (unsigned cell = 0; cell < num_cells; cell++)
+        {
+            if (rTable.GetNumEdges(cell) != rMesh.GetElement(cell)->GetNumEdges())
+            {
+                EXCEPTION("Cell " << cell << " of the initial condition table has " << rTable.GetNumEdges(cell)
+                          << " edges, but its element has " << rMesh.GetElement(cell)->GetNumEdges() << ".");
+            }
+        }
+
+        // One solver for every edge
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        const std::string& r_solver_name = p_registry->rGetActiveSolver();
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = p_registry->CreateSolver(r_solver_name);
+        const double dt = p_registry->GetDefaultDt(r_solver_name);
+
+        // Build the SRNs of contiguous ranges of cells concurrently, the first range on this thread
+        std::vector<CellSrnModel*> srn_models(num_cells, nullptr);
+        auto build_srn_models = [&](unsigned begin, unsigned end)
+        {
+            for (unsigned cell = begin; cell < end; cell++)
+            {
+                // Owned here until complete, so that it is freed if building an edge throws
+                std::unique_ptr<CellSrnModel> p_cell_srn_model(new CellSrnModel());
+                std::vector<double> initial_conditions(num_species);
+                for (unsigned edge = 0; edge < rTable.GetNumEdges(cell); edge++)
+                {
+                    const double* p_levels = rTable.GetLevels(rTable.GetFirstEdge(cell) + edge);
+                    initial_conditions.assign(p_levels, p_levels + num_species);
+
+                    boost::shared_ptr<PolarityEdgeSrnModel> p_srn_model = PolarityEdgeSrnModel::Create(p_solver);
+                    if (dt > 0.0)
+                    {
+                        p_srn_model->SetDt(dt);
+                    }
+                    p_srn_model->SetInitialConditions(initial_conditions);
+                    p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+                }
+                srn_models[cell] = p_cell_srn_model.release();
+            }
+        };
+
+        const unsigned num_ranges = std::max(1u, std::min(mNumThreads, num_cells));
+        std::vector<std::thread> workers;
+        std::vector<std::exception_ptr> errors(num_ranges);
+        for (unsigned range = 1; range < num_ranges; range++)
+        {
+            const unsigned begin = (std::size_t(num_cells)*range)/num_ranges;
+            const unsigned end = (std::size_t(num_cells)*(range + 1))/num_ranges;
+            auto build_range = [&, begin, end, range]
+            {
+                try
+                {
+                    build_srn_models(begin, end);
+                }
+                catch (...)
+                {
+                    errors[range] = std::current_exception();
+                }
+            };
+            try
+            {
+                workers.emplace_back(build_range);
+            }
+            catch (std::system_error&)
+            {
+                // Out of threads: build the range here instead
+                build_range();
+            }
+        }
+        try
+        {
+            build_srn_models(0, num_cells/num_ranges);
+        }
+        catch (...)
+        {
+            errors[0] = std::current_exception();
+        }
+        for (std::thread& r_worker : workers)
+        {
+            r_worker.join();
+        }
+        for (std::exception_ptr& r_error : errors)
+        {
+            if (r_error)
+            {
+                for (CellSrnModel* p_cell_srn_model : srn_models)
+                {
+                    delete p_cell_srn_model;
+                }
+                std::rethrow_exception(r_error);
+            }
+        }
+
+        // Create the cells in order
+        if (!pCellProliferativeType)
+        {
+            pCellProliferativeType.reset(new StemCellProliferativeType);
+        }
+        boost::shared_ptr<AbstractCellProperty> p_state(new WildTypeCellMutationState);
+        rCells.clear();
+        rCells.reserve(num_cells);
+        for (unsigned cell = 0; cell < num_cells; cell++)
+        {
+            CELL_CYCLE_MODEL* p_cell_cycle_model = new CELL_CYCLE_MODEL;
+            p_cell_cycle_model->SetDimension(DIM);
+
+            CellPtr p_cell(new Cell(p_state, p_cell_cycle_model, srn_models[cell]));
+            p_cell->SetCellProliferativeType(pCellProliferativeType);
+            p_cell->SetBirthTime(rTable.GetBirthTime(cell));
+            rCells.push_back(p_cell);
+        }
+    }
+
+    /**
+     * Build a vertex-based cell population of a mesh, with a cell per element, from a
+     * table of initial conditions.
+     *
+     * @param rMesh the mesh, which must outlive the population
+     * @param rTable the initial conditions
+     * @param pCellProliferativeType the proliferative type of the cells (defaults to stem)
+     * @return the population
+     */
+    boost::shared_ptr<VertexBasedCellPopulation<DIM> > CreateCellPopulation(MutableVertexMesh<DIM,DIM>& rMesh,
+                                                                            const PolarityInitialConditionTable& rTable,
+                                                                            boost::shared_ptr<AbstractCellProperty> pCellProliferativeType=boost::shared_ptr<AbstractCellProperty>())
+    {
+        std::vector<CellPtr> cells;
+        GenerateCells(cells, rMesh, rTable, pCellProliferativeType);
+        return boost::shared_ptr<VertexBasedCellPopulation<DIM> >(new VertexBasedCellPopulation<DIM>(rMesh, cells));
+    }
+};
+
+#endif /*POLARITYCELLSGENERATOR_HPP_*/
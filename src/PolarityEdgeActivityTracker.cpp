@@ -0,0 +1,183 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "PolarityEdgeActivityTracker.hpp"
+
+#include <cmath>
+
+#include "Exception.hpp"
+
+PolarityEdgeActivityTracker* PolarityEdgeActivityTracker::mpInstance = nullptr;
+
+PolarityEdgeActivityTracker::PolarityEdgeActivityTracker()
+    : mIsEnabled(false),
+      mRhsTolerance(1e-6),
+      mInputTolerance(1e-4),
+      mNumberOfSolves(0),
+      mNumberOfSkippedSolves(0),
+      mNumberOfWakeUps(0)
+{
+}
+
+PolarityEdgeActivityTracker* PolarityEdgeActivityTracker::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new PolarityEdgeActivityTracker;
+    }
+    return mpInstance;
+}
+
+void PolarityEdgeActivityTracker::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = nullptr;
+    }
+}
+
+void PolarityEdgeActivityTracker::SetEnabled(bool isEnabled)
+{
+    mIsEnabled = isEnabled;
+}
+
+bool PolarityEdgeActivityTracker::IsEnabled() const
+{
+    return mIsEnabled;
+}
+
+void PolarityEdgeActivityTracker::SetRhsTolerance(double tolerance)
+{
+    if (tolerance <= 0.0)
+    {
+        EXCEPTION("The RHS tolerance for dormant edges must be positive.");
+    }
+    mRhsTolerance = tolerance;
+}
+
+double PolarityEdgeActivityTracker::GetRhsTolerance() const
+{
+    return mRhsTolerance;
+}
+
+void PolarityEdgeActivityTracker::SetInputTolerance(double tolerance)
+{
+    if (tolerance <= 0.0)
+    {
+        EXCEPTION("The input tolerance for dormant edges must be positive.");
+    }
+    mInputTolerance = tolerance;
+}
+
+double PolarityEdgeActivityTracker::GetInputTolerance() const
+{
+    return mInputTolerance;
+}
+
+bool PolarityEdgeActivityTracker::IsQuiescent(const std::vector<double>& rDerivatives) const
+{
+    for (unsigned i = 0; i < rDerivatives.size(); i++)
+    {
+        // Written this way round so that a NaN is never quiescent
+        if (!(fabs(rDerivatives[i]) <= mRhsTolerance))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PolarityEdgeActivityTracker::HasInputChanged(const std::vector<double>& rSnapshot, const std::vector<double>& rCurrent) const
+{
+    if (rSnapshot.size() != rCurrent.size())
+    {
+        return true;
+    }
+    return HasInputChanged(rSnapshot.data(), rCurrent);
+}
+
+bool PolarityEdgeActivityTracker::HasInputChanged(const double* pSnapshot, const std::vector<double>& rCurrent) const
+{
+    for (unsigned i = 0; i < rCurrent.size(); i++)
+    {
+        if (!(fabs(rCurrent[i] - pSnapshot[i]) <= mInputTolerance))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PolarityEdgeActivityTracker::RecordSolve(bool wasSkipped)
+{
+    mNumberOfSolves++;
+    if (wasSkipped)
+    {
+        mNumberOfSkippedSolves++;
+    }
+}
+
+void PolarityEdgeActivityTracker::RecordWakeUp()
+{
+    mNumberOfWakeUps++;
+}
+
+unsigned PolarityEdgeActivityTracker::GetNumberOfSolves() const
+{
+    return mNumberOfSolves;
+}
+
+unsigned PolarityEdgeActivityTracker::GetNumberOfSkippedSolves() const
+{
+    return mNumberOfSkippedSolves;
+}
+
+unsigned PolarityEdgeActivityTracker::GetNumberOfWakeUps() const
+{
+    return mNumberOfWakeUps;
+}
+
+double PolarityEdgeActivityTracker::GetSkippedFraction() const
+{
+    return (mNumberOfSolves == 0) ? 0.0 : static_cast<double>(mNumberOfSkippedSolves)/mNumberOfSolves;
+}
+
+void PolarityEdgeActivityTracker::ResetCounters()
+{
+    mNumberOfSolves = 0;
+    mNumberOfSkippedSolves = 0;
+    mNumberOfWakeUps = 0;
+}
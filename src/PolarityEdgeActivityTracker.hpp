@@ -0,0 +1,185 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYEDGEACTIVITYTRACKER_HPP_
+#define POLARITYEDGEACTIVITYTRACKER_HPP_
+
+#include <vector>
+
+/**
+ * Decides when the ODEs of a PolarityEdgeSrnModel can be skipped, and counts how
+ * much work this saves.
+ *
+ * When enabled, an edge whose right-hand side has fallen below the RHS tolerance
+ * after a solve is marked dormant. A dormant edge is not integrated: its state is at
+ * equilibrium, so advancing it only means moving its simulated-to time on. The edge
+ * is woken, and integrated again, as soon as its own state (which may be changed by
+ * membrane diffusion or edge rearrangements) or its neighbour parameters have moved
+ * further than the input tolerance from their values when it fell dormant.
+ *
+ * Skipping is disabled by default, so that results are unchanged unless it is asked for.
+ */
+class PolarityEdgeActivityTracker
+{
+private:
+
+    /** The single instance of this class. */
+    static PolarityEdgeActivityTracker* mpInstance;
+
+    /** Whether dormant edges are skipped. */
+    bool mIsEnabled;
+
+    /** Largest absolute value of any component of the RHS for an edge to fall dormant. Defaults to 1e-6. */
+    double mRhsTolerance;
+
+    /** Largest change in any state variable or neighbour parameter for an edge to stay dormant. Defaults to 1e-4. */
+    double mInputTolerance;
+
+    /** Number of edge solves over a non-empty interval since the counters were reset. */
+    unsigned mNumberOfSolves;
+
+    /** Number of those solves that were skipped. */
+    unsigned mNumberOfSkippedSolves;
+
+    /** Number of edges woken since the counters were reset. */
+    unsigned mNumberOfWakeUps;
+
+    /**
+     * Private constructor. Use Instance().
+     */
+    PolarityEdgeActivityTracker();
+
+public:
+
+    /**
+     * @return the single instance of the tracker, creating it on first call.
+     */
+    static PolarityEdgeActivityTracker* Instance();
+
+    /**
+     * Destroy the current instance, so that the next call to Instance() creates a new
+     * tracker with the default settings. Should be called at the end of a simulation.
+     */
+    static void Destroy();
+
+    /**
+     * @param isEnabled whether dormant edges should be skipped
+     */
+    void SetEnabled(bool isEnabled);
+
+    /**
+     * @return whether dormant edges are skipped
+     */
+    bool IsEnabled() const;
+
+    /**
+     * @param tolerance the largest absolute value of any component of the RHS for an edge to fall dormant
+     */
+    void SetRhsTolerance(double tolerance);
+
+    /**
+     * @return the RHS tolerance
+     */
+    double GetRhsTolerance() const;
+
+    /**
+     * @param tolerance the largest change in any state variable or neighbour parameter for an edge to stay dormant
+     */
+    void SetInputTolerance(double tolerance);
+
+    /**
+     * @return the input tolerance
+     */
+    double GetInputTolerance() const;
+
+    /**
+     * @param rDerivatives the RHS of an edge after a solve
+     * @return whether the edge is quiescent and can fall dormant
+     */
+    bool IsQuiescent(const std::vector<double>& rDerivatives) const;
+
+    /**
+     * @param rSnapshot values recorded when an edge fell dormant
+     * @param rCurrent the current values
+     * @return whether any value has moved further than the input tolerance
+     */
+    bool HasInputChanged(const std::vector<double>& rSnapshot, const std::vector<double>& rCurrent) const;
+
+    /**
+     * @param pSnapshot values recorded when an edge fell dormant, as many as in rCurrent
+     * @param rCurrent the current values
+     * @return whether any value has moved further than the input tolerance
+     */
+    bool HasInputChanged(const double* pSnapshot, const std::vector<double>& rCurrent) const;
+
+    /**
+     * Record an edge solve.
+     *
+     * @param wasSkipped whether the solve was skipped because the edge was dormant
+     */
+    void RecordSolve(bool wasSkipped);
+
+    /**
+     * Record that a dormant edge has been woken.
+     */
+    void RecordWakeUp();
+
+    /**
+     * @return the number of edge solves over a non-empty interval since the counters were reset
+     */
+    unsigned GetNumberOfSolves() const;
+
+    /**
+     * @return the number of edge solves skipped since the counters were reset
+     */
+    unsigned GetNumberOfSkippedSolves() const;
+
+    /**
+     * @return the number of edges woken since the counters were reset
+     */
+    unsigned GetNumberOfWakeUps() const;
+
+    /**
+     * @return the fraction of edge solves that were skipped, or 0 if there have been none
+     */
+    double GetSkippedFraction() const;
+
+    /**
+     * Reset the counters to zero.
+     */
+    void ResetCounters();
+};
+
+#endif /*POLARITYEDGEACTIVITYTRACKER_HPP_*/
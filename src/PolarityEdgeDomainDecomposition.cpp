@@ -0,0 +1,358 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "PolarityEdgeDomainDecomposition.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+
+#include "CellSrnModel.hpp"
+#include "Exception.hpp"
+#include "PolarityEdgeSpecies.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+/** The number of levels exchanged per edge. */
+static const unsigned NUM_LEVELS_PER_EDGE = PolarityEdgeSpecies::NUM_SPECIES;
+
+template<unsigned DIM>
+PolarityEdgeDomainDecomposition<DIM>::PolarityEdgeDomainDecomposition()
+    : mNumLocalCells(0)
+{
+}
+
+template<unsigned DIM>
+std::vector<unsigned> PolarityEdgeDomainDecomposition<DIM>::PartitionGraph(const std::vector<std::set<unsigned> >& rAdjacency,
+                                                                          unsigned numParts)
+{
+    const unsigned num_vertices = rAdjacency.size();
+    const unsigned unassigned = numParts;
+    std::vector<unsigned> parts(num_vertices, unassigned);
+
+    unsigned next_seed = 0;
+    unsigned num_assigned = 0;
+    for (unsigned part = 0; part < numParts; part++)
+    {
+        // Share the remaining vertices equally between the remaining parts
+        const unsigned target = (num_vertices - num_assigned + (numParts - part) - 1)/(numParts - part);
+        unsigned part_size = 0;
+        std::deque<unsigned> queue;
+        while (part_size < target)
+        {
+            if (queue.empty())
+            {
+                // Start from the lowest numbered unassigned vertex, which also covers disconnected graphs
+                while (parts[next_seed] != unassigned)
+                {
+                    next_seed++;
+                }
+                queue.push_back(next_seed);
+                parts[next_seed] = part;
+                part_size++;
+                continue;
+            }
+
+            const unsigned vertex = queue.front();
+            queue.pop_front();
+            for (unsigned neighbour : rAdjacency[vertex])
+            {
+                if (part_size < target && parts[neighbour] == unassigned)
+                {
+                    parts[neighbour] = part;
+                    part_size++;
+                    queue.push_back(neighbour);
+                }
+            }
+        }
+        num_assigned += part_size;
+    }
+    return parts;
+}
+
+template<unsigned DIM>
+void PolarityEdgeDomainDecomposition<DIM>::Partition(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    assert(dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation));
+    auto p_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+
+    // Number the cells by location index, which is the same on every process
+    std::vector<unsigned> location_indices;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        location_indices.push_back(p_population->GetLocationIndexUsingCell(*cell_iter));
+    }
+    std::sort(location_indices.begin(), location_indices.end());
+    std::map<unsigned, unsigned> vertex_of_location;
+    for (unsigned vertex = 0; vertex < location_indices.size(); vertex++)
+    {
+        vertex_of_location[location_indices[vertex]] = vertex;
+    }
+
+    std::vector<std::set<unsigned> > adjacency(location_indices.size());
+    for (unsigned vertex = 0; vertex < location_indices.size(); vertex++)
+    {
+        for (unsigned neighbour_location : p_population->GetNeighbouringLocationIndices(
+                 p_population->GetCellUsingLocationIndex(location_indices[vertex])))
+        {
+            adjacency[vertex].insert(vertex_of_location[neighbour_location]);
+        }
+    }
+
+    const unsigned my_rank = PetscTools::GetMyRank();
+    std::vector<unsigned> parts = PartitionGraph(adjacency, PetscTools::GetNumProcs());
+
+    mOwners.clear();
+    mIsBoundaryCell.clear();
+    mSendEdges.clear();
+    mReceiveEdges.clear();
+    mNumLocalCells = 0;
+    mCellsOfProcess.assign(PetscTools::GetNumProcs(), std::vector<unsigned>());
+    mGatherCounts.assign(PetscTools::GetNumProcs(), 0);
+    for (unsigned vertex = 0; vertex < location_indices.size(); vertex++)
+    {
+        mOwners[location_indices[vertex]] = parts[vertex];
+        mCellsOfProcess[parts[vertex]].push_back(location_indices[vertex]);
+
+        auto p_cell_srn = static_cast<CellSrnModel*>(p_population->GetCellUsingLocationIndex(location_indices[vertex])->GetSrnModel());
+        mGatherCounts[parts[vertex]] += NUM_LEVELS_PER_EDGE*p_cell_srn->GetNumEdgeSrn();
+    }
+    mGatherDisplacements.assign(PetscTools::GetNumProcs(), 0);
+    for (unsigned process = 1; process < mGatherCounts.size(); process++)
+    {
+        mGatherDisplacements[process] = mGatherDisplacements[process - 1] + mGatherCounts[process - 1];
+    }
+    mGatherBuffer.resize(mGatherDisplacements.back() + mGatherCounts.back());
+
+    // Find the edges to exchange; sets keep both sides of each message in the same order
+    std::map<unsigned, std::set<std::pair<unsigned, unsigned> > > send_edges;
+    std::map<unsigned, std::set<std::pair<unsigned, unsigned> > > receive_edges;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        const unsigned location_index = p_population->GetLocationIndexUsingCell(*cell_iter);
+        const bool is_owned = (mOwners[location_index] == my_rank);
+
+        assert(dynamic_cast<CellSrnModel*>(cell_iter->GetSrnModel()));
+        auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+        for (unsigned edge_index = 0; edge_index < p_cell_srn->GetNumEdgeSrn(); ++edge_index)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+            p_edge_srn->SetIsLocallyOwned(is_owned);
+        }
+        if (!is_owned)
+        {
+            continue;
+        }
+
+        mNumLocalCells++;
+        mIsBoundaryCell[location_index] = false;
+        for (unsigned edge_index = 0; edge_index < p_cell_srn->GetNumEdgeSrn(); ++edge_index)
+        {
+            for (auto neighbour : p_population->GetNeighbouringEdgeIndices(*cell_iter, edge_index))
+            {
+                const unsigned neighbour_owner = mOwners[neighbour.first];
+                if (neighbour_owner != my_rank)
+                {
+                    send_edges[neighbour_owner].insert(std::make_pair(location_index, edge_index));
+                    receive_edges[neighbour_owner].insert(neighbour);
+                    mIsBoundaryCell[location_index] = true;
+                }
+            }
+        }
+    }
+
+    for (auto& r_entry : send_edges)
+    {
+        mSendEdges[r_entry.first].assign(r_entry.second.begin(), r_entry.second.end());
+    }
+    for (auto& r_entry : receive_edges)
+    {
+        mReceiveEdges[r_entry.first].assign(r_entry.second.begin(), r_entry.second.end());
+    }
+}
+
+template<unsigned DIM>
+bool PolarityEdgeDomainDecomposition<DIM>::IsLocallyOwned(unsigned locationIndex) const
+{
+    auto it = mOwners.find(locationIndex);
+    if (it == mOwners.end())
+    {
+        EXCEPTION("Distributed polarity edge networks require a fixed tissue topology.");
+    }
+    return it->second == PetscTools::GetMyRank();
+}
+
+template<unsigned DIM>
+bool PolarityEdgeDomainDecomposition<DIM>::IsBoundaryCell(unsigned locationIndex) const
+{
+    auto it = mIsBoundaryCell.find(locationIndex);
+    return it != mIsBoundaryCell.end() && it->second;
+}
+
+template<unsigned DIM>
+unsigned PolarityEdgeDomainDecomposition<DIM>::GetNumLocalCells() const
+{
+    return mNumLocalCells;
+}
+
+template<unsigned DIM>
+unsigned PolarityEdgeDomainDecomposition<DIM>::GetNumHaloEdges() const
+{
+    unsigned num_edges = 0;
+    for (auto& r_entry : mReceiveEdges)
+    {
+        num_edges += r_entry.second.size();
+    }
+    return num_edges;
+}
+
+template<unsigned DIM>
+void PolarityEdgeDomainDecomposition<DIM>::StartHaloExchange(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    assert(mRequests.empty());
+    const int tag = 2987;
+
+    mReceiveBuffers.resize(mReceiveEdges.size());
+    unsigned buffer_index = 0;
+    for (auto& r_entry : mReceiveEdges)
+    {
+        std::vector<double>& r_buffer = mReceiveBuffers[buffer_index++];
+        r_buffer.resize(NUM_LEVELS_PER_EDGE*r_entry.second.size());
+        mRequests.push_back(MPI_Request());
+        MPI_Irecv(&r_buffer[0], r_buffer.size(), MPI_DOUBLE, r_entry.first, tag, PetscTools::GetWorld(), &mRequests.back());
+    }
+
+    mSendBuffers.resize(mSendEdges.size());
+    buffer_index = 0;
+    for (auto& r_entry : mSendEdges)
+    {
+        std::vector<double>& r_buffer = mSendBuffers[buffer_index++];
+        r_buffer.clear();
+        for (auto edge : r_entry.second)
+        {
+            auto p_cell_srn = static_cast<CellSrnModel*>(rCellPopulation.GetCellUsingLocationIndex(edge.first)->GetSrnModel());
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge.second));
+            std::array<double, NUM_LEVELS_PER_EDGE> levels;
+            PolarityEdgeSpecies::GetLevels(*p_edge_srn, levels);
+            r_buffer.insert(r_buffer.end(), levels.begin(), levels.end());
+        }
+        mRequests.push_back(MPI_Request());
+        MPI_Isend(&r_buffer[0], r_buffer.size(), MPI_DOUBLE, r_entry.first, tag, PetscTools::GetWorld(), &mRequests.back());
+    }
+}
+
+template<unsigned DIM>
+void PolarityEdgeDomainDecomposition<DIM>::FinishHaloExchange(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (!mRequests.empty())
+    {
+        MPI_Waitall(mRequests.size(), &mRequests[0], MPI_STATUSES_IGNORE);
+        mRequests.clear();
+    }
+
+    unsigned buffer_index = 0;
+    for (auto& r_entry : mReceiveEdges)
+    {
+        const std::vector<double>& r_buffer = mReceiveBuffers[buffer_index++];
+        const double* p_levels = r_buffer.empty() ? nullptr : &r_buffer[0];
+        for (auto edge : r_entry.second)
+        {
+            auto p_cell_srn = static_cast<CellSrnModel*>(rCellPopulation.GetCellUsingLocationIndex(edge.first)->GetSrnModel());
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge.second));
+            std::array<double, NUM_LEVELS_PER_EDGE> levels;
+            std::copy(p_levels, p_levels + NUM_LEVELS_PER_EDGE, levels.begin());
+            PolarityEdgeSpecies::SetLevels(*p_edge_srn, levels);
+            p_levels += NUM_LEVELS_PER_EDGE;
+        }
+    }
+}
+
+template<unsigned DIM>
+void PolarityEdgeDomainDecomposition<DIM>::GatherLevels(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (rCellPopulation.GetNumRealCells() != mOwners.size())
+    {
+        EXCEPTION("Distributed polarity edge networks require a fixed tissue topology.");
+    }
+
+    // Pack this process's edges into its own part of the buffer, and gather the rest in place
+    const unsigned my_rank = PetscTools::GetMyRank();
+    double* p_levels = mGatherBuffer.data() + mGatherDisplacements[my_rank];
+    for (unsigned location_index : mCellsOfProcess[my_rank])
+    {
+        auto p_cell_srn = static_cast<CellSrnModel*>(rCellPopulation.GetCellUsingLocationIndex(location_index)->GetSrnModel());
+        for (unsigned edge_index = 0; edge_index < p_cell_srn->GetNumEdgeSrn(); ++edge_index)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+            std::array<double, NUM_LEVELS_PER_EDGE> levels;
+            PolarityEdgeSpecies::GetLevels(*p_edge_srn, levels);
+            p_levels = std::copy(levels.begin(), levels.end(), p_levels);
+        }
+    }
+    assert(p_levels == mGatherBuffer.data() + mGatherDisplacements[my_rank] + mGatherCounts[my_rank]);
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, mGatherBuffer.data(), &mGatherCounts[0],
+                   &mGatherDisplacements[0], MPI_DOUBLE, PetscTools::GetWorld());
+
+    for (unsigned process = 0; process < mCellsOfProcess.size(); process++)
+    {
+        if (process == my_rank)
+        {
+            continue;
+        }
+        p_levels = mGatherBuffer.data() + mGatherDisplacements[process];
+        for (unsigned location_index : mCellsOfProcess[process])
+        {
+            auto p_cell_srn = static_cast<CellSrnModel*>(rCellPopulation.GetCellUsingLocationIndex(location_index)->GetSrnModel());
+            for (unsigned edge_index = 0; edge_index < p_cell_srn->GetNumEdgeSrn(); ++edge_index)
+            {
+                auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+                std::array<double, NUM_LEVELS_PER_EDGE> levels;
+                std::copy(p_levels, p_levels + NUM_LEVELS_PER_EDGE, levels.begin());
+                PolarityEdgeSpecies::SetLevels(*p_edge_srn, levels);
+                p_levels += NUM_LEVELS_PER_EDGE;
+            }
+        }
+        assert(p_levels == mGatherBuffer.data() + mGatherDisplacements[process] + mGatherCounts[process]);
+    }
+}
+
+// Explicit instantiation
+template class PolarityEdgeDomainDecomposition<1>;
+template class PolarityEdgeDomainDecomposition<2>;
+template class PolarityEdgeDomainDecomposition<3>;
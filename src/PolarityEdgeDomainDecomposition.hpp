@@ -0,0 +1,186 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYEDGEDOMAINDECOMPOSITION_HPP_
+#define POLARITYEDGEDOMAINDECOMPOSITION_HPP_
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "AbstractCellPopulation.hpp"
+#include "PetscTools.hpp"
+
+/**
+ * Shares the work of integrating the edge SRNs of a vertex-based tissue between the MPI
+ * processes.
+ *
+ * This shares work, not memory. Every process holds the whole cell population, with
+ * the edge SRNs, CellEdgeData and modifier caches of every cell, so the memory taken by
+ * each process does not fall as processes are added. Each cell is owned by one process,
+ * which alone integrates its edge SRNs and diffuses its membrane proteins. Cells are
+ * assigned by growing contiguous parts of the cell adjacency graph breadth-first, so that
+ * each part has few neighbours on other processes.
+ *
+ * The neighbour means of an owned edge may need the levels of an edge owned elsewhere.
+ * Only these boundary edges are exchanged at every time step, with non-blocking
+ * point-to-point messages, so that the exchange overlaps the diffusion of the owner's
+ * interior cells; it does not overlap the SRN solve. Received levels are written into the
+ * local copies of the SRNs of the sending process's cells, from which
+ * PolarityEdgeTrackingModifier publishes them as usual.
+ *
+ * The SRNs of the other cells owned elsewhere are otherwise stale. Before anything reads
+ * the published levels of every cell, such as the population writers or
+ * AsyncEdgeDataOutputModifier, GatherLevels() must bring them up to date;
+ * PolarityEdgeTrackingModifier does so at each step it is told output may be sampled.
+ *
+ * The tissue topology must not change once the cells have been partitioned.
+ */
+template<unsigned DIM>
+class PolarityEdgeDomainDecomposition
+{
+private:
+
+    /** The process owning each cell, by location index. */
+    std::map<unsigned, unsigned> mOwners;
+
+    /** Whether each cell owned by this process has an edge next to a cell owned by another process. */
+    std::map<unsigned, bool> mIsBoundaryCell;
+
+    /** For each other process, the (location index, local edge index) of the owned edges it needs. */
+    std::map<unsigned, std::vector<std::pair<unsigned, unsigned> > > mSendEdges;
+
+    /** For each other process, the (location index, local edge index) of its edges this process needs. */
+    std::map<unsigned, std::vector<std::pair<unsigned, unsigned> > > mReceiveEdges;
+
+    /** Send buffers, one per entry of mSendEdges. */
+    std::vector<std::vector<double> > mSendBuffers;
+
+    /** Receive buffers, one per entry of mReceiveEdges. */
+    std::vector<std::vector<double> > mReceiveBuffers;
+
+    /** Outstanding requests of the current exchange. */
+    std::vector<MPI_Request> mRequests;
+
+    /** The location indices of the cells owned by each process, in increasing order. */
+    std::vector<std::vector<unsigned> > mCellsOfProcess;
+
+    /** The number of levels contributed by each process to GatherLevels(). */
+    std::vector<int> mGatherCounts;
+
+    /** The offset of each process's levels in mGatherBuffer. */
+    std::vector<int> mGatherDisplacements;
+
+    /** The levels of every edge, gathered by GatherLevels(), packed process by process. */
+    std::vector<double> mGatherBuffer;
+
+    /** The number of cells owned by this process. */
+    unsigned mNumLocalCells;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    PolarityEdgeDomainDecomposition();
+
+    /**
+     * Assign the vertices of a graph to parts of (nearly) equal size, growing each part
+     * breadth-first from its lowest numbered unassigned vertex.
+     *
+     * @param rAdjacency the neighbours of each vertex
+     * @param numParts the number of parts
+     * @return the part of each vertex
+     */
+    static std::vector<unsigned> PartitionGraph(const std::vector<std::set<unsigned> >& rAdjacency, unsigned numParts);
+
+    /**
+     * Assign the cells to processes, mark the SRNs of cells owned elsewhere and work out
+     * which edges are exchanged with which process.
+     *
+     * @param rCellPopulation the cell population, which must be vertex based
+     */
+    void Partition(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @param locationIndex the location index of a cell
+     * @return whether the cell is owned by this process
+     */
+    bool IsLocallyOwned(unsigned locationIndex) const;
+
+    /**
+     * @param locationIndex the location index of a cell owned by this process
+     * @return whether the cell has an edge next to a cell owned by another process
+     */
+    bool IsBoundaryCell(unsigned locationIndex) const;
+
+    /**
+     * @return the number of cells owned by this process
+     */
+    unsigned GetNumLocalCells() const;
+
+    /**
+     * @return the number of edges received from other processes at each exchange
+     */
+    unsigned GetNumHaloEdges() const;
+
+    /**
+     * Send the levels of this process's boundary edges to the processes that need them,
+     * and post receives for the levels this process needs. Returns without waiting.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void StartHaloExchange(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Wait for the exchange started by StartHaloExchange() and copy the received levels
+     * into the SRNs of the corresponding cells.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void FinishHaloExchange(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Send the levels of every edge owned by this process to every other process, and
+     * copy the levels received into the SRNs of the cells owned elsewhere, so that every
+     * SRN on every process is up to date. Must be called by all processes together.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void GatherLevels(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+};
+
+#endif /*POLARITYEDGEDOMAINDECOMPOSITION_HPP_*/
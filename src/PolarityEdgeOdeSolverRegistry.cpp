@@ -0,0 +1,381 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+#include "BackwardEulerIvpOdeSolver.hpp"
+#include "BufferedOneStepIvpOdeSolver.hpp"
+#include "CellCycleModelOdeSolver.hpp"
+#include "Exception.hpp"
+#include "ModifiedPatankarRungeKuttaIvpOdeSolver.hpp"
+#include "MultirateIvpOdeSolver.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "RosenbrockWIvpOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "RungeKuttaFehlbergIvpOdeSolver.hpp"
+#ifdef CHASTE_CVODE
+#include "CvodeAdaptor.hpp"
+#endif //CHASTE_CVODE
+
+namespace
+{
+/**
+ * Factory for solvers that need no set-up beyond Initialise().
+ *
+ * @return the initialised solver
+ */
+template<class ODE_SOLVER>
+boost::shared_ptr<AbstractCellCycleModelOdeSolver> CreateSimpleSolver(double, double)
+{
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = CellCycleModelOdeSolver<PolarityEdgeSrnModel, ODE_SOLVER>::Instance();
+    p_solver->Initialise();
+    return p_solver;
+}
+
+/**
+ * Factory for the backward Euler solver, which must be told the size of the ODE system.
+ *
+ * @return the initialised solver
+ */
+boost::shared_ptr<AbstractCellCycleModelOdeSolver> CreateBackwardEulerSolver(double, double)
+{
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = CellCycleModelOdeSolver<PolarityEdgeSrnModel, BackwardEulerIvpOdeSolver>::Instance();
+    p_solver->SetSizeOfOdeSystem(8);
+    p_solver->Initialise();
+    return p_solver;
+}
+
+/**
+ * Factory for the Rosenbrock-W solver. CellCycleModelOdeSolver default-constructs
+ * its solver, so the tolerances are passed on as the solver defaults.
+ *
+ * @param relTol the relative tolerance
+ * @param absTol the absolute tolerance
+ * @return the initialised solver
+ */
+boost::shared_ptr<AbstractCellCycleModelOdeSolver> CreateRosenbrockWSolver(double relTol, double absTol)
+{
+    RosenbrockWIvpOdeSolver::SetDefaultTolerances(relTol, absTol);
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = CellCycleModelOdeSolver<PolarityEdgeSrnModel, RosenbrockWIvpOdeSolver>::Instance();
+    p_solver->Initialise();
+    return p_solver;
+}
+
+/**
+ * Factory for the multirate solver, which like the Rosenbrock-W solver takes its
+ * tolerances from the solver defaults.
+ *
+ * @param relTol the relative tolerance
+ * @param absTol the absolute tolerance
+ * @return the initialised solver
+ */
+boost::shared_ptr<AbstractCellCycleModelOdeSolver> CreateMultirateSolver(double relTol, double absTol)
+{
+    MultirateIvpOdeSolver::SetDefaultTolerances(relTol, absTol);
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = CellCycleModelOdeSolver<PolarityEdgeSrnModel, MultirateIvpOdeSolver>::Instance();
+    p_solver->Initialise();
+    return p_solver;
+}
+
+#ifdef CHASTE_CVODE
+/**
+ * Factory for CVODE.
+ *
+ * @param relTol the relative tolerance
+ * @param absTol the absolute tolerance
+ * @return the initialised solver
+ */
+boost::shared_ptr<AbstractCellCycleModelOdeSolver> CreateCvodeSolver(double relTol, double absTol)
+{
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = CellCycleModelOdeSolver<PolarityEdgeSrnModel, CvodeAdaptor>::Instance();
+    p_solver->Initialise();
+    p_solver->SetMaxSteps(10000);
+    p_solver->SetTolerances(relTol, absTol);
+    return p_solver;
+}
+#endif //CHASTE_CVODE
+}
+
+PolarityEdgeOdeSolverRegistry* PolarityEdgeOdeSolverRegistry::mpInstance = nullptr;
+
+PolarityEdgeOdeSolverRegistry::PolarityEdgeOdeSolverRegistry()
+    : mRelativeTolerance(1e-4),
+      mAbsoluteTolerance(1e-6)
+{
+    // The fixed-step one-step solvers are wrapped so that a solve keeps its working memory between calls
+    RegisterSolver("RungeKutta4", &CreateSimpleSolver<BufferedOneStepIvpOdeSolver<RungeKutta4IvpOdeSolver> >, 0.001, false);
+    // Chaste's RKF solver adapts its step to a built-in tolerance, not the registry's, so is registered as fixed-step
+    RegisterSolver("RungeKuttaFehlberg", &CreateSimpleSolver<RungeKuttaFehlbergIvpOdeSolver>, 0.01, false);
+    RegisterSolver("BackwardEuler", &CreateBackwardEulerSolver, 0.01, false);
+    RegisterSolver("ModifiedPatankar", &CreateSimpleSolver<BufferedOneStepIvpOdeSolver<ModifiedPatankarRungeKuttaIvpOdeSolver> >, 0.01, false);
+    // The time step is only the maximum step size of this adaptive solver
+    RegisterSolver("RosenbrockW", &CreateRosenbrockWSolver, 0.1, true);
+    RegisterSolver("Multirate", &CreateMultirateSolver, 0.1, true);
+#ifdef CHASTE_CVODE
+    // CVODE picks its own internal steps, so keep the SRN model's default dt
+    RegisterSolver("Cvode", &CreateCvodeSolver, 0.0, true);
+    mActiveSolver = "Cvode";
+#else
+    mActiveSolver = "RungeKutta4";
+#endif //CHASTE_CVODE
+}
+
+PolarityEdgeOdeSolverRegistry* PolarityEdgeOdeSolverRegistry::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new PolarityEdgeOdeSolverRegistry;
+    }
+    return mpInstance;
+}
+
+void PolarityEdgeOdeSolverRegistry::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = nullptr;
+    }
+}
+
+const PolarityEdgeOdeSolverRegistry::SolverEntry& PolarityEdgeOdeSolverRegistry::rGetEntry(const std::string& rName) const
+{
+    std::map<std::string, SolverEntry>::const_iterator iter = mSolvers.find(rName);
+    if (iter == mSolvers.end())
+    {
+        EXCEPTION("No ODE solver named '" << rName << "' has been registered for PolarityEdgeSrnModel.");
+    }
+    return iter->second;
+}
+
+void PolarityEdgeOdeSolverRegistry::RegisterSolver(const std::string& rName, SolverFactory factory, double defaultDt, bool isAdaptive)
+{
+    SolverEntry entry;
+    entry.mFactory = factory;
+    entry.mDefaultDt = defaultDt;
+    entry.mIsAdaptive = isAdaptive;
+    mSolvers[rName] = entry;
+}
+
+bool PolarityEdgeOdeSolverRegistry::HasSolver(const std::string& rName) const
+{
+    return mSolvers.find(rName) != mSolvers.end();
+}
+
+std::vector<std::string> PolarityEdgeOdeSolverRegistry::GetSolverNames() const
+{
+    std::vector<std::string> names;
+    for (std::map<std::string, SolverEntry>::const_iterator iter = mSolvers.begin();
+         iter != mSolvers.end();
+         ++iter)
+    {
+        names.push_back(iter->first);
+    }
+    return names;
+}
+
+bool PolarityEdgeOdeSolverRegistry::IsAdaptive(const std::string& rName) const
+{
+    return rGetEntry(rName).mIsAdaptive;
+}
+
+void PolarityEdgeOdeSolverRegistry::SetActiveSolver(const std::string& rName)
+{
+    // Check that the solver exists before making it active
+    rGetEntry(rName);
+    mActiveSolver = rName;
+}
+
+const std::string& PolarityEdgeOdeSolverRegistry::rGetActiveSolver() const
+{
+    return mActiveSolver;
+}
+
+double PolarityEdgeOdeSolverRegistry::GetDefaultDt(const std::string& rName) const
+{
+    return rGetEntry(rName).mDefaultDt;
+}
+
+void PolarityEdgeOdeSolverRegistry::SetDefaultDt(const std::string& rName, double dt)
+{
+    rGetEntry(rName);
+    mSolvers[rName].mDefaultDt = dt;
+}
+
+void PolarityEdgeOdeSolverRegistry::SetTolerances(double relTol, double absTol)
+{
+    if (relTol <= 0.0 || absTol <= 0.0)
+    {
+        EXCEPTION("ODE solver tolerances must be positive.");
+    }
+    mRelativeTolerance = relTol;
+    mAbsoluteTolerance = absTol;
+}
+
+double PolarityEdgeOdeSolverRegistry::GetRelativeTolerance() const
+{
+    return mRelativeTolerance;
+}
+
+double PolarityEdgeOdeSolverRegistry::GetAbsoluteTolerance() const
+{
+    return mAbsoluteTolerance;
+}
+
+boost::shared_ptr<AbstractCellCycleModelOdeSolver> PolarityEdgeOdeSolverRegistry::CreateSolver(const std::string& rName) const
+{
+    return (*rGetEntry(rName).mFactory)(mRelativeTolerance, mAbsoluteTolerance);
+}
+
+std::string PolarityEdgeOdeSolverRegistry::AutoTune(const std::vector<std::vector<double> >& rEdgeInitialConditions,
+                                                    const std::vector<std::vector<double> >& rEdgeParameters,
+                                                    double probeDuration,
+                                                    double targetError)
+{
+    if (rEdgeInitialConditions.empty() || rEdgeInitialConditions.size() != rEdgeParameters.size())
+    {
+        EXCEPTION("AutoTune() needs initial conditions and parameters for each edge of the probe cell.");
+    }
+    if (probeDuration <= 0.0)
+    {
+        EXCEPTION("The AutoTune() probe duration must be positive.");
+    }
+
+    const unsigned num_edges = rEdgeInitialConditions.size();
+
+    // Reference solution; RK4 at this step size is converged to round-off for the probe lengths of interest
+    std::vector<std::vector<double> > reference(num_edges);
+    RungeKutta4IvpOdeSolver reference_solver;
+    for (unsigned edge = 0; edge < num_edges; edge++)
+    {
+        PolarityEdgeOdeSystem system(rEdgeInitialConditions[edge]);
+        for (unsigned i = 0; i < rEdgeParameters[edge].size(); i++)
+        {
+            system.SetParameter(i, rEdgeParameters[edge][i]);
+        }
+        reference_solver.SolveAndUpdateStateVariable(&system, 0.0, probeDuration, 1e-4);
+        reference[edge] = system.rGetStateVariables();
+    }
+
+    std::string fastest_solver;
+    double fastest_time = DBL_MAX;
+    std::string most_accurate_solver;
+    double smallest_error = DBL_MAX;
+
+    for (std::map<std::string, SolverEntry>::const_iterator iter = mSolvers.begin();
+         iter != mSolvers.end();
+         ++iter)
+    {
+        // Solvers using the SRN model's default dt are probed at the usual simulation dt
+        const double dt = (iter->second.mDefaultDt > 0.0) ? iter->second.mDefaultDt : std::min(0.1, probeDuration);
+
+        std::vector<PolarityEdgeOdeSystem*> systems;
+        for (unsigned edge = 0; edge < num_edges; edge++)
+        {
+            systems.push_back(new PolarityEdgeOdeSystem(rEdgeInitialConditions[edge]));
+            for (unsigned i = 0; i < rEdgeParameters[edge].size(); i++)
+            {
+                systems.back()->SetParameter(i, rEdgeParameters[edge][i]);
+            }
+        }
+
+        bool solved = true;
+        double error = 0.0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        try
+        {
+            boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = CreateSolver(iter->first);
+            for (unsigned edge = 0; edge < num_edges; edge++)
+            {
+                p_solver->SolveAndUpdateStateVariable(systems[edge], 0.0, probeDuration, dt);
+            }
+        }
+        catch (Exception&)
+        {
+            // A solver that fails on the probe is not a candidate
+            solved = false;
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (unsigned edge = 0; solved && edge < num_edges; edge++)
+        {
+            const std::vector<double>& r_state = systems[edge]->rGetStateVariables();
+            double scale = DBL_EPSILON;
+            double difference = 0.0;
+            for (unsigned i = 0; i < r_state.size(); i++)
+            {
+                scale = std::max(scale, fabs(reference[edge][i]));
+                difference = std::max(difference, fabs(r_state[i] - reference[edge][i]));
+            }
+            error = std::max(error, difference/scale);
+        }
+        for (unsigned edge = 0; edge < num_edges; edge++)
+        {
+            delete systems[edge];
+        }
+
+        if (!solved || std::isnan(error))
+        {
+            continue;
+        }
+        if (error < smallest_error)
+        {
+            smallest_error = error;
+            most_accurate_solver = iter->first;
+        }
+        if (error <= targetError && elapsed < fastest_time)
+        {
+            fastest_time = elapsed;
+            fastest_solver = iter->first;
+        }
+    }
+
+    if (fastest_solver.empty())
+    {
+        if (most_accurate_solver.empty())
+        {
+            EXCEPTION("None of the registered ODE solvers could integrate the AutoTune() probe.");
+        }
+        fastest_solver = most_accurate_solver;
+    }
+    mActiveSolver = fastest_solver;
+    return mActiveSolver;
+}
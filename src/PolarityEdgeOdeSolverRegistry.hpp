@@ -0,0 +1,222 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYEDGEODESOLVERREGISTRY_HPP_
+#define POLARITYEDGEODESOLVERREGISTRY_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellCycleModelOdeSolver.hpp"
+
+/**
+ * A run-time registry of the ODE solvers that can be used to integrate a
+ * PolarityEdgeSrnModel.
+ *
+ * Each solver is registered under a name, together with a factory returning the
+ * CellCycleModelOdeSolver singleton for that solver type and the time step to use
+ * with it. Every PolarityEdgeSrnModel that is constructed without an explicit
+ * solver uses the currently active solver, so the solver can be changed between
+ * simulations (for example between points of a parameter sweep) without
+ * recompiling.
+ *
+ * AutoTune() runs a short probe on a representative cell with each registered
+ * solver and makes the fastest one that meets a given accuracy target active.
+ */
+class PolarityEdgeOdeSolverRegistry
+{
+public:
+
+    /**
+     * Signature of a solver factory. The arguments are the relative and absolute
+     * tolerances, which are ignored by fixed-step solvers.
+     */
+    typedef boost::shared_ptr<AbstractCellCycleModelOdeSolver> (*SolverFactory)(double, double);
+
+private:
+
+    /** Information stored for each registered solver. */
+    struct SolverEntry
+    {
+        /** Factory returning the solver. */
+        SolverFactory mFactory;
+
+        /** Time step passed to the solver; a non-positive value leaves the SRN model's default. */
+        double mDefaultDt;
+
+        /** Whether the solver chooses its step size to meet the registry's tolerances. */
+        bool mIsAdaptive;
+    };
+
+    /** The single instance of this class. */
+    static PolarityEdgeOdeSolverRegistry* mpInstance;
+
+    /** The registered solvers, keyed by name. */
+    std::map<std::string, SolverEntry> mSolvers;
+
+    /** Name of the solver given to newly constructed SRN models. */
+    std::string mActiveSolver;
+
+    /** Relative tolerance passed to adaptive solvers. Defaults to 1e-4. */
+    double mRelativeTolerance;
+
+    /** Absolute tolerance passed to adaptive solvers. Defaults to 1e-6. */
+    double mAbsoluteTolerance;
+
+    /**
+     * Private constructor; registers the solvers available in this build. Use Instance().
+     */
+    PolarityEdgeOdeSolverRegistry();
+
+    /**
+     * @param rName the name of a registered solver
+     * @return the entry for this solver; throws if it has not been registered
+     */
+    const SolverEntry& rGetEntry(const std::string& rName) const;
+
+public:
+
+    /**
+     * @return the single instance of the registry, creating it on first call.
+     */
+    static PolarityEdgeOdeSolverRegistry* Instance();
+
+    /**
+     * Destroy the current instance, so that the next call to Instance() creates a new
+     * registry with the default settings. Should be called at the end of a simulation.
+     */
+    static void Destroy();
+
+    /**
+     * Register a solver, replacing any previous solver of the same name.
+     *
+     * @param rName the name of the solver
+     * @param factory the factory used to obtain the solver
+     * @param defaultDt the time step to use with this solver (non-positive to keep the SRN model default)
+     * @param isAdaptive whether the solver chooses its step size to meet the tolerances passed to the factory
+     */
+    void RegisterSolver(const std::string& rName, SolverFactory factory, double defaultDt, bool isAdaptive);
+
+    /**
+     * @param rName a solver name
+     * @return whether a solver has been registered under this name
+     */
+    bool HasSolver(const std::string& rName) const;
+
+    /**
+     * @return the names of all registered solvers, in alphabetical order
+     */
+    std::vector<std::string> GetSolverNames() const;
+
+    /**
+     * @param rName the name of a registered solver
+     * @return whether the solver chooses its step size to meet the registry's tolerances
+     */
+    bool IsAdaptive(const std::string& rName) const;
+
+    /**
+     * Set the solver used by subsequently constructed PolarityEdgeSrnModels.
+     *
+     * @param rName the name of a registered solver
+     */
+    void SetActiveSolver(const std::string& rName);
+
+    /**
+     * @return the name of the solver used by newly constructed PolarityEdgeSrnModels
+     */
+    const std::string& rGetActiveSolver() const;
+
+    /**
+     * @param rName the name of a registered solver
+     * @return the time step used with this solver
+     */
+    double GetDefaultDt(const std::string& rName) const;
+
+    /**
+     * Set the time step used with a solver.
+     *
+     * @param rName the name of a registered solver
+     * @param dt the new time step (non-positive to keep the SRN model default)
+     */
+    void SetDefaultDt(const std::string& rName, double dt);
+
+    /**
+     * Set the tolerances passed to adaptive solvers when they are created.
+     *
+     * @param relTol the relative tolerance
+     * @param absTol the absolute tolerance
+     */
+    void SetTolerances(double relTol, double absTol);
+
+    /**
+     * @return the relative tolerance passed to adaptive solvers
+     */
+    double GetRelativeTolerance() const;
+
+    /**
+     * @return the absolute tolerance passed to adaptive solvers
+     */
+    double GetAbsoluteTolerance() const;
+
+    /**
+     * @param rName the name of a registered solver
+     * @return the (initialised) solver registered under this name
+     */
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> CreateSolver(const std::string& rName) const;
+
+    /**
+     * Select the active solver by running a short probe with every registered solver.
+     *
+     * Each edge of the representative cell is integrated in isolation over the probe
+     * interval, with its neighbour parameters held fixed. The result of each solver is
+     * compared with a reference solution computed using RK4 with a very small time step,
+     * and the fastest solver whose maximum relative error does not exceed the target is
+     * made active. If no solver meets the target, the most accurate one is chosen.
+     *
+     * @param rEdgeInitialConditions the initial conditions of each edge of the representative cell
+     * @param rEdgeParameters the parameters (neighbour levels) of each edge
+     * @param probeDuration the length of the probe interval
+     * @param targetError the maximum acceptable relative error
+     * @return the name of the selected solver
+     */
+    std::string AutoTune(const std::vector<std::vector<double> >& rEdgeInitialConditions,
+                         const std::vector<std::vector<double> >& rEdgeParameters,
+                         double probeDuration,
+                         double targetError);
+};
+
+#endif /*POLARITYEDGEODESOLVERREGISTRY_HPP_*/
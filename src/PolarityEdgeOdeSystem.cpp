@@ -35,47 +35,37 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "CellwiseOdeSystemInformation.hpp"
 #include "PolarityEdgeOdeSystem.hpp"
-
 PolarityEdgeOdeSystem::PolarityEdgeOdeSystem(std::vector<double> stateVariables)
-    : AbstractOdeSystem(8)
+    : AbstractReactionNetworkOdeSystem(PolarityEdgeReactionNetwork::NUM_SPECIES),
+      mpKineticParameters(PolarityKineticParameters::GetDefault())
 {
-    mpSystemInfo.reset(new CellwiseOdeSystemInformation<PolarityEdgeOdeSystem>);
+    mpSystemInfo = GetSharedSystemInformation();
 
     /**
      * The state variables are as follows:
      *
-     * 0 - Bound A homodimer concentration for this cell edge
-     * 1 - Unbound A concentration for this cell edge
+     * 0 - Unbound A concentration for this cell edge
+     * 1 - Bound A homodimer concentration for this cell edge
      * 2 - B concentration for this cell edge
-     * 2 - C concentration for this cell edge
+     * 3 - C concentration for this cell edge
      * 4 - B-A concentration for this cell edge
      * 5 - A-B concentration for this cell edge
      * 6 - C-A concentration for this cell edge
      * 7 - A-C concentration for this cell edge
-     * 
+     *
      * We store the last state variable so that it can be written
      * to file at each time step alongside the others, and visualized.
+     *
+     * Their default initial conditions are set once, in the shared system information.
      */
 
-    SetDefaultInitialCondition(0, 1.0); // soon overwritten
-    SetDefaultInitialCondition(1, 1.0); // soon overwritten
-    SetDefaultInitialCondition(2, 1.0); // soon overwritten
-    SetDefaultInitialCondition(3, 1.0); // soon overwritten
-    SetDefaultInitialCondition(4, 1.0); // soon overwritten
-    SetDefaultInitialCondition(5, 1.0); // soon overwritten
-    SetDefaultInitialCondition(6, 1.0); // soon overwritten
-    SetDefaultInitialCondition(7, 1.0); // soon overwritten
-
-    this->mParameters.push_back(0.5);
-    //By default zero.
-    this->mParameters.push_back(0.0);
-    this->mParameters.push_back(0.0);
-    this->mParameters.push_back(0.0);
-    this->mParameters.push_back(0.0);
-    this->mParameters.push_back(0.0);
-    this->mParameters.push_back(0.0);
-    this->mParameters.push_back(0.0);
-    this->mParameters.push_back(0.0);
+    // The neighbour levels (by default zero, but for A)
+    this->mParameters.reserve(PolarityEdgeReactionNetwork::NUM_INPUTS);
+    for (unsigned i = 0; i < PolarityEdgeReactionNetwork::NUM_INPUTS; i++)
+    {
+        this->mParameters.push_back(PolarityEdgeReactionNetwork::GetDefaultInput(i));
+    }
+
     if (stateVariables != std::vector<double>())
     {
         SetStateVariables(stateVariables);
@@ -86,122 +76,104 @@ PolarityEdgeOdeSystem::~PolarityEdgeOdeSystem()
 {
 }
 
-void PolarityEdgeOdeSystem::EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY)
+std::vector<double> PolarityEdgeOdeSystem::GetDefaultKineticParameters()
 {
-    const double BoundA = rY[1];
-    const double A = rY[0];
-    const double B = rY[2];
-    const double C = rY[3];
-    const double BA = rY[4];
-    const double AB = rY[5];
-    const double CA = rY[6];
-    const double AC = rY[7];
-
-    const double neigh_A = this->mParameters[0]; // Shorthand for "this->mParameter("neighbor delta");"
-    const double neigh_B = this->mParameters[2]; // Shorthand for "this->mParameter("neighbor notch");"
-    const double neigh_C = this->mParameters[3]; // Shorthand for "this->mParameter("neighbor notch");"
-    const double neigh_BA = this->mParameters[4]; // Shorthand for "this->mParameter("neighbor notch");"
-    const double neigh_CA = this->mParameters[6]; // Shorthand for "this->mParameter("neighbor notch");"
-
-    const double KD1 = 5;
-    const double KD2 = 0.1;
-
-    const double k = 1.0;
-    const double v1 = KD1*k;
-    const double v2 = KD2*k;
-
-    const double K = 0.1665;
-    const double VF = 10.0;
-    const double VS = 10.0;
-    const double xF = BA;
-    const double xS = CA;
-    const double xFm = (neigh_BA);
-    const double xSm = (neigh_CA);
-    const double w = 2.0;
-
-    const double hF = 1 + (((VF -1)*pow(xF,w))/(pow(K,w) + pow(xF,w)));
-    const double hS = 1 + (((VS -1)*pow(xS,w))/(pow(K,w) + pow(xS,w)));
-    const double hFm = 1 + (((VF -1)*pow(xFm,w))/(pow(K,w) + pow(xFm,w)));
-    const double hSm = 1 + (((VS -1)*pow(xSm,w))/(pow(K,w) + pow(xSm,w)));
-
-    const double R1 = k*(A*neigh_A) - (v1*(BoundA)); // A -> Bound A
-
-    const double R2 = k*(B*BoundA) - v2*hS*xS*(BA); // FZ:FL -> B + Bound A
-    const double Rm2 = k*(neigh_B*BoundA) - v2*hSm*xSm*(AB); // FL:FZm -> Bm + Bound A
+    // KD1, KD2, k, K, VF, VS, w
+    std::vector<double> kinetic_parameters(NUM_KINETIC_PARAMETERS);
+    for (unsigned i = 0; i < NUM_KINETIC_PARAMETERS; i++)
+    {
+        kinetic_parameters[i] = PolarityEdgeReactionNetwork::GetDefaultParameter(i);
+    }
+    return kinetic_parameters;
+}
 
-    const double R3 = k*(C*BoundA) - v2*hF*xF*(CA); // Stb:FL -> B + Bound A
-    const double Rm3 = k*((neigh_C)*BoundA) -v2*hFm*xFm*(AC);// FL:Stbm -> Bm + Bound A
+boost::shared_ptr<AbstractOdeSystemInformation> PolarityEdgeOdeSystem::GetSharedSystemInformation()
+{
+    // Never destroyed, as systems may be freed during static destruction
+    static boost::shared_ptr<AbstractOdeSystemInformation>* p_system_info =
+        new boost::shared_ptr<AbstractOdeSystemInformation>(new CellwiseOdeSystemInformation<PolarityEdgeOdeSystem>);
+    return *p_system_info;
+}
 
+FixedSizeObjectPool* PolarityEdgeOdeSystem::GetObjectPool()
+{
+    // Never destroyed, as systems may be freed during static destruction
+    static FixedSizeObjectPool* p_pool = new FixedSizeObjectPool(sizeof(PolarityEdgeOdeSystem));
+    return p_pool;
+}
 
-    rDY[1] =  R1 - R2 -Rm2 -R3 -Rm3;// d[Bound A]/dt
+void* PolarityEdgeOdeSystem::operator new(std::size_t size)
+{
+    if (size != sizeof(PolarityEdgeOdeSystem))
+    {
+        // A subclass
+        return ::operator new(size);
+    }
+    return GetObjectPool()->Allocate();
+}
 
-    rDY[0] = -R1 ; // d[A]/dt
-    
-    rDY[2] = -R2; // d[B]/dt
+void PolarityEdgeOdeSystem::operator delete(void* pObject, std::size_t size)
+{
+    if (size != sizeof(PolarityEdgeOdeSystem))
+    {
+        ::operator delete(pObject);
+        return;
+    }
+    GetObjectPool()->Deallocate(pObject);
+}
 
-    rDY[3] = -R3; // d[C]/dt
+void PolarityEdgeOdeSystem::CopyParameters(const PolarityEdgeOdeSystem& rSystem)
+{
+    // Both systems have the same number of parameters, so this does not allocate
+    this->mParameters = rSystem.mParameters;
+    mpKineticParameters = rSystem.mpKineticParameters;
+}
 
-    rDY[4] = R2; // d[FZ:FL:FL]/dt
+const std::vector<double>& PolarityEdgeOdeSystem::rGetParameters() const
+{
+    return this->mParameters;
+}
 
-    rDY[5] = Rm2; // d[FL:FL:FZ]/dt
+void PolarityEdgeOdeSystem::SetKineticParameters(boost::shared_ptr<const PolarityKineticParameters> pKineticParameters)
+{
+    assert(pKineticParameters);
+    mpKineticParameters = pKineticParameters;
+}
 
-    rDY[6] = R3; // d[STB:FL:FL]/dt
+boost::shared_ptr<const PolarityKineticParameters> PolarityEdgeOdeSystem::GetKineticParameters() const
+{
+    return mpKineticParameters;
+}
 
-    rDY[7] = Rm3; // d[FL:FL:STB]/dt
+void PolarityEdgeOdeSystem::EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY)
+{
+    PolarityEdgeReactionNetwork::EvaluateRhs(&rY[0], &(this->mParameters[0]), &(mpKineticParameters->rGetValues()[0]), &rDY[0]);
+}
 
+void PolarityEdgeOdeSystem::EvaluateJacobian(double time, const std::vector<double>& rY, std::vector<double>& rJacobian)
+{
+    const unsigned num_species = PolarityEdgeReactionNetwork::NUM_SPECIES;
+    rJacobian.resize(num_species*num_species);
+    PolarityEdgeReactionNetwork::EvaluateJacobian(&rY[0], &(this->mParameters[0]), &(mpKineticParameters->rGetValues()[0]),
+                                                  &rJacobian[0]);
 }
 
 template<>
 void CellwiseOdeSystemInformation<PolarityEdgeOdeSystem>::Initialise()
 {
-    this->mVariableNames.push_back("BoundA");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mVariableNames.push_back("A");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mVariableNames.push_back("B");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mVariableNames.push_back("C");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mVariableNames.push_back("BA");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mVariableNames.push_back("AB");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mVariableNames.push_back("CA");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mVariableNames.push_back("AC");
-    this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(1.0); // will be filled in later
-
-    this->mParameterNames.push_back("neighbour A");
-    this->mParameterUnits.push_back("non-dim");
-    this->mParameterNames.push_back("neighbour boundA");
-    this->mParameterUnits.push_back("non-dim");
-    this->mParameterNames.push_back("neighbour B");
-    this->mParameterUnits.push_back("non-dim");
-    this->mParameterNames.push_back("neighbour C");
-    this->mParameterUnits.push_back("non-dim");
-    this->mParameterNames.push_back("neighbour BA");
-    this->mParameterUnits.push_back("non-dim");
-    this->mParameterNames.push_back("neighbour AB");
-    this->mParameterUnits.push_back("non-dim");
-    this->mParameterNames.push_back("neighbour CA");
-    this->mParameterUnits.push_back("non-dim");
-    this->mParameterNames.push_back("neighbour AC");
-    this->mParameterUnits.push_back("non-dim");
+    for (unsigned i = 0; i < PolarityEdgeReactionNetwork::NUM_SPECIES; i++)
+    {
+        this->mVariableNames.push_back(PolarityEdgeReactionNetwork::GetSpeciesName(i));
+        this->mVariableUnits.push_back("non-dim");
+        this->mInitialConditions.push_back(PolarityEdgeReactionNetwork::GetDefaultInitialCondition(i)); // will be filled in later
+    }
+
+    // Only the neighbour levels; the kinetic parameters are held in a shared block
+    for (unsigned i = 0; i < PolarityEdgeReactionNetwork::NUM_INPUTS; i++)
+    {
+        this->mParameterNames.push_back(PolarityEdgeReactionNetwork::GetInputName(i));
+        this->mParameterUnits.push_back("non-dim");
+    }
 
     this->mInitialised = true;
 }
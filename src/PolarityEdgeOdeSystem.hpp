@@ -38,11 +38,16 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <cmath>
 #include <iostream>
 
-#include "AbstractOdeSystem.hpp"
+#include "AbstractReactionNetworkOdeSystem.hpp"
+#include "FixedSizeObjectPool.hpp"
+#include "PolarityEdgeReactionNetwork.hpp"
+#include "PolarityKineticParameters.hpp"
 
 /**
  * Represents the Delta-Notch ODE system described by Collier et al,
@@ -52,8 +57,16 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * Here, however, we include edge based model: Delta and Notch interactions between each cell
  * are modelled directly. We use similar ODE system as by Collier et al., except that we modify terms
  * corresponding to means of neighbour concentrations of Delta/Notch.
+ *
+ * The reactions are described in reaction_networks/PolarityEdge.rn, from which the
+ * right-hand side, Jacobian and species metadata (PolarityEdgeReactionNetwork) are generated.
+ *
+ * The parameters of the system are the eight neighbour levels only. The kinetic
+ * parameters are read through a pointer to an immutable PolarityKineticParameters
+ * block, which is shared by every edge using the same values rather than copied
+ * into each of them.
  */
-class PolarityEdgeOdeSystem : public AbstractOdeSystem
+class PolarityEdgeOdeSystem : public AbstractReactionNetworkOdeSystem
 {
 private:
 
@@ -67,13 +80,30 @@ private:
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractOdeSystem>(*this);
+        archive & boost::serialization::base_object<AbstractReactionNetworkOdeSystem>(*this);
+
+        // Blocks are archived as cell properties too, so go through the non-const type
+        boost::shared_ptr<PolarityKineticParameters> p_kinetic_parameters =
+            boost::const_pointer_cast<PolarityKineticParameters>(mpKineticParameters);
+        archive & p_kinetic_parameters;
+        mpKineticParameters = p_kinetic_parameters;
     }
+
+    /** The block of kinetic parameters used by this system; never empty. */
+    boost::shared_ptr<const PolarityKineticParameters> mpKineticParameters;
+
 public:
 
+    /** The number of kinetic parameters: KD1, KD2, k, K, VF, VS and w. */
+    static const unsigned NUM_KINETIC_PARAMETERS = PolarityEdgeReactionNetwork::NUM_KINETIC_PARAMETERS;
+
     /**
      * Default constructor.
      *
+     * The eight parameters hold the mean levels in the neighbouring edges, in the order
+     * of the state variables. The kinetic parameters are those of the block returned by
+     * PolarityKineticParameters::GetDefault() until SetKineticParameters() is called.
+     *
      * @param stateVariables optional initial conditions for state variables (only used in archiving)
      */
     PolarityEdgeOdeSystem(std::vector<double> stateVariables=std::vector<double>());
@@ -83,6 +113,66 @@ public:
      */
     ~PolarityEdgeOdeSystem();
 
+    /**
+     * @return the default values of the kinetic parameters KD1, KD2, k, K, VF, VS and w
+     */
+    static std::vector<double> GetDefaultKineticParameters();
+
+    /**
+     * @return the system information (names, units and default initial conditions) shared
+     *     by every system, rather than each allocating its own. Changing the default initial
+     *     conditions of one system therefore changes them for all.
+     */
+    static boost::shared_ptr<AbstractOdeSystemInformation> GetSharedSystemInformation();
+
+    /**
+     * @return the pool from which systems are allocated
+     */
+    static FixedSizeObjectPool* GetObjectPool();
+
+    /**
+     * Allocate a system from the pool, since every edge of a growing tissue has one.
+     * The state and parameter vectors are members of Chaste's AbstractParameterisedSystem
+     * and keep the standard allocator, so each still takes one small block of its own.
+     *
+     * @param size the size of the object
+     * @return memory for the object
+     */
+    static void* operator new(std::size_t size);
+
+    /**
+     * Return a system's memory to the pool.
+     *
+     * @param pObject the object
+     * @param size the size of the object
+     */
+    static void operator delete(void* pObject, std::size_t size);
+
+    /**
+     * Copy all the parameters of another system at once, rather than one by one
+     * through the virtual accessors, and share its block of kinetic parameters.
+     *
+     * @param rSystem the system to copy
+     */
+    void CopyParameters(const PolarityEdgeOdeSystem& rSystem);
+
+    /**
+     * @return all the parameters, which are the neighbour levels
+     */
+    const std::vector<double>& rGetParameters() const;
+
+    /**
+     * Set the block of kinetic parameters used by this system. The block is shared, not copied.
+     *
+     * @param pKineticParameters the block
+     */
+    void SetKineticParameters(boost::shared_ptr<const PolarityKineticParameters> pKineticParameters);
+
+    /**
+     * @return the block of kinetic parameters used by this system
+     */
+    boost::shared_ptr<const PolarityKineticParameters> GetKineticParameters() const;
+
     /**
      * Notch in this edge is inhibited by Delta in neighbouring edge. Cytoplasmic Notch is trafficked into
      * this junction.
@@ -91,6 +181,15 @@ public:
      * @param rDY filled in with the resulting derivatives (using  Collier et al. system of equations).
      */
     void EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY);
+
+    /**
+     * Overridden EvaluateJacobian() method, giving the analytic Jacobian of EvaluateYDerivatives().
+     *
+     * @param time used to evaluate the Jacobian.
+     * @param rY value of the solution vector used to evaluate the Jacobian.
+     * @param rJacobian filled in with the 8x8 Jacobian, stored by rows.
+     */
+    void EvaluateJacobian(double time, const std::vector<double>& rY, std::vector<double>& rJacobian) override;
 };
 
 // Declare identifier for the serializer
@@ -0,0 +1,119 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYEDGESPECIES_HPP_
+#define POLARITYEDGESPECIES_HPP_
+
+#include <array>
+
+#include "PolarityEdgeSrnModel.hpp"
+
+/**
+ * The species list of the polarity edge SRN, for EdgeSpeciesTrackingModifier.
+ *
+ * The species are listed in the order in which their levels are published: bound A,
+ * then the unbound proteins A, B and C, which diffuse within the membrane, then the
+ * complexes BA, AB, CA and AC. Every species is exchanged with neighbouring edges.
+ */
+struct PolarityEdgeSpecies
+{
+    /** The edge SRN model holding the species. */
+    typedef PolarityEdgeSrnModel SrnModel;
+
+    /** The number of species. */
+    static constexpr unsigned NUM_SPECIES = 8;
+
+    /**
+     * @param species the index of a species
+     * @return the name used in the CellEdgeData items of the species
+     */
+    static const char* GetName(unsigned species)
+    {
+        static const char* const names[NUM_SPECIES] = {"boundA", "A", "B", "C", "BA", "AB", "CA", "AC"};
+        return names[species];
+    }
+
+    /**
+     * @param species the index of a species
+     * @return whether the species diffuses around the edges of a cell
+     */
+    static constexpr bool IsDiffusing(unsigned species)
+    {
+        return species >= 1 && species <= 3;
+    }
+
+    /**
+     * @param species the index of a species
+     * @return whether the mean level of the species in neighbouring edges is published
+     */
+    static constexpr bool IsExchanged(unsigned species)
+    {
+        return true;
+    }
+
+    /**
+     * @param rSrnModel an edge SRN model
+     * @param rLevels filled in with the level of each species
+     */
+    static void GetLevels(SrnModel& rSrnModel, std::array<double, NUM_SPECIES>& rLevels)
+    {
+        rLevels[0] = rSrnModel.GetBoundA();
+        rLevels[1] = rSrnModel.GetA();
+        rLevels[2] = rSrnModel.GetB();
+        rLevels[3] = rSrnModel.GetC();
+        rLevels[4] = rSrnModel.GetBA();
+        rLevels[5] = rSrnModel.GetAB();
+        rLevels[6] = rSrnModel.GetCA();
+        rLevels[7] = rSrnModel.GetAC();
+    }
+
+    /**
+     * @param rSrnModel an edge SRN model
+     * @param rLevels the level of each species
+     */
+    static void SetLevels(SrnModel& rSrnModel, const std::array<double, NUM_SPECIES>& rLevels)
+    {
+        rSrnModel.SetBoundA(rLevels[0]);
+        rSrnModel.SetA(rLevels[1]);
+        rSrnModel.SetB(rLevels[2]);
+        rSrnModel.SetC(rLevels[3]);
+        rSrnModel.SetBA(rLevels[4]);
+        rSrnModel.SetAB(rLevels[5]);
+        rSrnModel.SetCA(rLevels[6]);
+        rSrnModel.SetAC(rLevels[7]);
+    }
+};
+
+#endif /*POLARITYEDGESPECIES_HPP_*/
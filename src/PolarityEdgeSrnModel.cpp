@@ -28,27 +28,43 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "PolarityEdgeSrnModel.hpp"
+#include "Exception.hpp"
+#include "FixedSizeObjectPoolAllocator.hpp"
+#include "PolarityEdgeActivityTracker.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityKineticParameters.hpp"
+#include "SimulationTime.hpp"
+
+#include <algorithm>
+#include <boost/checked_delete.hpp>
 
 PolarityEdgeSrnModel::PolarityEdgeSrnModel(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver)
-    : AbstractOdeSrnModel(8, pOdeSolver)
+    : AbstractOdeSrnModel(8, pOdeSolver),
+      mIsDormant(false),
+      mIsLocallyOwned(true),
+      mpCellEdgeDataOwner(nullptr)
 {
     if (mpOdeSolver == boost::shared_ptr<AbstractCellCycleModelOdeSolver>())
     {
-#ifdef CHASTE_CVODE
-        mpOdeSolver = CellCycleModelOdeSolver<PolarityEdgeSrnModel, CvodeAdaptor>::Instance();
-        mpOdeSolver->Initialise();
-        mpOdeSolver->SetMaxSteps(10000);
-#else
-        mpOdeSolver = CellCycleModelOdeSolver<PolarityEdgeSrnModel, RungeKutta4IvpOdeSolver>::Instance();
-        mpOdeSolver->Initialise();
-        SetDt(0.001);
-#endif //CHASTE_CVODE
+        // The solver is chosen at run time, see PolarityEdgeOdeSolverRegistry
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        const std::string& r_solver_name = p_registry->rGetActiveSolver();
+        mpOdeSolver = p_registry->CreateSolver(r_solver_name);
+        const double dt = p_registry->GetDefaultDt(r_solver_name);
+        if (dt > 0.0)
+        {
+            SetDt(dt);
+        }
     }
     assert(mpOdeSolver->IsSetUp());
 }
 
 PolarityEdgeSrnModel::PolarityEdgeSrnModel(const PolarityEdgeSrnModel& rModel)
-    : AbstractOdeSrnModel(rModel)
+    : AbstractOdeSrnModel(rModel),
+      mpKineticParameters(rModel.mpKineticParameters),
+      mIsDormant(false),
+      mIsLocallyOwned(true),
+      mpCellEdgeDataOwner(nullptr)
 {
     /*
      * Set each member variable of the new SRN model that inherits
@@ -65,10 +81,14 @@ PolarityEdgeSrnModel::PolarityEdgeSrnModel(const PolarityEdgeSrnModel& rModel)
      * in parent classes will be defined there.
      */
     assert(rModel.GetOdeSystem());
-    AbstractOdeSystem* p_parent_system(rModel.GetOdeSystem());
-    SetOdeSystem(new PolarityEdgeOdeSystem(p_parent_system->rGetStateVariables()));
-    for (unsigned int i=0; i < p_parent_system->GetNumberOfParameters(); ++i)
-        mpOdeSystem->SetParameter(i, p_parent_system->GetParameter(i));
+    PolarityEdgeOdeSystem* p_parent_system = static_cast<PolarityEdgeOdeSystem*>(rModel.GetOdeSystem());
+    PolarityEdgeOdeSystem* p_system = new PolarityEdgeOdeSystem(p_parent_system->rGetStateVariables());
+    p_system->CopyParameters(*p_parent_system);
+
+    // Keep the adaptive step and multirate hints, so the daughter does not restart from scratch
+    p_system->SetSuggestedTimeStep(p_parent_system->GetSuggestedTimeStep());
+    p_system->SetFastSpeciesHint(p_parent_system->rGetFastSpeciesHint());
+    SetOdeSystem(p_system);
 }
 
 AbstractSrnModel* PolarityEdgeSrnModel::CreateSrnModel()
@@ -76,17 +96,172 @@ AbstractSrnModel* PolarityEdgeSrnModel::CreateSrnModel()
     return new PolarityEdgeSrnModel(*this);
 }
 
+boost::shared_ptr<PolarityEdgeSrnModel> PolarityEdgeSrnModel::Create(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver)
+{
+    return boost::shared_ptr<PolarityEdgeSrnModel>(new PolarityEdgeSrnModel(pOdeSolver),
+                                                   boost::checked_deleter<PolarityEdgeSrnModel>(),
+                                                   FixedSizeObjectPoolAllocator<PolarityEdgeSrnModel>(GetControlBlockPool()));
+}
+
+FixedSizeObjectPool* PolarityEdgeSrnModel::GetObjectPool()
+{
+    // Never destroyed, as SRN models may be freed during static destruction
+    static FixedSizeObjectPool* p_pool = new FixedSizeObjectPool(sizeof(PolarityEdgeSrnModel));
+    return p_pool;
+}
+
+FixedSizeObjectPool* PolarityEdgeSrnModel::GetControlBlockPool()
+{
+    // Never destroyed, for the same reason. A control block holds a few pointers and two counts.
+    static FixedSizeObjectPool* p_pool = new FixedSizeObjectPool(8*sizeof(void*));
+    return p_pool;
+}
+
+void* PolarityEdgeSrnModel::operator new(std::size_t size)
+{
+    if (size != sizeof(PolarityEdgeSrnModel))
+    {
+        // A subclass
+        return ::operator new(size);
+    }
+    return GetObjectPool()->Allocate();
+}
+
+void PolarityEdgeSrnModel::operator delete(void* pObject, std::size_t size)
+{
+    if (size != sizeof(PolarityEdgeSrnModel))
+    {
+        ::operator delete(pObject);
+        return;
+    }
+    GetObjectPool()->Deallocate(pObject);
+}
+
 void PolarityEdgeSrnModel::SimulateToCurrentTime()
 {
+    if (!mIsLocallyOwned)
+    {
+        // The owning process integrates this edge and sends us its levels
+        SetSimulatedToTime(SimulationTime::Instance()->GetTime());
+        return;
+    }
+
     // Update information before running simulation
     UpdatePolarity();
-    // Run the ODE simulation as needed
+
+    PolarityEdgeActivityTracker* p_tracker = PolarityEdgeActivityTracker::Instance();
+    const double current_time = SimulationTime::Instance()->GetTime();
+    if (!p_tracker->IsEnabled())
+    {
+        mIsDormant = false;
+
+        // Run the ODE simulation as needed
+        AbstractOdeSrnModel::SimulateToCurrentTime();
+        return;
+    }
+    if (current_time <= GetSimulatedToTime())
+    {
+        return;
+    }
+
+    // Wake a dormant edge if its own state or its neighbours have moved on
+    if (mIsDormant
+        && (p_tracker->HasInputChanged(mDormantState.data(), mpOdeSystem->rGetStateVariables())
+            || p_tracker->HasInputChanged(mDormantParameters.data(), rGetNeighbourParameters())))
+    {
+        mIsDormant = false;
+        p_tracker->RecordWakeUp();
+    }
+
+    if (mIsDormant)
+    {
+        // The edge is at equilibrium, so advancing it to the current time changes nothing
+        SetSimulatedToTime(current_time);
+        p_tracker->RecordSolve(true);
+        return;
+    }
+
     AbstractOdeSrnModel::SimulateToCurrentTime();
+    p_tracker->RecordSolve(false);
+
+    // Working memory shared by the edges, rather than a buffer in each; the snapshots are held in the model
+    static thread_local std::vector<double> derivatives(PolarityEdgeReactionNetwork::NUM_SPECIES);
+    mpOdeSystem->EvaluateYDerivatives(current_time, mpOdeSystem->rGetStateVariables(), derivatives);
+    if (p_tracker->IsQuiescent(derivatives))
+    {
+        mIsDormant = true;
+        const std::vector<double>& r_state = mpOdeSystem->rGetStateVariables();
+        const std::vector<double>& r_parameters = rGetNeighbourParameters();
+        std::copy(r_state.begin(), r_state.end(), mDormantState.begin());
+        std::copy(r_parameters.begin(), r_parameters.end(), mDormantParameters.begin());
+    }
+}
+
+bool PolarityEdgeSrnModel::IsDormant() const
+{
+    return mIsDormant;
+}
+
+void PolarityEdgeSrnModel::SetIsLocallyOwned(bool isLocallyOwned)
+{
+    mIsLocallyOwned = isLocallyOwned;
+}
+
+bool PolarityEdgeSrnModel::IsLocallyOwned() const
+{
+    return mIsLocallyOwned;
+}
+
+void PolarityEdgeSrnModel::SetKineticParameters(const std::vector<double>& rKineticParameters)
+{
+    if (rKineticParameters.size() != PolarityEdgeOdeSystem::NUM_KINETIC_PARAMETERS)
+    {
+        EXCEPTION("A polarity edge needs " << PolarityEdgeOdeSystem::NUM_KINETIC_PARAMETERS << " kinetic parameters, not "
+                  << rKineticParameters.size() << ".");
+    }
+    mpKineticParameters.reset(new PolarityKineticParameters(rKineticParameters));
+    if (mpOdeSystem != nullptr)
+    {
+        ApplyKineticParameters();
+    }
+}
+
+void PolarityEdgeSrnModel::ApplyKineticParameters()
+{
+    assert(mpOdeSystem != nullptr);
+
+    // The edge's own block takes precedence over its cell's block
+    boost::shared_ptr<const PolarityKineticParameters> p_block = mpKineticParameters;
+    if (!p_block && mpCell)
+    {
+        p_block = PolarityKineticParameters::GetFromCell(mpCell);
+    }
+    if (!p_block)
+    {
+        p_block = PolarityKineticParameters::GetDefault();
+    }
+    static_cast<PolarityEdgeOdeSystem*>(mpOdeSystem)->SetKineticParameters(p_block);
+}
+
+std::vector<double> PolarityEdgeSrnModel::GetKineticParameters() const
+{
+    if (mpOdeSystem == nullptr)
+    {
+        return mpKineticParameters ? mpKineticParameters->rGetValues() : PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+    }
+    return static_cast<const PolarityEdgeOdeSystem*>(GetOdeSystem())->GetKineticParameters()->rGetValues();
+}
+
+const std::vector<double>& PolarityEdgeSrnModel::rGetNeighbourParameters() const
+{
+    assert(mpOdeSystem != nullptr);
+    return static_cast<const PolarityEdgeOdeSystem*>(GetOdeSystem())->rGetParameters();
 }
 
 void PolarityEdgeSrnModel::Initialise()
 {
     AbstractOdeSrnModel::Initialise(new PolarityEdgeOdeSystem);
+    ApplyKineticParameters();
 }
 
 void PolarityEdgeSrnModel::InitialiseDaughterCell()
@@ -121,38 +296,29 @@ void PolarityEdgeSrnModel::UpdatePolarity()
     assert(mpOdeSystem != nullptr);
     assert(mpCell != nullptr);
 
-    double neigh_A
-    = mpCell->GetCellEdgeData()->GetItem("neighbour A")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour A", neigh_A);
-    
-    double neigh_boundA
-    = mpCell->GetCellEdgeData()->GetItem("neighbour boundA")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour boundA", neigh_boundA);
-
-    double neigh_B
-    = mpCell->GetCellEdgeData()->GetItem("neighbour B")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour B", neigh_B);
-
-    double neigh_C
-    = mpCell->GetCellEdgeData()->GetItem("neighbour C")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour C", neigh_C);
-
-    double neigh_BA
-    = mpCell->GetCellEdgeData()->GetItem("neighbour BA")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour BA", neigh_BA);
-
-    double neigh_AB
-    = mpCell->GetCellEdgeData()->GetItem("neighbour AB")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour AB", neigh_AB);
-
-    double neigh_CA
-    = mpCell->GetCellEdgeData()->GetItem("neighbour CA")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour CA", neigh_CA);
-
-    double neigh_AC
-    = mpCell->GetCellEdgeData()->GetItem("neighbour AC")[this->GetEdgeLocalIndex()];
-    mpOdeSystem->SetParameter("neighbour AC", neigh_AC);
+    // The names of the inputs, which are the parameters, built once rather than at every call
+    static const std::vector<std::string> input_names = []()
+    {
+        std::vector<std::string> names;
+        for (unsigned i = 0; i < PolarityEdgeReactionNetwork::NUM_INPUTS; i++)
+        {
+            names.push_back(PolarityEdgeReactionNetwork::GetInputName(i));
+        }
+        return names;
+    }();
+
+    if (mpCellEdgeDataOwner != mpCell.get())
+    {
+        mpCellEdgeData = mpCell->GetCellEdgeData();
+        mpCellEdgeDataOwner = mpCell.get();
+    }
 
+    // Read the neighbour levels in place, rather than copying each CellEdgeData item
+    const unsigned edge_index = this->GetEdgeLocalIndex();
+    for (unsigned i = 0; i < PolarityEdgeReactionNetwork::NUM_INPUTS; i++)
+    {
+        mpOdeSystem->SetParameter(i, mpCellEdgeData->GetItemAtIndex(input_names[i], edge_index));
+    }
 }
 
 double PolarityEdgeSrnModel::GetA()
@@ -262,7 +428,7 @@ void PolarityEdgeSrnModel::SetAC(double value)
 double PolarityEdgeSrnModel::GetNeighbouringBoundA() const
 {
     assert(mpOdeSystem != nullptr);
-    return mpOdeSystem->GetParameter("neighbour BoundA");
+    return mpOdeSystem->GetParameter("neighbour boundA");
 }
 
 double PolarityEdgeSrnModel::GetNeighbouringA() const
@@ -372,3 +538,10 @@ void PolarityEdgeSrnModel::SplitEdgeSrn(const double relative_position)
 CHASTE_CLASS_EXPORT(PolarityEdgeSrnModel)
 #include "CellCycleModelOdeSolverExportWrapper.hpp"
 EXPORT_CELL_CYCLE_MODEL_ODE_SOLVER(PolarityEdgeSrnModel)
+
+// The project-specific solvers are not covered by the macro above; their typedefs are in the header
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelRosenbrockWIvpOdeSolver)
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelModifiedPatankarRungeKuttaIvpOdeSolver)
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelMultirateIvpOdeSolver)
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelBufferedRungeKutta4IvpOdeSolver)
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelBufferedModifiedPatankarRungeKuttaIvpOdeSolver)
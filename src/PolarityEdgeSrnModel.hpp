@@ -39,9 +39,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 
+#include <array>
+
 #include "PolarityEdgeOdeSystem.hpp"
 #include "AbstractOdeSrnModel.hpp"
 
+class CellEdgeData;
+
 /**
  * A subclass of AbstractOdeSrnModel that includes a A-BoundA ODE system in the sub-cellular reaction network.
  * This SRN model represents a membrane/cortex of a single junction of a cell. This class of models can be used together
@@ -66,8 +70,46 @@ private:
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractOdeSrnModel>(*this);
+        archive & mpKineticParameters;
+        // Dormancy is not archived; a loaded edge is integrated until it falls dormant again
+        // Ownership is not archived either; it is set again when the cells are partitioned
     }
 
+    /**
+     * The block of kinetic parameters given to this edge by SetKineticParameters(),
+     * overriding that of its cell. Empty unless SetKineticParameters() has been called.
+     */
+    boost::shared_ptr<PolarityKineticParameters> mpKineticParameters;
+
+    /** Whether this edge is dormant, see PolarityEdgeActivityTracker. */
+    bool mIsDormant;
+
+    /**
+     * Whether this edge belongs to a cell owned by this process, see
+     * PolarityEdgeDomainDecomposition. Defaults to true.
+     */
+    bool mIsLocallyOwned;
+
+    /** The state variables when this edge fell dormant, held in the (pooled) model itself. */
+    std::array<double, PolarityEdgeReactionNetwork::NUM_SPECIES> mDormantState;
+
+    /** The neighbour parameters when this edge fell dormant, held in the (pooled) model itself. */
+    std::array<double, PolarityEdgeReactionNetwork::NUM_INPUTS> mDormantParameters;
+
+    /**
+     * The CellEdgeData of the cell last seen by UpdatePolarity(), kept since
+     * Cell::GetCellEdgeData() searches (and copies) the cell's properties. Not archived.
+     */
+    boost::shared_ptr<CellEdgeData> mpCellEdgeData;
+
+    /** The cell whose CellEdgeData is held in mpCellEdgeData, or nullptr. */
+    const Cell* mpCellEdgeDataOwner;
+
+    /**
+     * @return the current values of the ODE system parameters, which hold the neighbour levels
+     */
+    const std::vector<double>& rGetNeighbourParameters() const;
+
 protected:
 
     /**
@@ -87,7 +129,8 @@ protected:
 public:
 
     /**
-     * Default constructor calls base class.
+     * Default constructor calls base class. If no ODE solver is given, the solver that is
+     * currently active in PolarityEdgeOdeSolverRegistry is used, with its registered time step.
      *
      * @param pOdeSolver An optional pointer to a cell-cycle model ODE solver object (allows the use of different ODE solvers)
      */
@@ -100,6 +143,45 @@ public:
      */
     virtual AbstractSrnModel* CreateSrnModel() override;
 
+    /**
+     * Create an SRN model owned by a shared pointer whose control block, like the model
+     * itself, comes from a pool rather than the heap. Use this rather than MAKE_PTR when
+     * building many edges. (Copies made on division are wrapped by Chaste's CellSrnModel,
+     * so their control blocks still come from the heap.)
+     *
+     * @param pOdeSolver an optional ODE solver, as for the constructor
+     * @return the new SRN model
+     */
+    static boost::shared_ptr<PolarityEdgeSrnModel> Create(
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver = boost::shared_ptr<AbstractCellCycleModelOdeSolver>());
+
+    /**
+     * @return the pool from which SRN models are allocated
+     */
+    static FixedSizeObjectPool* GetObjectPool();
+
+    /**
+     * @return the pool from which the control blocks of the shared pointers made by Create() are allocated
+     */
+    static FixedSizeObjectPool* GetControlBlockPool();
+
+    /**
+     * Allocate an SRN model from the pool, since edges are created and destroyed
+     * throughout the growth of a tissue.
+     *
+     * @param size the size of the object
+     * @return memory for the object
+     */
+    static void* operator new(std::size_t size);
+
+    /**
+     * Return an SRN model's memory to the pool, for reuse by the next edge created.
+     *
+     * @param pObject the object
+     * @param size the size of the object
+     */
+    static void operator delete(void* pObject, std::size_t size);
+
     /**
      * Initialise the SRN model at the start of a simulation.
      *
@@ -115,10 +197,55 @@ public:
     /**
      * Overridden SimulateToTime() method for custom behaviour.
      * Updates parameters (such as neighbour or interior A/BoundA) and
-     * runs the simulation to current time
+     * runs the simulation to current time.
+     *
+     * If PolarityEdgeActivityTracker is enabled, an edge that has reached equilibrium
+     * falls dormant and is not integrated until its state or neighbour levels change.
+     * An edge owned by another process is never integrated here.
      */
     virtual void SimulateToCurrentTime() override;
 
+    /**
+     * @return whether this edge is currently dormant, see PolarityEdgeActivityTracker
+     */
+    bool IsDormant() const;
+
+    /**
+     * Set whether this edge belongs to a cell owned by this process. The ODE system of an
+     * edge owned by another process is not integrated; its levels are received from that
+     * process instead, see PolarityEdgeDomainDecomposition.
+     *
+     * @param isLocallyOwned whether this edge is owned by this process
+     */
+    void SetIsLocallyOwned(bool isLocallyOwned);
+
+    /**
+     * @return whether this edge belongs to a cell owned by this process
+     */
+    bool IsLocallyOwned() const;
+
+    /**
+     * Set the kinetic parameters of this edge, overriding any PolarityKineticParameters
+     * block carried by its cell. May be called before or after Initialise(). The values
+     * are held in a block of their own, which is shared with the edge's daughters.
+     *
+     * @param rKineticParameters the values of KD1, KD2, k, K, VF, VS and w
+     */
+    void SetKineticParameters(const std::vector<double>& rKineticParameters);
+
+    /**
+     * Point the ODE system of this edge at its block of kinetic parameters: the one given
+     * to SetKineticParameters() if any, otherwise the PolarityKineticParameters block
+     * carried by its cell, otherwise PolarityKineticParameters::GetDefault(). Called by
+     * Initialise() and PolarityKineticParameters::AssignToCell().
+     */
+    void ApplyKineticParameters();
+
+    /**
+     * @return the kinetic parameters KD1, KD2, k, K, VF, VS and w of this edge
+     */
+    std::vector<double> GetKineticParameters() const;
+
     /**
      * Update the levels of A and BoundA of neighbouring edge sensed by this edge
      * That is, fetch neighbour values from CellEdgeData object, storing the sensed information,
@@ -315,4 +442,22 @@ CHASTE_CLASS_EXPORT(PolarityEdgeSrnModel)
 #include "CellCycleModelOdeSolverExportWrapper.hpp"
 EXPORT_CELL_CYCLE_MODEL_ODE_SOLVER(PolarityEdgeSrnModel)
 
+// The project-specific solvers are not covered by the macro above
+#include "BufferedOneStepIvpOdeSolver.hpp"
+#include "ModifiedPatankarRungeKuttaIvpOdeSolver.hpp"
+#include "MultirateIvpOdeSolver.hpp"
+#include "RosenbrockWIvpOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "CellCycleModelOdeSolver.hpp"
+typedef CellCycleModelOdeSolver<PolarityEdgeSrnModel, RosenbrockWIvpOdeSolver> CellCycleModelOdeSolverPolarityEdgeSrnModelRosenbrockWIvpOdeSolver;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelRosenbrockWIvpOdeSolver)
+typedef CellCycleModelOdeSolver<PolarityEdgeSrnModel, ModifiedPatankarRungeKuttaIvpOdeSolver> CellCycleModelOdeSolverPolarityEdgeSrnModelModifiedPatankarRungeKuttaIvpOdeSolver;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelModifiedPatankarRungeKuttaIvpOdeSolver)
+typedef CellCycleModelOdeSolver<PolarityEdgeSrnModel, MultirateIvpOdeSolver> CellCycleModelOdeSolverPolarityEdgeSrnModelMultirateIvpOdeSolver;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelMultirateIvpOdeSolver)
+typedef CellCycleModelOdeSolver<PolarityEdgeSrnModel, BufferedOneStepIvpOdeSolver<RungeKutta4IvpOdeSolver> > CellCycleModelOdeSolverPolarityEdgeSrnModelBufferedRungeKutta4IvpOdeSolver;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelBufferedRungeKutta4IvpOdeSolver)
+typedef CellCycleModelOdeSolver<PolarityEdgeSrnModel, BufferedOneStepIvpOdeSolver<ModifiedPatankarRungeKuttaIvpOdeSolver> > CellCycleModelOdeSolverPolarityEdgeSrnModelBufferedModifiedPatankarRungeKuttaIvpOdeSolver;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverPolarityEdgeSrnModelBufferedModifiedPatankarRungeKuttaIvpOdeSolver)
+
 #endif  /* POLARITYEDGESRNMODEL_HPP_ */
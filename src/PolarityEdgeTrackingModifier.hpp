@@ -39,22 +39,43 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 
-
-#include "AbstractCellBasedSimulationModifier.hpp"
-
+#include "EdgeSpeciesTrackingModifier.hpp"
+#include "PolarityEdgeDomainDecomposition.hpp"
+#include "PolarityEdgeSpecies.hpp"
+
+/**
+ * Tracks the levels of the polarity edge SRN species, see PolarityEdgeSpecies. The unbound
+ * proteins A, B and C diffuse within the membrane; every species is exchanged with
+ * neighbouring edges.
+ *
+ * On top of EdgeSpeciesTrackingModifier, the cells may be shared between MPI processes,
+ * see PolarityEdgeDomainDecomposition. The levels of every cell are then gathered to every
+ * process before they are published at each step where output may be sampled, so that the
+ * population writers and AsyncEdgeDataOutputModifier see current levels for all cells.
+ */
 template<unsigned DIM>
-class PolarityEdgeTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+class PolarityEdgeTrackingModifier : public EdgeSpeciesTrackingModifier<DIM, PolarityEdgeSpecies>
 {
 
   private:
 
     /**
-     * Diffusion coefficient of unbound protein concentrations within the plasma 
-     * membrane. Stored in this class, rather than in FtDsEdgeSrnModel or in 
-     * FtDsEdgeOdeSystem, since it is only used in this class. Initialised to 
-     * 0.03 in the constructor.
+     * Whether to share the cells between the MPI processes, each integrating and
+     * diffusing only the edges of its own cells. Initialised to false in the constructor.
+     */
+    bool mUseDomainDecomposition;
+
+    /**
+     * The number of time steps between gathers of the levels of every cell to every
+     * process, when the tissue is decomposed. Initialised to 1 in the constructor.
      */
-    double mUnboundProteinDiffusionCoefficient;
+    unsigned mGatherTimestepMultiple;
+
+    /** The assignment of cells to processes, set up in SetupSolve() if mUseDomainDecomposition is true. */
+    boost::shared_ptr<PolarityEdgeDomainDecomposition<DIM> > mpDomainDecomposition;
+
+    /** The locally owned cells with no edge on a process boundary, reused by DiffuseEdgeSpecies(). */
+    std::vector<CellPtr> mInteriorCells;
 
     /** Needed for serialization. */
     friend class boost::serialization::access;
@@ -68,10 +89,39 @@ class PolarityEdgeTrackingModifier : public AbstractCellBasedSimulationModifier<
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
-        archive & mUnboundProteinDiffusionCoefficient;
+        archive & boost::serialization::base_object<EdgeSpeciesTrackingModifier<DIM, PolarityEdgeSpecies> >(*this);
+        archive & mUseDomainDecomposition;
+        archive & mGatherTimestepMultiple;
     }
 
+protected:
+
+    /**
+     * Overridden IsLocallyOwned() method.
+     *
+     * @param locationIndex the location index of a cell
+     * @return whether the cell is owned by this process
+     */
+    virtual bool IsLocallyOwned(unsigned locationIndex) const override;
+
+    /**
+     * Overridden ReduceDrift() method. If the tissue is decomposed, takes the largest
+     * drift over all processes, so that they all exchange at the same steps, and refuses
+     * any change of topology after partitioning.
+     *
+     * @param rMaxDrift the largest drift over this process's cells, updated in place
+     * @param topologyChanged whether the cells or edges have changed since the last exchange
+     */
+    virtual void ReduceDrift(double& rMaxDrift, bool topologyChanged) override;
+
+    /**
+     * Overridden SynchroniseLevels() method. If the tissue is decomposed, gathers the
+     * levels of every cell to every process at every mGatherTimestepMultiple-th step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void SynchroniseLevels(AbstractCellPopulation<DIM,DIM>& rCellPopulation) override;
+
 public:
 
     /**
@@ -85,34 +135,68 @@ public:
     virtual ~PolarityEdgeTrackingModifier();
 
     /**
-     * Overridden UpdateAtEndOfTimeStep() method.
-     *
-     * Specifies what to do in the simulation at the end of each time step.
+     * @param diffusionCoefficient the diffusion coefficient of unbound proteins within the membrane
+     */
+    void SetUnboundProteinDiffusionCoefficient(double diffusionCoefficient);
+
+    /**
+     * @return the diffusion coefficient of unbound proteins within the membrane
+     */
+    double GetUnboundProteinDiffusionCoefficient() const;
+
+    /**
+     * Set whether to share the cells between the MPI processes, see
+     * PolarityEdgeDomainDecomposition. The tissue topology must then stay fixed.
      *
-     * @param rCellPopulation reference to the cell population
+     * @param useDomainDecomposition whether to decompose the tissue
+     */
+    void SetUseDomainDecomposition(bool useDomainDecomposition);
+
+    /**
+     * @return whether the cells are shared between the MPI processes
      */
-    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+    bool GetUseDomainDecomposition() const;
 
     /**
-     * Overridden SetupSolve() method.
+     * @return the assignment of cells to processes, or a null pointer if the tissue
+     *     is not decomposed or SetupSolve() has not yet been called
+     */
+    boost::shared_ptr<PolarityEdgeDomainDecomposition<DIM> > GetDomainDecomposition() const;
+
+    /**
+     * Set the number of time steps between gathers of the levels of every cell to every
+     * process, when the tissue is decomposed. Between gathers, cells owned by another
+     * process publish stale levels, so this must divide the sampling timestep multiple
+     * of the simulation and of any AsyncEdgeDataOutputModifier.
      *
-     * Specifies what to do in the simulation before the start of the time loop.
+     * @param gatherTimestepMultiple the number of time steps between gathers
+     */
+    void SetGatherTimestepMultiple(unsigned gatherTimestepMultiple);
+
+    /**
+     * @return the number of time steps between gathers of the levels of every cell
+     */
+    unsigned GetGatherTimestepMultiple() const;
+
+    /**
+     * Overridden SetupSolve() method. Partitions the cells first if the tissue is decomposed.
      *
      * @param rCellPopulation reference to the cell population
      * @param outputDirectory the output directory, relative to where Chaste output is stored
      */
-    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory) override;
 
     /**
-     * Helper method to compute the mean level of Delta in each cell's neighbours and store these in the CellData.
+     * Overridden DiffuseEdgeSpecies() method.
      *
-     * Note: If using a CaBasedCellPopulation, we assume a Moore neighbourhood and unit carrying capacity.
-     * If a cell has no neighbours (such as an isolated cell in a CaBasedCellPopulation), we store the
-     * value -1 in the CellData.
+     * If the tissue is decomposed, only this process's cells are diffused. The cells on the
+     * boundary of its part go first, so that their levels can be sent to the neighbouring
+     * processes while the interior cells are diffused.
      *
      * @param rCellPopulation reference to the cell population
+     * @param dt the time step
      */
-    void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+    virtual void DiffuseEdgeSpecies(AbstractCellPopulation<DIM,DIM>& rCellPopulation, double dt) override;
 
     /**
      * Overridden OutputSimulationModifierParameters() method.
@@ -0,0 +1,214 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "PolarityInitialConditionTable.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Exception.hpp"
+
+const char PolarityInitialConditionTable::MAGIC[8] = {'P', 'E', 'D', 'G', 'E', 'I', 'C', '1'};
+
+/** The size of the header of a table file: the magic characters and two 32-bit counts. */
+static const std::size_t HEADER_SIZE = 8 + 2*sizeof(uint32_t);
+
+PolarityInitialConditionTable::PolarityInitialConditionTable()
+    : mNumSpecies(0),
+      mNumCells(0),
+      mpMappedData(nullptr),
+      mMappedSize(0),
+      mpFirstEdge(nullptr),
+      mpBirthTimes(nullptr),
+      mpLevels(nullptr)
+{
+}
+
+PolarityInitialConditionTable::PolarityInitialConditionTable(unsigned numSpecies,
+                                                             const std::vector<unsigned>& rNumEdges,
+                                                             const std::vector<double>& rBirthTimes,
+                                                             const std::vector<double>& rLevels)
+    : mNumSpecies(numSpecies),
+      mNumCells(rNumEdges.size()),
+      mFirstEdgeStorage(1, 0),
+      mBirthTimeStorage(rBirthTimes),
+      mLevelStorage(rLevels),
+      mpMappedData(nullptr),
+      mMappedSize(0)
+{
+    if (rBirthTimes.size() != rNumEdges.size())
+    {
+        EXCEPTION("An initial condition table needs a birth time for each of its " << rNumEdges.size() << " cells.");
+    }
+    mFirstEdgeStorage.reserve(mNumCells + 1);
+    for (unsigned num_edges : rNumEdges)
+    {
+        mFirstEdgeStorage.push_back(mFirstEdgeStorage.back() + num_edges);
+    }
+    if (rLevels.size() != mFirstEdgeStorage.back()*numSpecies)
+    {
+        EXCEPTION("An initial condition table of " << mFirstEdgeStorage.back() << " edges and " << numSpecies
+                  << " species needs " << mFirstEdgeStorage.back()*numSpecies << " levels, not " << rLevels.size() << ".");
+    }
+
+    mpFirstEdge = &mFirstEdgeStorage[0];
+    mpBirthTimes = mBirthTimeStorage.data();
+    mpLevels = mLevelStorage.data();
+}
+
+PolarityInitialConditionTable::~PolarityInitialConditionTable()
+{
+    if (mpMappedData)
+    {
+        munmap(mpMappedData, mMappedSize);
+    }
+}
+
+boost::shared_ptr<PolarityInitialConditionTable> PolarityInitialConditionTable::Load(const std::string& rPath)
+{
+    int file_descriptor = open(rPath.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+    {
+        EXCEPTION("Could not open the initial condition table " << rPath << ".");
+    }
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) != 0 || std::size_t(file_status.st_size) < HEADER_SIZE)
+    {
+        close(file_descriptor);
+        EXCEPTION(rPath << " is not an initial condition table.");
+    }
+
+    boost::shared_ptr<PolarityInitialConditionTable> p_table(new PolarityInitialConditionTable());
+    p_table->mMappedSize = file_status.st_size;
+    void* p_data = mmap(nullptr, p_table->mMappedSize, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    close(file_descriptor);
+    if (p_data == MAP_FAILED)
+    {
+        EXCEPTION("Could not map the initial condition table " << rPath << ".");
+    }
+    p_table->mpMappedData = p_data;
+
+    // The header
+    const char* p_bytes = static_cast<const char*>(p_data);
+    uint32_t counts[2];
+    std::memcpy(counts, p_bytes + 8, sizeof(counts));
+    if (std::memcmp(p_bytes, MAGIC, 8) != 0)
+    {
+        EXCEPTION(rPath << " is not an initial condition table.");
+    }
+    p_table->mNumSpecies = counts[0];
+    p_table->mNumCells = counts[1];
+
+    // The arrays follow, each aligned as the page-aligned mapping is
+    const std::size_t first_edge_offset = HEADER_SIZE;
+    const std::size_t birth_time_offset = first_edge_offset + (std::size_t(p_table->mNumCells) + 1)*sizeof(uint64_t);
+    const std::size_t level_offset = birth_time_offset + std::size_t(p_table->mNumCells)*sizeof(double);
+    if (level_offset > p_table->mMappedSize)
+    {
+        EXCEPTION("The initial condition table " << rPath << " is truncated.");
+    }
+    p_table->mpFirstEdge = reinterpret_cast<const uint64_t*>(p_bytes + first_edge_offset);
+    p_table->mpBirthTimes = reinterpret_cast<const double*>(p_bytes + birth_time_offset);
+    p_table->mpLevels = reinterpret_cast<const double*>(p_bytes + level_offset);
+    if (level_offset + p_table->GetNumEdges()*p_table->mNumSpecies*sizeof(double) != p_table->mMappedSize)
+    {
+        EXCEPTION("The initial condition table " << rPath << " is truncated.");
+    }
+    return p_table;
+}
+
+void PolarityInitialConditionTable::Write(const std::string& rPath) const
+{
+    std::ofstream file(rPath.c_str(), std::ios::binary);
+    if (!file)
+    {
+        EXCEPTION("Could not write the initial condition table " << rPath << ".");
+    }
+    const uint32_t counts[2] = {mNumSpecies, mNumCells};
+    file.write(MAGIC, 8);
+    file.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    file.write(reinterpret_cast<const char*>(mpFirstEdge), (std::size_t(mNumCells) + 1)*sizeof(uint64_t));
+    file.write(reinterpret_cast<const char*>(mpBirthTimes), std::size_t(mNumCells)*sizeof(double));
+    file.write(reinterpret_cast<const char*>(mpLevels), GetNumEdges()*mNumSpecies*sizeof(double));
+    if (!file)
+    {
+        EXCEPTION("Could not write the initial condition table " << rPath << ".");
+    }
+}
+
+unsigned PolarityInitialConditionTable::GetNumSpecies() const
+{
+    return mNumSpecies;
+}
+
+unsigned PolarityInitialConditionTable::GetNumCells() const
+{
+    return mNumCells;
+}
+
+std::size_t PolarityInitialConditionTable::GetNumEdges() const
+{
+    return mpFirstEdge[mNumCells];
+}
+
+unsigned PolarityInitialConditionTable::GetNumEdges(unsigned cell) const
+{
+    assert(cell < mNumCells);
+    return mpFirstEdge[cell + 1] - mpFirstEdge[cell];
+}
+
+std::size_t PolarityInitialConditionTable::GetFirstEdge(unsigned cell) const
+{
+    assert(cell < mNumCells);
+    return mpFirstEdge[cell];
+}
+
+double PolarityInitialConditionTable::GetBirthTime(unsigned cell) const
+{
+    assert(cell < mNumCells);
+    return mpBirthTimes[cell];
+}
+
+const double* PolarityInitialConditionTable::GetLevels(std::size_t edge) const
+{
+    assert(edge < GetNumEdges());
+    return mpLevels + edge*mNumSpecies;
+}
@@ -0,0 +1,185 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYINITIALCONDITIONTABLE_HPP_
+#define POLARITYINITIALCONDITIONTABLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+/**
+ * A table of initial conditions for a tissue of polarity edge SRNs: for each cell its
+ * birth time and, for each of its edges, the initial level of every species. It is read
+ * by PolarityCellsGenerator to build a cell population in bulk.
+ *
+ * A table is either built in memory or memory-mapped from a binary file, so that large
+ * tables need not be read and copied before use. The file holds, in the byte order of the
+ * machine that wrote it:
+ *  - the 8 characters "PEDGEIC1";
+ *  - the number of species per edge, as a 32-bit unsigned integer;
+ *  - the number of cells, as a 32-bit unsigned integer;
+ *  - the number of the first edge of each cell followed by the total number of edges,
+ *    as 64-bit unsigned integers;
+ *  - the birth time of each cell, as doubles;
+ *  - the level of each species on each edge, as doubles, packed edge by edge.
+ */
+class PolarityInitialConditionTable
+{
+private:
+
+    /** The number of species per edge. */
+    unsigned mNumSpecies;
+
+    /** The number of cells. */
+    unsigned mNumCells;
+
+    /** The first edges of a table built in memory. */
+    std::vector<uint64_t> mFirstEdgeStorage;
+
+    /** The birth times of a table built in memory. */
+    std::vector<double> mBirthTimeStorage;
+
+    /** The levels of a table built in memory. */
+    std::vector<double> mLevelStorage;
+
+    /** The start of the mapped file, or NULL for a table built in memory. */
+    void* mpMappedData;
+
+    /** The size of the mapped file. */
+    std::size_t mMappedSize;
+
+    /** The number of the first edge of each cell, followed by the total number of edges. */
+    const uint64_t* mpFirstEdge;
+
+    /** The birth time of each cell. */
+    const double* mpBirthTimes;
+
+    /** The levels, packed edge by edge. */
+    const double* mpLevels;
+
+    /**
+     * Private constructor of an empty table, for Load().
+     */
+    PolarityInitialConditionTable();
+
+    /** Tables are not copied, since they may be mapped. */
+    PolarityInitialConditionTable(const PolarityInitialConditionTable&) = delete;
+
+    /** Tables are not copied, since they may be mapped. */
+    PolarityInitialConditionTable& operator=(const PolarityInitialConditionTable&) = delete;
+
+public:
+
+    /** The magic characters at the start of a table file. */
+    static const char MAGIC[8];
+
+    /**
+     * Build a table in memory.
+     *
+     * @param numSpecies the number of species per edge
+     * @param rNumEdges the number of edges of each cell
+     * @param rBirthTimes the birth time of each cell
+     * @param rLevels the level of each species on each edge, packed edge by edge
+     */
+    PolarityInitialConditionTable(unsigned numSpecies,
+                                  const std::vector<unsigned>& rNumEdges,
+                                  const std::vector<double>& rBirthTimes,
+                                  const std::vector<double>& rLevels);
+
+    /**
+     * Destructor. Unmaps the file of a loaded table.
+     */
+    ~PolarityInitialConditionTable();
+
+    /**
+     * Memory-map a table file.
+     *
+     * @param rPath the absolute path of the file
+     * @return the table, valid as long as it exists
+     */
+    static boost::shared_ptr<PolarityInitialConditionTable> Load(const std::string& rPath);
+
+    /**
+     * Write the table to a file that Load() can map.
+     *
+     * @param rPath the absolute path of the file
+     */
+    void Write(const std::string& rPath) const;
+
+    /**
+     * @return the number of species per edge
+     */
+    unsigned GetNumSpecies() const;
+
+    /**
+     * @return the number of cells
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * @return the total number of edges
+     */
+    std::size_t GetNumEdges() const;
+
+    /**
+     * @param cell the index of a cell
+     * @return the number of edges of the cell
+     */
+    unsigned GetNumEdges(unsigned cell) const;
+
+    /**
+     * @param cell the index of a cell
+     * @return the number of the first edge of the cell
+     */
+    std::size_t GetFirstEdge(unsigned cell) const;
+
+    /**
+     * @param cell the index of a cell
+     * @return the birth time of the cell
+     */
+    double GetBirthTime(unsigned cell) const;
+
+    /**
+     * @param edge the number of an edge
+     * @return the levels of the species on the edge
+     */
+    const double* GetLevels(std::size_t edge) const;
+};
+
+#endif /*POLARITYINITIALCONDITIONTABLE_HPP_*/
@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "PolarityKineticParameters.hpp"
+
+#include "CellSrnModel.hpp"
+#include "Exception.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+
+PolarityKineticParameters::PolarityKineticParameters(const std::vector<double>& rValues)
+    : AbstractCellProperty(),
+      mValues(rValues)
+{
+    if (mValues.empty())
+    {
+        mValues = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+    }
+    if (mValues.size() != PolarityEdgeOdeSystem::NUM_KINETIC_PARAMETERS)
+    {
+        EXCEPTION("A polarity kinetic parameter block needs " << PolarityEdgeOdeSystem::NUM_KINETIC_PARAMETERS
+                  << " values, not " << mValues.size() << ".");
+    }
+}
+
+PolarityKineticParameters::~PolarityKineticParameters()
+{
+}
+
+unsigned PolarityKineticParameters::GetIndex(const std::string& rName)
+{
+    for (unsigned i = 0; i < PolarityEdgeOdeSystem::NUM_KINETIC_PARAMETERS; i++)
+    {
+        if (rName == PolarityEdgeReactionNetwork::GetParameterName(i))
+        {
+            return i;
+        }
+    }
+    EXCEPTION("There is no polarity kinetic parameter called \"" << rName << "\".");
+}
+
+boost::shared_ptr<const PolarityKineticParameters> PolarityKineticParameters::GetDefault()
+{
+    // Never destroyed, as edge ODE systems may be freed during static destruction
+    static boost::shared_ptr<const PolarityKineticParameters>* p_default =
+        new boost::shared_ptr<const PolarityKineticParameters>(new PolarityKineticParameters());
+    return *p_default;
+}
+
+const std::vector<double>& PolarityKineticParameters::rGetValues() const
+{
+    return mValues;
+}
+
+double PolarityKineticParameters::GetValue(const std::string& rName) const
+{
+    return mValues[GetIndex(rName)];
+}
+
+boost::shared_ptr<PolarityKineticParameters> PolarityKineticParameters::CreateOverride(const std::string& rName, double value) const
+{
+    std::vector<double> values = mValues;
+    values[GetIndex(rName)] = value;
+    return boost::shared_ptr<PolarityKineticParameters>(new PolarityKineticParameters(values));
+}
+
+boost::shared_ptr<PolarityKineticParameters> PolarityKineticParameters::GetFromCell(CellPtr pCell)
+{
+    if (!pCell->HasCellProperty<PolarityKineticParameters>())
+    {
+        return boost::shared_ptr<PolarityKineticParameters>();
+    }
+    CellPropertyCollection collection = pCell->rGetCellPropertyCollection().GetPropertiesType<PolarityKineticParameters>();
+    return boost::static_pointer_cast<PolarityKineticParameters>(collection.GetProperty());
+}
+
+void PolarityKineticParameters::AssignToCell(CellPtr pCell, boost::shared_ptr<PolarityKineticParameters> pParameters)
+{
+    if (pCell->HasCellProperty<PolarityKineticParameters>())
+    {
+        pCell->RemoveCellProperty<PolarityKineticParameters>();
+    }
+    pCell->AddCellProperty(pParameters);
+
+    CellSrnModel* p_cell_srn = dynamic_cast<CellSrnModel*>(pCell->GetSrnModel());
+    if (p_cell_srn != nullptr)
+    {
+        for (unsigned i = 0; i < p_cell_srn->GetNumEdgeSrn(); i++)
+        {
+            auto p_edge_srn = boost::dynamic_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(i));
+            if (p_edge_srn && p_edge_srn->GetOdeSystem() != nullptr)
+            {
+                p_edge_srn->ApplyKineticParameters();
+            }
+        }
+    }
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(PolarityKineticParameters)
@@ -0,0 +1,150 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYKINETICPARAMETERS_HPP_
+#define POLARITYKINETICPARAMETERS_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+#include "AbstractCellProperty.hpp"
+#include "Cell.hpp"
+
+/**
+ * A block of the kinetic parameters KD1, KD2, k, K, VF, VS and w of the polarity edge
+ * ODEs, held as a cell property so that one block can be shared by every cell of a
+ * type, and a few cells (a mutant clone, say) given a block of their own.
+ *
+ * Each edge ODE system holds a pointer to the block it uses, rather than a copy of its
+ * values. The edge SRNs of a cell carrying a block are pointed at it when they are
+ * initialised, unless PolarityEdgeSrnModel::SetKineticParameters() has been called on
+ * the edge itself, which takes precedence; edges of cells without a block share the
+ * one returned by GetDefault(). Blocks are immutable. To change the parameters of a
+ * cell, give it a new block with AssignToCell(), which re-points the cell's initialised
+ * edges; a block added with Cell::AddCellProperty() after the edges have been
+ * initialised is not seen by them. Daughter cells inherit their mother's block.
+ */
+class PolarityKineticParameters : public AbstractCellProperty
+{
+private:
+
+    /** The values of KD1, KD2, k, K, VF, VS and w. */
+    std::vector<double> mValues;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the cell property.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellProperty>(*this);
+        archive & mValues;
+    }
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rValues the values of KD1, KD2, k, K, VF, VS and w (defaults to those of PolarityEdgeOdeSystem)
+     */
+    PolarityKineticParameters(const std::vector<double>& rValues=std::vector<double>());
+
+    /**
+     * Destructor.
+     */
+    virtual ~PolarityKineticParameters();
+
+    /**
+     * @param rName the name of a kinetic parameter, such as "KD2"
+     * @return its index among the kinetic parameters
+     */
+    static unsigned GetIndex(const std::string& rName);
+
+    /**
+     * @return the block holding the defaults of PolarityEdgeOdeSystem, shared by every
+     *     edge whose cell carries no block
+     */
+    static boost::shared_ptr<const PolarityKineticParameters> GetDefault();
+
+    /**
+     * @return the values of KD1, KD2, k, K, VF, VS and w
+     */
+    const std::vector<double>& rGetValues() const;
+
+    /**
+     * @param rName the name of a kinetic parameter
+     * @return its value
+     */
+    double GetValue(const std::string& rName) const;
+
+    /**
+     * @param rName the name of a kinetic parameter
+     * @param value its new value
+     * @return a new block, with the values of this one but for the one given
+     */
+    boost::shared_ptr<PolarityKineticParameters> CreateOverride(const std::string& rName, double value) const;
+
+    /**
+     * @param pCell a cell
+     * @return the block carried by the cell, or an empty pointer if it has none
+     */
+    static boost::shared_ptr<PolarityKineticParameters> GetFromCell(CellPtr pCell);
+
+    /**
+     * Give a cell a block, replacing any it already has, and point the cell's polarity
+     * edge SRNs that have been initialised at it.
+     *
+     * @param pCell the cell
+     * @param pParameters the block
+     */
+    static void AssignToCell(CellPtr pCell, boost::shared_ptr<PolarityKineticParameters> pParameters);
+};
+
+#include "SerializationExportWrapper.hpp"
+// Declare identifier for the serializer
+CHASTE_CLASS_EXPORT(PolarityKineticParameters)
+
+#endif /*POLARITYKINETICPARAMETERS_HPP_*/
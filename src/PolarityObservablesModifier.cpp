@@ -0,0 +1,316 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "PolarityObservablesModifier.hpp"
+#include "CellSrnModel.hpp"
+#include "PetscTools.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+
+/**
+ * @param rVector a vector
+ * @return the angle of the vector in the xy-plane
+ */
+template<unsigned DIM>
+static double AngleInXyPlane(const c_vector<double, DIM>& rVector)
+{
+    // The index is only used when DIM > 1, but must be valid for DIM = 1 too
+    const double y = (DIM > 1) ? rVector[DIM > 1 ? 1 : 0] : 0.0;
+    return atan2(y, rVector[0]);
+}
+
+template<unsigned DIM>
+PolarityObservablesModifier<DIM>::PolarityObservablesModifier()
+    : AbstractCellBasedSimulationModifier<DIM,DIM>(),
+      mSamplingTimestepMultiple(1),
+      mOutputCellPolarities(true),
+      mNumCells(0),
+      mMeanMagnitude(0.0),
+      mPolarOrder(0.0),
+      mMeanAngle(0.0),
+      mNematicOrder(0.0)
+{
+}
+
+template<unsigned DIM>
+PolarityObservablesModifier<DIM>::~PolarityObservablesModifier()
+{
+}
+
+template<unsigned DIM>
+void PolarityObservablesModifier<DIM>::SetSamplingTimestepMultiple(unsigned samplingTimestepMultiple)
+{
+    if (samplingTimestepMultiple == 0)
+    {
+        EXCEPTION("The sampling timestep multiple must be positive.");
+    }
+    mSamplingTimestepMultiple = samplingTimestepMultiple;
+}
+
+template<unsigned DIM>
+unsigned PolarityObservablesModifier<DIM>::GetSamplingTimestepMultiple() const
+{
+    return mSamplingTimestepMultiple;
+}
+
+template<unsigned DIM>
+void PolarityObservablesModifier<DIM>::SetOutputCellPolarities(bool outputCellPolarities)
+{
+    mOutputCellPolarities = outputCellPolarities;
+}
+
+template<unsigned DIM>
+bool PolarityObservablesModifier<DIM>::GetOutputCellPolarities() const
+{
+    return mOutputCellPolarities;
+}
+
+template<unsigned DIM>
+unsigned PolarityObservablesModifier<DIM>::GetNumCells() const
+{
+    return mNumCells;
+}
+
+template<unsigned DIM>
+double PolarityObservablesModifier<DIM>::GetMeanMagnitude() const
+{
+    return mMeanMagnitude;
+}
+
+template<unsigned DIM>
+double PolarityObservablesModifier<DIM>::GetPolarOrder() const
+{
+    return mPolarOrder;
+}
+
+template<unsigned DIM>
+double PolarityObservablesModifier<DIM>::GetMeanAngle() const
+{
+    return mMeanAngle;
+}
+
+template<unsigned DIM>
+double PolarityObservablesModifier<DIM>::GetNematicOrder() const
+{
+    return mNematicOrder;
+}
+
+template<unsigned DIM>
+c_vector<double, DIM> PolarityObservablesModifier<DIM>::CalculateCellPolarity(VertexBasedCellPopulation<DIM>& rCellPopulation,
+                                                                              CellPtr pCell)
+{
+    MutableVertexMesh<DIM,DIM>& r_mesh = rCellPopulation.rGetMesh();
+    const unsigned location_index = rCellPopulation.GetLocationIndexUsingCell(pCell);
+    VertexElement<DIM,DIM>* p_element = r_mesh.GetElement(location_index);
+    const c_vector<double, DIM> centroid = r_mesh.GetCentroidOfElement(location_index);
+
+    assert(dynamic_cast<CellSrnModel*>(pCell->GetSrnModel()));
+    auto p_cell_srn = static_cast<CellSrnModel*>(pCell->GetSrnModel());
+    assert(p_cell_srn->GetNumEdgeSrn() == p_element->GetNumEdges());
+
+    c_vector<double, DIM> polarity = zero_vector<double>(DIM);
+    double perimeter = 0.0;
+    for (unsigned edge_index = 0; edge_index < p_element->GetNumEdges(); edge_index++)
+    {
+        Edge<DIM>* p_edge = p_element->GetEdge(edge_index);
+        const c_vector<double, DIM>& r_start = p_edge->GetNode(0)->rGetLocation();
+        const c_vector<double, DIM> edge_vector = r_mesh.GetVectorFromAtoB(r_start, p_edge->GetNode(1)->rGetLocation());
+        const double length = norm_2(edge_vector);
+
+        // Outward from the centroid, through the edge midpoint
+        const c_vector<double, DIM> midpoint = r_start + 0.5*edge_vector;
+        c_vector<double, DIM> direction = r_mesh.GetVectorFromAtoB(centroid, midpoint);
+        const double distance = norm_2(direction);
+        if (distance > 0.0)
+        {
+            direction /= distance;
+        }
+
+        auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+        polarity += length*(p_edge_srn->GetBA() - p_edge_srn->GetCA())*direction;
+        perimeter += length;
+    }
+
+    if (perimeter > 0.0)
+    {
+        polarity /= perimeter;
+    }
+    return polarity;
+}
+
+template<unsigned DIM>
+void PolarityObservablesModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (SimulationTime::Instance()->GetTimeStepsElapsed() % mSamplingTimestepMultiple == 0)
+    {
+        SampleObservables(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void PolarityObservablesModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    assert(dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation));
+
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    mpOrderFile.reset();
+    mpCellFile.reset();
+    if (PetscTools::AmMaster())
+    {
+        mpOrderFile = output_file_handler.OpenOutputFile("polarity_order.dat");
+        *mpOrderFile << "# time num_cells mean_magnitude polar_order mean_angle nematic_order\n";
+    }
+    if (mOutputCellPolarities)
+    {
+        if (PetscTools::IsParallel())
+        {
+            mpCellFile = output_file_handler.OpenOutputFile("polarity_cells_", PetscTools::GetMyRank(), ".dat");
+        }
+        else
+        {
+            mpCellFile = output_file_handler.OpenOutputFile("polarity_cells.dat");
+        }
+        *mpCellFile << "# time cell_id";
+        for (unsigned i = 0; i < DIM; i++)
+        {
+            *mpCellFile << " polarity_" << char('x' + i);
+        }
+        *mpCellFile << " magnitude\n";
+    }
+    SampleObservables(rCellPopulation);
+}
+
+template<unsigned DIM>
+void PolarityObservablesModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpOrderFile)
+    {
+        mpOrderFile->close();
+        mpOrderFile.reset();
+    }
+    if (mpCellFile)
+    {
+        mpCellFile->close();
+        mpCellFile.reset();
+    }
+}
+
+template<unsigned DIM>
+void PolarityObservablesModifier<DIM>::SampleObservables(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    VertexBasedCellPopulation<DIM>* p_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    const double time = SimulationTime::Instance()->GetTime();
+
+    // The number of cells, the sum of magnitudes, the two nematic sums, then the summed polarity vector
+    std::vector<double> sums(4 + DIM, 0.0);
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        // Cells owned by another process are counted there
+        auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+        if (p_cell_srn->GetNumEdgeSrn() > 0
+            && !boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(0))->IsLocallyOwned())
+        {
+            continue;
+        }
+
+        const c_vector<double, DIM> polarity = CalculateCellPolarity(*p_population, *cell_iter);
+        const double magnitude = norm_2(polarity);
+        const double angle = AngleInXyPlane<DIM>(polarity);
+        sums[0] += 1.0;
+        sums[1] += magnitude;
+        sums[2] += magnitude*cos(2.0*angle);
+        sums[3] += magnitude*sin(2.0*angle);
+        for (unsigned i = 0; i < DIM; i++)
+        {
+            sums[4 + i] += polarity[i];
+        }
+
+        if (mpCellFile)
+        {
+            *mpCellFile << time << " " << cell_iter->GetCellId();
+            for (unsigned i = 0; i < DIM; i++)
+            {
+                *mpCellFile << " " << polarity[i];
+            }
+            *mpCellFile << " " << magnitude << "\n";
+        }
+    }
+
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(MPI_IN_PLACE, &sums[0], sums.size(), MPI_DOUBLE, MPI_SUM, PetscTools::GetWorld());
+    }
+
+    c_vector<double, DIM> summed_polarity;
+    for (unsigned i = 0; i < DIM; i++)
+    {
+        summed_polarity[i] = sums[4 + i];
+    }
+    mNumCells = unsigned(sums[0] + 0.5);
+    mMeanMagnitude = mNumCells > 0 ? sums[1]/mNumCells : 0.0;
+    mPolarOrder = sums[1] > 0.0 ? norm_2(summed_polarity)/sums[1] : 0.0;
+    mMeanAngle = AngleInXyPlane<DIM>(summed_polarity);
+    mNematicOrder = sums[1] > 0.0 ? sqrt(sums[2]*sums[2] + sums[3]*sums[3])/sums[1] : 0.0;
+
+    if (mpOrderFile)
+    {
+        *mpOrderFile << time << " " << mNumCells << " " << mMeanMagnitude << " " << mPolarOrder
+                     << " " << mMeanAngle << " " << mNematicOrder << "\n";
+    }
+}
+
+template<unsigned DIM>
+void PolarityObservablesModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<SamplingTimestepMultiple>" << mSamplingTimestepMultiple << "</SamplingTimestepMultiple>\n";
+    *rParamsFile << "\t\t\t<OutputCellPolarities>" << mOutputCellPolarities << "</OutputCellPolarities>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class PolarityObservablesModifier<1>;
+template class PolarityObservablesModifier<2>;
+template class PolarityObservablesModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(PolarityObservablesModifier)
@@ -0,0 +1,231 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYOBSERVABLESMODIFIER_HPP_
+#define POLARITYOBSERVABLESMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "OutputFileHandler.hpp"
+#include "UblasIncludes.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+/**
+ * A modifier that computes polarity observables of a tissue of polarity edge SRNs (see
+ * PolarityEdgeSrnModel) as the simulation runs, so that the raw edge levels need not be
+ * written out and analysed afterwards.
+ *
+ * The polarity vector of a cell is the asymmetry BA - CA of each edge, weighted by the
+ * length of the edge, along the unit vector from the cell centroid to the edge midpoint,
+ * divided by the perimeter of the cell. From the polarity vectors P of the cells the
+ * following tissue order parameters are computed, with angles taken in the xy-plane:
+ *  - the mean magnitude <|P|>;
+ *  - the polar order |sum P| / sum |P|, which is 1 when all cells point the same way;
+ *  - the angle of sum P;
+ *  - the nematic order |sum |P| exp(2 i theta)| / sum |P|, which is also 1 when cells
+ *    point in opposite directions along the same axis.
+ *
+ * Every sampled time step, a row of the tissue observables is appended to
+ * polarity_order.dat and, optionally, a row per cell with its polarity vector to
+ * polarity_cells.dat. When the cells are shared between processes (see
+ * PolarityEdgeDomainDecomposition), each cell is counted by its owner, the order
+ * parameters are combined across processes, and each process writes its own cells to
+ * polarity_cells_<rank>.dat.
+ */
+template<unsigned DIM>
+class PolarityObservablesModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The number of time steps between samples. Initialised to 1 in the constructor. */
+    unsigned mSamplingTimestepMultiple;
+
+    /** Whether to write the polarity vector of every cell. Initialised to true in the constructor. */
+    bool mOutputCellPolarities;
+
+    /** The number of cells in the last sample. */
+    unsigned mNumCells;
+
+    /** The mean magnitude of the cell polarity vectors in the last sample. */
+    double mMeanMagnitude;
+
+    /** The polar order parameter of the last sample. */
+    double mPolarOrder;
+
+    /** The angle of the summed polarity vector of the last sample. */
+    double mMeanAngle;
+
+    /** The nematic order parameter of the last sample. */
+    double mNematicOrder;
+
+    /** The file of tissue observables, open on the master process during a solve. */
+    out_stream mpOrderFile;
+
+    /** The file of cell polarity vectors, open during a solve if mOutputCellPolarities is true. */
+    out_stream mpCellFile;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mSamplingTimestepMultiple;
+        archive & mOutputCellPolarities;
+    }
+
+    /**
+     * Helper method to compute the observables of the population and write them to file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SampleObservables(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    PolarityObservablesModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~PolarityObservablesModifier();
+
+    /**
+     * @param samplingTimestepMultiple the number of time steps between samples
+     */
+    void SetSamplingTimestepMultiple(unsigned samplingTimestepMultiple);
+
+    /**
+     * @return the number of time steps between samples
+     */
+    unsigned GetSamplingTimestepMultiple() const;
+
+    /**
+     * @param outputCellPolarities whether to write the polarity vector of every cell
+     */
+    void SetOutputCellPolarities(bool outputCellPolarities);
+
+    /**
+     * @return whether the polarity vector of every cell is written
+     */
+    bool GetOutputCellPolarities() const;
+
+    /**
+     * @return the number of cells in the last sample
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * @return the mean magnitude of the cell polarity vectors in the last sample
+     */
+    double GetMeanMagnitude() const;
+
+    /**
+     * @return the polar order parameter of the last sample
+     */
+    double GetPolarOrder() const;
+
+    /**
+     * @return the angle, in the xy-plane, of the summed polarity vector of the last sample
+     */
+    double GetMeanAngle() const;
+
+    /**
+     * @return the nematic order parameter of the last sample
+     */
+    double GetNematicOrder() const;
+
+    /**
+     * Compute the polarity vector of a cell from the levels of its edge SRNs.
+     *
+     * @param rCellPopulation the cell population
+     * @param pCell the cell, whose SRN model must be a CellSrnModel of PolarityEdgeSrnModels
+     * @return the polarity vector of the cell
+     */
+    static c_vector<double, DIM> CalculateCellPolarity(VertexBasedCellPopulation<DIM>& rCellPopulation, CellPtr pCell);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specify what to do in the simulation at the end of each time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Open the output files and take the initial sample.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Close the output files.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(PolarityObservablesModifier)
+
+#endif /*POLARITYOBSERVABLESMODIFIER_HPP_*/
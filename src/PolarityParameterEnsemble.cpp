@@ -0,0 +1,278 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "PolarityParameterEnsemble.hpp"
+
+#include <algorithm>
+
+#include "CellSrnModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "Exception.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OutputFileHandler.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityKineticParameters.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+PolarityParameterEnsemble::PolarityParameterEnsemble(MutableVertexMesh<2,2>& rMesh, const std::string& rOutputDirectory)
+    : mrMesh(rMesh),
+      mOutputDirectory(rOutputDirectory),
+      mUseStrangSplitting(false)
+{
+}
+
+unsigned PolarityParameterEnsemble::AddMember(const std::vector<double>& rKineticParameters, double diffusionCoefficient)
+{
+    if (rKineticParameters.size() != PolarityEdgeOdeSystem::NUM_KINETIC_PARAMETERS)
+    {
+        EXCEPTION("A polarity edge needs " << PolarityEdgeOdeSystem::NUM_KINETIC_PARAMETERS << " kinetic parameters, not "
+                  << rKineticParameters.size() << ".");
+    }
+    if (diffusionCoefficient < 0.0)
+    {
+        EXCEPTION("The unbound protein diffusion coefficient must be non-negative.");
+    }
+    if (!mPopulations.empty())
+    {
+        EXCEPTION("Members cannot be added once the ensemble has been solved.");
+    }
+    mKineticParameters.push_back(rKineticParameters);
+    mDiffusionCoefficients.push_back(diffusionCoefficient);
+    return mKineticParameters.size() - 1;
+}
+
+unsigned PolarityParameterEnsemble::GetNumMembers() const
+{
+    return mKineticParameters.size();
+}
+
+void PolarityParameterEnsemble::SetInitialConditions(const std::vector<std::vector<double> >& rInitialConditions)
+{
+    mInitialConditions = rInitialConditions;
+}
+
+void PolarityParameterEnsemble::SetUseStrangSplitting(bool useStrangSplitting)
+{
+    mUseStrangSplitting = useStrangSplitting;
+}
+
+void PolarityParameterEnsemble::SetUpMember(unsigned member)
+{
+    MAKE_PTR(WildTypeCellMutationState, p_state);
+    MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+
+    // One block of kinetic parameters, shared by all the member's cells
+    boost::shared_ptr<PolarityKineticParameters> p_kinetic_parameters(new PolarityKineticParameters(mKineticParameters[member]));
+
+    std::vector<CellPtr> cells;
+    for (unsigned elem_index = 0; elem_index < mrMesh.GetNumElements(); elem_index++)
+    {
+        auto p_cell_srn_model = new CellSrnModel();
+        for (unsigned i = 0; i < mrMesh.GetElement(elem_index)->GetNumEdges(); i++)
+        {
+            boost::shared_ptr<PolarityEdgeSrnModel> p_srn_model = PolarityEdgeSrnModel::Create();
+            if (!mInitialConditions.empty())
+            {
+                p_srn_model->SetInitialConditions(mInitialConditions[i % mInitialConditions.size()]);
+            }
+            p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+        }
+
+        NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+        p_cc_model->SetDimension(2);
+        CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+        p_cell->SetCellProliferativeType(p_diff_type);
+        p_cell->AddCellProperty(p_kinetic_parameters);
+        p_cell->SetBirthTime(SimulationTime::Instance()->GetTime());
+        cells.push_back(p_cell);
+    }
+
+    boost::shared_ptr<VertexBasedCellPopulation<2> > p_population(new VertexBasedCellPopulation<2>(mrMesh, cells));
+    p_population->InitialiseCells();
+
+    MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+    p_modifier->SetUnboundProteinDiffusionCoefficient(mDiffusionCoefficients[member]);
+    p_modifier->SetUseStrangSplitting(mUseStrangSplitting);
+    p_modifier->SetupSolve(*p_population, mOutputDirectory);
+
+    mPopulations.push_back(p_population);
+    mModifiers.push_back(p_modifier);
+}
+
+void PolarityParameterEnsemble::Solve(double dt, double endTime, unsigned samplingTimestepMultiple)
+{
+    if (mKineticParameters.empty())
+    {
+        EXCEPTION("No members have been added to the ensemble.");
+    }
+    if (samplingTimestepMultiple == 0)
+    {
+        EXCEPTION("The sampling timestep multiple must be at least one.");
+    }
+
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+    const double current_time = p_simulation_time->GetTime();
+    if (endTime <= current_time)
+    {
+        EXCEPTION("The end time must be later than the current time.");
+    }
+    unsigned num_time_steps = (unsigned)((endTime - current_time)/dt + 0.5);
+    if (p_simulation_time->IsEndTimeAndNumberOfTimeStepsSetUp())
+    {
+        p_simulation_time->ResetEndTimeAndNumberOfTimeSteps(endTime, num_time_steps);
+    }
+    else
+    {
+        p_simulation_time->SetEndTimeAndNumberOfTimeSteps(endTime, num_time_steps);
+    }
+
+    // Members are only set up on the first call, so a later call continues from where the last one stopped
+    const bool continuing = !mPopulations.empty();
+    OutputFileHandler output_file_handler(mOutputDirectory, !continuing);
+    if (!continuing)
+    {
+        for (unsigned member = 0; member < mKineticParameters.size(); member++)
+        {
+            SetUpMember(member);
+        }
+
+        out_stream p_parameters_file = output_file_handler.OpenOutputFile("ensemble_parameters.dat");
+        *p_parameters_file << "# member KD1 KD2 k K VF VS w D\n";
+        for (unsigned member = 0; member < mKineticParameters.size(); member++)
+        {
+            *p_parameters_file << member;
+            for (double value : mKineticParameters[member])
+            {
+                *p_parameters_file << " " << value;
+            }
+            *p_parameters_file << " " << mDiffusionCoefficients[member] << "\n";
+        }
+        p_parameters_file->close();
+    }
+
+    std::ios_base::openmode mode = continuing ? std::ios::out | std::ios::app : std::ios::out;
+    std::vector<out_stream> member_files;
+    for (unsigned member = 0; member < mPopulations.size(); member++)
+    {
+        member_files.push_back(output_file_handler.OpenOutputFile("member_", member, ".dat", mode));
+    }
+
+    while (!p_simulation_time->IsFinished())
+    {
+        if (p_simulation_time->GetTimeStepsElapsed() % samplingTimestepMultiple == 0)
+        {
+            for (unsigned member = 0; member < mPopulations.size(); member++)
+            {
+                *member_files[member] << p_simulation_time->GetTime();
+                for (double level : GetMeanLevels(member))
+                {
+                    *member_files[member] << " " << level;
+                }
+                *member_files[member] << "\n";
+            }
+        }
+
+        // Solve every member's edge SRNs up to the start of the time step
+        for (unsigned member = 0; member < mPopulations.size(); member++)
+        {
+            for (AbstractCellPopulation<2>::Iterator cell_iter = mPopulations[member]->Begin();
+                 cell_iter != mPopulations[member]->End();
+                 ++cell_iter)
+            {
+                cell_iter->GetSrnModel()->SimulateToCurrentTime();
+            }
+        }
+
+        p_simulation_time->IncrementTimeOneStep();
+
+        for (unsigned member = 0; member < mPopulations.size(); member++)
+        {
+            mModifiers[member]->UpdateAtEndOfTimeStep(*mPopulations[member]);
+        }
+    }
+
+    for (unsigned member = 0; member < mPopulations.size(); member++)
+    {
+        *member_files[member] << p_simulation_time->GetTime();
+        for (double level : GetMeanLevels(member))
+        {
+            *member_files[member] << " " << level;
+        }
+        *member_files[member] << "\n";
+        member_files[member]->close();
+    }
+}
+
+VertexBasedCellPopulation<2>& PolarityParameterEnsemble::rGetPopulation(unsigned member)
+{
+    if (member >= mPopulations.size())
+    {
+        EXCEPTION("Ensemble member " << member << " has not been set up; call Solve() first.");
+    }
+    return *mPopulations[member];
+}
+
+std::vector<double> PolarityParameterEnsemble::GetMeanLevels(unsigned member)
+{
+    std::vector<double> means(8, 0.0);
+    unsigned num_edges = 0;
+    for (AbstractCellPopulation<2>::Iterator cell_iter = rGetPopulation(member).Begin();
+         cell_iter != rGetPopulation(member).End();
+         ++cell_iter)
+    {
+        auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+        for (unsigned edge_index = 0; edge_index < p_cell_srn->GetNumEdgeSrn(); ++edge_index)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge_index));
+            means[0] += p_edge_srn->GetBoundA();
+            means[1] += p_edge_srn->GetA();
+            means[2] += p_edge_srn->GetB();
+            means[3] += p_edge_srn->GetC();
+            means[4] += p_edge_srn->GetBA();
+            means[5] += p_edge_srn->GetAB();
+            means[6] += p_edge_srn->GetCA();
+            means[7] += p_edge_srn->GetAC();
+            num_edges++;
+        }
+    }
+    for (double& r_mean : means)
+    {
+        r_mean /= std::max(num_edges, 1u);
+    }
+    return means;
+}
@@ -0,0 +1,163 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POLARITYPARAMETERENSEMBLE_HPP_
+#define POLARITYPARAMETERENSEMBLE_HPP_
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "MutableVertexMesh.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+/**
+ * Runs the polarity model for several sets of kinetic parameters and membrane diffusion
+ * coefficients in one process, sharing a single vertex mesh.
+ *
+ * Each member of the ensemble has its own cells, edge SRNs and PolarityEdgeTrackingModifier,
+ * but all members are built on the same mesh and advanced together, as extra lanes of one
+ * time loop. This avoids rebuilding the mesh and relaunching the executable for each point
+ * of a parameter sweep. Each member's mean edge levels are written to its own file.
+ *
+ * The tissue is static: no forces are applied and cells neither divide nor die, so that the
+ * mesh can be shared between members. Within each time step the edge SRNs are solved before
+ * the time is incremented and the modifiers are updated afterwards, exactly as in
+ * OffLatticeSimulation, so each member reproduces a simulation of a static tissue with the
+ * same parameters.
+ */
+class PolarityParameterEnsemble
+{
+private:
+
+    /** The mesh shared by all members. */
+    MutableVertexMesh<2,2>& mrMesh;
+
+    /** The output directory, relative to where Chaste output is stored. */
+    std::string mOutputDirectory;
+
+    /** The initial conditions of the edges, indexed by local edge index (cyclically). */
+    std::vector<std::vector<double> > mInitialConditions;
+
+    /** The kinetic parameters KD1, KD2, k, K, VF, VS and w of each member. */
+    std::vector<std::vector<double> > mKineticParameters;
+
+    /** The membrane diffusion coefficient of each member. */
+    std::vector<double> mDiffusionCoefficients;
+
+    /** Whether each member uses Strang splitting, see PolarityEdgeTrackingModifier. */
+    bool mUseStrangSplitting;
+
+    /** The cell population of each member, created by Solve(). */
+    std::vector<boost::shared_ptr<VertexBasedCellPopulation<2> > > mPopulations;
+
+    /** The modifier of each member, created by Solve(). */
+    std::vector<boost::shared_ptr<PolarityEdgeTrackingModifier<2> > > mModifiers;
+
+    /**
+     * Create the cells, population and modifier of one member.
+     *
+     * @param member the index of the member
+     */
+    void SetUpMember(unsigned member);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rMesh the mesh shared by all members; must outlive this object
+     * @param rOutputDirectory the output directory, relative to where Chaste output is stored
+     */
+    PolarityParameterEnsemble(MutableVertexMesh<2,2>& rMesh, const std::string& rOutputDirectory);
+
+    /**
+     * Add a member to the ensemble.
+     *
+     * @param rKineticParameters the values of KD1, KD2, k, K, VF, VS and w
+     * @param diffusionCoefficient the diffusion coefficient of unbound proteins within the membrane
+     * @return the index of the new member
+     */
+    unsigned AddMember(const std::vector<double>& rKineticParameters, double diffusionCoefficient);
+
+    /**
+     * @return the number of members
+     */
+    unsigned GetNumMembers() const;
+
+    /**
+     * Set the initial conditions of every edge. The i-th edge of each element is given
+     * rInitialConditions[i % rInitialConditions.size()], so a single vector gives all
+     * edges the same initial conditions.
+     *
+     * @param rInitialConditions the initial conditions, by local edge index
+     */
+    void SetInitialConditions(const std::vector<std::vector<double> >& rInitialConditions);
+
+    /**
+     * @param useStrangSplitting whether the members use Strang splitting
+     */
+    void SetUseStrangSplitting(bool useStrangSplitting);
+
+    /**
+     * Run all members from the current time up to endTime.
+     *
+     * Each member's mean edge levels are written to member_<index>.dat in the output
+     * directory every samplingTimestepMultiple time steps, one row per sample holding
+     * the time and the means of BoundA, A, B, C, BA, AB, CA and AC. The parameters of
+     * each member are written to ensemble_parameters.dat.
+     *
+     * @param dt the time step
+     * @param endTime the end time
+     * @param samplingTimestepMultiple the number of time steps between samples
+     */
+    void Solve(double dt, double endTime, unsigned samplingTimestepMultiple=1);
+
+    /**
+     * @param member the index of the member
+     * @return the cell population of the member (only available after Solve())
+     */
+    VertexBasedCellPopulation<2>& rGetPopulation(unsigned member);
+
+    /**
+     * @param member the index of the member
+     * @return the means over all edges of BoundA, A, B, C, BA, AB, CA and AC in the member
+     */
+    std::vector<double> GetMeanLevels(unsigned member);
+};
+
+#endif /*POLARITYPARAMETERENSEMBLE_HPP_*/
@@ -0,0 +1,360 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "RosenbrockWIvpOdeSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "AbstractReactionNetworkOdeSystem.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+double RosenbrockWIvpOdeSolver::msDefaultRelativeTolerance = 1e-4;
+double RosenbrockWIvpOdeSolver::msDefaultAbsoluteTolerance = 1e-6;
+
+RosenbrockWIvpOdeSolver::RosenbrockWIvpOdeSolver()
+    : AbstractIvpOdeSolver(),
+      mRelativeTolerance(msDefaultRelativeTolerance),
+      mAbsoluteTolerance(msDefaultAbsoluteTolerance),
+      mUseFiniteDifferenceJacobian(false),
+      mNumberOfAcceptedSteps(0),
+      mNumberOfRejectedSteps(0)
+{
+}
+
+RosenbrockWIvpOdeSolver::~RosenbrockWIvpOdeSolver()
+{
+}
+
+void RosenbrockWIvpOdeSolver::SetDefaultTolerances(double relTol, double absTol)
+{
+    if (relTol <= 0.0 || absTol <= 0.0)
+    {
+        EXCEPTION("ODE solver tolerances must be positive.");
+    }
+    msDefaultRelativeTolerance = relTol;
+    msDefaultAbsoluteTolerance = absTol;
+}
+
+void RosenbrockWIvpOdeSolver::SetTolerances(double relTol, double absTol)
+{
+    if (relTol <= 0.0 || absTol <= 0.0)
+    {
+        EXCEPTION("ODE solver tolerances must be positive.");
+    }
+    mRelativeTolerance = relTol;
+    mAbsoluteTolerance = absTol;
+}
+
+double RosenbrockWIvpOdeSolver::GetRelativeTolerance() const
+{
+    return mRelativeTolerance;
+}
+
+double RosenbrockWIvpOdeSolver::GetAbsoluteTolerance() const
+{
+    return mAbsoluteTolerance;
+}
+
+void RosenbrockWIvpOdeSolver::SetUseFiniteDifferenceJacobian(bool useFiniteDifferences)
+{
+    mUseFiniteDifferenceJacobian = useFiniteDifferences;
+}
+
+unsigned RosenbrockWIvpOdeSolver::GetNumberOfAcceptedSteps() const
+{
+    return mNumberOfAcceptedSteps;
+}
+
+unsigned RosenbrockWIvpOdeSolver::GetNumberOfRejectedSteps() const
+{
+    return mNumberOfRejectedSteps;
+}
+
+void RosenbrockWIvpOdeSolver::ComputeJacobian(AbstractOdeSystem* pOdeSystem, double time, const std::vector<double>& rY)
+{
+    AbstractReactionNetworkOdeSystem* p_network = dynamic_cast<AbstractReactionNetworkOdeSystem*>(pOdeSystem);
+    if (p_network && !mUseFiniteDifferenceJacobian)
+    {
+        p_network->EvaluateJacobian(time, rY, mJacobian);
+    }
+    else
+    {
+        AbstractReactionNetworkOdeSystem::ApproximateJacobian(*pOdeSystem, time, rY, mJacobian);
+    }
+}
+
+void RosenbrockWIvpOdeSolver::FactoriseIterationMatrix(double gammaH)
+{
+    const unsigned n = mPivots.size();
+    for (unsigned i = 0; i < n; i++)
+    {
+        for (unsigned j = 0; j < n; j++)
+        {
+            mMatrix[i*n + j] = -gammaH*mJacobian[i*n + j];
+        }
+        mMatrix[i*n + i] += 1.0;
+    }
+
+    // Dense LU factorisation with partial pivoting
+    for (unsigned k = 0; k < n; k++)
+    {
+        unsigned pivot = k;
+        for (unsigned i = k + 1; i < n; i++)
+        {
+            if (fabs(mMatrix[i*n + k]) > fabs(mMatrix[pivot*n + k]))
+            {
+                pivot = i;
+            }
+        }
+        mPivots[k] = pivot;
+        if (pivot != k)
+        {
+            for (unsigned j = 0; j < n; j++)
+            {
+                std::swap(mMatrix[k*n + j], mMatrix[pivot*n + j]);
+            }
+        }
+        if (mMatrix[k*n + k] == 0.0)
+        {
+            EXCEPTION("Singular iteration matrix in RosenbrockWIvpOdeSolver.");
+        }
+        for (unsigned i = k + 1; i < n; i++)
+        {
+            const double multiplier = mMatrix[i*n + k]/mMatrix[k*n + k];
+            mMatrix[i*n + k] = multiplier;
+            for (unsigned j = k + 1; j < n; j++)
+            {
+                mMatrix[i*n + j] -= multiplier*mMatrix[k*n + j];
+            }
+        }
+    }
+}
+
+void RosenbrockWIvpOdeSolver::BackSubstitute(std::vector<double>& rB)
+{
+    const unsigned n = mPivots.size();
+    for (unsigned k = 0; k < n; k++)
+    {
+        if (mPivots[k] != k)
+        {
+            std::swap(rB[k], rB[mPivots[k]]);
+        }
+    }
+    for (unsigned i = 1; i < n; i++)
+    {
+        for (unsigned j = 0; j < i; j++)
+        {
+            rB[i] -= mMatrix[i*n + j]*rB[j];
+        }
+    }
+    for (unsigned i = n; i-- > 0; )
+    {
+        for (unsigned j = i + 1; j < n; j++)
+        {
+            rB[i] -= mMatrix[i*n + j]*rB[j];
+        }
+        rB[i] /= mMatrix[i*n + i];
+    }
+}
+
+void RosenbrockWIvpOdeSolver::InternalSolve(AbstractOdeSystem* pOdeSystem,
+                                            std::vector<double>& rYValues,
+                                            double startTime,
+                                            double endTime,
+                                            double maxTimeStep)
+{
+    const unsigned n = rYValues.size();
+    mMatrix.resize(n*n);
+    mJacobian.resize(n*n);
+    mPivots.resize(n);
+    mK1.resize(n);
+    mK2.resize(n);
+    mF0.resize(n);
+    mF1.resize(n);
+    mYNew.resize(n);
+
+    const double gamma = 1.0 + 1.0/sqrt(2.0);
+    const double min_time_step = 1e-12*std::max(1.0, fabs(endTime));
+
+    // Restart from this system's own step size if it has one
+    AbstractReactionNetworkOdeSystem* p_network = dynamic_cast<AbstractReactionNetworkOdeSystem*>(pOdeSystem);
+    double h = maxTimeStep;
+    if (p_network && p_network->GetSuggestedTimeStep() > 0.0)
+    {
+        h = std::min(h, p_network->GetSuggestedTimeStep());
+    }
+
+    double time = startTime;
+    bool at_new_state = true;
+    while (endTime - time > min_time_step)
+    {
+        if (at_new_state)
+        {
+            pOdeSystem->EvaluateYDerivatives(time, rYValues, mF0);
+            ComputeJacobian(pOdeSystem, time, rYValues);
+            at_new_state = false;
+        }
+
+        const bool last_step = (h >= endTime - time);
+        const double step = last_step ? endTime - time : h;
+
+        FactoriseIterationMatrix(gamma*step);
+
+        mK1 = mF0;
+        BackSubstitute(mK1);
+        for (unsigned i = 0; i < n; i++)
+        {
+            mYNew[i] = rYValues[i] + step*mK1[i];
+        }
+        pOdeSystem->EvaluateYDerivatives(time + step, mYNew, mF1);
+        for (unsigned i = 0; i < n; i++)
+        {
+            mK2[i] = mF1[i] - 2.0*mK1[i];
+        }
+        BackSubstitute(mK2);
+
+        // Compare with the embedded first order solution y + h k1
+        double error_norm = 0.0;
+        for (unsigned i = 0; i < n; i++)
+        {
+            mYNew[i] = rYValues[i] + step*(1.5*mK1[i] + 0.5*mK2[i]);
+            const double error = 0.5*step*(mK1[i] + mK2[i]);
+            const double scale = mAbsoluteTolerance + mRelativeTolerance*std::max(fabs(rYValues[i]), fabs(mYNew[i]));
+            error_norm += (error/scale)*(error/scale);
+        }
+        error_norm = sqrt(error_norm/n);
+
+        if (error_norm <= 1.0)
+        {
+            std::copy(mYNew.begin(), mYNew.end(), rYValues.begin());
+            time = last_step ? endTime : time + step;
+            mNumberOfAcceptedSteps++;
+            at_new_state = true;
+
+            double factor = (error_norm > 0.0) ? 0.9/sqrt(error_norm) : 5.0;
+            factor = std::min(5.0, std::max(0.2, factor));
+
+            // A step shortened to land on endTime says little about the step size the system can take
+            if (!last_step || factor < 1.0)
+            {
+                h = std::min(maxTimeStep, (last_step ? h : step)*factor);
+            }
+
+            if (pOdeSystem->CalculateStoppingEvent(time, rYValues))
+            {
+                mStoppingTime = time;
+                mStoppingEventOccurred = true;
+                break;
+            }
+        }
+        else
+        {
+            // Also catches a NaN error norm
+            mNumberOfRejectedSteps++;
+            h = step*((error_norm > 0.0 && error_norm < 25.0) ? 0.9/sqrt(error_norm) : 0.2);
+            if (h < min_time_step)
+            {
+                EXCEPTION("RosenbrockWIvpOdeSolver step size fell below " << min_time_step << " at time " << time << ".");
+            }
+        }
+    }
+
+    if (p_network)
+    {
+        p_network->SetSuggestedTimeStep(h);
+    }
+}
+
+OdeSolution RosenbrockWIvpOdeSolver::Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                                           std::vector<double>& rYValues,
+                                           double startTime,
+                                           double endTime,
+                                           double timeStep,
+                                           double timeSampling)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+    assert(timeSampling >= timeStep);
+
+    mStoppingEventOccurred = false;
+    if (pAbstractOdeSystem->CalculateStoppingEvent(startTime, rYValues))
+    {
+        EXCEPTION("(Solve with sampling) Stopping event is true for initial condition");
+    }
+
+    TimeStepper stepper(startTime, endTime, timeSampling);
+
+    OdeSolution solutions;
+    solutions.SetNumberOfTimeSteps(stepper.EstimateTimeSteps());
+    solutions.rGetSolutions().push_back(rYValues);
+    solutions.rGetTimes().push_back(startTime);
+    solutions.SetOdeSystemInformation(pAbstractOdeSystem->GetSystemInformation());
+
+    while (!stepper.IsTimeAtEnd() && !mStoppingEventOccurred)
+    {
+        InternalSolve(pAbstractOdeSystem, rYValues, stepper.GetTime(), stepper.GetNextTime(), timeStep);
+        stepper.AdvanceOneTimeStep();
+
+        solutions.rGetSolutions().push_back(rYValues);
+        solutions.rGetTimes().push_back(mStoppingEventOccurred ? mStoppingTime : stepper.GetTime());
+    }
+    solutions.SetNumberOfTimeSteps(stepper.GetTotalTimeStepsTaken());
+
+    return solutions;
+}
+
+void RosenbrockWIvpOdeSolver::Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                                    std::vector<double>& rYValues,
+                                    double startTime,
+                                    double endTime,
+                                    double timeStep)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+
+    mStoppingEventOccurred = false;
+    if (pAbstractOdeSystem->CalculateStoppingEvent(startTime, rYValues))
+    {
+        EXCEPTION("(Solve without sampling) Stopping event is true for initial condition");
+    }
+
+    InternalSolve(pAbstractOdeSystem, rYValues, startTime, endTime, timeStep);
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(RosenbrockWIvpOdeSolver)
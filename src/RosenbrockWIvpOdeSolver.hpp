@@ -0,0 +1,265 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ROSENBROCKWIVPODESOLVER_HPP_
+#define ROSENBROCKWIVPODESOLVER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <vector>
+
+#include "AbstractIvpOdeSolver.hpp"
+
+/**
+ * A linearly implicit, adaptive Rosenbrock-W solver for small stiff ODE systems.
+ *
+ * The method is the two-stage, second order, L-stable ROS2 scheme of Verwer et al.
+ * (SIAM J. Sci. Comput. 20:1456-1480, 1999):
+ *
+ *   (I - gamma h J) k1 = f(t, y)
+ *   (I - gamma h J) k2 = f(t + h, y + h k1) - 2 k1
+ *   y_new = y + 3h/2 k1 + h/2 k2,    gamma = 1 + 1/sqrt(2).
+ *
+ * Being a W-method, it keeps second order accuracy when J is only an approximation
+ * of the Jacobian. The Jacobian is taken from AbstractReactionNetworkOdeSystem::EvaluateJacobian()
+ * when the system provides one, and is otherwise approximated by finite differences.
+ * Each step needs one dense LU factorisation of the n*n matrix and two right-hand
+ * side evaluations, which is much cheaper than CVODE's overhead for systems as small
+ * as PolarityEdgeOdeSystem.
+ *
+ * The local error is estimated against the embedded first order solution y + h k1
+ * and controlled using mixed relative/absolute tolerances. The time step passed to
+ * Solve() is used as the maximum step size. For an AbstractReactionNetworkOdeSystem
+ * the last proposed step size is stored on the system, so that one solver instance
+ * can be shared between all edges while each edge restarts with its own step size.
+ *
+ * When constructed by CellCycleModelOdeSolver, which default-constructs its solver,
+ * the tolerances are taken from SetDefaultTolerances().
+ */
+class RosenbrockWIvpOdeSolver : public AbstractIvpOdeSolver
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Archive the ODE solver and member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractIvpOdeSolver>(*this);
+        archive & mRelativeTolerance;
+        archive & mAbsoluteTolerance;
+        archive & mUseFiniteDifferenceJacobian;
+    }
+
+    /** Relative tolerance given to newly constructed solvers. */
+    static double msDefaultRelativeTolerance;
+
+    /** Absolute tolerance given to newly constructed solvers. */
+    static double msDefaultAbsoluteTolerance;
+
+    /** Relative tolerance for the local error. */
+    double mRelativeTolerance;
+
+    /** Absolute tolerance for the local error. */
+    double mAbsoluteTolerance;
+
+    /** Whether to approximate the Jacobian by finite differences even if the system provides one. */
+    bool mUseFiniteDifferenceJacobian;
+
+    /** Number of accepted steps since construction. */
+    unsigned mNumberOfAcceptedSteps;
+
+    /** Number of rejected steps since construction. */
+    unsigned mNumberOfRejectedSteps;
+
+    /** Working memory: the Jacobian, overwritten by the LU factors of I - gamma h J. */
+    std::vector<double> mMatrix;
+
+    /** Working memory: the Jacobian at the start of the current step. */
+    std::vector<double> mJacobian;
+
+    /** Working memory: row permutation from partial pivoting. */
+    std::vector<unsigned> mPivots;
+
+    /** Working memory: first stage. */
+    std::vector<double> mK1;
+
+    /** Working memory: second stage. */
+    std::vector<double> mK2;
+
+    /** Working memory: right-hand side at the start of the step. */
+    std::vector<double> mF0;
+
+    /** Working memory: right-hand side at the second stage. */
+    std::vector<double> mF1;
+
+    /** Working memory: state at the second stage, then the proposed new state. */
+    std::vector<double> mYNew;
+
+    /**
+     * Fill in mJacobian for the given system and state.
+     *
+     * @param pOdeSystem the ODE system
+     * @param time the current time
+     * @param rY the current state
+     */
+    void ComputeJacobian(AbstractOdeSystem* pOdeSystem, double time, const std::vector<double>& rY);
+
+    /**
+     * Form I - gammaH*J in mMatrix and overwrite it by its LU factorisation with partial pivoting.
+     *
+     * @param gammaH the product gamma*h
+     */
+    void FactoriseIterationMatrix(double gammaH);
+
+    /**
+     * Solve (I - gamma h J) x = b using the factors in mMatrix.
+     *
+     * @param rB the right-hand side, overwritten by the solution
+     */
+    void BackSubstitute(std::vector<double>& rB);
+
+    /**
+     * Integrate from startTime to endTime, updating rYValues.
+     *
+     * @param pOdeSystem the ODE system
+     * @param rYValues the initial state, overwritten by the final state
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param maxTimeStep the maximum step size
+     */
+    void InternalSolve(AbstractOdeSystem* pOdeSystem,
+                       std::vector<double>& rYValues,
+                       double startTime,
+                       double endTime,
+                       double maxTimeStep);
+
+public:
+
+    /**
+     * Constructor. The tolerances are those set by SetDefaultTolerances().
+     */
+    RosenbrockWIvpOdeSolver();
+
+    /**
+     * Destructor.
+     */
+    virtual ~RosenbrockWIvpOdeSolver();
+
+    /**
+     * Set the tolerances given to solvers constructed from now on.
+     *
+     * @param relTol the relative tolerance (defaults to 1e-4)
+     * @param absTol the absolute tolerance (defaults to 1e-6)
+     */
+    static void SetDefaultTolerances(double relTol, double absTol);
+
+    /**
+     * Set the tolerances of this solver.
+     *
+     * @param relTol the relative tolerance
+     * @param absTol the absolute tolerance
+     */
+    void SetTolerances(double relTol, double absTol);
+
+    /**
+     * @return the relative tolerance
+     */
+    double GetRelativeTolerance() const;
+
+    /**
+     * @return the absolute tolerance
+     */
+    double GetAbsoluteTolerance() const;
+
+    /**
+     * @param useFiniteDifferences whether to approximate the Jacobian even when the system provides one
+     */
+    void SetUseFiniteDifferenceJacobian(bool useFiniteDifferences);
+
+    /**
+     * @return the number of accepted steps taken by this solver
+     */
+    unsigned GetNumberOfAcceptedSteps() const;
+
+    /**
+     * @return the number of rejected steps taken by this solver
+     */
+    unsigned GetNumberOfRejectedSteps() const;
+
+    /**
+     * Solve the ODE system, returning the solution at the sampling times.
+     *
+     * @param pAbstractOdeSystem the ODE system
+     * @param rYValues the initial state, overwritten by the final state
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param timeStep the maximum step size
+     * @param timeSampling the interval at which to store the solution
+     * @return the solution
+     */
+    virtual OdeSolution Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                              std::vector<double>& rYValues,
+                              double startTime,
+                              double endTime,
+                              double timeStep,
+                              double timeSampling) override;
+
+    /**
+     * Solve the ODE system, updating rYValues to the final state.
+     *
+     * @param pAbstractOdeSystem the ODE system
+     * @param rYValues the initial state, overwritten by the final state
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param timeStep the maximum step size
+     */
+    virtual void Solve(AbstractOdeSystem* pAbstractOdeSystem,
+                       std::vector<double>& rYValues,
+                       double startTime,
+                       double endTime,
+                       double timeStep) override;
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(RosenbrockWIvpOdeSolver)
+
+#endif /*ROSENBROCKWIVPODESOLVER_HPP_*/
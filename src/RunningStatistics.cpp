@@ -0,0 +1,149 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "RunningStatistics.hpp"
+
+#include <algorithm>
+
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+
+RunningStatistics::RunningStatistics(unsigned numQuantities)
+    : mCount(0),
+      mMeans(numQuantities, 0.0),
+      mSumsOfSquares(numQuantities, 0.0)
+{
+}
+
+void RunningStatistics::AddSample(const std::vector<double>& rValues)
+{
+    if (rValues.size() != mMeans.size())
+    {
+        EXCEPTION("A sample of " << rValues.size() << " values cannot be added to statistics of "
+                  << mMeans.size() << " quantities.");
+    }
+
+    mCount++;
+    for (unsigned i = 0; i < mMeans.size(); i++)
+    {
+        const double delta = rValues[i] - mMeans[i];
+        mMeans[i] += delta/mCount;
+        mSumsOfSquares[i] += delta*(rValues[i] - mMeans[i]);
+    }
+}
+
+void RunningStatistics::Merge(const RunningStatistics& rOther)
+{
+    if (rOther.mMeans.size() != mMeans.size())
+    {
+        EXCEPTION("Statistics of " << rOther.mMeans.size() << " quantities cannot be merged with statistics of "
+                  << mMeans.size() << " quantities.");
+    }
+    if (rOther.mCount == 0)
+    {
+        return;
+    }
+
+    const double count = mCount;
+    const double other_count = rOther.mCount;
+    const double total_count = count + other_count;
+    for (unsigned i = 0; i < mMeans.size(); i++)
+    {
+        const double delta = rOther.mMeans[i] - mMeans[i];
+        mMeans[i] += delta*other_count/total_count;
+        mSumsOfSquares[i] += rOther.mSumsOfSquares[i] + delta*delta*count*other_count/total_count;
+    }
+    mCount += rOther.mCount;
+}
+
+void RunningStatistics::MergeAcrossProcesses()
+{
+    if (!PetscTools::IsParallel())
+    {
+        return;
+    }
+
+    const unsigned num_procs = PetscTools::GetNumProcs();
+    const unsigned num_quantities = mMeans.size();
+
+    std::vector<unsigned> counts(num_procs);
+    MPI_Allgather(&mCount, 1, MPI_UNSIGNED, &counts[0], 1, MPI_UNSIGNED, PetscTools::GetWorld());
+
+    std::vector<double> local(2*num_quantities);
+    std::copy(mMeans.begin(), mMeans.end(), local.begin());
+    std::copy(mSumsOfSquares.begin(), mSumsOfSquares.end(), local.begin() + num_quantities);
+    std::vector<double> all(2*num_quantities*num_procs);
+    MPI_Allgather(&local[0], 2*num_quantities, MPI_DOUBLE, &all[0], 2*num_quantities, MPI_DOUBLE, PetscTools::GetWorld());
+
+    RunningStatistics merged(num_quantities);
+    for (unsigned proc = 0; proc < num_procs; proc++)
+    {
+        RunningStatistics process_statistics(num_quantities);
+        process_statistics.mCount = counts[proc];
+        const double* p_data = &all[2*num_quantities*proc];
+        process_statistics.mMeans.assign(p_data, p_data + num_quantities);
+        process_statistics.mSumsOfSquares.assign(p_data + num_quantities, p_data + 2*num_quantities);
+        merged.Merge(process_statistics);
+    }
+    *this = merged;
+}
+
+unsigned RunningStatistics::GetNumQuantities() const
+{
+    return mMeans.size();
+}
+
+unsigned RunningStatistics::GetCount() const
+{
+    return mCount;
+}
+
+const std::vector<double>& RunningStatistics::rGetMeans() const
+{
+    return mMeans;
+}
+
+std::vector<double> RunningStatistics::GetVariances() const
+{
+    std::vector<double> variances(mMeans.size(), 0.0);
+    if (mCount > 1)
+    {
+        for (unsigned i = 0; i < mMeans.size(); i++)
+        {
+            variances[i] = mSumsOfSquares[i]/(mCount - 1);
+        }
+    }
+    return variances;
+}
@@ -0,0 +1,112 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef RUNNINGSTATISTICS_HPP_
+#define RUNNINGSTATISTICS_HPP_
+
+#include <vector>
+
+/**
+ * Running means and variances of a fixed number of quantities, updated one sample at a
+ * time with Welford's algorithm, so that samples never need to be stored.
+ *
+ * Statistics gathered separately, for example on different processes, can be combined
+ * with Merge() using the pairwise update of Chan, Golub and LeVeque (1979).
+ */
+class RunningStatistics
+{
+private:
+
+    /** The number of samples added. */
+    unsigned mCount;
+
+    /** The running mean of each quantity. */
+    std::vector<double> mMeans;
+
+    /** The running sum of squared deviations from the mean of each quantity. */
+    std::vector<double> mSumsOfSquares;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param numQuantities the number of quantities in each sample
+     */
+    RunningStatistics(unsigned numQuantities=1);
+
+    /**
+     * Add a sample.
+     *
+     * @param rValues the value of each quantity
+     */
+    void AddSample(const std::vector<double>& rValues);
+
+    /**
+     * Combine the samples of another set of statistics of the same quantities with these.
+     *
+     * @param rOther the other statistics
+     */
+    void Merge(const RunningStatistics& rOther);
+
+    /**
+     * Combine the statistics gathered on every process, so that all processes hold the
+     * statistics of all samples. The processes are merged in rank order, so the result
+     * is the same on every process. Does nothing when running sequentially.
+     */
+    void MergeAcrossProcesses();
+
+    /**
+     * @return the number of quantities in each sample
+     */
+    unsigned GetNumQuantities() const;
+
+    /**
+     * @return the number of samples added
+     */
+    unsigned GetCount() const;
+
+    /**
+     * @return the mean of each quantity
+     */
+    const std::vector<double>& rGetMeans() const;
+
+    /**
+     * @return the unbiased sample variance of each quantity (zero for fewer than two samples)
+     */
+    std::vector<double> GetVariances() const;
+};
+
+#endif /*RUNNINGSTATISTICS_HPP_*/
@@ -0,0 +1,209 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTALLOCATIONFREEEDGESPECIESUPDATE_HPP_
+#define TESTALLOCATIONFREEEDGESPECIESUPDATE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "CellSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/** The number of calls to operator new so far in this test executable. */
+static std::atomic<unsigned long> gNumberOfAllocations(0);
+
+/**
+ * Replacement global operator new, counting every allocation in the executable.
+ *
+ * @param size the number of bytes
+ * @return the memory
+ */
+void* operator new(std::size_t size)
+{
+    gNumberOfAllocations++;
+    void* p_memory = std::malloc(size == 0 ? 1 : size);
+    if (p_memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p_memory;
+}
+
+/**
+ * Replacement global operator delete, matching operator new above.
+ *
+ * @param pMemory the memory
+ */
+void operator delete(void* pMemory) noexcept
+{
+    std::free(pMemory);
+}
+
+/**
+ * Replacement sized global operator delete, matching operator new above.
+ *
+ * @param pMemory the memory
+ */
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+    std::free(pMemory);
+}
+
+/**
+ * Tests that, once a tissue of fixed topology has been stepped a few times, a whole time
+ * step of the edge SRNs (SimulateToCurrentTime(), including the neighbour update and the
+ * ODE solve) and the edge species modifier no longer allocate memory, with each of the
+ * fixed-step and project-specific solvers.
+ */
+class TestAllocationFreeEdgeSpeciesUpdate : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Step a small tissue whose edges use a given solver, counting the allocations made
+     * after a few warm-up steps.
+     *
+     * @param rSolverName the name of a solver registered with PolarityEdgeOdeSolverRegistry
+     * @return the number of allocations
+     */
+    unsigned long CountAllocationsInTimeSteps(const std::string& rSolverName)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 100);
+        PolarityEdgeOdeSolverRegistry::Instance()->SetActiveSolver(rSolverName);
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        std::vector<CellPtr> cells;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < p_mesh->GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                std::vector<double> initial_conditions(8, 0.0);
+                initial_conditions[0] = 0.333 + 0.01*i;
+                initial_conditions[2] = 0.333 + 0.02*elem_index;
+                initial_conditions[3] = 0.333;
+
+                boost::shared_ptr<PolarityEdgeSrnModel> p_srn_model = PolarityEdgeSrnModel::Create();
+                p_srn_model->SetInitialConditions(initial_conditions);
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        // Diffusion, and neighbour means updated both incrementally and in full
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        p_modifier->SetUnboundProteinDiffusionCoefficient(0.03);
+        p_modifier->SetUseIncrementalNeighbourMeans(true);
+        p_modifier->SetDirtyEdgeTolerance(0.0);
+        p_modifier->SetFullNeighbourRecomputeInterval(4);
+        p_modifier->SetupSolve(cell_population, "TestAllocationFreeEdgeSpeciesUpdate/" + rSolverName);
+
+        const unsigned num_warm_up_steps = 5;
+        unsigned long num_allocations = 0;
+        for (unsigned step = 0; step < 20; step++)
+        {
+            if (step == num_warm_up_steps)
+            {
+                num_allocations = gNumberOfAllocations;
+            }
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter)
+            {
+                auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+                for (unsigned i = 0; i < p_cell_srn->GetNumEdgeSrn(); i++)
+                {
+                    // Updates the neighbour levels, then integrates the edge
+                    p_cell_srn->GetEdgeSrn(i)->SimulateToCurrentTime();
+                }
+            }
+            p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        }
+        num_allocations = gNumberOfAllocations - num_allocations;
+
+        TS_ASSERT_LESS_THAN(1u, p_modifier->GetNumberOfNeighbourExchanges());
+        return num_allocations;
+    }
+
+protected:
+
+    /**
+     * Destroy the registry after each test, so that the choice of solver does not carry over.
+     */
+    void tearDown()
+    {
+        AbstractCellBasedTestSuite::tearDown();
+        PolarityEdgeOdeSolverRegistry::Destroy();
+    }
+
+public:
+
+    void TestTimeStepsDoNotAllocate()
+    {
+        TS_ASSERT_EQUALS(CountAllocationsInTimeSteps("RungeKutta4"), 0ul);
+        TS_ASSERT_EQUALS(CountAllocationsInTimeSteps("ModifiedPatankar"), 0ul);
+        TS_ASSERT_EQUALS(CountAllocationsInTimeSteps("RosenbrockW"), 0ul);
+        TS_ASSERT_EQUALS(CountAllocationsInTimeSteps("Multirate"), 0ul);
+    }
+};
+
+#endif /*TESTALLOCATIONFREEEDGESPECIESUPDATE_HPP_*/
@@ -0,0 +1,262 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTASYNCEDGEDATAOUTPUTMODIFIER_HPP_
+#define TESTASYNCEDGEDATAOUTPUTMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "AsyncEdgeDataOutputModifier.hpp"
+#include "CellSrnModel.hpp"
+#include "DeltaNotchEdgeSpeciesTrackingModifier.hpp"
+#include "DeltaNotchEdgeSrnModel.hpp"
+#include "EdgeDataVtuWriter.hpp"
+#include "FileFinder.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "OutputFileHandler.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the background edge data writer and the modifier that feeds it.
+ */
+class TestAsyncEdgeDataOutputModifier : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * @param rPath the path of a file
+     * @return the contents of the file
+     */
+    std::string ReadFile(const std::string& rPath)
+    {
+        std::ifstream file(rPath.c_str());
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+public:
+
+    void TestWriterWithSingleBuffer()
+    {
+        OutputFileHandler handler("TestAsyncEdgeDataWriter");
+        const std::string directory = handler.GetOutputDirectoryFullPath();
+
+        // With one buffer every snapshot after the first waits for the previous one to be written
+        EdgeDataVtuWriter writer(directory, "edge_results", 1);
+        for (unsigned step = 0; step < 5; step++)
+        {
+            EdgeDataSnapshot& r_snapshot = writer.AcquireBuffer();
+            TS_ASSERT(r_snapshot.mPoints.empty());
+            r_snapshot.mTime = 0.5*step;
+            r_snapshot.mTimeStep = step;
+            r_snapshot.mPoints = {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+            r_snapshot.mConnectivity = {0, 1, 2};
+            r_snapshot.mCellIds = {3};
+            r_snapshot.mFieldNames = {"edge delta"};
+            r_snapshot.mFields.resize(1);
+            r_snapshot.mFields[0] = {0.25*step};
+            writer.Submit(r_snapshot);
+        }
+        writer.Finish();
+        TS_ASSERT_EQUALS(writer.GetNumberOfSnapshotsWritten(), 5u);
+
+        std::string vtu = ReadFile(directory + "edge_results_4.vtu");
+        TS_ASSERT_DIFFERS(vtu.find("NumberOfPoints=\"3\" NumberOfCells=\"1\""), std::string::npos);
+        TS_ASSERT_DIFFERS(vtu.find("Name=\"edge delta\""), std::string::npos);
+        std::string collection = ReadFile(directory + "edge_results.pvd");
+        TS_ASSERT_DIFFERS(collection.find("file=\"edge_results_0.vtu\""), std::string::npos);
+        TS_ASSERT_DIFFERS(collection.find("timestep=\"2\" group=\"\" part=\"0\" file=\"edge_results_4.vtu\""), std::string::npos);
+
+        TS_ASSERT_THROWS_THIS(writer.AcquireBuffer(),
+                              "No snapshots may be written once the edge data writer has finished.");
+        TS_ASSERT_THROWS_THIS(EdgeDataVtuWriter(directory, "edge_results", 0),
+                              "An edge data writer needs at least one snapshot buffer.");
+
+        // Errors on the background thread surface on the simulation's side
+        EdgeDataVtuWriter failing_writer(directory + "missing_directory", "edge_results", 2);
+        EdgeDataSnapshot& r_snapshot = failing_writer.AcquireBuffer();
+        failing_writer.Submit(r_snapshot);
+        TS_ASSERT_THROWS_CONTAINS(failing_writer.Finish(), "Could not write");
+    }
+
+    void TestWriterWithPieces()
+    {
+        OutputFileHandler handler("TestAsyncEdgeDataWriterPieces");
+        const std::string directory = handler.GetOutputDirectoryFullPath();
+
+        // A 6x4 grid of square cells, each of four triangles
+        EdgeDataVtuWriter writer(directory, "edge_results", 2, 4, true);
+        EdgeDataSnapshot& r_snapshot = writer.AcquireBuffer();
+        r_snapshot.mTime = 1.0;
+        r_snapshot.mTimeStep = 10;
+        r_snapshot.mFieldNames = {"edge delta"};
+        r_snapshot.mFields.resize(1);
+        for (unsigned i = 0; i < 6; i++)
+        {
+            for (unsigned j = 0; j < 4; j++)
+            {
+                const unsigned first_point = r_snapshot.mPoints.size()/3;
+                const double corners[5][2] = {{i + 0.5, j + 0.5}, {i + 0.0, j + 0.0}, {i + 1.0, j + 0.0}, {i + 1.0, j + 1.0}, {i + 0.0, j + 1.0}};
+                for (unsigned corner = 0; corner < 5; corner++)
+                {
+                    r_snapshot.mPoints.insert(r_snapshot.mPoints.end(), {corners[corner][0], corners[corner][1], 0.0});
+                }
+                for (unsigned edge = 0; edge < 4; edge++)
+                {
+                    r_snapshot.mConnectivity.insert(r_snapshot.mConnectivity.end(), {first_point, first_point + 1 + edge, first_point + 1 + (edge + 1)%4});
+                    r_snapshot.mCellIds.push_back(4*i + j);
+                    r_snapshot.mFields[0].push_back(0.1*edge);
+                }
+            }
+        }
+        writer.Submit(r_snapshot);
+        writer.Finish();
+
+        std::string pvtu = ReadFile(directory + "edge_results_10.pvtu");
+        TS_ASSERT_DIFFERS(pvtu.find("<PDataArray type=\"Float64\" Name=\"edge delta\"/>"), std::string::npos);
+        TS_ASSERT_DIFFERS(pvtu.find("<Piece Source=\"edge_results_10_3.vtu\"/>"), std::string::npos);
+        TS_ASSERT_EQUALS(ReadFile(directory + "edge_results.pvd").find("edge_results_10.vtu"), std::string::npos);
+
+        // Each piece holds a quadrant of six whole cells, compressed
+        for (unsigned piece = 0; piece < 4; piece++)
+        {
+            std::stringstream piece_name;
+            piece_name << directory << "edge_results_10_" << piece << ".vtu";
+            std::string vtu = ReadFile(piece_name.str());
+            TS_ASSERT_DIFFERS(vtu.find("NumberOfPoints=\"30\" NumberOfCells=\"24\""), std::string::npos);
+            TS_ASSERT_DIFFERS(vtu.find("compressor=\"vtkZLibDataCompressor\""), std::string::npos);
+            TS_ASSERT_DIFFERS(vtu.find("<AppendedData encoding=\"raw\">"), std::string::npos);
+        }
+
+        TS_ASSERT_THROWS_THIS(EdgeDataVtuWriter(directory, "edge_results", 2, 0),
+                              "An edge data writer needs at least one piece.");
+    }
+
+    void TestModifierInSimulation()
+    {
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        std::vector<CellPtr> cells;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < p_mesh->GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                std::vector<double> initial_conditions;
+                initial_conditions.push_back(0.1 + 0.05*((3*elem_index + i) % 7));
+                initial_conditions.push_back(0.2 + 0.03*((elem_index + 2*i) % 5));
+
+                MAKE_PTR(DeltaNotchEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(initial_conditions);
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestAsyncEdgeDataOutputModifier");
+        simulator.SetDt(0.1);
+        simulator.SetEndTime(1.0);
+        simulator.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(DeltaNotchEdgeSpeciesTrackingModifier<2>, p_tracking_modifier);
+        simulator.AddSimulationModifier(p_tracking_modifier);
+
+        MAKE_PTR(AsyncEdgeDataOutputModifier<2>, p_output_modifier);
+        p_output_modifier->SetSamplingTimestepMultiple(2);
+        TS_ASSERT_EQUALS(p_output_modifier->GetSamplingTimestepMultiple(), 2u);
+        TS_ASSERT_EQUALS(p_output_modifier->GetNumberOfBuffers(), 2u);
+        TS_ASSERT_THROWS_THIS(p_output_modifier->SetSamplingTimestepMultiple(0),
+                              "The sampling timestep multiple must be positive.");
+        p_output_modifier->SetNumberOfPieces(2);
+        p_output_modifier->SetUseCompression(true);
+        TS_ASSERT_EQUALS(p_output_modifier->GetNumberOfPieces(), 2u);
+        TS_ASSERT(p_output_modifier->GetUseCompression());
+        TS_ASSERT(!p_output_modifier->GetEdgeDataSchema());
+        p_output_modifier->SetEdgeDataSchema(p_tracking_modifier->GetEdgeDataSchema());
+        simulator.AddSimulationModifier(p_output_modifier);
+
+        simulator.Solve();
+
+        // The initial state and every second one of the ten steps
+        TS_ASSERT_EQUALS(p_output_modifier->GetWriter()->GetNumberOfSnapshotsWritten(), 6u);
+        TS_ASSERT(FileFinder("TestAsyncEdgeDataOutputModifier/edge_results_10.pvtu", RelativeTo::ChasteTestOutput).IsFile());
+        TS_ASSERT(!FileFinder("TestAsyncEdgeDataOutputModifier/edge_results_9.pvtu", RelativeTo::ChasteTestOutput).IsFile());
+        FileFinder first_piece("TestAsyncEdgeDataOutputModifier/edge_results_10_0.vtu", RelativeTo::ChasteTestOutput);
+        FileFinder second_piece("TestAsyncEdgeDataOutputModifier/edge_results_10_1.vtu", RelativeTo::ChasteTestOutput);
+        TS_ASSERT(first_piece.IsFile());
+        TS_ASSERT(second_piece.IsFile());
+
+        // A triangle per edge, shared between the pieces and carrying the edge levels but not the neighbour means
+        unsigned num_edges = 0;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            num_edges += p_mesh->GetElement(elem_index)->GetNumEdges();
+        }
+        unsigned num_triangles = 0;
+        for (const FileFinder& r_piece : {first_piece, second_piece})
+        {
+            std::string vtu = ReadFile(r_piece.GetAbsolutePath());
+            const std::size_t start = vtu.find("NumberOfCells=\"") + std::string("NumberOfCells=\"").size();
+            num_triangles += atoi(vtu.substr(start, vtu.find('"', start) - start).c_str());
+            TS_ASSERT_DIFFERS(vtu.find("Name=\"edge delta\""), std::string::npos);
+            TS_ASSERT_EQUALS(vtu.find("Name=\"neighbour notch\""), std::string::npos);
+        }
+        TS_ASSERT_EQUALS(num_triangles, num_edges);
+    }
+};
+
+#endif /*TESTASYNCEDGEDATAOUTPUTMODIFIER_HPP_*/
@@ -0,0 +1,131 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTCOUNTERBASEDRANDOMNUMBERGENERATOR_HPP_
+#define TESTCOUNTERBASEDRANDOMNUMBERGENERATOR_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+
+#include "CounterBasedRandomNumberGenerator.hpp"
+
+/**
+ * Tests for the counter-based random number generator.
+ */
+class TestCounterBasedRandomNumberGenerator : public CxxTest::TestSuite
+{
+public:
+
+    void TestPhiloxKnownAnswers()
+    {
+        // Known answer tests from the Random123 distribution
+        uint32_t result[4];
+
+        const uint32_t zero_counter[4] = {0, 0, 0, 0};
+        const uint32_t zero_key[2] = {0, 0};
+        CounterBasedRandomNumberGenerator::Philox4x32(zero_counter, zero_key, result);
+        TS_ASSERT_EQUALS(result[0], 0x6627e8d5u);
+        TS_ASSERT_EQUALS(result[1], 0xe169c58du);
+        TS_ASSERT_EQUALS(result[2], 0xbc57ac4cu);
+        TS_ASSERT_EQUALS(result[3], 0x9b00dbd8u);
+
+        const uint32_t ones_counter[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+        const uint32_t ones_key[2] = {0xffffffff, 0xffffffff};
+        CounterBasedRandomNumberGenerator::Philox4x32(ones_counter, ones_key, result);
+        TS_ASSERT_EQUALS(result[0], 0x408f276du);
+        TS_ASSERT_EQUALS(result[1], 0x41c83b0eu);
+        TS_ASSERT_EQUALS(result[2], 0xa20bc7c6u);
+        TS_ASSERT_EQUALS(result[3], 0x6d5451fdu);
+
+        const uint32_t pi_counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+        const uint32_t pi_key[2] = {0xa4093822, 0x299f31d0};
+        CounterBasedRandomNumberGenerator::Philox4x32(pi_counter, pi_key, result);
+        TS_ASSERT_EQUALS(result[0], 0xd16cfe09u);
+        TS_ASSERT_EQUALS(result[1], 0x94fdccebu);
+        TS_ASSERT_EQUALS(result[2], 0x5001e420u);
+        TS_ASSERT_EQUALS(result[3], 0x24126ea1u);
+    }
+
+    void TestDrawsDoNotDependOnOrder()
+    {
+        CounterBasedRandomNumberGenerator rng(3);
+
+        std::vector<double> forwards;
+        for (unsigned cell_index = 0; cell_index < 100; cell_index++)
+        {
+            forwards.push_back(rng.ranf(cell_index, 2, 1));
+        }
+        for (unsigned cell_index = 100; cell_index-- > 0;)
+        {
+            TS_ASSERT_EQUALS(rng.ranf(cell_index, 2, 1), forwards[cell_index]);
+        }
+
+        // A second generator with the same key gives the same numbers
+        CounterBasedRandomNumberGenerator same_rng(3);
+        TS_ASSERT_EQUALS(same_rng.ranfForCell(7, 0), rng.ranfForCell(7, 0));
+
+        // Different seeds, streams, cells, edges and draws give different numbers
+        TS_ASSERT_DIFFERS(CounterBasedRandomNumberGenerator(4).ranf(0, 0), rng.ranf(0, 0));
+        TS_ASSERT_DIFFERS(CounterBasedRandomNumberGenerator(3, 1).ranf(0, 0), rng.ranf(0, 0));
+        TS_ASSERT_DIFFERS(rng.ranf(1, 0), rng.ranf(0, 0));
+        TS_ASSERT_DIFFERS(rng.ranf(0, 1), rng.ranf(0, 0));
+        TS_ASSERT_DIFFERS(rng.ranf(0, 0, 1), rng.ranf(0, 0, 0));
+        TS_ASSERT_DIFFERS(rng.ranfForCell(0, 0), rng.ranf(0, 0, 0));
+    }
+
+    void TestUniformDistribution()
+    {
+        CounterBasedRandomNumberGenerator rng(0);
+        const unsigned num_draws = 100000;
+        double sum = 0.0;
+        double sum_of_squares = 0.0;
+        for (unsigned i = 0; i < num_draws; i++)
+        {
+            double x = rng.ranf(i, 0);
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, x);
+            TS_ASSERT_LESS_THAN(x, 1.0);
+            sum += x;
+            sum_of_squares += x*x;
+        }
+
+        // Mean 1/2 and variance 1/12, to within several standard errors
+        double mean = sum/num_draws;
+        TS_ASSERT_DELTA(mean, 0.5, 0.005);
+        TS_ASSERT_DELTA(sum_of_squares/num_draws - mean*mean, 1.0/12.0, 0.002);
+    }
+};
+
+#endif /*TESTCOUNTERBASEDRANDOMNUMBERGENERATOR_HPP_*/
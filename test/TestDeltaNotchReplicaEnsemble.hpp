@@ -0,0 +1,203 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTDELTANOTCHREPLICAENSEMBLE_HPP_
+#define TESTDELTANOTCHREPLICAENSEMBLE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cmath>
+
+#include "DeltaNotchReplicaEnsemble.hpp"
+#include "FileFinder.hpp"
+#include "PetscTools.hpp"
+#include "RunningStatistics.hpp"
+#include "SimulationTime.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+/**
+ * Tests for the running statistics and the Delta-Notch replica ensemble. These can also be
+ * run in parallel, in which case the replicas are shared between the processes.
+ */
+class TestDeltaNotchReplicaEnsemble : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestRunningStatistics()
+    {
+        RunningStatistics statistics(2);
+        RunningStatistics first_half(2);
+        RunningStatistics second_half(2);
+        for (unsigned i = 1; i <= 5; i++)
+        {
+            std::vector<double> sample = {double(i), 10.0 - 2.0*i};
+            statistics.AddSample(sample);
+            (i <= 2 ? first_half : second_half).AddSample(sample);
+        }
+
+        TS_ASSERT_EQUALS(statistics.GetCount(), 5u);
+        TS_ASSERT_DELTA(statistics.rGetMeans()[0], 3.0, 1e-12);
+        TS_ASSERT_DELTA(statistics.rGetMeans()[1], 4.0, 1e-12);
+        TS_ASSERT_DELTA(statistics.GetVariances()[0], 2.5, 1e-12);
+        TS_ASSERT_DELTA(statistics.GetVariances()[1], 10.0, 1e-12);
+
+        // Merging statistics of two halves gives the statistics of the whole
+        first_half.Merge(second_half);
+        TS_ASSERT_EQUALS(first_half.GetCount(), 5u);
+        TS_ASSERT_DELTA(first_half.rGetMeans()[0], 3.0, 1e-12);
+        TS_ASSERT_DELTA(first_half.GetVariances()[1], 10.0, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(statistics.AddSample(std::vector<double>(3, 0.0)),
+                              "A sample of 3 values cannot be added to statistics of 2 quantities.");
+        TS_ASSERT_THROWS_THIS(statistics.Merge(RunningStatistics(1)),
+                              "Statistics of 1 quantities cannot be merged with statistics of 2 quantities.");
+
+        // Each process contributes its rank
+        RunningStatistics rank_statistics;
+        rank_statistics.AddSample(std::vector<double>(1, PetscTools::GetMyRank()));
+        rank_statistics.MergeAcrossProcesses();
+        TS_ASSERT_EQUALS(rank_statistics.GetCount(), PetscTools::GetNumProcs());
+        TS_ASSERT_DELTA(rank_statistics.rGetMeans()[0], 0.5*(PetscTools::GetNumProcs() - 1.0), 1e-12);
+    }
+
+    void TestCalculateWavelength()
+    {
+        std::vector<double> alternating;
+        for (unsigned i = 0; i < 10; i++)
+        {
+            alternating.push_back(i%2);
+        }
+        TS_ASSERT_DELTA(DeltaNotchReplicaEnsemble::CalculateWavelength(alternating), 20.0/9.0, 1e-12);
+
+        std::vector<double> uniform(10, 1.0);
+        TS_ASSERT_DELTA(DeltaNotchReplicaEnsemble::CalculateWavelength(uniform), 20.0, 1e-12);
+    }
+
+    void TestCalculateRowWavelength()
+    {
+        /*
+         * Four rows of six cells laid out as in a honeycomb, with odd rows shifted by half a
+         * cell along x and with round-off sized noise in y, so that sorting all the cells by x
+         * alone would interleave the rows. The checkerboard alternates along every row.
+         */
+        std::vector<c_vector<double, 2> > centres;
+        std::vector<double> checkerboard;
+        std::vector<double> mixed;
+        for (unsigned row = 0; row < 4; row++)
+        {
+            for (unsigned i = 0; i < 6; i++)
+            {
+                c_vector<double, 2> centre;
+                centre[0] = i + 0.5*(row%2);
+                centre[1] = row*0.5*sqrt(3.0) + 1e-12*i;
+                centres.push_back(centre);
+                checkerboard.push_back((i + row)%2);
+
+                // Even rows alternate, odd rows change every other cell
+                mixed.push_back((row%2 == 0) ? i%2 : (i/2)%2);
+            }
+        }
+
+        // Each row of the checkerboard crosses its mean five times, a wavelength of 12/5 cells
+        TS_ASSERT_DELTA(DeltaNotchReplicaEnsemble::CalculateRowWavelength(centres, checkerboard), 2.4, 1e-12);
+
+        // Odd rows of the mixed pattern cross their mean twice, a wavelength of 6 cells
+        TS_ASSERT_DELTA(DeltaNotchReplicaEnsemble::CalculateRowWavelength(centres, mixed), 0.5*(2.4 + 6.0), 1e-12);
+
+        // A single row is the one-dimensional wavelength
+        std::vector<c_vector<double, 2> > row_centres(centres.begin(), centres.begin() + 6);
+        std::vector<double> row_levels(checkerboard.begin(), checkerboard.begin() + 6);
+        TS_ASSERT_DELTA(DeltaNotchReplicaEnsemble::CalculateRowWavelength(row_centres, row_levels),
+                        DeltaNotchReplicaEnsemble::CalculateWavelength(row_levels), 1e-12);
+    }
+
+    void TestReplicaEnsemble()
+    {
+        DeltaNotchReplicaEnsemble ensemble(6, 1, "TestDeltaNotchReplicaEnsemble");
+        ensemble.SetNumReplicas(4);
+        ensemble.SetBaseSeed(10);
+        ensemble.SetEndTime(2.0);
+        ensemble.Solve();
+
+        // Statistics of all four replicas are available on every process
+        TS_ASSERT_EQUALS(ensemble.rGetCellDeltaStatistics().GetCount(), 4u);
+        TS_ASSERT_EQUALS(ensemble.rGetCellDeltaStatistics().GetNumQuantities(), 6u);
+        TS_ASSERT_EQUALS(ensemble.rGetEdgeNotchStatistics().GetNumQuantities(), 36u);
+        TS_ASSERT_EQUALS(ensemble.rGetWavelengthStatistics().GetCount(), 4u);
+        TS_ASSERT_LESS_THAN(0.0, ensemble.rGetCellDeltaStatistics().GetVariances()[0]);
+        TS_ASSERT(FileFinder("TestDeltaNotchReplicaEnsemble/cell_statistics.dat", RelativeTo::ChasteTestOutput).IsFile());
+        TS_ASSERT(FileFinder("TestDeltaNotchReplicaEnsemble/edge_statistics.dat", RelativeTo::ChasteTestOutput).IsFile());
+        TS_ASSERT(FileFinder("TestDeltaNotchReplicaEnsemble/wavelength_statistics.dat", RelativeTo::ChasteTestOutput).IsFile());
+
+        // The replicas are reproducible
+        DeltaNotchReplicaEnsemble same_ensemble(6, 1, "TestDeltaNotchReplicaEnsemble");
+        same_ensemble.SetNumReplicas(4);
+        same_ensemble.SetBaseSeed(10);
+        same_ensemble.SetEndTime(2.0);
+        same_ensemble.Solve();
+
+        DeltaNotchReplicaEnsemble other_ensemble(6, 1, "TestDeltaNotchReplicaEnsemble");
+        other_ensemble.SetNumReplicas(4);
+        other_ensemble.SetBaseSeed(20);
+        other_ensemble.SetEndTime(2.0);
+        other_ensemble.Solve();
+
+        double difference = 0.0;
+        for (unsigned i = 0; i < 36; i++)
+        {
+            TS_ASSERT_DELTA(same_ensemble.rGetEdgeDeltaStatistics().rGetMeans()[i],
+                            ensemble.rGetEdgeDeltaStatistics().rGetMeans()[i], 1e-12);
+            difference = std::max(difference, fabs(other_ensemble.rGetEdgeDeltaStatistics().rGetMeans()[i]
+                                                   - ensemble.rGetEdgeDeltaStatistics().rGetMeans()[i]));
+        }
+        TS_ASSERT_LESS_THAN(1e-6, difference);
+
+        TS_ASSERT_THROWS_THIS(ensemble.SetNumReplicas(0), "The ensemble must have at least one replica.");
+
+        // The start time set up by the test suite is given back, with no end time
+        TS_ASSERT(SimulationTime::Instance()->IsStartTimeSetUp());
+        TS_ASSERT(!SimulationTime::Instance()->IsEndTimeAndNumberOfTimeStepsSetUp());
+        TS_ASSERT_DELTA(SimulationTime::Instance()->GetTime(), 0.0, 1e-12);
+
+        // The ensemble cannot take over SimulationTime from a running simulation
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 100);
+        TS_ASSERT_THROWS_THIS(ensemble.Solve(),
+                              "The replica ensemble sets up SimulationTime itself, so it cannot be solved while the end time is set up.");
+        TS_ASSERT_DELTA(SimulationTime::Instance()->GetTimeStep(), 0.1, 1e-12);
+    }
+};
+
+#endif /*TESTDELTANOTCHREPLICAENSEMBLE_HPP_*/
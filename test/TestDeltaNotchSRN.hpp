@@ -50,6 +50,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "CellSrnModel.hpp"
 #include "CellVolumesWriter.hpp"
 #include "CheckpointArchiveTypes.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
 #include "DeltaNotchEdgeSrnModel.hpp"
 #include "DeltaNotchEdgeTrackingModifier.hpp"
 #include "DeltaNotchInteriorSrnModel.hpp"
@@ -108,6 +109,10 @@ public:
         MAKE_PTR(WildTypeCellMutationState, p_state);
         MAKE_PTR(StemCellProliferativeType, p_diff_type);
         
+        /*Random levels are drawn from a counter-based generator, keyed by the cell index, so they do not
+          depend on the order in which the cells are set up*/
+        CounterBasedRandomNumberGenerator rng(0);
+
         /*Now we need to loop over all the elements in the mesh to set up our initial conditions*/
         for (unsigned elem_index=0; elem_index < p_mesh->GetNumElements(); elem_index++)
         {
@@ -123,8 +128,8 @@ public:
             auto p_cell_edge_srn_model = new CellSrnModel();
 
             /* We choose to initialise the total concentrations to random levels */
-            auto delta_concentration = RandomNumberGenerator::Instance()->ranf();
-            auto notch_concentration = RandomNumberGenerator::Instance()->ranf();
+            auto delta_concentration = rng.ranfForCell(elem_index, 0);
+            auto notch_concentration = rng.ranfForCell(elem_index, 1);
             
             /*Our concentrations will be initalised based on the edges current length*/
             double total_edge_length = 0.0;
@@ -158,7 +163,7 @@ public:
             p_cell->SetCellProliferativeType(p_diff_type);
             
             /*We also must give our cells a birth time, here we randomly initialise it*/
-            const double birth_time = -RandomNumberGenerator::Instance()->ranf() * 12.0;
+            const double birth_time = -rng.ranfForCell(elem_index, 2) * 12.0;
             p_cell->SetBirthTime(birth_time);
             /*Finally we push back the current cell to our overall cells*/
             cells.push_back(p_cell);
@@ -0,0 +1,303 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTEDGESPECIESTRACKINGMODIFIER_HPP_
+#define TESTEDGESPECIESTRACKINGMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <algorithm>
+#include <csignal>
+
+#include "CellSrnModel.hpp"
+#include "DeltaNotchEdgeSpeciesTrackingModifier.hpp"
+#include "DeltaNotchEdgeSrnModel.hpp"
+#include "DeltaNotchEdgeTrackingModifier.hpp"
+#include "EdgeDataSchema.hpp"
+#include "FileFinder.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "PolarityEdgeSpecies.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the species-list modifier EdgeSpeciesTrackingModifier. The polarity model is
+ * covered by the tests of PolarityEdgeTrackingModifier, which derives from it.
+ */
+class TestEdgeSpeciesTrackingModifier : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Create a Delta-Notch cell for each element of a mesh, with levels varying from edge to edge.
+     *
+     * @param rMesh the mesh
+     * @param rCells filled in with the cells
+     */
+    void CreateDeltaNotchCells(MutableVertexMesh<2,2>& rMesh, std::vector<CellPtr>& rCells)
+    {
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        for (unsigned elem_index = 0; elem_index < rMesh.GetNumElements(); elem_index++)
+        {
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < rMesh.GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                std::vector<double> initial_conditions;
+                initial_conditions.push_back(0.1 + 0.05*((3*elem_index + i) % 7));
+                initial_conditions.push_back(0.2 + 0.03*((elem_index + 2*i) % 5));
+
+                MAKE_PTR(DeltaNotchEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(initial_conditions);
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            rCells.push_back(p_cell);
+        }
+    }
+
+public:
+
+    void TestPolaritySpeciesList()
+    {
+        unsigned num_species = PolarityEdgeSpecies::NUM_SPECIES;
+        TS_ASSERT_EQUALS(num_species, 8u);
+        TS_ASSERT_EQUALS(std::string(PolarityEdgeSpecies::GetName(0)), "boundA");
+        TS_ASSERT_EQUALS(std::string(PolarityEdgeSpecies::GetName(7)), "AC");
+
+        // Only the unbound proteins A, B and C diffuse
+        for (unsigned species = 0; species < PolarityEdgeSpecies::NUM_SPECIES; species++)
+        {
+            bool is_unbound = (species == 1 || species == 2 || species == 3);
+            TS_ASSERT_EQUALS(PolarityEdgeSpecies::IsDiffusing(species), is_unbound);
+            TS_ASSERT(PolarityEdgeSpecies::IsExchanged(species));
+        }
+
+        // The levels are read and written in the order of the names
+        PolarityEdgeSrnModel srn_model;
+        srn_model.Initialise();
+        std::array<double, PolarityEdgeSpecies::NUM_SPECIES> levels = {{1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0}};
+        PolarityEdgeSpecies::SetLevels(srn_model, levels);
+        TS_ASSERT_DELTA(srn_model.GetBoundA(), 1.0, 1e-12);
+        TS_ASSERT_DELTA(srn_model.GetA(), 2.0, 1e-12);
+        TS_ASSERT_DELTA(srn_model.GetAC(), 8.0, 1e-12);
+
+        std::array<double, PolarityEdgeSpecies::NUM_SPECIES> read_levels;
+        PolarityEdgeSpecies::GetLevels(srn_model, read_levels);
+        TS_ASSERT_EQUALS(read_levels, levels);
+    }
+
+    void TestDeltaNotchMatchesHandWrittenModifier()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        HoneycombVertexMeshGenerator generator(4, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> reference_cells;
+        CreateDeltaNotchCells(*p_mesh, reference_cells);
+        VertexBasedCellPopulation<2> reference_population(*p_mesh, reference_cells);
+        reference_population.InitialiseCells();
+
+        std::vector<CellPtr> cells;
+        CreateDeltaNotchCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        MAKE_PTR(DeltaNotchEdgeTrackingModifier<2>, p_reference_modifier);
+        p_reference_modifier->SetupSolve(reference_population, "TestEdgeSpeciesTrackingModifier");
+
+        MAKE_PTR(DeltaNotchEdgeSpeciesTrackingModifier<2>, p_modifier);
+        p_modifier->SetupSolve(cell_population, "TestEdgeSpeciesTrackingModifier");
+
+        // Both publish the same edge levels and neighbour means
+        const std::string items[4] = {"edge delta", "edge notch", "neighbour delta", "neighbour notch"};
+        for (unsigned cell_index = 0; cell_index < cells.size(); cell_index++)
+        {
+            for (const std::string& r_item : items)
+            {
+                std::vector<double> expected = reference_cells[cell_index]->GetCellEdgeData()->GetItem(r_item);
+                std::vector<double> published = cells[cell_index]->GetCellEdgeData()->GetItem(r_item);
+                TS_ASSERT_EQUALS(published.size(), expected.size());
+                for (unsigned i = 0; i < published.size(); i++)
+                {
+                    TS_ASSERT_DELTA(published[i], expected[i], 1e-12);
+                }
+            }
+        }
+
+        // Neither Delta nor Notch diffuses, so the end of a time step leaves the edge levels alone
+        std::vector<double> delta_before = cells[5]->GetCellEdgeData()->GetItem("edge delta");
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        std::vector<double> delta_after = cells[5]->GetCellEdgeData()->GetItem("edge delta");
+        TS_ASSERT_EQUALS(delta_after, delta_before);
+        TS_ASSERT_EQUALS(p_modifier->GetNumberOfNeighbourExchanges(), 2u);
+
+        TS_ASSERT_THROWS_THIS(p_modifier->SetDiffusionCoefficient(-1.0),
+                              "The diffusion coefficient must be non-negative.");
+    }
+
+    void TestEdgeDataSchema()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        CreateDeltaNotchCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        // By default the edge levels are kept and written, the neighbour means only kept
+        MAKE_PTR(DeltaNotchEdgeSpeciesTrackingModifier<2>, p_modifier);
+        boost::shared_ptr<EdgeDataSchema> p_schema = p_modifier->GetEdgeDataSchema();
+        TS_ASSERT_EQUALS(p_schema->GetNumFields(), 4u);
+        std::vector<std::string> kept_fields = {"edge delta", "edge notch", "neighbour delta", "neighbour notch"};
+        std::vector<std::string> written_fields = {"edge delta", "edge notch"};
+        TS_ASSERT_EQUALS(p_schema->GetKeptFields(), kept_fields);
+        TS_ASSERT_EQUALS(p_schema->GetWrittenFields(), written_fields);
+        TS_ASSERT(p_schema->IsItemWritten("some other item"));
+        TS_ASSERT(!p_schema->IsItemWritten("neighbour delta"));
+
+        // The edge SRNs read the neighbour means, so they cannot be dropped
+        TS_ASSERT_THROWS_THIS(p_schema->SetKept("neighbour delta", false),
+                              "The edge data field \"neighbour delta\" is read by the edge SRNs and must be kept.");
+        TS_ASSERT_THROWS_THIS(p_schema->SetKept("in delta", false),
+                              "The edge data schema has no field called \"in delta\".");
+        TS_ASSERT_THROWS_THIS(p_schema->AddField("edge delta", false, true),
+                              "The edge data schema already has a field called \"edge delta\".");
+
+        // Writing a field keeps it, and dropping it stops it being written
+        p_schema->SetWritten("neighbour notch", true);
+        TS_ASSERT(p_schema->IsWritten(p_schema->GetFieldIndex("neighbour notch")));
+        p_schema->SetKept("edge notch", false);
+        TS_ASSERT(!p_schema->IsKept(p_schema->GetFieldIndex("edge notch")));
+        TS_ASSERT(!p_schema->IsWritten(p_schema->GetFieldIndex("edge notch")));
+
+        // Only the kept fields are stored, with no copies of the edge levels
+        p_modifier->SetupSolve(cell_population, "TestEdgeSpeciesTrackingModifier");
+        std::vector<std::string> stored_items = {"edge delta", "neighbour delta", "neighbour notch"};
+        for (CellPtr p_cell : cells)
+        {
+            std::vector<std::string> keys = p_cell->GetCellEdgeData()->GetKeys();
+            std::sort(keys.begin(), keys.end());
+            TS_ASSERT_EQUALS(keys, stored_items);
+        }
+    }
+
+    void TestFlightRecorder()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        CreateDeltaNotchCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        // Without a flight recorder there is nothing to dump
+        MAKE_PTR(DeltaNotchEdgeSpeciesTrackingModifier<2>, p_modifier);
+        TS_ASSERT_EQUALS(p_modifier->GetFlightRecorderLength(), 0u);
+        TS_ASSERT(!p_modifier->GetDumpFlightRecorderOnSignal());
+        TS_ASSERT_DELTA(p_modifier->GetFlightRecorderNegativeTolerance(), 1e-8, 1e-12);
+        TS_ASSERT_THROWS_THIS(p_modifier->SetFlightRecorderNegativeTolerance(-1.0),
+                              "The flight recorder's negative level tolerance must be non-negative.");
+        p_modifier->SetupSolve(cell_population, "TestEdgeSpeciesTrackingModifierFlightRecorder");
+        TS_ASSERT(!p_modifier->GetFlightRecorder());
+        TS_ASSERT_EQUALS(p_modifier->DumpFlightRecorder("test"), "");
+
+        // The recorder holds the last three steps
+        p_modifier->SetFlightRecorderLength(3);
+        p_modifier->SetDumpFlightRecorderOnSignal(true);
+        p_modifier->SetupSolve(cell_population, "TestEdgeSpeciesTrackingModifierFlightRecorder");
+        for (unsigned step = 0; step < 4; step++)
+        {
+            p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        }
+        boost::shared_ptr<EdgeStateFlightRecorder> p_recorder = p_modifier->GetFlightRecorder();
+        TS_ASSERT_EQUALS(p_recorder->GetLength(), 3u);
+        TS_ASSERT_EQUALS(p_recorder->GetNumFramesHeld(), 3u);
+        TS_ASSERT_EQUALS(p_recorder->GetNumberOfDumps(), 0u);
+
+        // Its frames hold the packed levels and neighbour means, in cell iteration order
+        const EdgeStateFrame& r_frame = p_recorder->rGetFrame(0);
+        TS_ASSERT_EQUALS(r_frame.mCellIds.size(), cells.size());
+        TS_ASSERT_EQUALS(r_frame.mCellIds[0], cells[0]->GetCellId());
+        std::vector<double> notch = cells[0]->GetCellEdgeData()->GetItem("edge notch");
+        std::vector<double> neighbour_delta = cells[0]->GetCellEdgeData()->GetItem("neighbour delta");
+        for (unsigned edge = 0; edge < notch.size(); edge++)
+        {
+            TS_ASSERT_DELTA(r_frame.mLevels[2*edge + 1], notch[edge], 1e-12);
+            TS_ASSERT_DELTA(r_frame.mNeighbourMeans[2*edge], neighbour_delta[edge], 1e-12);
+        }
+
+        // Explicit dumps
+        std::string path = p_modifier->DumpFlightRecorder("requested by the test");
+        TS_ASSERT(FileFinder(path, RelativeTo::Absolute).IsFile());
+        TS_ASSERT_EQUALS(p_recorder->GetNumberOfDumps(), 1u);
+
+        // A signal triggers a dump at the next step
+        std::raise(SIGUSR1);
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        TS_ASSERT_EQUALS(p_recorder->GetNumberOfDumps(), 2u);
+
+        // So does a negative level, once
+        auto p_cell_srn = static_cast<CellSrnModel*>(cells[4]->GetSrnModel());
+        auto p_edge_srn = boost::static_pointer_cast<DeltaNotchEdgeSrnModel>(p_cell_srn->GetEdgeSrn(2));
+        p_edge_srn->SetDelta(-1.0);
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        TS_ASSERT_EQUALS(p_recorder->GetNumberOfDumps(), 3u);
+        TS_ASSERT(FileFinder("TestEdgeSpeciesTrackingModifierFlightRecorder/flight_recorder_2.dat",
+                             RelativeTo::ChasteTestOutput).IsFile());
+
+        p_modifier->UpdateAtEndOfSolve(cell_population);
+    }
+};
+
+#endif /*TESTEDGESPECIESTRACKINGMODIFIER_HPP_*/
@@ -0,0 +1,168 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTFIXEDSIZEOBJECTPOOL_HPP_
+#define TESTFIXEDSIZEOBJECTPOOL_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <set>
+#include <vector>
+
+#include "FixedSizeObjectPool.hpp"
+#include "FixedSizeObjectPoolAllocator.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for allocating edge SRN models, their ODE systems and their shared pointers from pools.
+ */
+class TestFixedSizeObjectPool : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestPoolReusesFreedObjects()
+    {
+        FixedSizeObjectPool pool(20, 4);
+        TS_ASSERT_EQUALS(pool.GetObjectSize() % alignof(std::max_align_t), 0u);
+        TS_ASSERT_LESS_THAN_EQUALS(20u, pool.GetObjectSize());
+        TS_ASSERT_EQUALS(pool.GetCapacity(), 0u);
+
+        // Six objects take two chunks, and are all distinct
+        std::vector<void*> objects;
+        for (unsigned i = 0; i < 6; i++)
+        {
+            objects.push_back(pool.Allocate());
+        }
+        TS_ASSERT_EQUALS(std::set<void*>(objects.begin(), objects.end()).size(), 6u);
+        TS_ASSERT_EQUALS(pool.GetNumObjectsInUse(), 6u);
+        TS_ASSERT_EQUALS(pool.GetCapacity(), 8u);
+
+        // Freed objects are handed out again, most recent first, without another chunk
+        pool.Deallocate(objects[1]);
+        pool.Deallocate(objects[4]);
+        TS_ASSERT_EQUALS(pool.GetNumObjectsInUse(), 4u);
+        TS_ASSERT_EQUALS(pool.Allocate(), objects[4]);
+        TS_ASSERT_EQUALS(pool.Allocate(), objects[1]);
+        pool.Allocate();
+        pool.Allocate();
+        TS_ASSERT_EQUALS(pool.GetCapacity(), 8u);
+        pool.Allocate();
+        TS_ASSERT_EQUALS(pool.GetCapacity(), 12u);
+        TS_ASSERT_EQUALS(pool.GetNumObjectsInUse(), 9u);
+    }
+
+    void TestEdgeSrnModelsComeFromPools()
+    {
+        FixedSizeObjectPool* p_srn_pool = PolarityEdgeSrnModel::GetObjectPool();
+        FixedSizeObjectPool* p_system_pool = PolarityEdgeOdeSystem::GetObjectPool();
+        const unsigned num_srns = p_srn_pool->GetNumObjectsInUse();
+        const unsigned num_systems = p_system_pool->GetNumObjectsInUse();
+
+        std::vector<double> kinetic_parameters = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+        kinetic_parameters[0] *= 2.0;
+        {
+            boost::shared_ptr<PolarityEdgeSrnModel> p_srn_model(new PolarityEdgeSrnModel);
+            p_srn_model->SetInitialConditions(std::vector<double>(8, 0.25));
+            p_srn_model->SetKineticParameters(kinetic_parameters);
+            p_srn_model->Initialise();
+            TS_ASSERT_EQUALS(p_srn_pool->GetNumObjectsInUse(), num_srns + 1);
+            TS_ASSERT_EQUALS(p_system_pool->GetNumObjectsInUse(), num_systems + 1);
+
+            // Copies, as made on division, copy every parameter
+            p_srn_model->GetOdeSystem()->SetParameter(4, 0.75);
+            boost::shared_ptr<AbstractSrnModel> p_copy(p_srn_model->CreateSrnModel());
+            TS_ASSERT_EQUALS(p_srn_pool->GetNumObjectsInUse(), num_srns + 2);
+            TS_ASSERT_EQUALS(p_system_pool->GetNumObjectsInUse(), num_systems + 2);
+
+            auto p_copied_model = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_copy);
+            TS_ASSERT_DELTA(p_copied_model->GetOdeSystem()->GetParameter(4), 0.75, 1e-12);
+            TS_ASSERT_DELTA(p_copied_model->GetKineticParameters()[0], kinetic_parameters[0], 1e-12);
+            TS_ASSERT_DELTA(p_copied_model->GetBA(), 0.25, 1e-12);
+        }
+
+        // Removing the edges returns their memory to the pools
+        TS_ASSERT_EQUALS(p_srn_pool->GetNumObjectsInUse(), num_srns);
+        TS_ASSERT_EQUALS(p_system_pool->GetNumObjectsInUse(), num_systems);
+
+        const unsigned capacity = p_srn_pool->GetCapacity();
+        for (unsigned i = 0; i < 10*capacity; i++)
+        {
+            boost::shared_ptr<PolarityEdgeSrnModel> p_srn_model(new PolarityEdgeSrnModel);
+        }
+        TS_ASSERT_EQUALS(p_srn_pool->GetCapacity(), capacity);
+    }
+
+    void TestSharedPointerControlBlocksAndSystemInformationArePooled()
+    {
+        FixedSizeObjectPool* p_srn_pool = PolarityEdgeSrnModel::GetObjectPool();
+        FixedSizeObjectPool* p_control_block_pool = PolarityEdgeSrnModel::GetControlBlockPool();
+        const unsigned num_srns = p_srn_pool->GetNumObjectsInUse();
+        const unsigned num_control_blocks = p_control_block_pool->GetNumObjectsInUse();
+        {
+            boost::shared_ptr<PolarityEdgeSrnModel> p_srn_model = PolarityEdgeSrnModel::Create();
+            TS_ASSERT_EQUALS(p_srn_pool->GetNumObjectsInUse(), num_srns + 1);
+            TS_ASSERT_EQUALS(p_control_block_pool->GetNumObjectsInUse(), num_control_blocks + 1);
+
+            // Every system shares one system information and one block of kinetic parameters
+            p_srn_model->Initialise();
+            PolarityEdgeOdeSystem other_system;
+            TS_ASSERT_EQUALS(p_srn_model->GetOdeSystem()->GetSystemInformation(), other_system.GetSystemInformation());
+            TS_ASSERT_EQUALS(other_system.GetSystemInformation(), PolarityEdgeOdeSystem::GetSharedSystemInformation());
+            TS_ASSERT_EQUALS(other_system.rGetStateVariableNames()[7], "AC");
+            TS_ASSERT_DELTA(other_system.GetInitialConditions()[0], 1.0, 1e-12);
+        }
+        TS_ASSERT_EQUALS(p_srn_pool->GetNumObjectsInUse(), num_srns);
+        TS_ASSERT_EQUALS(p_control_block_pool->GetNumObjectsInUse(), num_control_blocks);
+
+        // Arrays, and objects too large for the pool, come from the heap instead
+        FixedSizeObjectPool pool(16, 4);
+        FixedSizeObjectPoolAllocator<double> allocator(&pool);
+        double* p_values = allocator.allocate(3);
+        TS_ASSERT_EQUALS(pool.GetNumObjectsInUse(), 0u);
+        allocator.deallocate(p_values, 3);
+        FixedSizeObjectPoolAllocator<char[64]> large_allocator(allocator);
+        TS_ASSERT(large_allocator == allocator);
+        large_allocator.deallocate(large_allocator.allocate(1), 1);
+        p_values = allocator.allocate(1);
+        TS_ASSERT_EQUALS(pool.GetNumObjectsInUse(), 1u);
+        allocator.deallocate(p_values, 1);
+        TS_ASSERT_EQUALS(pool.GetNumObjectsInUse(), 0u);
+    }
+};
+
+#endif /*TESTFIXEDSIZEOBJECTPOOL_HPP_*/
@@ -0,0 +1,198 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMODIFIEDPATANKARRUNGEKUTTAIVPODESOLVER_HPP_
+#define TESTMODIFIEDPATANKARRUNGEKUTTAIVPODESOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ModifiedPatankarRungeKuttaIvpOdeSolver.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the positivity-preserving, conservative Patankar solver.
+ */
+class TestModifiedPatankarRungeKuttaIvpOdeSolver : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Set up an edge with nonzero levels of everything on the facing edge.
+     *
+     * @param rSystem the system to set up
+     */
+    void SetNeighbourLevels(PolarityEdgeOdeSystem& rSystem)
+    {
+        rSystem.SetParameter("neighbour A", 0.4);
+        rSystem.SetParameter("neighbour B", 0.35);
+        rSystem.SetParameter("neighbour C", 0.3);
+        rSystem.SetParameter("neighbour BA", 0.05);
+        rSystem.SetParameter("neighbour CA", 0.02);
+    }
+
+    /**
+     * @param rY the state of an edge
+     * @return the total amount of A on the edge
+     */
+    double GetTotalA(const std::vector<double>& rY)
+    {
+        return rY[0] + rY[1] + rY[4] + rY[5] + rY[6] + rY[7];
+    }
+
+    /**
+     * @param rY the state of an edge
+     * @return the total amount of B on the edge, which the polarity ODEs conserve
+     */
+    double GetTotalB(const std::vector<double>& rY)
+    {
+        return rY[2] + rY[4];
+    }
+
+    /**
+     * @param rY the state of an edge
+     * @return the total amount of C on the edge, which the polarity ODEs conserve
+     */
+    double GetTotalC(const std::vector<double>& rY)
+    {
+        return rY[3] + rY[6];
+    }
+
+public:
+
+    void TestConvergenceAndConservation()
+    {
+        std::vector<double> initial_conditions(8, 0.0);
+        initial_conditions[0] = 0.333;
+        initial_conditions[2] = 0.333;
+        initial_conditions[3] = 0.333;
+
+        PolarityEdgeOdeSystem ode_system(initial_conditions);
+        SetNeighbourLevels(ode_system);
+        std::vector<double> reference = initial_conditions;
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.Solve(&ode_system, reference, 0.0, 20.0, 1e-4);
+
+        ModifiedPatankarRungeKuttaIvpOdeSolver solver;
+
+        // At ten times the usual RK4 step the solution is accurate, and all three totals are conserved to round-off
+        std::vector<double> state = initial_conditions;
+        solver.Solve(&ode_system, state, 0.0, 20.0, 0.01);
+        double error = 0.0;
+        for (unsigned i = 0; i < 8; i++)
+        {
+            error = std::max(error, fabs(state[i] - reference[i]));
+        }
+        TS_ASSERT_LESS_THAN(error, 1e-6);
+        TS_ASSERT_DELTA(GetTotalA(state), GetTotalA(initial_conditions), 1e-12);
+        TS_ASSERT_DELTA(GetTotalB(state), GetTotalB(initial_conditions), 1e-12);
+        TS_ASSERT_DELTA(GetTotalC(state), GetTotalC(initial_conditions), 1e-12);
+
+        // Halving the step quarters the error
+        std::vector<double> coarse_state = initial_conditions;
+        solver.Solve(&ode_system, coarse_state, 0.0, 20.0, 0.02);
+        double coarse_error = 0.0;
+        for (unsigned i = 0; i < 8; i++)
+        {
+            coarse_error = std::max(coarse_error, fabs(coarse_state[i] - reference[i]));
+        }
+        TS_ASSERT_LESS_THAN(3.5*error, coarse_error);
+        TS_ASSERT_LESS_THAN(coarse_error, 4.5*error);
+
+        // At very large steps it is inaccurate, but the totals are still conserved and nothing goes negative
+        const double large_steps[2] = {1.0, 10.0};
+        for (unsigned k = 0; k < 2; k++)
+        {
+            state = initial_conditions;
+            solver.Solve(&ode_system, state, 0.0, 20.0, large_steps[k]);
+            TS_ASSERT_DELTA(GetTotalA(state), GetTotalA(initial_conditions), 1e-12);
+            TS_ASSERT_DELTA(GetTotalB(state), GetTotalB(initial_conditions), 1e-12);
+            TS_ASSERT_DELTA(GetTotalC(state), GetTotalC(initial_conditions), 1e-12);
+            for (unsigned i = 0; i < 8; i++)
+            {
+                TS_ASSERT_LESS_THAN(0.0, state[i]);
+            }
+        }
+    }
+
+    void TestLowAbundance()
+    {
+        // Explicit schemes undershoot here unless the step is tiny
+        std::vector<double> initial_conditions(8, 0.0);
+        initial_conditions[0] = 1e-8;
+        initial_conditions[2] = 1e-8;
+        initial_conditions[3] = 0.333;
+        PolarityEdgeOdeSystem ode_system(initial_conditions);
+        SetNeighbourLevels(ode_system);
+
+        std::vector<double> state = initial_conditions;
+        ModifiedPatankarRungeKuttaIvpOdeSolver solver;
+        solver.Solve(&ode_system, state, 0.0, 100.0, 10.0);
+        for (unsigned i = 0; i < 8; i++)
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, state[i]);
+        }
+        TS_ASSERT_DELTA(GetTotalA(state), 1e-8, 1e-20);
+        TS_ASSERT_DELTA(GetTotalB(state), 1e-8, 1e-20);
+        TS_ASSERT_DELTA(GetTotalC(state), 0.333, 1e-12);
+
+        // Negative input is rejected rather than silently propagated
+        state[2] = -1e-3;
+        TS_ASSERT_THROWS_CONTAINS(solver.Solve(&ode_system, state, 0.0, 1.0, 0.1),
+                                  "ModifiedPatankarRungeKuttaIvpOdeSolver needs non-negative state variables");
+    }
+
+    void TestUseWithSrnModel()
+    {
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        TS_ASSERT(p_registry->HasSolver("ModifiedPatankar"));
+        TS_ASSERT(!p_registry->IsAdaptive("ModifiedPatankar"));
+
+        const std::string original_solver = p_registry->rGetActiveSolver();
+        p_registry->SetActiveSolver("ModifiedPatankar");
+        PolarityEdgeSrnModel srn_model;
+        TS_ASSERT_DELTA(srn_model.GetDt(), 0.01, 1e-12);
+        p_registry->SetActiveSolver(original_solver);
+    }
+};
+
+#endif /*TESTMODIFIEDPATANKARRUNGEKUTTAIVPODESOLVER_HPP_*/
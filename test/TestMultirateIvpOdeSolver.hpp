@@ -0,0 +1,200 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMULTIRATEIVPODESOLVER_HPP_
+#define TESTMULTIRATEIVPODESOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "MultirateIvpOdeSolver.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the multirate solver on PolarityEdgeOdeSystem.
+ */
+class TestMultirateIvpOdeSolver : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Set up an edge with nonzero levels of everything on the facing edge.
+     *
+     * @param rSystem the system to set up
+     */
+    void SetNeighbourLevels(PolarityEdgeOdeSystem& rSystem)
+    {
+        rSystem.SetParameter("neighbour A", 0.4);
+        rSystem.SetParameter("neighbour B", 0.35);
+        rSystem.SetParameter("neighbour C", 0.3);
+        rSystem.SetParameter("neighbour BA", 0.05);
+        rSystem.SetParameter("neighbour CA", 0.02);
+    }
+
+    /**
+     * @return the initial conditions used in TestPolaritySRN
+     */
+    std::vector<double> GetInitialConditions()
+    {
+        std::vector<double> initial_conditions(8, 0.0);
+        initial_conditions[0] = 0.333;
+        initial_conditions[2] = 0.333;
+        initial_conditions[3] = 0.333;
+        return initial_conditions;
+    }
+
+public:
+
+    void TestLongRunAgainstRungeKutta4()
+    {
+        PolarityEdgeOdeSystem reference_system(GetInitialConditions());
+        SetNeighbourLevels(reference_system);
+        std::vector<double> reference = GetInitialConditions();
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.Solve(&reference_system, reference, 0.0, 200.0, 1e-3);
+
+        // Integrate over intervals of one time unit, as the SRN model would with a large dt
+        PolarityEdgeOdeSystem ode_system(GetInitialConditions());
+        SetNeighbourLevels(ode_system);
+        std::vector<double> state = GetInitialConditions();
+        MultirateIvpOdeSolver solver;
+        for (unsigned i = 0; i < 200; i++)
+        {
+            solver.Solve(&ode_system, state, i, i + 1.0, 1.0);
+        }
+
+        for (unsigned i = 0; i < 8; i++)
+        {
+            TS_ASSERT_DELTA(state[i], reference[i], 1e-4);
+        }
+
+        // Far fewer right-hand side evaluations than RK4, which needed 800000
+        TS_ASSERT_LESS_THAN(solver.GetNumberOfRhsEvaluations(), 20000u);
+
+        // Unbinding of bound A is the fastest process, so bound A is substepped
+        const std::vector<unsigned>& r_fast = solver.rGetLastFastSpecies();
+        TS_ASSERT(std::find(r_fast.begin(), r_fast.end(), 1u) != r_fast.end());
+        TS_ASSERT(std::find(r_fast.begin(), r_fast.end(), 2u) == r_fast.end());
+        TS_ASSERT_DELTA(ode_system.GetSuggestedTimeStep(), 1.0, 1e-12);
+    }
+
+    void TestFastSpeciesHint()
+    {
+        PolarityEdgeOdeSystem reference_system(GetInitialConditions());
+        SetNeighbourLevels(reference_system);
+        std::vector<double> reference = GetInitialConditions();
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.Solve(&reference_system, reference, 0.0, 5.0, 1e-4);
+
+        // Treat the complexes as fast during the initial transient
+        PolarityEdgeOdeSystem ode_system(GetInitialConditions());
+        SetNeighbourLevels(ode_system);
+        std::vector<unsigned> complexes;
+        for (unsigned i = 4; i < 8; i++)
+        {
+            complexes.push_back(i);
+        }
+        ode_system.SetFastSpeciesHint(complexes);
+        TS_ASSERT_EQUALS(ode_system.rGetFastSpeciesHint().size(), 4u);
+
+        std::vector<double> state = GetInitialConditions();
+        MultirateIvpOdeSolver solver;
+        solver.Solve(&ode_system, state, 0.0, 5.0, 1.0);
+        for (unsigned i = 0; i < 8; i++)
+        {
+            TS_ASSERT_DELTA(state[i], reference[i], 1e-4);
+        }
+        TS_ASSERT_EQUALS(solver.rGetLastFastSpecies().size(), 4u);
+        TS_ASSERT_EQUALS(solver.rGetLastFastSpecies()[0], 4u);
+
+        std::vector<unsigned> bad_hint(1, 8);
+        TS_ASSERT_THROWS_THIS(ode_system.SetFastSpeciesHint(bad_hint), "Fast species index 8 is out of range.");
+        TS_ASSERT_THROWS_THIS(solver.SetTolerances(-1.0, 1e-6), "ODE solver tolerances must be positive.");
+    }
+
+    void TestAllSpeciesFast()
+    {
+        PolarityEdgeOdeSystem reference_system(GetInitialConditions());
+        SetNeighbourLevels(reference_system);
+        std::vector<double> reference = GetInitialConditions();
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.Solve(&reference_system, reference, 0.0, 50.0, 1e-4);
+
+        // With no slow partition, only the RK4 substeps' own error estimate limits the macro step
+        PolarityEdgeOdeSystem ode_system(GetInitialConditions());
+        SetNeighbourLevels(ode_system);
+        std::vector<unsigned> all_species;
+        for (unsigned i = 0; i < 8; i++)
+        {
+            all_species.push_back(i);
+        }
+        ode_system.SetFastSpeciesHint(all_species);
+
+        std::vector<double> state = GetInitialConditions();
+        MultirateIvpOdeSolver solver;
+        solver.SetTolerances(1e-7, 1e-9);
+        solver.Solve(&ode_system, state, 0.0, 50.0, 10.0);
+        TS_ASSERT_EQUALS(solver.rGetLastFastSpecies().size(), 8u);
+
+        // Taking the largest macro step throughout would give errors of about 1e-9
+        TS_ASSERT_LESS_THAN(0u, solver.GetNumberOfRejectedSteps());
+        for (unsigned i = 0; i < 8; i++)
+        {
+            TS_ASSERT_DELTA(state[i], reference[i], 1e-11);
+        }
+    }
+
+    void TestUseWithSrnModel()
+    {
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        TS_ASSERT(p_registry->HasSolver("Multirate"));
+        TS_ASSERT(p_registry->IsAdaptive("Multirate"));
+
+        const std::string original_solver = p_registry->rGetActiveSolver();
+        p_registry->SetActiveSolver("Multirate");
+        PolarityEdgeSrnModel srn_model;
+        TS_ASSERT_DELTA(srn_model.GetDt(), 0.1, 1e-12);
+        p_registry->SetActiveSolver(original_solver);
+    }
+};
+
+#endif /*TESTMULTIRATEIVPODESOLVER_HPP_*/
@@ -0,0 +1,189 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYCELLSGENERATOR_HPP_
+#define TESTPOLARITYCELLSGENERATOR_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <fstream>
+#include <string>
+
+#include "CellSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OutputFileHandler.hpp"
+#include "PolarityCellsGenerator.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityInitialConditionTable.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for building a tissue of polarity edge SRNs from a table of initial conditions.
+ */
+class TestPolarityCellsGenerator : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * @return the level of a species on an edge of a cell in the test table
+     */
+    static double Level(unsigned cell, unsigned edge, unsigned species)
+    {
+        return 0.01*cell + 0.001*edge + 0.0001*species;
+    }
+
+public:
+
+    void TestInitialConditionTable()
+    {
+        std::vector<unsigned> num_edges = {6, 4};
+        std::vector<double> birth_times = {-1.0, -2.0};
+        std::vector<double> levels(10*8);
+        for (unsigned i = 0; i < levels.size(); i++)
+        {
+            levels[i] = 0.5*i;
+        }
+        PolarityInitialConditionTable table(8, num_edges, birth_times, levels);
+
+        OutputFileHandler handler("TestPolarityInitialConditionTable");
+        const std::string path = handler.GetOutputDirectoryFullPath() + "table.bin";
+        table.Write(path);
+
+        boost::shared_ptr<PolarityInitialConditionTable> p_table = PolarityInitialConditionTable::Load(path);
+        TS_ASSERT_EQUALS(p_table->GetNumSpecies(), 8u);
+        TS_ASSERT_EQUALS(p_table->GetNumCells(), 2u);
+        TS_ASSERT_EQUALS(p_table->GetNumEdges(), 10u);
+        TS_ASSERT_EQUALS(p_table->GetNumEdges(1), 4u);
+        TS_ASSERT_EQUALS(p_table->GetFirstEdge(1), 6u);
+        TS_ASSERT_DELTA(p_table->GetBirthTime(1), -2.0, 1e-12);
+        TS_ASSERT_DELTA(p_table->GetLevels(9)[7], 0.5*79, 1e-12);
+
+        // Badly formed tables
+        TS_ASSERT_THROWS_THIS(PolarityInitialConditionTable(8, num_edges, std::vector<double>(1), levels),
+                              "An initial condition table needs a birth time for each of its 2 cells.");
+        TS_ASSERT_THROWS_THIS(PolarityInitialConditionTable(8, num_edges, birth_times, std::vector<double>(3)),
+                              "An initial condition table of 10 edges and 8 species needs 80 levels, not 3.");
+
+        const std::string bad_path = handler.GetOutputDirectoryFullPath() + "not_a_table.bin";
+        {
+            std::ofstream bad_file(bad_path.c_str());
+            bad_file << "# time cell edge level\n";
+        }
+        TS_ASSERT_THROWS_THIS(PolarityInitialConditionTable::Load(bad_path), bad_path + " is not an initial condition table.");
+        TS_ASSERT_THROWS_CONTAINS(PolarityInitialConditionTable::Load(handler.GetOutputDirectoryFullPath() + "missing.bin"),
+                                  "Could not open the initial condition table");
+    }
+
+    void TestGenerateCellsFromTable()
+    {
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        std::vector<unsigned> num_edges;
+        std::vector<double> birth_times;
+        std::vector<double> levels;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            num_edges.push_back(p_mesh->GetElement(elem_index)->GetNumEdges());
+            birth_times.push_back(-0.5*elem_index);
+            for (unsigned edge = 0; edge < num_edges.back(); edge++)
+            {
+                for (unsigned species = 0; species < 8; species++)
+                {
+                    levels.push_back(Level(elem_index, edge, species));
+                }
+            }
+        }
+        OutputFileHandler handler("TestPolarityCellsGenerator");
+        const std::string path = handler.GetOutputDirectoryFullPath() + "table.bin";
+        PolarityInitialConditionTable(8, num_edges, birth_times, levels).Write(path);
+        boost::shared_ptr<PolarityInitialConditionTable> p_table = PolarityInitialConditionTable::Load(path);
+
+        PolarityCellsGenerator<NoCellCycleModel, 2> cells_generator(2);
+        TS_ASSERT_EQUALS(cells_generator.GetNumThreads(), 2u);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_population = cells_generator.CreateCellPopulation(*p_mesh, *p_table);
+        TS_ASSERT_EQUALS(p_population->GetNumRealCells(), p_mesh->GetNumElements());
+
+        // As a simulation would, create the ODE systems from the initial conditions
+        p_population->InitialiseCells();
+
+        for (typename AbstractCellPopulation<2>::Iterator cell_iter = p_population->Begin();
+             cell_iter != p_population->End();
+             ++cell_iter)
+        {
+            const unsigned elem_index = p_population->GetLocationIndexUsingCell(*cell_iter);
+            TS_ASSERT_DELTA(cell_iter->GetBirthTime(), -0.5*elem_index, 1e-12);
+
+            auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+            TS_ASSERT_EQUALS(p_cell_srn->GetNumEdgeSrn(), num_edges[elem_index]);
+            for (unsigned edge = 0; edge < p_cell_srn->GetNumEdgeSrn(); edge++)
+            {
+                auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge));
+                TS_ASSERT_DELTA(p_edge_srn->GetA(), Level(elem_index, edge, 0), 1e-12);
+                TS_ASSERT_DELTA(p_edge_srn->GetBoundA(), Level(elem_index, edge, 1), 1e-12);
+                TS_ASSERT_DELTA(p_edge_srn->GetBA(), Level(elem_index, edge, 4), 1e-12);
+                TS_ASSERT_DELTA(p_edge_srn->GetAC(), Level(elem_index, edge, 7), 1e-12);
+            }
+        }
+
+        // The same cells are built, in the same order, by a single thread
+        std::vector<CellPtr> cells;
+        PolarityCellsGenerator<NoCellCycleModel, 2>(1).GenerateCells(cells, *p_mesh, *p_table);
+        TS_ASSERT_EQUALS(cells.size(), p_mesh->GetNumElements());
+        TS_ASSERT_EQUALS(static_cast<CellSrnModel*>(cells[4]->GetSrnModel())->GetNumEdgeSrn(), num_edges[4]);
+
+        // Tables that do not match the mesh
+        HoneycombVertexMeshGenerator small_generator(2, 2);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_small_mesh = small_generator.GetMesh();
+        TS_ASSERT_THROWS_THIS(cells_generator.GenerateCells(cells, *p_small_mesh, *p_table),
+                              "The initial condition table has 9 cells, but the mesh has 4 elements.");
+
+        PolarityInitialConditionTable two_species(2, num_edges, birth_times, std::vector<double>(levels.size()/4));
+        TS_ASSERT_THROWS_THIS(cells_generator.GenerateCells(cells, *p_mesh, two_species),
+                              "The initial condition table has 2 species per edge, not 8.");
+
+        std::swap(num_edges[0], num_edges[1]);
+        if (num_edges[0] != num_edges[1])
+        {
+            PolarityInitialConditionTable swapped(8, num_edges, birth_times, levels);
+            TS_ASSERT_THROWS_CONTAINS(cells_generator.GenerateCells(cells, *p_mesh, swapped),
+                                      "Cell 0 of the initial condition table has");
+        }
+    }
+};
+
+#endif /*TESTPOLARITYCELLSGENERATOR_HPP_*/
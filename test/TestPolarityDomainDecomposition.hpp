@@ -0,0 +1,284 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYDOMAINDECOMPOSITION_HPP_
+#define TESTPOLARITYDOMAINDECOMPOSITION_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "CellSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "PetscTools.hpp"
+#include "PolarityEdgeDomainDecomposition.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+/**
+ * Tests for sharing the edge SRNs of a tissue between MPI processes. These are meant
+ * to be run in parallel as well as sequentially; the decomposed tissue must give the
+ * same levels as the undecomposed one whatever the number of processes.
+ */
+class TestPolarityDomainDecomposition : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Create a polarity cell for each element of a mesh, with levels that vary from cell
+     * to cell so that neighbours exchange different values.
+     *
+     * @param rMesh the mesh
+     * @param rCells filled in with the cells
+     */
+    void CreateCells(MutableVertexMesh<2,2>& rMesh, std::vector<CellPtr>& rCells)
+    {
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        for (unsigned elem_index = 0; elem_index < rMesh.GetNumElements(); elem_index++)
+        {
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < rMesh.GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                std::vector<double> initial_conditions(8, 0.0);
+                initial_conditions[0] = 0.333 + 0.01*((elem_index + i) % 5);
+                initial_conditions[2] = 0.333;
+                initial_conditions[3] = 0.333 - 0.01*(elem_index % 3);
+
+                MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(initial_conditions);
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            rCells.push_back(p_cell);
+        }
+    }
+
+    /**
+     * Run a 4x4 tissue, stepping the edge SRNs and the modifier as OffLatticeSimulation
+     * does, and return the final levels of every edge.
+     *
+     * @param pModifier the modifier to use
+     * @param includeCellsOwnedElsewhere whether to return the levels of cells owned by other processes too
+     * @return the levels of A and BA on each edge of each cell owned by this process,
+     *     by location index; empty for cells owned elsewhere unless includeCellsOwnedElsewhere
+     */
+    std::vector<std::vector<double> > RunTissue(boost::shared_ptr<PolarityEdgeTrackingModifier<2> > pModifier,
+                                                bool includeCellsOwnedElsewhere=false)
+    {
+        SimulationTime::Destroy();
+        SimulationTime* p_simulation_time = SimulationTime::Instance();
+        p_simulation_time->SetStartTime(0.0);
+        p_simulation_time->SetEndTimeAndNumberOfTimeSteps(10.0, 100);
+
+        HoneycombVertexMeshGenerator generator(4, 4);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        CreateCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+        pModifier->SetupSolve(cell_population, "TestPolarityDomainDecomposition");
+
+        while (!p_simulation_time->IsFinished())
+        {
+            for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter)
+            {
+                cell_iter->GetSrnModel()->SimulateToCurrentTime();
+            }
+            p_simulation_time->IncrementTimeOneStep();
+            pModifier->UpdateAtEndOfTimeStep(cell_population);
+        }
+
+        // The published levels of cells owned elsewhere are only current at steps where they are gathered
+        std::vector<std::vector<double> > levels(cell_population.GetNumRealCells());
+        auto p_decomposition = pModifier->GetDomainDecomposition();
+        for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter)
+        {
+            unsigned location_index = cell_population.GetLocationIndexUsingCell(*cell_iter);
+            if (includeCellsOwnedElsewhere || !p_decomposition || p_decomposition->IsLocallyOwned(location_index))
+            {
+                std::vector<double> A = cell_iter->GetCellEdgeData()->GetItem("edge A");
+                std::vector<double> BA = cell_iter->GetCellEdgeData()->GetItem("edge BA");
+                levels[location_index].insert(levels[location_index].end(), A.begin(), A.end());
+                levels[location_index].insert(levels[location_index].end(), BA.begin(), BA.end());
+            }
+        }
+        return levels;
+    }
+
+    /**
+     * Check that the decomposed tissue reproduces the undecomposed one.
+     *
+     * @param useStrangSplitting whether to use Strang splitting
+     */
+    void CompareWithUndecomposedTissue(bool useStrangSplitting)
+    {
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_reference_modifier);
+        p_reference_modifier->SetUseStrangSplitting(useStrangSplitting);
+        std::vector<std::vector<double> > reference = RunTissue(p_reference_modifier);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        p_modifier->SetUseStrangSplitting(useStrangSplitting);
+        p_modifier->SetUseDomainDecomposition(true);
+        TS_ASSERT(p_modifier->GetUseDomainDecomposition());
+        std::vector<std::vector<double> > levels = RunTissue(p_modifier);
+
+        auto p_decomposition = p_modifier->GetDomainDecomposition();
+        TS_ASSERT(p_decomposition);
+
+        // Every cell is owned by exactly one process
+        unsigned num_local_cells = p_decomposition->GetNumLocalCells();
+        unsigned num_cells = 0;
+        MPI_Allreduce(&num_local_cells, &num_cells, 1, MPI_UNSIGNED, MPI_SUM, PetscTools::GetWorld());
+        TS_ASSERT_EQUALS(num_cells, 16u);
+        if (!PetscTools::IsParallel())
+        {
+            TS_ASSERT_EQUALS(p_decomposition->GetNumHaloEdges(), 0u);
+        }
+
+        // The owned cells have the same levels as in the undecomposed tissue
+        TS_ASSERT_EQUALS(levels.size(), reference.size());
+        unsigned num_compared = 0;
+        for (unsigned location_index = 0; location_index < levels.size(); location_index++)
+        {
+            if (!p_decomposition->IsLocallyOwned(location_index))
+            {
+                TS_ASSERT(levels[location_index].empty());
+                continue;
+            }
+            TS_ASSERT_EQUALS(levels[location_index].size(), reference[location_index].size());
+            for (unsigned i = 0; i < levels[location_index].size(); i++)
+            {
+                TS_ASSERT_DELTA(levels[location_index][i], reference[location_index][i], 1e-12);
+            }
+            num_compared++;
+        }
+        TS_ASSERT_EQUALS(num_compared, num_local_cells);
+    }
+
+public:
+
+    void TestPartitionGraph()
+    {
+        // A path of ten vertices is cut into contiguous, balanced pieces
+        std::vector<std::set<unsigned> > path(10);
+        for (unsigned i = 0; i + 1 < path.size(); i++)
+        {
+            path[i].insert(i + 1);
+            path[i + 1].insert(i);
+        }
+        std::vector<unsigned> parts = PolarityEdgeDomainDecomposition<2>::PartitionGraph(path, 3);
+        std::vector<unsigned> expected = {0, 0, 0, 0, 1, 1, 1, 2, 2, 2};
+        TS_ASSERT_EQUALS(parts, expected);
+
+        // Disconnected vertices are still assigned
+        std::vector<std::set<unsigned> > isolated(5);
+        parts = PolarityEdgeDomainDecomposition<2>::PartitionGraph(isolated, 2);
+        expected = {0, 0, 0, 1, 1};
+        TS_ASSERT_EQUALS(parts, expected);
+    }
+
+    void TestDecomposedTissueMatchesUndecomposedTissue()
+    {
+        CompareWithUndecomposedTissue(false);
+    }
+
+    void TestDecomposedTissueWithStrangSplitting()
+    {
+        CompareWithUndecomposedTissue(true);
+    }
+
+    void TestGatheredLevelsOfCellsOwnedElsewhere()
+    {
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_reference_modifier);
+        std::vector<std::vector<double> > reference = RunTissue(p_reference_modifier);
+
+        // The levels are gathered at the last step, so every process publishes current levels for every cell
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        p_modifier->SetUseDomainDecomposition(true);
+        TS_ASSERT_EQUALS(p_modifier->GetGatherTimestepMultiple(), 1u);
+        p_modifier->SetGatherTimestepMultiple(20);
+        TS_ASSERT_EQUALS(p_modifier->GetGatherTimestepMultiple(), 20u);
+        TS_ASSERT_THROWS_THIS(p_modifier->SetGatherTimestepMultiple(0), "The gather timestep multiple must be positive.");
+        std::vector<std::vector<double> > levels = RunTissue(p_modifier, true);
+
+        auto p_decomposition = p_modifier->GetDomainDecomposition();
+        TS_ASSERT_EQUALS(levels.size(), reference.size());
+        unsigned num_owned_elsewhere = 0;
+        for (unsigned location_index = 0; location_index < levels.size(); location_index++)
+        {
+            if (!p_decomposition->IsLocallyOwned(location_index))
+            {
+                num_owned_elsewhere++;
+            }
+            TS_ASSERT_EQUALS(levels[location_index].size(), reference[location_index].size());
+            for (unsigned i = 0; i < levels[location_index].size(); i++)
+            {
+                TS_ASSERT_DELTA(levels[location_index][i], reference[location_index][i], 1e-12);
+            }
+        }
+        TS_ASSERT_EQUALS(num_owned_elsewhere, 16u - p_decomposition->GetNumLocalCells());
+    }
+
+    void TestDecomposedTissueRequiresFixedTopology()
+    {
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        p_modifier->SetUseDomainDecomposition(true);
+        RunTissue(p_modifier);
+
+        // Any change to the tissue after partitioning is refused
+        HoneycombVertexMeshGenerator generator(2, 2);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CreateCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> other_population(*p_mesh, cells);
+        other_population.InitialiseCells();
+        TS_ASSERT_THROWS_THIS(p_modifier->UpdateCellData(other_population),
+                              "Distributed polarity edge networks require a fixed tissue topology.");
+    }
+};
+
+#endif /*TESTPOLARITYDOMAINDECOMPOSITION_HPP_*/
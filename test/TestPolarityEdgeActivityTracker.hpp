@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYEDGEACTIVITYTRACKER_HPP_
+#define TESTPOLARITYEDGEACTIVITYTRACKER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "CellSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "PolarityEdgeActivityTracker.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for skipping the ODEs of edges that have reached equilibrium.
+ */
+class TestPolarityEdgeActivityTracker : public AbstractCellBasedTestSuite
+{
+protected:
+
+    /**
+     * Destroy the tracker after each test, so that no settings carry over to the next.
+     */
+    void tearDown()
+    {
+        AbstractCellBasedTestSuite::tearDown();
+        PolarityEdgeActivityTracker::Destroy();
+    }
+
+public:
+
+    void TestTrackerSettings()
+    {
+        PolarityEdgeActivityTracker* p_tracker = PolarityEdgeActivityTracker::Instance();
+        TS_ASSERT(!p_tracker->IsEnabled());
+        TS_ASSERT_DELTA(p_tracker->GetRhsTolerance(), 1e-6, 1e-15);
+        TS_ASSERT_DELTA(p_tracker->GetInputTolerance(), 1e-4, 1e-15);
+        TS_ASSERT_DELTA(p_tracker->GetSkippedFraction(), 0.0, 1e-12);
+
+        std::vector<double> derivatives(3, 1e-7);
+        TS_ASSERT(p_tracker->IsQuiescent(derivatives));
+        derivatives[1] = -1e-5;
+        TS_ASSERT(!p_tracker->IsQuiescent(derivatives));
+
+        std::vector<double> snapshot(3, 0.5);
+        std::vector<double> current(3, 0.50005);
+        TS_ASSERT(!p_tracker->HasInputChanged(snapshot, current));
+        current[2] = 0.6;
+        TS_ASSERT(p_tracker->HasInputChanged(snapshot, current));
+
+        TS_ASSERT_THROWS_THIS(p_tracker->SetRhsTolerance(0.0), "The RHS tolerance for dormant edges must be positive.");
+        TS_ASSERT_THROWS_THIS(p_tracker->SetInputTolerance(-1.0), "The input tolerance for dormant edges must be positive.");
+
+        // Destroying the tracker brings back the default settings
+        p_tracker->SetEnabled(true);
+        p_tracker->SetRhsTolerance(1e-3);
+        PolarityEdgeActivityTracker::Destroy();
+        p_tracker = PolarityEdgeActivityTracker::Instance();
+        TS_ASSERT(!p_tracker->IsEnabled());
+        TS_ASSERT_DELTA(p_tracker->GetRhsTolerance(), 1e-6, 1e-15);
+    }
+
+    void TestDormantEdgesAreSkippedAndWoken()
+    {
+        PolarityEdgeActivityTracker* p_tracker = PolarityEdgeActivityTracker::Instance();
+        p_tracker->SetEnabled(true);
+        p_tracker->ResetCounters();
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        std::vector<CellPtr> cells;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            // Every edge starts at the trivial equilibrium with no protein
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < p_mesh->GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(std::vector<double>(8, 0.0));
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestPolarityEdgeActivityTracker");
+        simulator.SetSamplingTimestepMultiple(10);
+        simulator.SetDt(0.1);
+        simulator.SetEndTime(1.0);
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+        simulator.Solve();
+
+        // Each edge is integrated once, then skipped for the remaining eight of its nine solves
+        TS_ASSERT_LESS_THAN(0u, p_tracker->GetNumberOfSolves());
+        TS_ASSERT_LESS_THAN(0.85, p_tracker->GetSkippedFraction());
+        TS_ASSERT_EQUALS(p_tracker->GetNumberOfWakeUps(), 0u);
+
+        // Adding A to one cell wakes its edges, and those of its neighbours
+        CellPtr p_perturbed_cell = *(cell_population.Begin());
+        auto p_cell_srn = static_cast<CellSrnModel*>(p_perturbed_cell->GetSrnModel());
+        for (unsigned i = 0; i < p_cell_srn->GetNumEdgeSrn(); i++)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(i));
+            TS_ASSERT(p_edge_srn->IsDormant());
+            p_edge_srn->SetA(0.3);
+        }
+
+        p_tracker->ResetCounters();
+        simulator.SetEndTime(2.0);
+        simulator.Solve();
+
+        TS_ASSERT_LESS_THAN_EQUALS(p_cell_srn->GetNumEdgeSrn(), p_tracker->GetNumberOfWakeUps());
+        TS_ASSERT_LESS_THAN(0u, p_tracker->GetNumberOfSolves() - p_tracker->GetNumberOfSkippedSolves());
+
+        p_tracker->SetEnabled(false);
+    }
+};
+
+#endif /*TESTPOLARITYEDGEACTIVITYTRACKER_HPP_*/
@@ -0,0 +1,160 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYKINETICPARAMETERS_HPP_
+#define TESTPOLARITYKINETICPARAMETERS_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "CellSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityKineticParameters.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for sharing blocks of kinetic parameters between the edges of many cells.
+ */
+class TestPolarityKineticParameters : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestParameterBlocks()
+    {
+        PolarityKineticParameters defaults;
+        TS_ASSERT_EQUALS(defaults.rGetValues().size(), 7u);
+        TS_ASSERT_DELTA(defaults.GetValue("KD1"), 5.0, 1e-12);
+        TS_ASSERT_DELTA(defaults.GetValue("w"), 2.0, 1e-12);
+        TS_ASSERT_EQUALS(PolarityKineticParameters::GetIndex("KD2"), 1u);
+
+        boost::shared_ptr<PolarityKineticParameters> p_mutant = defaults.CreateOverride("KD2", 0.3);
+        TS_ASSERT_DELTA(p_mutant->GetValue("KD2"), 0.3, 1e-12);
+        TS_ASSERT_DELTA(p_mutant->GetValue("KD1"), 5.0, 1e-12);
+        TS_ASSERT_DELTA(defaults.GetValue("KD2"), 0.1, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(PolarityKineticParameters(std::vector<double>(2, 1.0)),
+                              "A polarity kinetic parameter block needs 7 values, not 2.");
+        TS_ASSERT_THROWS_THIS(defaults.GetValue("KD3"), "There is no polarity kinetic parameter called \"KD3\".");
+    }
+
+    void TestCellsShareBlocks()
+    {
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        // A wild-type block shared by every cell, and a mutant block with a weaker KD2 for the centre cell
+        boost::shared_ptr<PolarityKineticParameters> p_wild_type(new PolarityKineticParameters());
+        boost::shared_ptr<PolarityKineticParameters> p_mutant = p_wild_type->CreateOverride("KD2", 0.3);
+        const unsigned mutant_index = 4;
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        std::vector<CellPtr> cells;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < p_mesh->GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(std::vector<double>(8, 0.1));
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            p_cell->AddCellProperty(elem_index == mutant_index ? p_mutant : p_wild_type);
+            cells.push_back(p_cell);
+        }
+
+        // An edge's own parameters take precedence over its cell's block
+        std::vector<double> edge_parameters = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+        edge_parameters[1] = 0.05;
+        auto p_first_srn = static_cast<CellSrnModel*>(cells[0]->GetSrnModel());
+        boost::static_pointer_cast<PolarityEdgeSrnModel>(p_first_srn->GetEdgeSrn(0))->SetKineticParameters(edge_parameters);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        for (unsigned elem_index = 0; elem_index < cells.size(); elem_index++)
+        {
+            TS_ASSERT_EQUALS(PolarityKineticParameters::GetFromCell(cells[elem_index]),
+                             elem_index == mutant_index ? p_mutant : p_wild_type);
+            auto p_cell_srn = static_cast<CellSrnModel*>(cells[elem_index]->GetSrnModel());
+            for (unsigned i = 0; i < p_cell_srn->GetNumEdgeSrn(); i++)
+            {
+                auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(i));
+                double expected_KD2 = (elem_index == mutant_index) ? 0.3 : 0.1;
+                if (elem_index == 0 && i == 0)
+                {
+                    expected_KD2 = 0.05;
+                }
+                auto p_system = static_cast<PolarityEdgeOdeSystem*>(p_edge_srn->GetOdeSystem());
+                TS_ASSERT_DELTA(p_system->GetKineticParameters()->GetValue("KD2"), expected_KD2, 1e-12);
+                TS_ASSERT_DELTA(p_edge_srn->GetKineticParameters()[0], 5.0, 1e-12);
+
+                // The edges share their cell's block rather than holding copies of its values
+                if (elem_index != 0 || i != 0)
+                {
+                    TS_ASSERT_EQUALS(p_system->GetKineticParameters(),
+                                     PolarityKineticParameters::GetFromCell(cells[elem_index]));
+                }
+            }
+        }
+
+        // Giving a cell a new block during a simulation passes it on to its edges
+        boost::shared_ptr<PolarityKineticParameters> p_revertant = p_mutant->CreateOverride("KD2", 0.2);
+        PolarityKineticParameters::AssignToCell(cells[mutant_index], p_revertant);
+        TS_ASSERT_EQUALS(PolarityKineticParameters::GetFromCell(cells[mutant_index]), p_revertant);
+        auto p_mutant_srn = static_cast<CellSrnModel*>(cells[mutant_index]->GetSrnModel());
+        for (unsigned i = 0; i < p_mutant_srn->GetNumEdgeSrn(); i++)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_mutant_srn->GetEdgeSrn(i));
+            auto p_system = static_cast<PolarityEdgeOdeSystem*>(p_edge_srn->GetOdeSystem());
+            TS_ASSERT_EQUALS(p_system->GetKineticParameters(), p_revertant);
+        }
+    }
+};
+
+#endif /*TESTPOLARITYKINETICPARAMETERS_HPP_*/
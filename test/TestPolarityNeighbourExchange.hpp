@@ -0,0 +1,287 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYNEIGHBOUREXCHANGE_HPP_
+#define TESTPOLARITYNEIGHBOUREXCHANGE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cmath>
+
+#include "CellSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the relaxed exchange of edge levels between neighbouring cells in
+ * PolarityEdgeTrackingModifier.
+ */
+class TestPolarityNeighbourExchange : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Create a polarity cell for each element of a mesh, with the initial conditions of TestPolaritySRN.
+     *
+     * @param rMesh the mesh
+     * @param rCells filled in with the cells
+     */
+    void CreateCells(MutableVertexMesh<2,2>& rMesh, std::vector<CellPtr>& rCells)
+    {
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+
+        for (unsigned elem_index = 0; elem_index < rMesh.GetNumElements(); elem_index++)
+        {
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < rMesh.GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                double offset = (i == 0 || i == 5) ? 0.999 : ((i == 2 || i == 3) ? 1.001 : 1.0);
+                std::vector<double> initial_conditions(8, 0.0);
+                initial_conditions[0] = 0.333;
+                initial_conditions[2] = 0.333*offset;
+                initial_conditions[3] = 0.333;
+
+                MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(initial_conditions);
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            rCells.push_back(p_cell);
+        }
+    }
+
+    /**
+     * Run a 3x3 tissue and return the final level of BA on every edge.
+     *
+     * @param pModifier the modifier to use
+     * @return the level of BA on each edge, in cell iteration order
+     */
+    std::vector<double> RunTissue(boost::shared_ptr<PolarityEdgeTrackingModifier<2> > pModifier)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CreateCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestPolarityNeighbourExchange");
+        simulator.SetSamplingTimestepMultiple(100);
+        simulator.SetDt(0.1);
+        simulator.SetEndTime(50.0);
+        simulator.AddSimulationModifier(pModifier);
+        simulator.Solve();
+
+        std::vector<double> levels;
+        for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter)
+        {
+            std::vector<double> BA = cell_iter->GetCellEdgeData()->GetItem("edge BA");
+            levels.insert(levels.end(), BA.begin(), BA.end());
+        }
+        return levels;
+    }
+
+public:
+
+    void TestRelaxedExchange()
+    {
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_every_step_modifier);
+        TS_ASSERT_EQUALS(p_every_step_modifier->GetMaxNeighbourExchangeInterval(), 1u);
+        std::vector<double> reference = RunTissue(p_every_step_modifier);
+
+        // Exchanged in SetupSolve() and at each of the 500 time steps
+        TS_ASSERT_EQUALS(p_every_step_modifier->GetNumberOfNeighbourExchanges(), 501u);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_relaxed_modifier);
+        p_relaxed_modifier->SetMaxNeighbourExchangeInterval(16);
+        p_relaxed_modifier->SetNeighbourExchangeTolerance(5e-3);
+        std::vector<double> levels = RunTissue(p_relaxed_modifier);
+
+        // As the tissue relaxes, exchanges become less frequent without changing the result much
+        TS_ASSERT_LESS_THAN(p_relaxed_modifier->GetNumberOfNeighbourExchanges(), 375u);
+        TS_ASSERT_LESS_THAN(1u, p_relaxed_modifier->GetNeighbourExchangeInterval());
+        TS_ASSERT_EQUALS(levels.size(), reference.size());
+        for (unsigned i = 0; i < levels.size(); i++)
+        {
+            TS_ASSERT_DELTA(levels[i], reference[i], 2e-2);
+        }
+
+        TS_ASSERT_THROWS_THIS(p_relaxed_modifier->SetMaxNeighbourExchangeInterval(0),
+                              "The maximum neighbour exchange interval must be at least one time step.");
+        TS_ASSERT_THROWS_THIS(p_relaxed_modifier->SetNeighbourExchangeTolerance(0.0),
+                              "The neighbour exchange tolerance must be positive.");
+    }
+
+    void TestExchangeForcedByTopologyChange()
+    {
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CreateCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        HoneycombVertexMeshGenerator other_generator(2, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_other_mesh = other_generator.GetMesh();
+        std::vector<CellPtr> other_cells;
+        CreateCells(*p_other_mesh, other_cells);
+        VertexBasedCellPopulation<2> other_population(*p_other_mesh, other_cells);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        p_modifier->SetMaxNeighbourExchangeInterval(16);
+
+        // The first call always exchanges; an unchanged population then does not need to
+        p_modifier->UpdateCellData(cell_population);
+        TS_ASSERT_EQUALS(p_modifier->GetNumberOfNeighbourExchanges(), 1u);
+        p_modifier->UpdateCellData(cell_population);
+        p_modifier->UpdateCellData(cell_population);
+        TS_ASSERT_EQUALS(p_modifier->GetNumberOfNeighbourExchanges(), 2u);
+        TS_ASSERT_EQUALS(p_modifier->GetNeighbourExchangeInterval(), 2u);
+
+        // A different set of cells and edges forces an exchange and resets the interval
+        p_modifier->UpdateCellData(other_population);
+        TS_ASSERT_EQUALS(p_modifier->GetNumberOfNeighbourExchanges(), 3u);
+        TS_ASSERT_EQUALS(p_modifier->GetNeighbourExchangeInterval(), 1u);
+    }
+
+    void TestIncrementalNeighbourMeans()
+    {
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CreateCells(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        HoneycombVertexMeshGenerator other_generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_other_mesh = other_generator.GetMesh();
+        std::vector<CellPtr> other_cells;
+        CreateCells(*p_other_mesh, other_cells);
+        VertexBasedCellPopulation<2> other_population(*p_other_mesh, other_cells);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_full_modifier);
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_incremental_modifier);
+        TS_ASSERT(!p_incremental_modifier->GetUseIncrementalNeighbourMeans());
+        p_incremental_modifier->SetUseIncrementalNeighbourMeans(true);
+        p_incremental_modifier->SetDirtyEdgeTolerance(0.0);
+        TS_ASSERT_EQUALS(p_incremental_modifier->GetFullNeighbourRecomputeInterval(), 100u);
+
+        // The first exchange computes the means of all 54 edges
+        p_full_modifier->UpdateCellData(cell_population);
+        p_incremental_modifier->UpdateCellData(other_population);
+        TS_ASSERT_EQUALS(p_incremental_modifier->GetNumberOfUpdatedNeighbourMeans(), 54u);
+
+        // An unchanged tissue needs no updates
+        p_incremental_modifier->UpdateCellData(other_population);
+        TS_ASSERT_EQUALS(p_incremental_modifier->GetNumberOfNeighbourExchanges(), 2u);
+        TS_ASSERT_EQUALS(p_incremental_modifier->GetNumberOfUpdatedNeighbourMeans(), 54u);
+
+        // Changing one cell only updates the means of the edges next to it
+        for (VertexBasedCellPopulation<2>* p_population : {&cell_population, &other_population})
+        {
+            auto p_cell_srn = static_cast<CellSrnModel*>(p_population->Begin()->GetSrnModel());
+            for (unsigned i = 0; i < p_cell_srn->GetNumEdgeSrn(); i++)
+            {
+                auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(i));
+                p_edge_srn->SetA(p_edge_srn->GetA() + 0.1*(i + 1));
+            }
+        }
+        p_full_modifier->UpdateCellData(cell_population);
+        p_incremental_modifier->UpdateCellData(other_population);
+        unsigned num_updated = p_incremental_modifier->GetNumberOfUpdatedNeighbourMeans() - 54u;
+        TS_ASSERT_LESS_THAN(0u, num_updated);
+        TS_ASSERT_LESS_THAN_EQUALS(num_updated, 6u);
+
+        // The means agree with those recomputed from scratch
+        auto other_iter = other_population.Begin();
+        for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter, ++other_iter)
+        {
+            for (std::string name : {"neighbour A", "neighbour boundA", "neighbour B", "neighbour C",
+                                     "neighbour BA", "neighbour AB", "neighbour CA", "neighbour AC"})
+            {
+                std::vector<double> expected = cell_iter->GetCellEdgeData()->GetItem(name);
+                std::vector<double> actual = other_iter->GetCellEdgeData()->GetItem(name);
+                TS_ASSERT_EQUALS(actual.size(), expected.size());
+                for (unsigned i = 0; i < actual.size(); i++)
+                {
+                    TS_ASSERT_DELTA(actual[i], expected[i], 1e-12);
+                }
+            }
+        }
+
+        TS_ASSERT_THROWS_THIS(p_incremental_modifier->SetDirtyEdgeTolerance(-1.0),
+                              "The dirty edge tolerance must be non-negative.");
+        TS_ASSERT_THROWS_THIS(p_incremental_modifier->SetFullNeighbourRecomputeInterval(0),
+                              "The full neighbour recompute interval must be at least one exchange.");
+    }
+
+    void TestIncrementalNeighbourMeansInTissue()
+    {
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_reference_modifier);
+        std::vector<double> reference = RunTissue(p_reference_modifier);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_incremental_modifier);
+        p_incremental_modifier->SetUseIncrementalNeighbourMeans(true);
+        p_incremental_modifier->SetDirtyEdgeTolerance(1e-4);
+        std::vector<double> levels = RunTissue(p_incremental_modifier);
+
+        // Fewer means are updated than the 54 per exchange of the full recomputation
+        TS_ASSERT_LESS_THAN(p_incremental_modifier->GetNumberOfUpdatedNeighbourMeans(),
+                            p_reference_modifier->GetNumberOfUpdatedNeighbourMeans());
+        TS_ASSERT_EQUALS(levels.size(), reference.size());
+        for (unsigned i = 0; i < levels.size(); i++)
+        {
+            TS_ASSERT_DELTA(levels[i], reference[i], 2e-2);
+        }
+    }
+};
+
+#endif /*TESTPOLARITYNEIGHBOUREXCHANGE_HPP_*/
@@ -0,0 +1,241 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYOBSERVABLESMODIFIER_HPP_
+#define TESTPOLARITYOBSERVABLESMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <string>
+
+#include "CellSrnModel.hpp"
+#include "FileFinder.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "PolarityObservablesModifier.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the in-situ polarity observables of PolarityObservablesModifier.
+ */
+class TestPolarityObservablesModifier : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Create a polarity cell for each element of a mesh. On each edge, BA is 1 + cos(theta - phi),
+     * with theta the angle of the edge midpoint seen from the centroid, and CA is 1, so that
+     * every cell is polarised along the direction at angle phi.
+     *
+     * @param rMesh the mesh
+     * @param rCells filled in with the cells
+     * @param evenAngle the polarity angle phi of the cells of even-numbered elements
+     * @param oddAngle the polarity angle phi of the cells of odd-numbered elements
+     */
+    void CreateCells(MutableVertexMesh<2,2>& rMesh, std::vector<CellPtr>& rCells, double evenAngle, double oddAngle)
+    {
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+
+        for (unsigned elem_index = 0; elem_index < rMesh.GetNumElements(); elem_index++)
+        {
+            VertexElement<2,2>* p_element = rMesh.GetElement(elem_index);
+            c_vector<double, 2> centroid = rMesh.GetCentroidOfElement(elem_index);
+            const double phi = (elem_index%2 == 0) ? evenAngle : oddAngle;
+
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < p_element->GetNumEdges(); i++)
+            {
+                c_vector<double, 2> midpoint = 0.5*(p_element->GetEdge(i)->GetNode(0)->rGetLocation()
+                                                    + p_element->GetEdge(i)->GetNode(1)->rGetLocation());
+                double theta = atan2(midpoint[1] - centroid[1], midpoint[0] - centroid[0]);
+
+                std::vector<double> initial_conditions(8, 0.1);
+                initial_conditions[4] = 1.0 + cos(theta - phi);
+                initial_conditions[6] = 1.0;
+
+                MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(initial_conditions);
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            rCells.push_back(p_cell);
+        }
+    }
+
+    /**
+     * @param rPath the path of a file
+     * @return the number of lines in the file
+     */
+    unsigned CountLines(const std::string& rPath)
+    {
+        std::ifstream file(rPath.c_str());
+        unsigned num_lines = 0;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            num_lines++;
+        }
+        return num_lines;
+    }
+
+public:
+
+    void TestObservablesOfPolarisedTissue()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        for (bool towards_positive_x : {true, false})
+        {
+            HoneycombVertexMeshGenerator generator(4, 4);
+            boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+            std::vector<CellPtr> cells;
+            const double phi = towards_positive_x ? 0.0 : M_PI;
+            CreateCells(*p_mesh, cells, phi, phi);
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+            cell_population.InitialiseCells();
+
+            // For a regular hexagon the polarity vector is half the amplitude of the asymmetry
+            for (CellPtr p_cell : cells)
+            {
+                c_vector<double, 2> polarity = PolarityObservablesModifier<2>::CalculateCellPolarity(cell_population, p_cell);
+                TS_ASSERT_DELTA(polarity[0], towards_positive_x ? 0.5 : -0.5, 1e-9);
+                TS_ASSERT_DELTA(polarity[1], 0.0, 1e-9);
+            }
+
+            MAKE_PTR(PolarityObservablesModifier<2>, p_modifier);
+            p_modifier->SetOutputCellPolarities(false);
+            p_modifier->SetupSolve(cell_population, "TestPolarityObservablesModifier");
+            p_modifier->UpdateAtEndOfSolve(cell_population);
+
+            TS_ASSERT_EQUALS(p_modifier->GetNumCells(), 16u);
+            TS_ASSERT_DELTA(p_modifier->GetMeanMagnitude(), 0.5, 1e-9);
+            TS_ASSERT_DELTA(p_modifier->GetPolarOrder(), 1.0, 1e-9);
+            TS_ASSERT_DELTA(p_modifier->GetNematicOrder(), 1.0, 1e-9);
+            TS_ASSERT_DELTA(fabs(p_modifier->GetMeanAngle()), towards_positive_x ? 0.0 : M_PI, 1e-9);
+        }
+    }
+
+    void TestObservablesOfTissueWithTwoPolarityDirections()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        // Half of the cells are polarised along x and half along y
+        HoneycombVertexMeshGenerator generator(4, 4);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CreateCells(*p_mesh, cells, 0.0, 0.5*M_PI);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        for (unsigned i = 0; i < cells.size(); i++)
+        {
+            c_vector<double, 2> polarity = PolarityObservablesModifier<2>::CalculateCellPolarity(cell_population, cells[i]);
+            TS_ASSERT_DELTA(polarity[0], (i%2 == 0) ? 0.5 : 0.0, 1e-9);
+            TS_ASSERT_DELTA(polarity[1], (i%2 == 0) ? 0.0 : 0.5, 1e-9);
+        }
+
+        MAKE_PTR(PolarityObservablesModifier<2>, p_modifier);
+        p_modifier->SetOutputCellPolarities(false);
+        p_modifier->SetupSolve(cell_population, "TestPolarityObservablesModifierTwoDirections");
+        p_modifier->UpdateAtEndOfSolve(cell_population);
+
+        /*
+         * The summed polarity is 8*(0.5, 0.5) = (4, 4) against a summed magnitude of 8, so the
+         * polar order is sqrt(32)/8 = 1/sqrt(2) at an angle of pi/4. The doubled angles 0 and pi
+         * cancel, so there is no nematic order.
+         */
+        TS_ASSERT_EQUALS(p_modifier->GetNumCells(), 16u);
+        TS_ASSERT_DELTA(p_modifier->GetMeanMagnitude(), 0.5, 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetPolarOrder(), 1.0/sqrt(2.0), 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetMeanAngle(), 0.25*M_PI, 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetNematicOrder(), 0.0, 1e-9);
+    }
+
+    void TestModifierInSimulation()
+    {
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CreateCells(*p_mesh, cells, 0.0, 0.0);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestPolarityObservablesModifierInSimulation");
+        simulator.SetDt(0.1);
+        simulator.SetEndTime(1.0);
+        simulator.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_tracking_modifier);
+        simulator.AddSimulationModifier(p_tracking_modifier);
+
+        MAKE_PTR(PolarityObservablesModifier<2>, p_modifier);
+        TS_ASSERT_EQUALS(p_modifier->GetSamplingTimestepMultiple(), 1u);
+        TS_ASSERT(p_modifier->GetOutputCellPolarities());
+        TS_ASSERT_THROWS_THIS(p_modifier->SetSamplingTimestepMultiple(0),
+                              "The sampling timestep multiple must be positive.");
+        p_modifier->SetSamplingTimestepMultiple(5);
+        simulator.AddSimulationModifier(p_modifier);
+
+        simulator.Solve();
+
+        // A header, then samples at the start, after five steps and after ten steps
+        FileFinder order_file("TestPolarityObservablesModifierInSimulation/polarity_order.dat", RelativeTo::ChasteTestOutput);
+        FileFinder cell_file("TestPolarityObservablesModifierInSimulation/polarity_cells.dat", RelativeTo::ChasteTestOutput);
+        TS_ASSERT_EQUALS(CountLines(order_file.GetAbsolutePath()), 4u);
+        TS_ASSERT_EQUALS(CountLines(cell_file.GetAbsolutePath()), 1u + 3u*cells.size());
+
+        TS_ASSERT_EQUALS(p_modifier->GetNumCells(), cells.size());
+        TS_ASSERT(p_modifier->GetPolarOrder() >= 0.0);
+        TS_ASSERT(p_modifier->GetPolarOrder() <= 1.0 + 1e-12);
+    }
+};
+
+#endif /*TESTPOLARITYOBSERVABLESMODIFIER_HPP_*/
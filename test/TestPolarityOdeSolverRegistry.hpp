@@ -0,0 +1,132 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYODESOLVERREGISTRY_HPP_
+#define TESTPOLARITYODESOLVERREGISTRY_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "SmartPointers.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the run-time selection of the ODE solver used by PolarityEdgeSrnModel.
+ */
+class TestPolarityOdeSolverRegistry : public AbstractCellBasedTestSuite
+{
+protected:
+
+    /**
+     * Destroy the registry after each test, so that no settings carry over to the next.
+     */
+    void tearDown()
+    {
+        AbstractCellBasedTestSuite::tearDown();
+        PolarityEdgeOdeSolverRegistry::Destroy();
+    }
+
+public:
+
+    void TestRegisteredSolvers()
+    {
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        TS_ASSERT(p_registry->HasSolver("RungeKutta4"));
+        TS_ASSERT(p_registry->HasSolver("RungeKuttaFehlberg"));
+        TS_ASSERT(p_registry->HasSolver("BackwardEuler"));
+        TS_ASSERT(!p_registry->IsAdaptive("RungeKutta4"));
+
+        // Chaste's RKF solver ignores the registry's tolerances, so is treated as fixed-step
+        TS_ASSERT(!p_registry->IsAdaptive("RungeKuttaFehlberg"));
+#ifdef CHASTE_CVODE
+        TS_ASSERT_EQUALS(p_registry->rGetActiveSolver(), "Cvode");
+#else
+        TS_ASSERT_EQUALS(p_registry->rGetActiveSolver(), "RungeKutta4");
+#endif //CHASTE_CVODE
+
+        TS_ASSERT_THROWS_THIS(p_registry->SetActiveSolver("Euler"),
+                              "No ODE solver named 'Euler' has been registered for PolarityEdgeSrnModel.");
+        TS_ASSERT_THROWS_THIS(p_registry->SetTolerances(0.0, 1e-6), "ODE solver tolerances must be positive.");
+
+        // Models constructed after a change of solver pick up the new solver and its time step
+        const std::string original_solver = p_registry->rGetActiveSolver();
+        p_registry->SetActiveSolver("BackwardEuler");
+        MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+        TS_ASSERT_DELTA(p_srn_model->GetDt(), 0.01, 1e-12);
+
+        // Destroying the registry restores the default solver
+        PolarityEdgeOdeSolverRegistry::Destroy();
+        TS_ASSERT_EQUALS(PolarityEdgeOdeSolverRegistry::Instance()->rGetActiveSolver(), original_solver);
+    }
+
+    void TestAutoTune()
+    {
+        // A single hexagonal cell with the initial conditions used in TestPolaritySRN
+        std::vector<std::vector<double> > initial_conditions;
+        std::vector<std::vector<double> > parameters;
+        const double offsets[6] = {0.999, 1.000, 1.001, 1.001, 1.000, 0.999};
+        for (unsigned i = 0; i < 6; i++)
+        {
+            std::vector<double> y(8, 0.0);
+            y[0] = 0.333;
+            y[2] = 0.333*offsets[i];
+            y[3] = 0.333;
+            initial_conditions.push_back(y);
+
+            // Neighbouring edges are taken to hold the same unbound levels
+            std::vector<double> neighbour(8, 0.0);
+            neighbour[0] = 0.333;
+            neighbour[2] = 0.333;
+            neighbour[3] = 0.333;
+            parameters.push_back(neighbour);
+        }
+
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        const std::string original_solver = p_registry->rGetActiveSolver();
+
+        std::string chosen = p_registry->AutoTune(initial_conditions, parameters, 1.0, 1e-3);
+        TS_ASSERT(p_registry->HasSolver(chosen));
+        TS_ASSERT_EQUALS(p_registry->rGetActiveSolver(), chosen);
+
+        TS_ASSERT_THROWS_THIS(p_registry->AutoTune(initial_conditions, std::vector<std::vector<double> >(), 1.0, 1e-3),
+                              "AutoTune() needs initial conditions and parameters for each edge of the probe cell.");
+
+        p_registry->SetActiveSolver(original_solver);
+    }
+};
+
+#endif /*TESTPOLARITYODESOLVERREGISTRY_HPP_*/
@@ -0,0 +1,242 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYPARAMETERENSEMBLE_HPP_
+#define TESTPOLARITYPARAMETERENSEMBLE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cmath>
+
+#include "CellSrnModel.hpp"
+#include "FileFinder.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "PolarityKineticParameters.hpp"
+#include "PolarityParameterEnsemble.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for runtime kinetic parameters and for running parameter sweeps as one ensemble.
+ */
+class TestPolarityParameterEnsemble : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * @return the initial conditions of TestPolaritySRN, by local edge index
+     */
+    std::vector<std::vector<double> > GetInitialConditions()
+    {
+        std::vector<std::vector<double> > initial_conditions;
+        for (unsigned i = 0; i < 6; i++)
+        {
+            double offset = (i == 0 || i == 5) ? 0.999 : ((i == 2 || i == 3) ? 1.001 : 1.0);
+            std::vector<double> edge_initial_conditions(8, 0.0);
+            edge_initial_conditions[0] = 0.333;
+            edge_initial_conditions[2] = 0.333*offset;
+            edge_initial_conditions[3] = 0.333;
+            initial_conditions.push_back(edge_initial_conditions);
+        }
+        return initial_conditions;
+    }
+
+    /**
+     * @param rCellPopulation a population of polarity cells
+     * @return the level of BA on every edge, in cell iteration order
+     */
+    std::vector<double> GetBALevels(AbstractCellPopulation<2>& rCellPopulation)
+    {
+        std::vector<double> levels;
+        for (auto cell_iter = rCellPopulation.Begin(); cell_iter != rCellPopulation.End(); ++cell_iter)
+        {
+            auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+            for (unsigned i = 0; i < p_cell_srn->GetNumEdgeSrn(); i++)
+            {
+                levels.push_back(boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(i))->GetBA());
+            }
+        }
+        return levels;
+    }
+
+public:
+
+    void TestKineticParameters()
+    {
+        PolarityEdgeOdeSystem ode_system;
+        TS_ASSERT_EQUALS(ode_system.GetNumberOfParameters(), 8u);
+        boost::shared_ptr<const PolarityKineticParameters> p_defaults = ode_system.GetKineticParameters();
+        TS_ASSERT_DELTA(p_defaults->GetValue("KD1"), 5.0, 1e-12);
+        TS_ASSERT_DELTA(p_defaults->GetValue("KD2"), 0.1, 1e-12);
+        TS_ASSERT_DELTA(p_defaults->GetValue("k"), 1.0, 1e-12);
+        TS_ASSERT_DELTA(p_defaults->GetValue("K"), 0.1665, 1e-12);
+        TS_ASSERT_DELTA(p_defaults->GetValue("VF"), 10.0, 1e-12);
+        TS_ASSERT_DELTA(p_defaults->GetValue("VS"), 10.0, 1e-12);
+        TS_ASSERT_DELTA(p_defaults->GetValue("w"), 2.0, 1e-12);
+
+        // dA/dt = -(k*A*neigh_A - KD1*k*BoundA), with the default neighbour A of 0.5
+        std::vector<double> y = {0.3, 0.1, 0.3, 0.3, 0.05, 0.02, 0.04, 0.01};
+        std::vector<double> derivatives(8);
+        ode_system.EvaluateYDerivatives(0.0, y, derivatives);
+        TS_ASSERT_DELTA(derivatives[0], -(0.3*0.5 - 5.0*0.1), 1e-12);
+        ode_system.SetKineticParameters(p_defaults->CreateOverride("KD1", 10.0));
+        ode_system.EvaluateYDerivatives(0.0, y, derivatives);
+        TS_ASSERT_DELTA(derivatives[0], -(0.3*0.5 - 10.0*0.1), 1e-12);
+
+        // Kinetic parameters given to an SRN before it is initialised are passed on to its ODE system
+        std::vector<double> kinetic_parameters = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+        kinetic_parameters[1] = 0.2;
+        PolarityEdgeSrnModel srn_model;
+        srn_model.SetKineticParameters(kinetic_parameters);
+        srn_model.Initialise();
+        auto p_system = static_cast<PolarityEdgeOdeSystem*>(srn_model.GetOdeSystem());
+        TS_ASSERT_DELTA(p_system->GetKineticParameters()->GetValue("KD2"), 0.2, 1e-12);
+        TS_ASSERT_DELTA(srn_model.GetKineticParameters()[1], 0.2, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(srn_model.SetKineticParameters(std::vector<double>(3, 1.0)),
+                              "A polarity edge needs 7 kinetic parameters, not 3.");
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        TS_ASSERT_DELTA(p_modifier->GetUnboundProteinDiffusionCoefficient(), 0.03, 1e-12);
+        p_modifier->SetUnboundProteinDiffusionCoefficient(0.1);
+        TS_ASSERT_DELTA(p_modifier->GetUnboundProteinDiffusionCoefficient(), 0.1, 1e-12);
+        TS_ASSERT_THROWS_THIS(p_modifier->SetUnboundProteinDiffusionCoefficient(-1.0),
+                              "The unbound protein diffusion coefficient must be non-negative.");
+    }
+
+    void TestEnsembleMatchesSeparateSimulations()
+    {
+        std::vector<double> default_parameters = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+        std::vector<double> strong_unbinding = default_parameters;
+        strong_unbinding[0] = 10.0;
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_mesh = generator.GetMesh();
+
+        PolarityParameterEnsemble ensemble(*p_mesh, "TestPolarityParameterEnsemble");
+        ensemble.SetInitialConditions(GetInitialConditions());
+        TS_ASSERT_EQUALS(ensemble.AddMember(default_parameters, 0.03), 0u);
+        TS_ASSERT_EQUALS(ensemble.AddMember(strong_unbinding, 0.03), 1u);
+        TS_ASSERT_EQUALS(ensemble.AddMember(default_parameters, 0.1), 2u);
+        TS_ASSERT_EQUALS(ensemble.GetNumMembers(), 3u);
+
+        TS_ASSERT_THROWS_THIS(ensemble.AddMember(std::vector<double>(2, 1.0), 0.03),
+                              "A polarity edge needs 7 kinetic parameters, not 2.");
+        TS_ASSERT_THROWS_THIS(ensemble.AddMember(default_parameters, -0.1),
+                              "The unbound protein diffusion coefficient must be non-negative.");
+        TS_ASSERT_THROWS_THIS(ensemble.rGetPopulation(0),
+                              "Ensemble member 0 has not been set up; call Solve() first.");
+
+        ensemble.Solve(0.1, 10.0, 10);
+
+        // Each member writes its own output
+        for (unsigned member = 0; member < 3; member++)
+        {
+            std::stringstream file_name;
+            file_name << "TestPolarityParameterEnsemble/member_" << member << ".dat";
+            TS_ASSERT(FileFinder(file_name.str(), RelativeTo::ChasteTestOutput).IsFile());
+        }
+        TS_ASSERT(FileFinder("TestPolarityParameterEnsemble/ensemble_parameters.dat", RelativeTo::ChasteTestOutput).IsFile());
+
+        std::vector<double> member_0 = GetBALevels(ensemble.rGetPopulation(0));
+        std::vector<double> member_1 = GetBALevels(ensemble.rGetPopulation(1));
+        std::vector<double> member_2 = GetBALevels(ensemble.rGetPopulation(2));
+
+        // The default member reproduces a separate simulation of the same static tissue
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+
+        HoneycombVertexMeshGenerator other_generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2,2> > p_other_mesh = other_generator.GetMesh();
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        std::vector<std::vector<double> > initial_conditions = GetInitialConditions();
+        std::vector<CellPtr> cells;
+        for (unsigned elem_index = 0; elem_index < p_other_mesh->GetNumElements(); elem_index++)
+        {
+            auto p_cell_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < p_other_mesh->GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(initial_conditions[i % 6]);
+                p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+            p_cell->SetCellProliferativeType(p_stem_type);
+            p_cell->SetBirthTime(0.0);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_other_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestPolarityParameterEnsembleReference");
+        simulator.SetSamplingTimestepMultiple(10);
+        simulator.SetDt(0.1);
+        simulator.SetEndTime(10.0);
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+        simulator.Solve();
+
+        std::vector<double> reference = GetBALevels(cell_population);
+        TS_ASSERT_EQUALS(member_0.size(), reference.size());
+        TS_ASSERT_EQUALS(member_1.size(), reference.size());
+        TS_ASSERT_EQUALS(member_2.size(), reference.size());
+        double difference_1 = 0.0;
+        double difference_2 = 0.0;
+        for (unsigned i = 0; i < reference.size(); i++)
+        {
+            TS_ASSERT_DELTA(member_0[i], reference[i], 1e-10);
+            difference_1 = std::max(difference_1, fabs(member_1[i] - reference[i]));
+            difference_2 = std::max(difference_2, fabs(member_2[i] - reference[i]));
+        }
+
+        // The other members follow their own parameters
+        TS_ASSERT_LESS_THAN(1e-6, difference_1);
+        TS_ASSERT_LESS_THAN(1e-6, difference_2);
+    }
+};
+
+#endif /*TESTPOLARITYPARAMETERENSEMBLE_HPP_*/
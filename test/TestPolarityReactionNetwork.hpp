@@ -0,0 +1,190 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTPOLARITYREACTIONNETWORK_HPP_
+#define TESTPOLARITYREACTIONNETWORK_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+
+#include "PolarityEdgeReactionNetwork.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityKineticParameters.hpp"
+
+/**
+ * Tests for the code generated from reaction_networks/PolarityEdge.rn.
+ */
+class TestPolarityReactionNetwork : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @param system the index of a system
+     * @return a state with nonzero levels of every species
+     */
+    std::vector<double> GetState(unsigned system)
+    {
+        std::vector<double> state(PolarityEdgeReactionNetwork::NUM_SPECIES);
+        for (unsigned i = 0; i < state.size(); i++)
+        {
+            state[i] = 0.05 + 0.03*i + 0.01*system;
+        }
+        return state;
+    }
+
+    /**
+     * @param system the index of a system
+     * @return the default inputs with nonzero levels of everything on the facing edge
+     */
+    std::vector<double> GetInputs(unsigned system)
+    {
+        std::vector<double> inputs(PolarityEdgeReactionNetwork::NUM_INPUTS);
+        for (unsigned i = 0; i < inputs.size(); i++)
+        {
+            inputs[i] = PolarityEdgeReactionNetwork::GetDefaultInput(i);
+        }
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_A] = 0.4;
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_B] = 0.35 - 0.01*system;
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_C] = 0.3;
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_BA] = 0.05;
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_CA] = 0.02 + 0.01*system;
+        return inputs;
+    }
+
+public:
+
+    void TestMetadata()
+    {
+        const unsigned num_species = PolarityEdgeReactionNetwork::NUM_SPECIES;
+        const unsigned num_inputs = PolarityEdgeReactionNetwork::NUM_INPUTS;
+        const unsigned num_kinetic_parameters = PolarityEdgeReactionNetwork::NUM_KINETIC_PARAMETERS;
+        TS_ASSERT_EQUALS(num_species, 8u);
+        TS_ASSERT_EQUALS(num_inputs, 8u);
+        TS_ASSERT_EQUALS(num_kinetic_parameters, 7u);
+
+        // The ODE system takes its names and defaults from the generated metadata
+        PolarityEdgeOdeSystem ode_system;
+        TS_ASSERT_EQUALS(ode_system.GetNumberOfStateVariables(), num_species);
+        TS_ASSERT_EQUALS(ode_system.rGetStateVariableNames()[0], "A");
+        TS_ASSERT_EQUALS(ode_system.rGetStateVariableNames()[1], "BoundA");
+        TS_ASSERT_EQUALS(ode_system.GetStateVariableIndex("AC"), 7u);
+        TS_ASSERT_DELTA(ode_system.GetParameter("neighbour A"), 0.5, 1e-12);
+
+        // Only the neighbour levels are parameters of the system; the kinetic parameters are shared
+        TS_ASSERT_EQUALS(ode_system.GetNumberOfParameters(), num_inputs);
+        TS_ASSERT_EQUALS(ode_system.GetParameterIndex("neighbour boundA"), 1u);
+        TS_ASSERT_THROWS_ANYTHING(ode_system.GetParameterIndex("KD1"));
+        TS_ASSERT_EQUALS(ode_system.GetKineticParameters(), PolarityKineticParameters::GetDefault());
+        TS_ASSERT_DELTA(ode_system.GetKineticParameters()->GetValue("K"), 0.1665, 1e-12);
+        TS_ASSERT_EQUALS(PolarityKineticParameters::GetIndex("KD1"), PolarityEdgeReactionNetwork::PARAMETER_KD1);
+
+        std::vector<double> kinetic_parameters = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+        TS_ASSERT_EQUALS(kinetic_parameters.size(), 7u);
+        TS_ASSERT_DELTA(kinetic_parameters[0], 5.0, 1e-12);
+        TS_ASSERT_DELTA(kinetic_parameters[6], 2.0, 1e-12);
+    }
+
+    void TestRightHandSide()
+    {
+        std::vector<double> inputs = GetInputs(0);
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_A] = 0.5;
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_B] = 0.0;
+        inputs[PolarityEdgeReactionNetwork::INPUT_neigh_C] = 0.0;
+        std::vector<double> parameters = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+
+        // Only bound A and B: BoundA unbinds at rate KD1*k and binds B at rate k
+        std::vector<double> state(PolarityEdgeReactionNetwork::NUM_SPECIES, 0.0);
+        state[PolarityEdgeReactionNetwork::SPECIES_BoundA] = 1.0;
+        state[PolarityEdgeReactionNetwork::SPECIES_B] = 1.0;
+        std::vector<double> derivatives(PolarityEdgeReactionNetwork::NUM_SPECIES);
+        PolarityEdgeReactionNetwork::EvaluateRhs(&state[0], &inputs[0], &parameters[0], &derivatives[0]);
+        TS_ASSERT_DELTA(derivatives[PolarityEdgeReactionNetwork::SPECIES_A], 5.0, 1e-12);
+        TS_ASSERT_DELTA(derivatives[PolarityEdgeReactionNetwork::SPECIES_BoundA], -6.0, 1e-12);
+        TS_ASSERT_DELTA(derivatives[PolarityEdgeReactionNetwork::SPECIES_B], -1.0, 1e-12);
+        TS_ASSERT_DELTA(derivatives[PolarityEdgeReactionNetwork::SPECIES_BA], 1.0, 1e-12);
+        TS_ASSERT_DELTA(derivatives[PolarityEdgeReactionNetwork::SPECIES_CA], 0.0, 1e-12);
+
+        // Total A, total B (B + BA) and total C (C + CA) are conserved
+        state = GetState(0);
+        inputs = GetInputs(0);
+        PolarityEdgeReactionNetwork::EvaluateRhs(&state[0], &inputs[0], &parameters[0], &derivatives[0]);
+        TS_ASSERT_DELTA(derivatives[0] + derivatives[1] + derivatives[4] + derivatives[5] + derivatives[6] + derivatives[7], 0.0, 1e-12);
+        TS_ASSERT_DELTA(derivatives[2] + derivatives[4], 0.0, 1e-12);
+        TS_ASSERT_DELTA(derivatives[3] + derivatives[6], 0.0, 1e-12);
+    }
+
+    void TestBatchMatchesSingleSystem()
+    {
+        const unsigned num_systems = 13;
+        const unsigned num_species = PolarityEdgeReactionNetwork::NUM_SPECIES;
+        const unsigned num_inputs = PolarityEdgeReactionNetwork::NUM_INPUTS;
+
+        // Store the systems species by species; they share one block of kinetic parameters
+        std::vector<double> states(num_species*num_systems);
+        std::vector<double> inputs(num_inputs*num_systems);
+        for (unsigned s = 0; s < num_systems; s++)
+        {
+            std::vector<double> state = GetState(s);
+            std::vector<double> system_inputs = GetInputs(s);
+            for (unsigned i = 0; i < num_species; i++)
+            {
+                states[i*num_systems + s] = state[i];
+            }
+            for (unsigned j = 0; j < num_inputs; j++)
+            {
+                inputs[j*num_systems + s] = system_inputs[j];
+            }
+        }
+        std::vector<double> parameters = PolarityEdgeOdeSystem::GetDefaultKineticParameters();
+        parameters[PolarityEdgeReactionNetwork::PARAMETER_KD2] = 0.2;
+
+        std::vector<double> batch_derivatives(num_species*num_systems);
+        PolarityEdgeReactionNetwork::EvaluateRhsBatch(num_systems, &states[0], &inputs[0], &parameters[0], &batch_derivatives[0]);
+
+        for (unsigned s = 0; s < num_systems; s++)
+        {
+            std::vector<double> state = GetState(s);
+            std::vector<double> system_inputs = GetInputs(s);
+            std::vector<double> derivatives(num_species);
+            PolarityEdgeReactionNetwork::EvaluateRhs(&state[0], &system_inputs[0], &parameters[0], &derivatives[0]);
+            for (unsigned i = 0; i < num_species; i++)
+            {
+                TS_ASSERT_EQUALS(batch_derivatives[i*num_systems + s], derivatives[i]);
+            }
+        }
+    }
+};
+
+#endif /*TESTPOLARITYREACTIONNETWORK_HPP_*/
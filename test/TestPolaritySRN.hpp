@@ -57,6 +57,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "CellVolumesWriter.hpp"
 
 #include "CheckpointArchiveTypes.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
 
 /*As we wish to simulate our Edge based A Notch system we need to include the relavent files here.*/
 #include "PolarityEdgeSrnModel.hpp"
@@ -114,6 +115,9 @@ public:
         MAKE_PTR(WildTypeCellMutationState, p_state);
         MAKE_PTR(StemCellProliferativeType, p_diff_type);
 
+        /* Birth times are drawn from a counter-based generator, keyed by the cell index */
+        CounterBasedRandomNumberGenerator rng(0);
+
         for (unsigned elem_index=0; elem_index < p_mesh->GetNumElements(); elem_index++)
         {
             /* Initalise cell cycle */
@@ -168,7 +172,7 @@ public:
             p_cell->SetCellProliferativeType(p_diff_type);
 
 
-            double birth_time = -RandomNumberGenerator::Instance()->ranf()*12.0;
+            double birth_time = -rng.ranfForCell(elem_index, 0)*12.0;
             p_cell->SetBirthTime(birth_time);
             cells.push_back(p_cell);
         }
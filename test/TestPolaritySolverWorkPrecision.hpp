@@ -0,0 +1,327 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYSOLVERWORKPRECISION_HPP_
+#define TESTPOLARITYSOLVERWORKPRECISION_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <sstream>
+
+#include "CellSrnModel.hpp"
+#include "CellId.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "OutputFileHandler.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * @file
+ *
+ * Work-precision study of the ODE solvers registered in PolarityEdgeOdeSolverRegistry.
+ *
+ * Each solver is run across a range of tolerances if it is registered as adaptive, and
+ * otherwise across a range of time steps (which, for RKF, only bound its own adaptive
+ * steps, as Chaste's RKF solver has a fixed tolerance) on two problems that start from
+ * the initial conditions used in TestPolaritySRN:
+ *  - a single cell ring: the six edge ODE systems of one hexagonal cell, integrated
+ *    directly with their neighbour levels held at those of the facing edge;
+ *  - a small 3x3 tissue, run through the full simulation with PolarityEdgeTrackingModifier.
+ *
+ * The error is the maximum difference from a reference RK4 solution with a very small
+ * time step, relative to the largest reference value. The tables are written to
+ * TestPolaritySolverWorkPrecision/work_precision_{ring,tissue}.dat with columns
+ * solver, dt, relative tolerance, absolute tolerance, relative error, wall time (s).
+ */
+class TestPolaritySolverWorkPrecision : public AbstractCellBasedTestSuite
+{
+private:
+
+    /** Time step used for the reference solution. */
+    static constexpr double REFERENCE_DT = 1e-4;
+
+    /**
+     * @param edgeIndex the local index of an edge in a hexagonal cell
+     * @return the initial conditions used for this edge in TestPolaritySRN
+     */
+    std::vector<double> GetInitialConditions(unsigned edgeIndex)
+    {
+        double offset = 1.000;
+        if (edgeIndex == 0 || edgeIndex == 5)
+        {
+            offset = 0.999;
+        }
+        else if (edgeIndex == 2 || edgeIndex == 3)
+        {
+            offset = 1.001;
+        }
+
+        std::vector<double> initial_conditions(8, 0.0);
+        initial_conditions[0] = 0.333;
+        initial_conditions[2] = 0.333*offset;
+        initial_conditions[3] = 0.333;
+        return initial_conditions;
+    }
+
+    /**
+     * Integrate the single cell ring with the active solver.
+     *
+     * @param endTime the end time
+     * @param rWallTime filled in with the smallest wall time over several repeats
+     * @return the final state of every edge, concatenated
+     */
+    std::vector<double> RunRing(double endTime, double& rWallTime)
+    {
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        const std::string& r_name = p_registry->rGetActiveSolver();
+        const double dt = p_registry->GetDefaultDt(r_name) > 0.0 ? p_registry->GetDefaultDt(r_name) : 0.1;
+
+        std::vector<double> result;
+        rWallTime = DBL_MAX;
+        for (unsigned repeat = 0; repeat < 3; repeat++)
+        {
+            result.clear();
+            boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = p_registry->CreateSolver(r_name);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned edge = 0; edge < 6; edge++)
+            {
+                PolarityEdgeOdeSystem system(GetInitialConditions(edge));
+                std::vector<double> facing_edge = GetInitialConditions((edge + 3)%6);
+                for (unsigned i = 0; i < facing_edge.size(); i++)
+                {
+                    system.SetParameter(i, facing_edge[i]);
+                }
+                p_solver->SolveAndUpdateStateVariable(&system, 0.0, endTime, dt);
+                result.insert(result.end(), system.rGetStateVariables().begin(), system.rGetStateVariables().end());
+            }
+            rWallTime = std::min(rWallTime, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return result;
+    }
+
+    /**
+     * Run the 3x3 tissue with the active solver.
+     *
+     * @param endTime the end time
+     * @param rWallTime filled in with the wall time of the simulation
+     * @return the final state of every edge, concatenated in cell order
+     */
+    std::vector<double> RunTissue(double endTime, double& rWallTime)
+    {
+        // Start each run from the same state of the singletons
+        SimulationTime::Instance()->Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        CellId::ResetMaxCellId();
+        CounterBasedRandomNumberGenerator rng(0);
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_diff_type);
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
+        {
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+
+            auto p_cell_edge_srn_model = new CellSrnModel();
+            for (unsigned i = 0; i < p_mesh->GetElement(elem_index)->GetNumEdges(); i++)
+            {
+                MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+                p_srn_model->SetInitialConditions(GetInitialConditions(i));
+                p_cell_edge_srn_model->AddEdgeSrnModel(p_srn_model);
+            }
+
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_edge_srn_model));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            p_cell->SetBirthTime(-rng.ranfForCell(elem_index, 0)*12.0);
+            cells.push_back(p_cell);
+        }
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestPolaritySolverWorkPrecision/simulation");
+        simulator.SetDt(0.1);
+        simulator.SetEndTime(endTime);
+        simulator.SetSamplingTimestepMultiple(UINT_MAX);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        simulator.Solve();
+        rWallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<double> result;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            auto p_cell_srn = static_cast<CellSrnModel*>(cell_iter->GetSrnModel());
+            for (unsigned edge = 0; edge < p_cell_srn->GetNumEdgeSrn(); edge++)
+            {
+                auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_cell_srn->GetEdgeSrn(edge));
+                const std::vector<double>& r_state = p_edge_srn->GetOdeSystem()->rGetStateVariables();
+                result.insert(result.end(), r_state.begin(), r_state.end());
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @param rSolution a solution
+     * @param rReference the reference solution
+     * @return the maximum difference between them, relative to the largest reference value
+     */
+    double RelativeError(const std::vector<double>& rSolution, const std::vector<double>& rReference)
+    {
+        double scale = DBL_EPSILON;
+        double difference = 0.0;
+        for (unsigned i = 0; i < rReference.size(); i++)
+        {
+            scale = std::max(scale, fabs(rReference[i]));
+            difference = std::max(difference, fabs(rSolution[i] - rReference[i]));
+        }
+        // Report diverged runs as infinite error
+        return std::isfinite(difference) ? difference/scale : DBL_MAX;
+    }
+
+    /**
+     * Sweep every registered solver over its time steps or tolerances, writing one table row per run.
+     *
+     * @param isTissue whether to run the tissue problem (otherwise the single cell ring)
+     * @param endTime the end time of each run
+     * @param rTable the stream to which the table is written
+     */
+    void Sweep(bool isTissue, double endTime, std::ostream& rTable)
+    {
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        const std::string original_solver = p_registry->rGetActiveSolver();
+        const double original_rel_tol = p_registry->GetRelativeTolerance();
+        const double original_abs_tol = p_registry->GetAbsoluteTolerance();
+
+        double wall_time;
+        p_registry->SetActiveSolver("RungeKutta4");
+        const double rk4_dt = p_registry->GetDefaultDt("RungeKutta4");
+        p_registry->SetDefaultDt("RungeKutta4", REFERENCE_DT);
+        std::vector<double> reference = isTissue ? RunTissue(endTime, wall_time) : RunRing(endTime, wall_time);
+        p_registry->SetDefaultDt("RungeKutta4", rk4_dt);
+
+        const double time_steps[] = {0.05, 0.02, 0.01, 0.005, 0.002, 0.001};
+        const double tolerances[] = {1e-3, 1e-4, 1e-5, 1e-6, 1e-7};
+
+        std::vector<std::string> names = p_registry->GetSolverNames();
+        for (unsigned n = 0; n < names.size(); n++)
+        {
+            const std::string& r_name = names[n];
+            p_registry->SetActiveSolver(r_name);
+            const double default_dt = p_registry->GetDefaultDt(r_name);
+
+            if (p_registry->IsAdaptive(r_name))
+            {
+                std::vector<double> errors;
+                for (unsigned t = 0; t < sizeof(tolerances)/sizeof(double); t++)
+                {
+                    p_registry->SetTolerances(tolerances[t], 1e-2*tolerances[t]);
+                    std::vector<double> solution = isTissue ? RunTissue(endTime, wall_time) : RunRing(endTime, wall_time);
+                    errors.push_back(RelativeError(solution, reference));
+                    rTable << r_name << "\t" << default_dt << "\t" << tolerances[t] << "\t" << 1e-2*tolerances[t]
+                           << "\t" << errors.back() << "\t" << wall_time << "\n";
+                }
+                p_registry->SetTolerances(original_rel_tol, original_abs_tol);
+
+                // A solver that ignored the tolerances would fill the table with copies of one run
+                TS_ASSERT_LESS_THAN(errors.back(), errors.front());
+            }
+            else
+            {
+                for (unsigned t = 0; t < sizeof(time_steps)/sizeof(double); t++)
+                {
+                    p_registry->SetDefaultDt(r_name, time_steps[t]);
+                    std::vector<double> solution = isTissue ? RunTissue(endTime, wall_time) : RunRing(endTime, wall_time);
+                    rTable << r_name << "\t" << time_steps[t] << "\tnan\tnan\t"
+                           << RelativeError(solution, reference) << "\t" << wall_time << "\n";
+                }
+                p_registry->SetDefaultDt(r_name, default_dt);
+            }
+        }
+
+        p_registry->SetActiveSolver(original_solver);
+    }
+
+public:
+
+    void TestWorkPrecision()
+    {
+        std::stringstream ring_table;
+        ring_table << "solver\tdt\trel_tol\tabs_tol\terror\twall_time\n";
+        Sweep(false, 50.0, ring_table);
+
+        std::stringstream tissue_table;
+        tissue_table << "solver\tdt\trel_tol\tabs_tol\terror\twall_time\n";
+        Sweep(true, 20.0, tissue_table);
+
+        OutputFileHandler handler("TestPolaritySolverWorkPrecision", false);
+        out_stream p_ring_file = handler.OpenOutputFile("work_precision_ring.dat");
+        *p_ring_file << ring_table.str();
+        p_ring_file->close();
+
+        out_stream p_tissue_file = handler.OpenOutputFile("work_precision_tissue.dat");
+        *p_tissue_file << tissue_table.str();
+        p_tissue_file->close();
+
+        TS_ASSERT(handler.FindFile("work_precision_ring.dat").Exists());
+        TS_ASSERT(handler.FindFile("work_precision_tissue.dat").Exists());
+    }
+};
+
+#endif /*TESTPOLARITYSOLVERWORKPRECISION_HPP_*/
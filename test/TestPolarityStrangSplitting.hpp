@@ -0,0 +1,216 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPOLARITYSTRANGSPLITTING_HPP_
+#define TESTPOLARITYSTRANGSPLITTING_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cmath>
+
+#include "CellSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "PolarityEdgeTrackingModifier.hpp"
+#include "SmartPointers.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the splitting between membrane diffusion and the edge reactions in
+ * PolarityEdgeTrackingModifier.
+ *
+ * A single cell is used, so that the only coupling between edges is membrane
+ * diffusion and the splitting error is not mixed up with the lag in exchanging
+ * levels between neighbouring cells.
+ */
+class TestPolarityStrangSplitting : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Run a single-cell simulation and return the final state of each edge.
+     *
+     * @param dt the simulation time step
+     * @param useStrangSplitting whether to use Strang splitting
+     * @return the state variables of each edge at the end time
+     */
+    std::vector<std::vector<double> > RunSingleCell(double dt, bool useStrangSplitting)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+
+        HoneycombVertexMeshGenerator generator(1, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+
+        // Bound A and the unbound proteins vary around the cell, so diffusion and reaction do not commute
+        auto p_element = p_mesh->GetElement(0);
+        auto p_cell_srn_model = new CellSrnModel();
+        for (unsigned i = 0; i < p_element->GetNumEdges(); i++)
+        {
+            double offset = (i == 0 || i == 5) ? 0.9 : ((i == 2 || i == 3) ? 1.1 : 1.0);
+            std::vector<double> initial_conditions(8, 0.0);
+            initial_conditions[0] = 0.333*(2.0 - offset);
+            initial_conditions[1] = 0.2*offset;
+            initial_conditions[2] = 0.333*offset;
+            initial_conditions[3] = 0.333;
+            initial_conditions[4] = 0.05*offset;
+            initial_conditions[6] = 0.02;
+
+            MAKE_PTR(PolarityEdgeSrnModel, p_srn_model);
+            p_srn_model->SetInitialConditions(initial_conditions);
+            p_cell_srn_model->AddEdgeSrnModel(p_srn_model);
+        }
+
+        NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+        p_cc_model->SetDimension(2);
+        CellPtr p_cell(new Cell(p_state, p_cc_model, p_cell_srn_model));
+        p_cell->SetCellProliferativeType(p_stem_type);
+        p_cell->SetBirthTime(0.0);
+        std::vector<CellPtr> cells(1, p_cell);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestPolarityStrangSplitting");
+        simulator.SetSamplingTimestepMultiple(1000);
+        simulator.SetDt(dt);
+        simulator.SetEndTime(2.0);
+
+        MAKE_PTR(PolarityEdgeTrackingModifier<2>, p_modifier);
+        p_modifier->SetUseStrangSplitting(useStrangSplitting);
+        simulator.AddSimulationModifier(p_modifier);
+
+        simulator.Solve();
+
+        std::vector<std::vector<double> > edge_states;
+        auto p_srn = static_cast<CellSrnModel*>(cell_population.Begin()->GetSrnModel());
+        for (unsigned i = 0; i < p_srn->GetNumEdgeSrn(); i++)
+        {
+            auto p_edge_srn = boost::static_pointer_cast<PolarityEdgeSrnModel>(p_srn->GetEdgeSrn(i));
+            std::vector<double> state;
+            state.push_back(p_edge_srn->GetA());
+            state.push_back(p_edge_srn->GetBoundA());
+            state.push_back(p_edge_srn->GetB());
+            state.push_back(p_edge_srn->GetC());
+            state.push_back(p_edge_srn->GetBA());
+            state.push_back(p_edge_srn->GetAB());
+            state.push_back(p_edge_srn->GetCA());
+            state.push_back(p_edge_srn->GetAC());
+            edge_states.push_back(state);
+        }
+        return edge_states;
+    }
+
+    /**
+     * @param rStates the edge states of a simulation
+     * @param rReference the edge states of the reference simulation
+     * @return the maximum difference between the two
+     */
+    double GetMaxError(const std::vector<std::vector<double> >& rStates,
+                       const std::vector<std::vector<double> >& rReference)
+    {
+        double max_error = 0.0;
+        for (unsigned i = 0; i < rStates.size(); i++)
+        {
+            for (unsigned j = 0; j < rStates[i].size(); j++)
+            {
+                max_error = std::max(max_error, fabs(rStates[i][j] - rReference[i][j]));
+            }
+        }
+        return max_error;
+    }
+
+public:
+
+    void TestDiffuseAroundRing()
+    {
+        std::vector<double> euler_levels(6, 1.0);
+        euler_levels[0] = 2.0;
+        std::vector<double> heun_levels = euler_levels;
+
+        PolarityEdgeTrackingModifier<2>::DiffuseAroundRing(euler_levels, 0.03, 0.1, false);
+        TS_ASSERT_DELTA(euler_levels[0], 2.0 - 0.006, 1e-12);
+        TS_ASSERT_DELTA(euler_levels[1], 1.003, 1e-12);
+        TS_ASSERT_DELTA(euler_levels[3], 1.0, 1e-12);
+
+        // Both schemes conserve the total amount around the ring
+        PolarityEdgeTrackingModifier<2>::DiffuseAroundRing(heun_levels, 0.03, 0.1, true);
+        double euler_total = 0.0;
+        double heun_total = 0.0;
+        for (unsigned i = 0; i < 6; i++)
+        {
+            euler_total += euler_levels[i];
+            heun_total += heun_levels[i];
+        }
+        TS_ASSERT_DELTA(euler_total, 7.0, 1e-12);
+        TS_ASSERT_DELTA(heun_total, 7.0, 1e-12);
+        // Heun's method averages the flux -0.06 at the start and -0.05946 at the Euler prediction
+        TS_ASSERT_DELTA(heun_levels[0], 2.0 + 0.05*(-0.06 - 0.05946), 1e-12);
+    }
+
+    void TestSecondOrderConvergence()
+    {
+        // Use a fixed-step solver that is accurate enough not to hide the splitting error
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        const std::string original_solver = p_registry->rGetActiveSolver();
+        p_registry->SetActiveSolver("RungeKutta4");
+
+        std::vector<std::vector<double> > reference = RunSingleCell(0.0125, true);
+
+        double lie_error_coarse = GetMaxError(RunSingleCell(0.1, false), reference);
+        double lie_error_fine = GetMaxError(RunSingleCell(0.05, false), reference);
+        double strang_error_coarse = GetMaxError(RunSingleCell(0.1, true), reference);
+        double strang_error_fine = GetMaxError(RunSingleCell(0.05, true), reference);
+
+        // Halving dt halves the error of Lie splitting and quarters that of Strang splitting
+        TS_ASSERT_DELTA(lie_error_coarse/lie_error_fine, 2.0, 0.3);
+        TS_ASSERT_DELTA(strang_error_coarse/strang_error_fine, 4.0, 0.5);
+        TS_ASSERT_LESS_THAN(100.0*strang_error_coarse, lie_error_coarse);
+
+        p_registry->SetActiveSolver(original_solver);
+    }
+};
+
+#endif /*TESTPOLARITYSTRANGSPLITTING_HPP_*/
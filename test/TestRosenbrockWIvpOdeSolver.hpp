@@ -0,0 +1,196 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTROSENBROCKWIVPODESOLVER_HPP_
+#define TESTROSENBROCKWIVPODESOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cmath>
+
+#include "CellCycleModelOdeSolver.hpp"
+#include "PolarityEdgeOdeSolverRegistry.hpp"
+#include "PolarityEdgeOdeSystem.hpp"
+#include "PolarityEdgeSrnModel.hpp"
+#include "RosenbrockWIvpOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests for the Rosenbrock-W solver and the analytic Jacobian of PolarityEdgeOdeSystem.
+ */
+class TestRosenbrockWIvpOdeSolver : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Set up an edge with nonzero levels of everything on the facing edge.
+     *
+     * @param rSystem the system to set up
+     */
+    void SetNeighbourLevels(PolarityEdgeOdeSystem& rSystem)
+    {
+        rSystem.SetParameter("neighbour A", 0.4);
+        rSystem.SetParameter("neighbour B", 0.35);
+        rSystem.SetParameter("neighbour C", 0.3);
+        rSystem.SetParameter("neighbour BA", 0.05);
+        rSystem.SetParameter("neighbour CA", 0.02);
+    }
+
+public:
+
+    void TestAnalyticJacobian()
+    {
+        std::vector<double> state(8);
+        for (unsigned i = 0; i < 8; i++)
+        {
+            state[i] = 0.05 + 0.03*i;
+        }
+        PolarityEdgeOdeSystem ode_system(state);
+        SetNeighbourLevels(ode_system);
+
+        std::vector<double> analytic;
+        std::vector<double> approximate;
+        ode_system.EvaluateJacobian(0.0, state, analytic);
+        AbstractReactionNetworkOdeSystem::ApproximateJacobian(ode_system, 0.0, state, approximate);
+
+        TS_ASSERT_EQUALS(analytic.size(), 64u);
+        TS_ASSERT_EQUALS(approximate.size(), 64u);
+        for (unsigned i = 0; i < 64; i++)
+        {
+            TS_ASSERT_DELTA(analytic[i], approximate[i], 1e-5);
+        }
+    }
+
+    void TestAgreesWithRungeKutta4()
+    {
+        std::vector<double> initial_conditions(8, 0.0);
+        initial_conditions[0] = 0.333;
+        initial_conditions[2] = 0.333;
+        initial_conditions[3] = 0.333;
+
+        PolarityEdgeOdeSystem reference_system(initial_conditions);
+        SetNeighbourLevels(reference_system);
+        std::vector<double> reference = initial_conditions;
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.Solve(&reference_system, reference, 0.0, 20.0, 1e-4);
+
+        // Integrate over many short intervals, as the SRN model does
+        PolarityEdgeOdeSystem ode_system(initial_conditions);
+        SetNeighbourLevels(ode_system);
+        std::vector<double> state = initial_conditions;
+        RosenbrockWIvpOdeSolver solver;
+        TS_ASSERT_DELTA(solver.GetRelativeTolerance(), 1e-4, 1e-12);
+        TS_ASSERT_DELTA(solver.GetAbsoluteTolerance(), 1e-6, 1e-12);
+        TS_ASSERT_DELTA(ode_system.GetSuggestedTimeStep(), 0.0, 1e-12);
+        for (unsigned i = 0; i < 200; i++)
+        {
+            solver.Solve(&ode_system, state, 0.1*i, 0.1*(i + 1), 0.1);
+        }
+
+        for (unsigned i = 0; i < 8; i++)
+        {
+            TS_ASSERT_DELTA(state[i], reference[i], 1e-4);
+        }
+
+        // The step size is remembered by the system between calls
+        TS_ASSERT_LESS_THAN(0.0, ode_system.GetSuggestedTimeStep());
+        TS_ASSERT_LESS_THAN_EQUALS(ode_system.GetSuggestedTimeStep(), 0.1);
+        TS_ASSERT_LESS_THAN(0u, solver.GetNumberOfAcceptedSteps());
+
+        // The finite difference Jacobian gives the same answer to within the tolerances
+        PolarityEdgeOdeSystem fd_system(initial_conditions);
+        SetNeighbourLevels(fd_system);
+        std::vector<double> fd_state = initial_conditions;
+        RosenbrockWIvpOdeSolver fd_solver;
+        fd_solver.SetUseFiniteDifferenceJacobian(true);
+        fd_solver.Solve(&fd_system, fd_state, 0.0, 20.0, 0.1);
+        for (unsigned i = 0; i < 8; i++)
+        {
+            TS_ASSERT_DELTA(fd_state[i], reference[i], 1e-4);
+        }
+
+        TS_ASSERT_THROWS_THIS(solver.SetTolerances(1e-4, -1.0), "ODE solver tolerances must be positive.");
+    }
+
+    void TestLargeMaximumStep()
+    {
+        std::vector<double> initial_conditions(8, 0.0);
+        initial_conditions[0] = 0.333;
+        initial_conditions[2] = 0.333;
+        initial_conditions[3] = 0.333;
+        PolarityEdgeOdeSystem ode_system(initial_conditions);
+        SetNeighbourLevels(ode_system);
+
+        // Error control keeps the solution sensible even with an absurd maximum step
+        std::vector<double> state = initial_conditions;
+        RosenbrockWIvpOdeSolver solver;
+        OdeSolution solution = solver.Solve(&ode_system, state, 0.0, 1000.0, 100.0, 100.0);
+        TS_ASSERT_EQUALS(solution.rGetTimes().size(), 11u);
+        for (unsigned i = 0; i < 8; i++)
+        {
+            TS_ASSERT(std::isfinite(state[i]));
+            TS_ASSERT_LESS_THAN(-1e-6, state[i]);
+        }
+    }
+
+    void TestUseWithSrnModel()
+    {
+        PolarityEdgeOdeSolverRegistry* p_registry = PolarityEdgeOdeSolverRegistry::Instance();
+        TS_ASSERT(p_registry->HasSolver("RosenbrockW"));
+        TS_ASSERT(p_registry->IsAdaptive("RosenbrockW"));
+
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver = p_registry->CreateSolver("RosenbrockW");
+        TS_ASSERT(p_solver->IsSetUp());
+        TS_ASSERT(p_solver == (CellCycleModelOdeSolver<PolarityEdgeSrnModel, RosenbrockWIvpOdeSolver>::Instance()));
+
+        const std::string original_solver = p_registry->rGetActiveSolver();
+        p_registry->SetActiveSolver("RosenbrockW");
+        PolarityEdgeSrnModel srn_model;
+        TS_ASSERT_DELTA(srn_model.GetDt(), 0.1, 1e-12);
+        p_registry->SetActiveSolver(original_solver);
+
+        // A copy, as made on division, keeps the step proposed for the parent
+        auto p_parent_system = static_cast<AbstractReactionNetworkOdeSystem*>(srn_model.GetOdeSystem());
+        p_parent_system->SetSuggestedTimeStep(0.037);
+        boost::shared_ptr<AbstractSrnModel> p_copy(srn_model.CreateSrnModel());
+        auto p_copied_system = static_cast<AbstractReactionNetworkOdeSystem*>(
+            boost::static_pointer_cast<PolarityEdgeSrnModel>(p_copy)->GetOdeSystem());
+        TS_ASSERT_DELTA(p_copied_system->GetSuggestedTimeStep(), 0.037, 1e-12);
+    }
+};
+
+#endif /*TESTROSENBROCKWIVPODESOLVER_HPP_*/